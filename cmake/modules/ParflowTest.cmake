@@ -14,9 +14,15 @@
 #
 # For sequential tests set topology to 1 1 1
 #
+# An optional exchange argument runs the test with the AMPS_EXCHANGE
+# engine set to that value.
+#
 function (pf_add_parallel_test inputfile topology)
   string(REGEX REPLACE "/\.tcl" "" testname ${inputfile})
   string(REGEX REPLACE " " "_" postfix ${topology})
+  if (ARGC GREATER 2)
+    set (postfix ${postfix}_${ARGV2})
+  endif()
 
   list(APPEND args ${inputfile})
   separate_arguments(targs UNIX_COMMAND ${topology})
@@ -29,6 +35,13 @@ function (pf_add_parallel_test inputfile topology)
     add_test (NAME ${testname}_${postfix}_memcheck COMMAND ${CMAKE_COMMAND} -DPARFLOW_HAVE_MEMORYCHECK=${PARFLOW_HAVE_MEMORYCHECK} -DPARFLOW_MEMORYCHECK_COMMAND=${PARFLOW_MEMORYCHECK_COMMAND} -DPARFLOW_MEMORYCHECK_COMMAND_OPTIONS=${PARFLOW_MEMORYCHECK_COMMAND_OPTIONS} "-DPARFLOW_TEST=${args}" -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
   endif ()
 
+  if (ARGC GREATER 2)
+    set_tests_properties(${testname}_${postfix} PROPERTIES ENVIRONMENT "AMPS_EXCHANGE=${ARGV2}")
+    if( ${PARFLOW_HAVE_MEMORYCHECK} )
+      set_tests_properties(${testname}_${postfix}_memcheck PROPERTIES ENVIRONMENT "AMPS_EXCHANGE=${ARGV2}")
+    endif()
+  endif()
+
 endfunction()
 
 #
@@ -56,14 +69,27 @@ endfunction()
 #
 # inputfile is the TCL script that defines the test.
 #
+# An optional exchange argument runs the test with the AMPS_EXCHANGE
+# engine set to that value.
+#
 function (pf_add_amps_parallel_test test ranks loops)
   set (testname amps-${test}-${ranks}-${loops})
+  if (ARGC GREATER 3)
+    set (testname ${testname}-${ARGV3})
+  endif()
 
   add_test (NAME ${testname} COMMAND ${CMAKE_COMMAND} -DPARFLOW_TEST=${test} -DPARFLOW_RANKS=${ranks} -DPARFLOW_ARGS=${loops} -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunAmpsTest.cmake)
 
   if( ${PARFLOW_HAVE_MEMORYCHECK} )
     add_test (NAME ${testname}_memcheck COMMAND ${CMAKE_COMMAND} -DPARFLOW_HAVE_MEMORYCHECK=${PARFLOW_HAVE_MEMORYCHECK} -DPARFLOW_MEMORYCHECK_COMMAND=${PARFLOW_MEMORYCHECK_COMMAND} -DPARFLOW_MEMORYCHECK_COMMAND_OPTIONS=${PARFLOW_MEMORYCHECK_COMMAND_OPTIONS} -DPARFLOW_TEST=${test} -DPARFLOW_RANKS=${ranks} -DPARFLOW_ARGS=${loops} -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunAmpsTest.cmake)
   endif()
+
+  if (ARGC GREATER 3)
+    set_tests_properties(${testname} PROPERTIES ENVIRONMENT "AMPS_EXCHANGE=${ARGV3}")
+    if( ${PARFLOW_HAVE_MEMORYCHECK} )
+      set_tests_properties(${testname}_memcheck PROPERTIES ENVIRONMENT "AMPS_EXCHANGE=${ARGV3}")
+    endif()
+  endif()
 endfunction()
 
 #
@@ -79,6 +79,11 @@ int amps_Wait(amps_Handle handle)
 {
   if (handle)
   {
+#ifdef AMPS_HANDLE_ALLREDUCE
+    if (handle->type == AMPS_HANDLE_ALLREDUCE)
+      _amps_wait_allreduce(handle);
+    else
+#endif
     if (handle->type)
       amps_Recv(handle->comm, handle->id, handle->invoice);
     else
@@ -363,12 +363,18 @@ typedef struct {
 
 typedef amps_PackageStruct *amps_Package;
 
+/* Handle types; handles for receives and exchanges are set by amps_NewHandle */
+#define AMPS_HANDLE_EXCHANGE  0
+#define AMPS_HANDLE_RECV      1
+#define AMPS_HANDLE_ALLREDUCE 2
+
 typedef struct _amps_HandleObject {
   int type;
   amps_Comm comm;
   int id;
   amps_Invoice invoice;
   amps_Package package;
+  MPI_Request request;
 } amps_HandleObject;
 
 typedef amps_HandleObject *amps_Handle;
@@ -187,3 +187,99 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
   
   return 0;
 }
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_AllReduceDouble} reduces {\bf count} contiguous doubles in
+ * place over all the nodes of a context.  It does the same reduction as
+ * \Ref{amps_AllReduce} with a "%*d" invoice without building an invoice
+ * or copying through temporary buffers, which matters for the scalar
+ * reductions done in every Krylov iteration.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * double sum;
+ *
+ * // sum of the local sums on all nodes
+ * amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
+ * \end{verbatim}
+ *
+ * @memo Reduction of doubles
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Error code
+ */
+int amps_AllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation)
+{
+  return MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm);
+}
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_AllReduceInt} is \Ref{amps_AllReduceDouble} for ints.
+ *
+ * @memo Reduction of ints
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Error code
+ */
+int amps_AllReduceInt(amps_Comm comm, int *data, int count, MPI_Op operation)
+{
+  return MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_INT, operation, comm);
+}
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_IAllReduceDouble} starts a non-blocking
+ * \Ref{amps_AllReduceDouble}.  The {\bf data} may not be accessed until
+ * \Ref{amps_Wait} has been called on the returned handle.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * double      sums[2];
+ * amps_Handle handle;
+ *
+ * handle = amps_IAllReduceDouble(amps_CommWorld, sums, 2, amps_Add);
+ *
+ * // do some work
+ *
+ * amps_Wait(handle);
+ * \end{verbatim}
+ *
+ * {\large Notes:}
+ *
+ * Without MPI-3 the reduction is done before returning.
+ *
+ * @memo Non-blocking reduction of doubles
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Handle for the reduction
+ */
+amps_Handle amps_IAllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation)
+{
+  amps_Handle handle;
+
+#if MPI_VERSION >= 3
+  handle = amps_NewHandle(comm, 0, NULL, NULL);
+  handle->type = AMPS_HANDLE_ALLREDUCE;
+
+  MPI_Iallreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm,
+                 &handle->request);
+#else
+  MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm);
+  handle = NULL;
+#endif
+
+  return handle;
+}
+
+void _amps_wait_allreduce(amps_Handle handle)
+{
+  MPI_Wait(&handle->request, MPI_STATUS_IGNORE);
+}
@@ -9,9 +9,12 @@ set(AMPS_SRC_FILES
   amps_invoice.c
   amps_irecv.c
   amps_newpackage.c
+  amps_nodes.c
   amps_pack.c
+  amps_profile.c
   amps_recv.c
   amps_send.c
+  amps_shared.c
   amps_sizeofinvoice.c
   amps_test.c
   amps_unpack.c
@@ -166,6 +166,62 @@ extern int amps_node_size;
 extern int amps_write_rank;
 extern int amps_write_size;
 
+/*
+ * Engines for amps_IExchangePackage, selected at run time with the
+ * AMPS_EXCHANGE environment variable ("p2p", "neighbor", "shared" or
+ * "threaded").  The neighborhood collective and node shared memory
+ * engines need MPI-3 and persistent requests.  The threaded engine packs
+ * and posts the messages of an exchange from OpenMP threads, it needs
+ * an OpenMP build and MPI_THREAD_MULTIPLE.
+ */
+#if MPI_VERSION >= 3 && !defined(AMPS_MPI_NOT_USE_PERSISTENT) && \
+  !defined(PARFLOW_HAVE_CUDA) && !defined(PARFLOW_HAVE_KOKKOS)
+#define AMPS_MPI_NEIGHBOR_EXCHANGE
+#define AMPS_MPI_SHARED_EXCHANGE
+#ifdef _OPENMP
+#define AMPS_MPI_THREADED_EXCHANGE
+#endif
+#endif
+
+#define AMPS_EXCHANGE_P2P      0
+#define AMPS_EXCHANGE_NEIGHBOR 1
+#define AMPS_EXCHANGE_SHARED   2
+#define AMPS_EXCHANGE_THREADED 3
+
+extern int amps_exchange_engine;
+
+/* Thread support level provided by MPI */
+extern int amps_thread_level;
+
+/*
+ * amps_NodeIndices finds which processes share a compute node, it
+ * needs MPI_Comm_split_type from MPI-3.
+ */
+#if MPI_VERSION >= 3
+#define AMPS_NODE_INDICES
+#endif
+
+/*
+ * Communication profiling.  Exchanges and reductions are counted per
+ * call site; a site is a name such as the one given to a package with
+ * amps_SetPackageName.  The counters are always on, they are gathered
+ * over all ranks with amps_ProfileGather.
+ */
+#define AMPS_PROFILE
+
+#define AMPS_PROFILE_NAME_LENGTH 64
+
+typedef struct {
+  char name[AMPS_PROFILE_NAME_LENGTH];
+  int ranks;            /* number of ranks that used the site */
+  double calls;         /* exchanges or reductions started */
+  double messages;      /* point to point messages sent */
+  double bytes;         /* bytes sent or reduced */
+  double time;          /* seconds spent waiting for completion */
+  double time_min;      /* min and max of time over the ranks */
+  double time_max;
+} amps_ProfileStats;
+
 /*===========================================================================*/
 /**
  *
@@ -328,6 +384,40 @@ typedef struct amps_buffer {
   char *buffer;
 } amps_Buffer;
 
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+/*
+ * Default size in bytes of the node shared memory segment of each
+ * process, overridden by AMPS_SHARED_POOL_SIZE; pieces are aligned to
+ * cache lines.
+ */
+#define AMPS_SHARED_POOL_SIZE 268435456
+#define AMPS_SHARED_ALIGN     64
+
+/* Piece of the node shared memory segment, used or free */
+typedef struct amps_shared_block {
+  struct amps_shared_block *next;
+
+  char          *base;
+  size_t size;
+} amps_SharedBlock;
+
+/* Copy of a run of doubles from a process on the same node */
+typedef struct {
+  double        *dest;
+  double        *src;
+  int length;
+} amps_SharedCopy;
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+/* Strided run of doubles packed into or unpacked from a message */
+typedef struct {
+  double        *data;
+  int length;
+  int stride;
+} amps_ThreadedRun;
+#endif
+
 /*===========================================================================*/
 /* Package structure is used by the Exchange functions.  Contains several    */
 /* Invoices plus the src or dest rank.                                       */
@@ -347,16 +437,72 @@ typedef struct {
   MPI_Status    *status;
 
   int commited;
+
+  /* Profiling site and bytes sent per exchange, -1 until computed */
+  int profile_site;
+  long profile_bytes;
+
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+  /* Neighborhood collective exchange state, set up on first exchange */
+  int neighbor;
+  MPI_Comm neighbor_comm;
+  int           *neighbor_counts;
+  MPI_Aint      *neighbor_displs;
+  MPI_Datatype  *neighbor_types;
+  MPI_Request neighbor_request;
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+  /*
+   * Node shared memory exchange state, set up on first exchange.  Shared
+   * receive j runs copies shared_first_copy[j] to shared_first_copy[j+1]-1
+   * once its ready message arrives and then sends its done message; each
+   * shared send has a ready send and a done receive in
+   * shared_notify_requests.
+   */
+  int shared;
+  int num_shared_copies;
+  amps_SharedCopy *shared_copies;
+  int num_shared_requests;
+  MPI_Request     *shared_requests;
+  int num_shared_recvs;
+  int             *shared_first_copy;
+  MPI_Request     *shared_ready_requests;
+  MPI_Request     *shared_done_requests;
+  int num_shared_sends;
+  MPI_Request     *shared_notify_requests;
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  /*
+   * Thread parallel exchange state, set up on first exchange.  The
+   * messages are numbered receives first; message i is packed from or
+   * unpacked to runs threaded_first_run[i] to threaded_first_run[i+1]-1
+   * and sent from threaded_buffer + threaded_offsets[i].
+   */
+  int threaded;
+  int              *threaded_first_run;
+  amps_ThreadedRun *threaded_runs;
+  long             *threaded_offsets;
+  double           *threaded_buffer;
+  MPI_Request      *threaded_requests;
+#endif
 } amps_PackageStruct;
 
 typedef amps_PackageStruct *amps_Package;
 
+/* Handle types; handles for receives and exchanges are set by amps_NewHandle */
+#define AMPS_HANDLE_EXCHANGE  0
+#define AMPS_HANDLE_RECV      1
+#define AMPS_HANDLE_ALLREDUCE 2
+
 typedef struct _amps_HandleObject {
   int type;
   amps_Comm comm;
   int id;
   amps_Invoice invoice;
   amps_Package package;
+  MPI_Request request;
 } amps_HandleObject;
 
 typedef amps_HandleObject *amps_Handle;
@@ -1031,6 +1177,44 @@ void amps_ReadDouble(amps_File file, double *ptr, int len);
 #define amps_TFree(ptr) if (ptr) free(ptr); else {}
 /* note: the `else' is required to guarantee termination of the `if' */
 
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+/**
+ *
+ * \Ref{amps_CTAllocShared} allocates cleared memory for data that is
+ * communicated with \Ref{amps_IExchangePackage}.  When the node shared
+ * memory exchange engine is selected (AMPS_EXCHANGE=shared) the memory
+ * comes from an MPI shared window so that processes on the same node can
+ * copy ghost data directly.
+ *
+ * {\large Notes:}
+ *
+ * Each process has one shared segment, allocated by \Ref{amps_Init},
+ * of AMPS_SHARED_POOL_SIZE bytes.  Allocations are local to the process;
+ * once the segment is full the memory is allocated with calloc and is
+ * exchanged with messages.
+ *
+ * @memo Allocate node shared memory and clear it
+ * @param type The C type name
+ * @param count Number of items of type to allocate
+ * @return Pointer to the allocated dataspace
+ */
+#define amps_CTAllocShared(type, count) \
+  ((type*)_amps_ctalloc_shared((size_t)(count) * sizeof(type)))
+
+/**
+ *
+ * Frees memory allocated with \Ref{amps_CTAllocShared}.
+ *
+ * @memo Free memory allocated with \Ref{amps_CTAllocShared}
+ * @param ptr Pointer to dataspace to free
+ * @return Error code
+ */
+#define amps_TFreeShared(ptr) _amps_tfree_shared(ptr)
+#else
+#define amps_CTAllocShared(type, count) amps_CTAlloc(type, count)
+#define amps_TFreeShared(ptr) amps_TFree(ptr)
+#endif
+
 // SGS FIXME this should do something more than this
 #define amps_Error(name, type, comment, operation) \
   printf("%s : %s\n", name, comment)
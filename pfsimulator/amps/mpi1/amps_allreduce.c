@@ -30,6 +30,15 @@
 
 #include <strings.h>
 
+/* Profiling sites of the reductions, added on first use */
+static int amps_allreduce_site = -1;
+static int amps_allreduce_double_site = -1;
+static int amps_allreduce_int_site = -1;
+static int amps_iallreduce_double_site = -1;
+
+#define AMPS_PROFILE_SITE(site, name) \
+  ((site) < 0 ? ((site) = _amps_profile_site(name)) : (site))
+
 /*===========================================================================*/
 /**
  * The collective operation \Ref{amps_AllReduce} is used to take information
@@ -79,6 +88,8 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
   MPI_Datatype mpi_type = MPI_CHAR;
   int element_size = 0;
 
+  double start;
+
   ptr = invoice->list;
 
   while (ptr != NULL)
@@ -170,7 +181,11 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
            ptr_src += stride * element_size, ptr_dest += element_size)
         bcopy(ptr_src, ptr_dest, (size_t)(element_size));
 
+    start = MPI_Wtime();
     MPI_Allreduce(in_buffer, out_buffer, len, mpi_type, operation, comm);
+    _amps_profile_record(AMPS_PROFILE_SITE(amps_allreduce_site, "AllReduce"),
+                         1, 0, (double)(len * element_size),
+                         MPI_Wtime() - start);
 
     /* Copy back into user variables */
     if (stride == 1)
@@ -188,3 +203,128 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
   }
   return 0;
 }
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_AllReduceDouble} reduces {\bf count} contiguous doubles in
+ * place over all the nodes of a context.  It does the same reduction as
+ * \Ref{amps_AllReduce} with a "%*d" invoice without building an invoice
+ * or copying through temporary buffers, which matters for the scalar
+ * reductions done in every Krylov iteration.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * double sum;
+ *
+ * // sum of the local sums on all nodes
+ * amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
+ * \end{verbatim}
+ *
+ * @memo Reduction of doubles
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Error code
+ */
+int amps_AllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation)
+{
+  double start = MPI_Wtime();
+  int result;
+
+  result = MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm);
+
+  _amps_profile_record(AMPS_PROFILE_SITE(amps_allreduce_double_site,
+                                         "AllReduceDouble"),
+                       1, 0, (double)count * sizeof(double),
+                       MPI_Wtime() - start);
+
+  return result;
+}
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_AllReduceInt} is \Ref{amps_AllReduceDouble} for ints.
+ *
+ * @memo Reduction of ints
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Error code
+ */
+int amps_AllReduceInt(amps_Comm comm, int *data, int count, MPI_Op operation)
+{
+  double start = MPI_Wtime();
+  int result;
+
+  result = MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_INT, operation, comm);
+
+  _amps_profile_record(AMPS_PROFILE_SITE(amps_allreduce_int_site,
+                                         "AllReduceInt"),
+                       1, 0, (double)count * sizeof(int),
+                       MPI_Wtime() - start);
+
+  return result;
+}
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_IAllReduceDouble} starts a non-blocking
+ * \Ref{amps_AllReduceDouble}.  The {\bf data} may not be accessed until
+ * \Ref{amps_Wait} has been called on the returned handle.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * double      sums[2];
+ * amps_Handle handle;
+ *
+ * handle = amps_IAllReduceDouble(amps_CommWorld, sums, 2, amps_Add);
+ *
+ * // do some work
+ *
+ * amps_Wait(handle);
+ * \end{verbatim}
+ *
+ * {\large Notes:}
+ *
+ * Without MPI-3 the reduction is done before returning.
+ *
+ * @memo Non-blocking reduction of doubles
+ * @param comm communication context for the reduction [IN]
+ * @param data values to reduce [IN/OUT]
+ * @param count number of values [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Handle for the reduction
+ */
+amps_Handle amps_IAllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation)
+{
+  amps_Handle handle;
+
+  _amps_profile_record(AMPS_PROFILE_SITE(amps_iallreduce_double_site,
+                                         "IAllReduceDouble"),
+                       1, 0, (double)count * sizeof(double), 0.0);
+
+#if MPI_VERSION >= 3
+  handle = amps_NewHandle(comm, 0, NULL, NULL);
+  handle->type = AMPS_HANDLE_ALLREDUCE;
+
+  MPI_Iallreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm,
+                 &handle->request);
+#else
+  MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, operation, comm);
+  handle = NULL;
+#endif
+
+  return handle;
+}
+
+void _amps_wait_allreduce(amps_Handle handle)
+{
+  double start = MPI_Wtime();
+
+  MPI_Wait(&handle->request, MPI_STATUS_IGNORE);
+
+  _amps_profile_record(amps_iallreduce_double_site, 0, 0, 0,
+                       MPI_Wtime() - start);
+}
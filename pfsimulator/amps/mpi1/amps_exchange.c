@@ -28,10 +28,12 @@
 
 #include "amps.h"
 
+#include <limits.h>
+
 /* This CUDA stuff could be combined with AMPS_MPI_NOT_USE_PERSISTENT case */
 #if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS)
 
-void _amps_wait_exchange(amps_Handle handle)
+static void _amps_complete_exchange(amps_Handle handle)
 {
   char *combuf;
   int i;
@@ -72,7 +74,7 @@ void _amps_wait_exchange(amps_Handle handle)
   }
 }
 
-amps_Handle amps_IExchangePackage(amps_Package package)
+static amps_Handle _amps_start_exchange(amps_Package package)
 {
   char **combuf;
   int *size;
@@ -142,7 +144,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
 #elif defined(AMPS_MPI_NOT_USE_PERSISTENT)
 
-void _amps_wait_exchange(amps_Handle handle)
+static void _amps_complete_exchange(amps_Handle handle)
 {
   int i;
 
@@ -169,7 +171,7 @@ void _amps_wait_exchange(amps_Handle handle)
   }
 }
 
-amps_Handle amps_IExchangePackage(amps_Package package)
+static amps_Handle _amps_start_exchange(amps_Package package)
 {
   int i;
 
@@ -206,183 +208,1298 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
 #else
 
-void _amps_wait_exchange(amps_Handle handle)
-{
-  int i;
-  int num;
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
 
-  num = handle->package->num_send + handle->package->num_recv;
+/*
+ * Distributed graph communicators used by the neighborhood collective
+ * engine.  Packages with the same neighbors (e.g. every vector on a
+ * grid for a given update mode) share a communicator.  Communicators
+ * are created collectively and numbered in creation order so the
+ * numbers agree on all processes; they live until amps_Finalize.
+ */
+typedef struct amps_neighbor_comm {
+  struct amps_neighbor_comm *next;
 
-  if (num)
+  int id;
+  int num_recv;
+  int           *src;
+  int num_send;
+  int           *dest;
+
+  MPI_Comm comm;
+} amps_NeighborComm;
+
+static amps_NeighborComm *amps_neighbor_comms = NULL;
+static int amps_num_neighbor_comms = 0;
+
+static amps_NeighborComm *_amps_find_neighbor_comm(amps_Package package)
+{
+  amps_NeighborComm *neighbor_comm;
+
+  for (neighbor_comm = amps_neighbor_comms; neighbor_comm;
+       neighbor_comm = neighbor_comm->next)
   {
-    if (handle->package->num_recv)
+    if (neighbor_comm->num_recv == package->num_recv &&
+        neighbor_comm->num_send == package->num_send &&
+        !memcmp(neighbor_comm->src, package->src,
+                (size_t)package->num_recv * sizeof(int)) &&
+        !memcmp(neighbor_comm->dest, package->dest,
+                (size_t)package->num_send * sizeof(int)))
     {
-      for (i = 0; i < handle->package->num_recv; i++)
-      {
-        AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
-      }
+      return neighbor_comm;
     }
+  }
 
-    MPI_Waitall(num, handle->package->recv_requests,
-                handle->package->status);
+  return NULL;
+}
+
+/*
+ * Returns the graph communicator for the package neighbors.  This is
+ * collective over amps_CommWorld: a cached communicator is used only if
+ * every process found the same one, otherwise a new one is created.
+ */
+static MPI_Comm _amps_neighbor_comm(amps_Package package)
+{
+  amps_NeighborComm *neighbor_comm;
+  int ids[2];
+  int agreed[2];
+  int *weights;
+  int num_weights;
+  int i;
+
+  neighbor_comm = _amps_find_neighbor_comm(package);
+
+  ids[0] = neighbor_comm ? neighbor_comm->id : -1;
+  ids[1] = -ids[0];
+  MPI_Allreduce(ids, agreed, 2, MPI_INT, MPI_MIN, amps_CommWorld);
+
+  if (agreed[0] >= 0 && agreed[0] == -agreed[1])
+  {
+    return neighbor_comm->comm;
   }
 
-#ifdef AMPS_MPI_PACKAGE_LOWSTORAGE
-  /* Needed by the DEC's; need better memory allocation strategy */
-  /* Need to uncommit packages when not in use */
-  /* amps_Commit followed by amps_UnCommit ????? */
-  if (handle->package->commited)
+  neighbor_comm = (amps_NeighborComm*)calloc(1, sizeof(amps_NeighborComm));
+
+  neighbor_comm->id = amps_num_neighbor_comms++;
+  neighbor_comm->num_recv = package->num_recv;
+  neighbor_comm->num_send = package->num_send;
+  neighbor_comm->src = (int*)malloc((size_t)(package->num_recv + 1) * sizeof(int));
+  neighbor_comm->dest = (int*)malloc((size_t)(package->num_send + 1) * sizeof(int));
+  memcpy(neighbor_comm->src, package->src,
+         (size_t)package->num_recv * sizeof(int));
+  memcpy(neighbor_comm->dest, package->dest,
+         (size_t)package->num_send * sizeof(int));
+
+  /*
+   * Every edge gets a unit weight.  Passing MPI_UNWEIGHTED instead makes
+   * compilers that check the array arguments of the MPI prototypes warn
+   * about reading from a region of size 0.
+   */
+  num_weights = (package->num_recv > package->num_send) ?
+                package->num_recv : package->num_send;
+  weights = (int*)malloc((size_t)(num_weights + 1) * sizeof(int));
+  for (i = 0; i <= num_weights; i++)
   {
-    for (i = 0; i < handle->package->num_recv; i++)
-    {
-      if (handle->package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
-      {
-        MPI_Type_free(&(handle->package->recv_invoices[i]->mpi_type));
-      }
+    weights[i] = 1;
+  }
 
-      MPI_Request_free(&(handle->package->recv_requests[i]));
-    }
+  /* Ranks are not reordered; the graph only describes the exchange */
+  MPI_Dist_graph_create_adjacent(amps_CommWorld,
+                                 package->num_recv, neighbor_comm->src,
+                                 weights,
+                                 package->num_send, neighbor_comm->dest,
+                                 weights,
+                                 MPI_INFO_NULL, 0, &neighbor_comm->comm);
 
-    for (i = 0; i < handle->package->num_send; i++)
-    {
-      if (handle->package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
-      {
-        MPI_Type_free(&handle->package->send_invoices[i]->mpi_type);
-      }
+  free(weights);
 
-      MPI_Request_free(&(handle->package->send_requests[i]));
-    }
+  /* Newer entries are searched first */
+  neighbor_comm->next = amps_neighbor_comms;
+  amps_neighbor_comms = neighbor_comm;
 
-    if (handle->package->recv_requests)
+  return neighbor_comm->comm;
+}
+
+void _amps_free_neighbor_comms()
+{
+  amps_NeighborComm *neighbor_comm;
+
+  while (amps_neighbor_comms)
+  {
+    neighbor_comm = amps_neighbor_comms;
+    amps_neighbor_comms = neighbor_comm->next;
+
+    MPI_Comm_free(&neighbor_comm->comm);
+    free(neighbor_comm->src);
+    free(neighbor_comm->dest);
+    free(neighbor_comm);
+  }
+
+  amps_num_neighbor_comms = 0;
+}
+
+/*
+ * Sets up a package for exchange with MPI_Neighbor_alltoallw.  Each
+ * invoice becomes one block of the collective using its absolute
+ * address datatype, so no data is packed by AMPS.  With MPI-4 the
+ * collective is persistent and only started on each exchange.
+ */
+static void _amps_neighbor_commit(amps_Package package)
+{
+  int num = package->num_recv + package->num_send;
+  int i;
+
+  package->neighbor_comm = _amps_neighbor_comm(package);
+
+  package->neighbor_counts = (int*)malloc((size_t)(num + 1) * sizeof(int));
+  package->neighbor_displs = (MPI_Aint*)malloc((size_t)(num + 1) * sizeof(MPI_Aint));
+  package->neighbor_types =
+    (MPI_Datatype*)malloc((size_t)(num + 1) * sizeof(MPI_Datatype));
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+    MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+
+    package->neighbor_counts[i] = 1;
+    package->neighbor_displs[i] = 0;
+    package->neighbor_types[i] = package->recv_invoices[i]->mpi_type;
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
+    MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+
+    package->neighbor_counts[package->num_recv + i] = 1;
+    package->neighbor_displs[package->num_recv + i] = 0;
+    package->neighbor_types[package->num_recv + i] =
+      package->send_invoices[i]->mpi_type;
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Neighbor_alltoallw_init(MPI_BOTTOM,
+                              package->neighbor_counts + package->num_recv,
+                              package->neighbor_displs + package->num_recv,
+                              package->neighbor_types + package->num_recv,
+                              MPI_BOTTOM,
+                              package->neighbor_counts,
+                              package->neighbor_displs,
+                              package->neighbor_types,
+                              package->neighbor_comm, MPI_INFO_NULL,
+                              &package->neighbor_request);
+#endif
+
+  package->neighbor = TRUE;
+  package->commited = TRUE;
+}
+
+static amps_Handle _amps_neighbor_exchange(amps_Package package)
+{
+  if (!package->commited)
+  {
+    _amps_neighbor_commit(package);
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Start(&package->neighbor_request);
+#else
+  MPI_Ineighbor_alltoallw(MPI_BOTTOM,
+                          package->neighbor_counts + package->num_recv,
+                          package->neighbor_displs + package->num_recv,
+                          package->neighbor_types + package->num_recv,
+                          MPI_BOTTOM,
+                          package->neighbor_counts,
+                          package->neighbor_displs,
+                          package->neighbor_types,
+                          package->neighbor_comm,
+                          &package->neighbor_request);
+#endif
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+static void _amps_neighbor_wait(amps_Handle handle)
+{
+  int i;
+
+  for (i = 0; i < handle->package->num_recv; i++)
+  {
+    AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
+  }
+
+  MPI_Wait(&handle->package->neighbor_request, MPI_STATUS_IGNORE);
+}
+
+void _amps_neighbor_free(amps_Package package)
+{
+  int i;
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    if (package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
     {
-      free(handle->package->recv_requests);
-      handle->package->recv_requests = NULL;
+      MPI_Type_free(&(package->recv_invoices[i]->mpi_type));
     }
-    if (handle->package->status)
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    if (package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
     {
-      free(handle->package->status);
-      handle->package->status = NULL;
+      MPI_Type_free(&package->send_invoices[i]->mpi_type);
     }
-
-    handle->package->commited = FALSE;
   }
+
+#if MPI_VERSION >= 4
+  MPI_Request_free(&package->neighbor_request);
 #endif
+
+  free(package->neighbor_counts);
+  free(package->neighbor_displs);
+  free(package->neighbor_types);
+
+  /* The communicator is owned by the neighbor communicator list */
+  package->neighbor_comm = MPI_COMM_NULL;
+  package->neighbor = FALSE;
+  package->commited = FALSE;
 }
 
-/*===========================================================================*/
-/**
- *
- * The \Ref{amps_IExchangePackage} initiates the communication of the
- * invoices found in the {\bf package} structure that is passed in.  Once a
- * \Ref{amps_IExchangePackage} is issued it is illegal to access the
- * variables that are being communicated.  An \Ref{amps_IExchangePackage}
- * is always followed by an \Ref{amps_Wait} on the {\bf handle} that is
- * returned.
- *
- * {\large Example:}
- * \begin{verbatim}
- * // Initialize exchange of boundary points
- * handle = amps_IExchangePackage(package);
- *
- * // Compute on the "interior points"
- *
- * // Wait for the exchange to complete
- * amps_Wait(handle);
- * \end{verbatim}
- *
- * {\large Notes:}
- *
- * This routine can be optimized on some architectures so if your
- * communication can be formulated using it there might be
- * some performance advantages.
- *
- * @memo Initiate package communication
- * @param package the collection of invoices to communicate
- * @return Handle for the asynchronous communication
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+
+/*
+ * Tags used on amps_CommNode to set up shared memory exchanges and for
+ * the empty messages that say the sent data is ready to be copied and
+ * that the copy is done.
  */
-amps_Handle amps_IExchangePackage(amps_Package package)
+#define AMPS_SHARED_HEADER_TAG  1
+#define AMPS_SHARED_OFFSETS_TAG 2
+#define AMPS_SHARED_ACCEPT_TAG  3
+#define AMPS_SHARED_READY_TAG   4
+#define AMPS_SHARED_DONE_TAG    5
+
+/*
+ * Flattens an invoice of doubles that lives in the node shared segment
+ * of this process into the offsets (in doubles) of its elements from the
+ * segment start, in the order MPI would send them.  Returns the number
+ * of elements or -1 if the invoice is not in the segment or holds other
+ * types.
+ */
+static long _amps_flatten_invoice(
+                                  amps_Invoice inv,
+                                  long **      offsets_ptr)
 {
+  amps_InvoiceEntry *ptr;
+  long *offsets;
+  char *segment;
+  long num = 0;
+  long start, offset, index, extent;
+  long n, count;
+  char *data;
+  int dim, len, stride;
+  int *lens, *strides;
+  long step[3];
   int i;
-  int num;
 
-  num = package->num_send + package->num_recv;
+  *offsets_ptr = NULL;
 
-  /*-------------------------------------------------------------------
-  * Check if we need to allocate the MPI types and requests
-  *------------------------------------------------------------------*/
-  if (!package->commited)
+  if (inv->list == NULL)
   {
-    package->commited = TRUE;
-
-    /*--------------------------------------------------------------------
-     * Allocate the arrays need for MPI
-     *--------------------------------------------------------------------*/
-    if (num)
-    {
-      package->recv_requests = (MPI_Request*)calloc((size_t)(num),
-                                                    sizeof(MPI_Request));
+    return -1;
+  }
 
-      package->status = (MPI_Status*)calloc((size_t)(num),
-                                            sizeof(MPI_Status));
+  /* count the elements and check the entries can be flattened */
+  for (ptr = inv->list; ptr != NULL; ptr = ptr->next)
+  {
+    data = (ptr->data_type == AMPS_INVOICE_POINTER) ?
+           *((char**)(ptr->data)) : (char*)ptr->data;
 
-      package->send_requests = package->recv_requests +
-                               package->num_recv;
+    if (ptr->ignore || _amps_shared_offset(data) < 0 ||
+        _amps_shared_offset(data) % sizeof(double))
+    {
+      return -1;
     }
 
-    /*--------------------------------------------------------------------
-     * Set up the receive types and requests
-     *--------------------------------------------------------------------*/
-    if (package->num_recv)
+    if (ptr->type == AMPS_INVOICE_DOUBLE_CTYPE)
     {
-      for (i = 0; i < package->num_recv; i++)
+      num += (ptr->len_type == AMPS_INVOICE_POINTER) ?
+             *(ptr->ptr_len) : ptr->len;
+    }
+    else if (ptr->type == AMPS_INVOICE_LAST_CTYPE + AMPS_INVOICE_DOUBLE_CTYPE)
+    {
+      dim = (ptr->dim_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_dim) : ptr->dim;
+      if (dim > 3)
       {
-        amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
-        MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+        return -1;
+      }
 
-        // Temporaries needed by insure++
-        MPI_Datatype type = package->recv_invoices[i]->mpi_type;
-        MPI_Request *request_ptr = &(package->recv_requests[i]);
-        MPI_Recv_init(MPI_BOTTOM, 1,
-                      type,
-                      package->src[i], 0, amps_CommWorld,
-                      request_ptr);
+      count = 1;
+      for (i = 0; i < dim; i++)
+      {
+        count *= ptr->ptr_len[i];
       }
+      num += count;
     }
+    else
+    {
+      return -1;
+    }
+  }
 
-    /*--------------------------------------------------------------------
-     * Set up the send types and requests
-     *--------------------------------------------------------------------*/
-    if (package->num_send)
+  offsets = (long*)malloc((size_t)(num + 1) * sizeof(long));
+
+  num = 0;
+  for (ptr = inv->list; ptr != NULL; ptr = ptr->next)
+  {
+    data = (ptr->data_type == AMPS_INVOICE_POINTER) ?
+           *((char**)(ptr->data)) : (char*)ptr->data;
+    start = _amps_shared_offset(data) / (long)sizeof(double);
+
+    if (ptr->type == AMPS_INVOICE_DOUBLE_CTYPE)
     {
-      for (i = 0; i < package->num_send; i++)
+      len = (ptr->len_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_len) : ptr->len;
+      stride = (ptr->stride_type == AMPS_INVOICE_POINTER) ?
+               *(ptr->ptr_stride) : ptr->stride;
+
+      for (n = 0; n < len; n++)
       {
-        amps_create_mpi_type(amps_CommWorld,
-                             package->send_invoices[i]);
+        offsets[num++] = start + n * stride;
+      }
+    }
+    else
+    {
+      dim = (ptr->dim_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_dim) : ptr->dim;
+      lens = ptr->ptr_len;
+      strides = ptr->ptr_stride;
 
-        MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+      /* same layout as the hvectors built by amps_create_mpi_type */
+      step[0] = strides[0];
+      extent = (long)(lens[0] - 1) * strides[0] + 1;
+      for (i = 1; i < dim; i++)
+      {
+        step[i] = extent + strides[i] - 1;
+        extent = (long)(lens[i] - 1) * step[i] + extent;
+      }
 
-        // Temporaries needed by insure++
-        MPI_Datatype type = package->send_invoices[i]->mpi_type;
-        MPI_Request* request_ptr = &(package->send_requests[i]);
-        MPI_Ssend_init(MPI_BOTTOM, 1,
-                       type,
-                       package->dest[i], 0, amps_CommWorld,
-                       request_ptr);
+      count = 1;
+      for (i = 0; i < dim; i++)
+      {
+        count *= lens[i];
+      }
+
+      for (n = 0; n < count; n++)
+      {
+        index = n;
+        offset = start;
+        for (i = 0; i < dim; i++)
+        {
+          offset += (index % lens[i]) * step[i];
+          index /= lens[i];
+        }
+        offsets[num++] = offset;
       }
     }
   }
 
-  if (num)
+  segment = _amps_shared_segment(amps_node_rank);
+  for (n = 0; n < num; n++)
   {
-    /*--------------------------------------------------------------------
-     * post send and receives
-     *--------------------------------------------------------------------*/
-    MPI_Startall(num, package->recv_requests);
+    if (offsets[n] < 0 ||
+        _amps_shared_offset(segment + offsets[n] * (long)sizeof(double)) < 0)
+    {
+      free(offsets);
+      return -1;
+    }
   }
 
+  *offsets_ptr = offsets;
 
-  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+  return num;
 }
 
-#endif
+/*
+ * Sets up a package for the shared memory engine.  Processes on the
+ * same node send each other the flattened layout of their send
+ * invoices; when both ends live in the shared segments the receiver
+ * copies the data straight out of the sender's segment.  All other
+ * invoices use persistent point-to-point requests.
+ */
+static void _amps_shared_commit(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num_send = package->num_send;
+
+  amps_SharedCopy  *copy;
+
+  long              *headers;
+  long             **offsets;
+  int               *accept;
+  int               *node_ranks;
+  MPI_Request       *requests;
+  int num_requests = 0;
+  int num_header_requests;
 
+  long *recv_offsets;
+  long num, n;
+  double *base;
+  double *peer_base;
+  int i, j;
+
+  headers = (long*)calloc((size_t)(num_recv + num_send + 1), sizeof(long));
+  offsets = (long**)calloc((size_t)(num_recv + num_send + 1), sizeof(long*));
+  accept = (int*)calloc((size_t)(num_recv + num_send + 1), sizeof(int));
+  node_ranks = (int*)malloc((size_t)(num_recv + num_send + 1) * sizeof(int));
+  requests = (MPI_Request*)malloc((size_t)(2 * (num_recv + num_send) + 1) *
+                                  sizeof(MPI_Request));
+
+  /* receive the send layouts of processes on this node */
+  for (i = 0; i < num_recv; i++)
+  {
+    node_ranks[i] = _amps_node_rank(package->src[i]);
+    if (node_ranks[i] != MPI_UNDEFINED)
+    {
+      MPI_Irecv(&headers[i], 1, MPI_LONG, node_ranks[i],
+                AMPS_SHARED_HEADER_TAG, amps_CommNode,
+                &requests[num_requests++]);
+    }
+  }
+
+  num_header_requests = num_requests;
+
+  for (i = 0; i < num_send; i++)
+  {
+    node_ranks[num_recv + i] = _amps_node_rank(package->dest[i]);
+    if (node_ranks[num_recv + i] != MPI_UNDEFINED)
+    {
+      num = _amps_flatten_invoice(package->send_invoices[i],
+                                  &offsets[num_recv + i]);
+      headers[num_recv + i] = num;
+
+      MPI_Isend(&headers[num_recv + i], 1, MPI_LONG, node_ranks[num_recv + i],
+                AMPS_SHARED_HEADER_TAG, amps_CommNode,
+                &requests[num_requests++]);
+      if (num > 0)
+      {
+        MPI_Isend(offsets[num_recv + i], (int)num, MPI_LONG,
+                  node_ranks[num_recv + i], AMPS_SHARED_OFFSETS_TAG,
+                  amps_CommNode, &requests[num_requests++]);
+      }
+    }
+  }
+
+  MPI_Waitall(num_header_requests, requests, MPI_STATUSES_IGNORE);
+
+  for (i = 0; i < num_recv; i++)
+  {
+    if (node_ranks[i] != MPI_UNDEFINED && headers[i] > 0)
+    {
+      offsets[i] = (long*)malloc((size_t)headers[i] * sizeof(long));
+      MPI_Irecv(offsets[i], (int)headers[i], MPI_LONG, node_ranks[i],
+                AMPS_SHARED_OFFSETS_TAG, amps_CommNode,
+                &requests[num_requests++]);
+    }
+  }
+
+  MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+  num_requests = 0;
+
+  /* accept the invoices whose data is in the shared segments on both ends */
+  base = (double*)_amps_shared_segment(amps_node_rank);
+
+  package->num_shared_copies = 0;
+  package->shared_copies = NULL;
+  package->num_shared_recvs = 0;
+  package->shared_first_copy = (int*)malloc((size_t)(num_recv + 1) * sizeof(int));
+  package->shared_ready_requests = (MPI_Request*)malloc((size_t)(num_recv + 1) *
+                                                        sizeof(MPI_Request));
+  package->shared_done_requests = (MPI_Request*)malloc((size_t)(num_recv + 1) *
+                                                       sizeof(MPI_Request));
+  for (i = 0; i < num_recv; i++)
+  {
+    if (node_ranks[i] != MPI_UNDEFINED)
+    {
+      num = _amps_flatten_invoice(package->recv_invoices[i], &recv_offsets);
+
+      if (num > 0 && num == headers[i])
+      {
+        accept[i] = TRUE;
+
+        peer_base = (double*)_amps_shared_segment(node_ranks[i]);
+
+        j = package->num_shared_recvs++;
+        package->shared_first_copy[j] = package->num_shared_copies;
+        MPI_Recv_init(NULL, 0, MPI_BYTE, node_ranks[i],
+                      AMPS_SHARED_READY_TAG, amps_CommNode,
+                      &package->shared_ready_requests[j]);
+        MPI_Send_init(NULL, 0, MPI_BYTE, node_ranks[i],
+                      AMPS_SHARED_DONE_TAG, amps_CommNode,
+                      &package->shared_done_requests[j]);
+
+        /* merge runs that are contiguous on both ends */
+        package->shared_copies = (amps_SharedCopy*)
+                                 realloc(package->shared_copies,
+                                         (size_t)(package->num_shared_copies + num) *
+                                         sizeof(amps_SharedCopy));
+        copy = NULL;
+        for (n = 0; n < num; n++)
+        {
+          if (copy && recv_offsets[n] == recv_offsets[n - 1] + 1 &&
+              offsets[i][n] == offsets[i][n - 1] + 1)
+          {
+            copy->length++;
+          }
+          else
+          {
+            copy = &package->shared_copies[package->num_shared_copies++];
+            copy->dest = base + recv_offsets[n];
+            copy->src = peer_base + offsets[i][n];
+            copy->length = 1;
+          }
+        }
+      }
+
+      free(recv_offsets);
+
+      MPI_Isend(&accept[i], 1, MPI_INT, node_ranks[i],
+                AMPS_SHARED_ACCEPT_TAG, amps_CommNode,
+                &requests[num_requests++]);
+    }
+  }
+  package->shared_first_copy[package->num_shared_recvs] =
+    package->num_shared_copies;
+
+  for (i = 0; i < num_send; i++)
+  {
+    if (node_ranks[num_recv + i] != MPI_UNDEFINED)
+    {
+      MPI_Irecv(&accept[num_recv + i], 1, MPI_INT, node_ranks[num_recv + i],
+                AMPS_SHARED_ACCEPT_TAG, amps_CommNode,
+                &requests[num_requests++]);
+    }
+  }
+
+  MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+
+  /* everything else goes through persistent requests */
+  package->num_shared_requests = 0;
+  package->shared_requests = (MPI_Request*)malloc((size_t)(num_recv + num_send + 1) *
+                                                  sizeof(MPI_Request));
+  for (i = 0; i < num_recv; i++)
+  {
+    if (accept[i])
+    {
+      package->recv_invoices[i]->mpi_type = MPI_DATATYPE_NULL;
+    }
+    else
+    {
+      amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+      MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+      MPI_Recv_init(MPI_BOTTOM, 1, package->recv_invoices[i]->mpi_type,
+                    package->src[i], 0, amps_CommWorld,
+                    &package->shared_requests[package->num_shared_requests++]);
+    }
+  }
+
+  package->num_shared_sends = 0;
+  package->shared_notify_requests = (MPI_Request*)malloc((size_t)(2 * num_send + 1) *
+                                                         sizeof(MPI_Request));
+  for (i = 0; i < num_send; i++)
+  {
+    if (accept[num_recv + i])
+    {
+      package->send_invoices[i]->mpi_type = MPI_DATATYPE_NULL;
+
+      j = package->num_shared_sends++;
+      MPI_Send_init(NULL, 0, MPI_BYTE, node_ranks[num_recv + i],
+                    AMPS_SHARED_READY_TAG, amps_CommNode,
+                    &package->shared_notify_requests[2 * j]);
+      MPI_Recv_init(NULL, 0, MPI_BYTE, node_ranks[num_recv + i],
+                    AMPS_SHARED_DONE_TAG, amps_CommNode,
+                    &package->shared_notify_requests[2 * j + 1]);
+    }
+    else
+    {
+      amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
+      MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+      MPI_Ssend_init(MPI_BOTTOM, 1, package->send_invoices[i]->mpi_type,
+                     package->dest[i], 0, amps_CommWorld,
+                     &package->shared_requests[package->num_shared_requests++]);
+    }
+  }
+
+  for (i = 0; i < num_recv + num_send; i++)
+  {
+    free(offsets[i]);
+  }
+  free(headers);
+  free(offsets);
+  free(accept);
+  free(node_ranks);
+  free(requests);
+
+  package->shared = TRUE;
+  package->commited = TRUE;
+}
+
+static amps_Handle _amps_shared_exchange(amps_Package package)
+{
+  if (!package->commited)
+  {
+    _amps_shared_commit(package);
+  }
+
+  /* the data written so far must be visible before the ready messages */
+  if (package->num_shared_sends)
+  {
+    _amps_shared_sync();
+  }
+
+  if (package->num_shared_requests)
+  {
+    MPI_Startall(package->num_shared_requests, package->shared_requests);
+  }
+
+  if (package->num_shared_recvs)
+  {
+    MPI_Startall(package->num_shared_recvs, package->shared_ready_requests);
+  }
+
+  if (package->num_shared_sends)
+  {
+    MPI_Startall(2 * package->num_shared_sends,
+                 package->shared_notify_requests);
+  }
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+/*
+ * Copies the data of each neighbor on the node as soon as it says the
+ * data is ready and tells it when the copy is done.  Only processes
+ * that exchange data wait for each other.
+ */
+static void _amps_shared_wait(amps_Handle handle)
+{
+  amps_Package package = handle->package;
+  amps_SharedCopy *copy;
+  int i, j, k;
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    AMPS_CLEAR_INVOICE(package->recv_invoices[i]);
+  }
+
+  for (k = 0; k < package->num_shared_recvs; k++)
+  {
+    MPI_Waitany(package->num_shared_recvs, package->shared_ready_requests,
+                &j, MPI_STATUS_IGNORE);
+
+    _amps_shared_sync();
+    for (i = package->shared_first_copy[j];
+         i < package->shared_first_copy[j + 1]; i++)
+    {
+      copy = &package->shared_copies[i];
+      memcpy(copy->dest, copy->src, (size_t)copy->length * sizeof(double));
+    }
+    _amps_shared_sync();
+
+    MPI_Start(&package->shared_done_requests[j]);
+  }
+
+  if (package->num_shared_requests)
+  {
+    MPI_Waitall(package->num_shared_requests, package->shared_requests,
+                MPI_STATUSES_IGNORE);
+  }
+
+  if (package->num_shared_recvs)
+  {
+    MPI_Waitall(package->num_shared_recvs, package->shared_done_requests,
+                MPI_STATUSES_IGNORE);
+  }
+
+  /* the sent data may not change until every copy of it is done */
+  if (package->num_shared_sends)
+  {
+    MPI_Waitall(2 * package->num_shared_sends,
+                package->shared_notify_requests, MPI_STATUSES_IGNORE);
+    _amps_shared_sync();
+  }
+}
+
+void _amps_shared_free(amps_Package package)
+{
+  int i;
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    if (package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+    {
+      MPI_Type_free(&(package->recv_invoices[i]->mpi_type));
+    }
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    if (package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+    {
+      MPI_Type_free(&package->send_invoices[i]->mpi_type);
+    }
+  }
+
+  for (i = 0; i < package->num_shared_requests; i++)
+  {
+    MPI_Request_free(&package->shared_requests[i]);
+  }
+
+  for (i = 0; i < package->num_shared_recvs; i++)
+  {
+    MPI_Request_free(&package->shared_ready_requests[i]);
+    MPI_Request_free(&package->shared_done_requests[i]);
+  }
+
+  for (i = 0; i < 2 * package->num_shared_sends; i++)
+  {
+    MPI_Request_free(&package->shared_notify_requests[i]);
+  }
+
+  free(package->shared_requests);
+  free(package->shared_copies);
+  free(package->shared_first_copy);
+  free(package->shared_ready_requests);
+  free(package->shared_done_requests);
+  free(package->shared_notify_requests);
+
+  package->shared = FALSE;
+  package->commited = FALSE;
+}
+
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+
+/*
+ * Appends the strided runs of doubles described by an invoice to the
+ * package.  Returns the number of doubles or -1 if the invoice holds
+ * other types.
+ */
+static long _amps_threaded_runs(amps_Package package, amps_Invoice inv,
+                                int *num_runs, int *max_runs)
+{
+  amps_InvoiceEntry *ptr;
+  amps_ThreadedRun *run;
+  double *data;
+  long num = 0;
+  long step[3];
+  long extent, offset, index;
+  int dim, len, stride;
+  int *lens, *strides;
+  int count, n, i;
+
+  for (ptr = inv->list; ptr != NULL; ptr = ptr->next)
+  {
+    if (ptr->ignore)
+    {
+      return -1;
+    }
+
+    data = (ptr->data_type == AMPS_INVOICE_POINTER) ?
+           *((double**)(ptr->data)) : (double*)ptr->data;
+
+    if (ptr->type == AMPS_INVOICE_DOUBLE_CTYPE)
+    {
+      len = (ptr->len_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_len) : ptr->len;
+      stride = (ptr->stride_type == AMPS_INVOICE_POINTER) ?
+               *(ptr->ptr_stride) : ptr->stride;
+      dim = 1;
+      lens = &len;
+      strides = &stride;
+    }
+    else if (ptr->type == AMPS_INVOICE_LAST_CTYPE + AMPS_INVOICE_DOUBLE_CTYPE)
+    {
+      dim = (ptr->dim_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_dim) : ptr->dim;
+      if (dim < 1 || dim > 3)
+      {
+        return -1;
+      }
+      lens = ptr->ptr_len;
+      strides = ptr->ptr_stride;
+    }
+    else
+    {
+      return -1;
+    }
+
+    /* same layout as the hvectors built by amps_create_mpi_type */
+    step[0] = strides[0];
+    extent = (long)(lens[0] - 1) * strides[0] + 1;
+    for (i = 1; i < dim; i++)
+    {
+      step[i] = extent + strides[i] - 1;
+      extent = (long)(lens[i] - 1) * step[i] + extent;
+    }
+
+    /* one run per row of the innermost dimension */
+    count = 1;
+    for (i = 1; i < dim; i++)
+    {
+      count *= lens[i];
+    }
+
+    if (*num_runs + count > *max_runs)
+    {
+      *max_runs = 2 * (*num_runs + count);
+      package->threaded_runs = (amps_ThreadedRun*)
+                               realloc(package->threaded_runs,
+                                       (size_t)(*max_runs) *
+                                       sizeof(amps_ThreadedRun));
+    }
+
+    for (n = 0; n < count; n++)
+    {
+      index = n;
+      offset = 0;
+      for (i = 1; i < dim; i++)
+      {
+        offset += (index % lens[i]) * step[i];
+        index /= lens[i];
+      }
+
+      run = &package->threaded_runs[(*num_runs)++];
+      run->data = data + offset;
+      run->length = lens[0];
+      run->stride = strides[0];
+    }
+
+    num += (long)count * lens[0];
+  }
+
+  return num;
+}
+
+/*
+ * Sets up a package for the threaded engine.  Every invoice is flattened
+ * into runs of doubles and gets its own slice of a single message
+ * buffer, so the messages can be packed and posted independently.
+ * Returns FALSE if an invoice cannot be flattened or two messages go to
+ * the same process (their order would depend on the threads); such
+ * packages use the point-to-point engine.
+ */
+static int _amps_threaded_commit(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int num_runs = 0;
+  int max_runs = 0;
+  long length;
+  int i, j;
+
+  for (i = 0; i < num_recv; i++)
+  {
+    for (j = 0; j < i; j++)
+    {
+      if (package->src[i] == package->src[j])
+      {
+        return FALSE;
+      }
+    }
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    for (j = 0; j < i; j++)
+    {
+      if (package->dest[i] == package->dest[j])
+      {
+        return FALSE;
+      }
+    }
+  }
+
+  package->threaded_runs = NULL;
+  package->threaded_first_run = (int*)malloc((size_t)(num + 1) * sizeof(int));
+  package->threaded_offsets = (long*)malloc((size_t)(num + 1) * sizeof(long));
+
+  package->threaded_offsets[0] = 0;
+  for (i = 0; i < num; i++)
+  {
+    package->threaded_first_run[i] = num_runs;
+
+    length = _amps_threaded_runs(package,
+                                 (i < num_recv) ?
+                                 package->recv_invoices[i] :
+                                 package->send_invoices[i - num_recv],
+                                 &num_runs, &max_runs);
+    if (length < 0 || length > INT_MAX)
+    {
+      free(package->threaded_runs);
+      free(package->threaded_first_run);
+      free(package->threaded_offsets);
+      return FALSE;
+    }
+
+    package->threaded_offsets[i + 1] = package->threaded_offsets[i] + length;
+  }
+  package->threaded_first_run[num] = num_runs;
+
+  package->threaded_buffer = (double*)malloc((size_t)(package->threaded_offsets[num] + 1) *
+                                             sizeof(double));
+  package->threaded_requests = (MPI_Request*)malloc((size_t)(num + 1) *
+                                                    sizeof(MPI_Request));
+
+  package->threaded = TRUE;
+
+  return TRUE;
+}
+
+static amps_Handle _amps_threaded_exchange(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int i;
+
+  /*
+   * Each thread packs and posts whole messages; the end of the parallel
+   * loop keeps the messages of consecutive exchanges in order.
+   */
+  #pragma omp parallel for schedule(dynamic)
+  for (i = 0; i < num; i++)
+  {
+    amps_ThreadedRun *run;
+    double *buffer = package->threaded_buffer + package->threaded_offsets[i];
+    int count = (int)(package->threaded_offsets[i + 1] -
+                      package->threaded_offsets[i]);
+    int r, n;
+
+    if (i < num_recv)
+    {
+      MPI_Irecv(buffer, count, MPI_DOUBLE, package->src[i], 0,
+                amps_CommWorld, &package->threaded_requests[i]);
+    }
+    else
+    {
+      for (r = package->threaded_first_run[i];
+           r < package->threaded_first_run[i + 1]; r++)
+      {
+        run = &package->threaded_runs[r];
+        for (n = 0; n < run->length; n++)
+        {
+          *buffer++ = run->data[(long)n * run->stride];
+        }
+      }
+
+      MPI_Isend(package->threaded_buffer + package->threaded_offsets[i],
+                count, MPI_DOUBLE, package->dest[i - num_recv], 0,
+                amps_CommWorld, &package->threaded_requests[i]);
+    }
+  }
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+static void _amps_threaded_wait(amps_Handle handle)
+{
+  amps_Package package = handle->package;
+  int num_recv = package->num_recv;
+  int i;
+
+  /* unpack each message as soon as its thread has received it */
+  #pragma omp parallel for schedule(dynamic)
+  for (i = 0; i < num_recv; i++)
+  {
+    amps_ThreadedRun *run;
+    double *buffer = package->threaded_buffer + package->threaded_offsets[i];
+    int r, n;
+
+    MPI_Wait(&package->threaded_requests[i], MPI_STATUS_IGNORE);
+
+    for (r = package->threaded_first_run[i];
+         r < package->threaded_first_run[i + 1]; r++)
+    {
+      run = &package->threaded_runs[r];
+      for (n = 0; n < run->length; n++)
+      {
+        run->data[(long)n * run->stride] = *buffer++;
+      }
+    }
+  }
+
+  for (i = 0; i < num_recv; i++)
+  {
+    AMPS_CLEAR_INVOICE(package->recv_invoices[i]);
+  }
+
+  if (package->num_send)
+  {
+    MPI_Waitall(package->num_send, package->threaded_requests + num_recv,
+                MPI_STATUSES_IGNORE);
+  }
+}
+
+void _amps_threaded_free(amps_Package package)
+{
+  free(package->threaded_runs);
+  free(package->threaded_first_run);
+  free(package->threaded_offsets);
+  free(package->threaded_buffer);
+  free(package->threaded_requests);
+
+  package->threaded = FALSE;
+}
+
+#endif
+
+static void _amps_complete_exchange(amps_Handle handle)
+{
+  int i;
+  int num;
+
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+  if (handle->package->neighbor)
+  {
+    _amps_neighbor_wait(handle);
+    return;
+  }
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+  if (handle->package->shared)
+  {
+    _amps_shared_wait(handle);
+    return;
+  }
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  if (handle->package->threaded)
+  {
+    _amps_threaded_wait(handle);
+    return;
+  }
+#endif
+
+  num = handle->package->num_send + handle->package->num_recv;
+
+  if (num)
+  {
+    if (handle->package->num_recv)
+    {
+      for (i = 0; i < handle->package->num_recv; i++)
+      {
+        AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
+      }
+    }
+
+    MPI_Waitall(num, handle->package->recv_requests,
+                handle->package->status);
+  }
+
+#ifdef AMPS_MPI_PACKAGE_LOWSTORAGE
+  /* Needed by the DEC's; need better memory allocation strategy */
+  /* Need to uncommit packages when not in use */
+  /* amps_Commit followed by amps_UnCommit ????? */
+  if (handle->package->commited)
+  {
+    for (i = 0; i < handle->package->num_recv; i++)
+    {
+      if (handle->package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+      {
+        MPI_Type_free(&(handle->package->recv_invoices[i]->mpi_type));
+      }
+
+      MPI_Request_free(&(handle->package->recv_requests[i]));
+    }
+
+    for (i = 0; i < handle->package->num_send; i++)
+    {
+      if (handle->package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+      {
+        MPI_Type_free(&handle->package->send_invoices[i]->mpi_type);
+      }
+
+      MPI_Request_free(&(handle->package->send_requests[i]));
+    }
+
+    if (handle->package->recv_requests)
+    {
+      free(handle->package->recv_requests);
+      handle->package->recv_requests = NULL;
+    }
+    if (handle->package->status)
+    {
+      free(handle->package->status);
+      handle->package->status = NULL;
+    }
+
+    handle->package->commited = FALSE;
+  }
+#endif
+}
+
+static amps_Handle _amps_start_exchange(amps_Package package)
+{
+  int i;
+  int num;
+
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+  if (amps_exchange_engine == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    return _amps_neighbor_exchange(package);
+  }
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+  if (amps_exchange_engine == AMPS_EXCHANGE_SHARED)
+  {
+    return _amps_shared_exchange(package);
+  }
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  if (amps_exchange_engine == AMPS_EXCHANGE_THREADED &&
+      (package->threaded ||
+       (!package->commited && _amps_threaded_commit(package))))
+  {
+    return _amps_threaded_exchange(package);
+  }
+#endif
+
+  num = package->num_send + package->num_recv;
+
+  /*-------------------------------------------------------------------
+  * Check if we need to allocate the MPI types and requests
+  *------------------------------------------------------------------*/
+  if (!package->commited)
+  {
+    package->commited = TRUE;
+
+    /*--------------------------------------------------------------------
+     * Allocate the arrays need for MPI
+     *--------------------------------------------------------------------*/
+    if (num)
+    {
+      package->recv_requests = (MPI_Request*)calloc((size_t)(num),
+                                                    sizeof(MPI_Request));
+
+      package->status = (MPI_Status*)calloc((size_t)(num),
+                                            sizeof(MPI_Status));
+
+      package->send_requests = package->recv_requests +
+                               package->num_recv;
+    }
+
+    /*--------------------------------------------------------------------
+     * Set up the receive types and requests
+     *--------------------------------------------------------------------*/
+    if (package->num_recv)
+    {
+      for (i = 0; i < package->num_recv; i++)
+      {
+        amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+        MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+
+        // Temporaries needed by insure++
+        MPI_Datatype type = package->recv_invoices[i]->mpi_type;
+        MPI_Request *request_ptr = &(package->recv_requests[i]);
+        MPI_Recv_init(MPI_BOTTOM, 1,
+                      type,
+                      package->src[i], 0, amps_CommWorld,
+                      request_ptr);
+      }
+    }
+
+    /*--------------------------------------------------------------------
+     * Set up the send types and requests
+     *--------------------------------------------------------------------*/
+    if (package->num_send)
+    {
+      for (i = 0; i < package->num_send; i++)
+      {
+        amps_create_mpi_type(amps_CommWorld,
+                             package->send_invoices[i]);
+
+        MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+
+        // Temporaries needed by insure++
+        MPI_Datatype type = package->send_invoices[i]->mpi_type;
+        MPI_Request* request_ptr = &(package->send_requests[i]);
+        MPI_Ssend_init(MPI_BOTTOM, 1,
+                       type,
+                       package->dest[i], 0, amps_CommWorld,
+                       request_ptr);
+      }
+    }
+  }
+
+  if (num)
+  {
+    /*--------------------------------------------------------------------
+     * post send and receives
+     *--------------------------------------------------------------------*/
+    MPI_Startall(num, package->recv_requests);
+  }
+
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+#endif
+
+/*
+ * The profiling wraps the engines: the waiting time of an exchange is
+ * charged to the site of its package.
+ */
+void _amps_wait_exchange(amps_Handle handle)
+{
+  double start = MPI_Wtime();
+
+  _amps_complete_exchange(handle);
+
+  _amps_profile_record(handle->package->profile_site, 0, 0, 0,
+                       MPI_Wtime() - start);
+}
+
+/*===========================================================================*/
+/**
+ *
+ * The \Ref{amps_IExchangePackage} initiates the communication of the
+ * invoices found in the {\bf package} structure that is passed in.  Once a
+ * \Ref{amps_IExchangePackage} is issued it is illegal to access the
+ * variables that are being communicated.  An \Ref{amps_IExchangePackage}
+ * is always followed by an \Ref{amps_Wait} on the {\bf handle} that is
+ * returned.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * // Initialize exchange of boundary points
+ * handle = amps_IExchangePackage(package);
+ *
+ * // Compute on the "interior points"
+ *
+ * // Wait for the exchange to complete
+ * amps_Wait(handle);
+ * \end{verbatim}
+ *
+ * {\large Notes:}
+ *
+ * This routine can be optimized on some architectures so if your
+ * communication can be formulated using it there might be
+ * some performance advantages.
+ *
+ * @memo Initiate package communication
+ * @param package the collection of invoices to communicate
+ * @return Handle for the asynchronous communication
+ */
+amps_Handle amps_IExchangePackage(amps_Package package)
+{
+  _amps_profile_exchange(package);
+
+  return _amps_start_exchange(package);
+}
@@ -65,6 +65,14 @@ int amps_Finalize()
 {
   if (amps_mpi_initialized)
   {
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+    _amps_free_neighbor_comms();
+#endif
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    _amps_shared_finalize();
+#endif
+    _amps_profile_free();
+
     MPI_Comm_free(&amps_CommNode);
     MPI_Comm_free(&amps_CommWrite);
     MPI_Comm_free(&amps_CommWorld);
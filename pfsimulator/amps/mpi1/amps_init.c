@@ -52,6 +52,10 @@ MPI_Comm amps_CommWorld = MPI_COMM_NULL;
 MPI_Comm amps_CommNode = MPI_COMM_NULL;
 MPI_Comm amps_CommWrite = MPI_COMM_NULL;
 
+int amps_exchange_engine = AMPS_EXCHANGE_P2P;
+
+int amps_thread_level = MPI_THREAD_SINGLE;
+
 #ifdef AMPS_F2CLIB_FIX
 int MAIN__()
 {
@@ -114,7 +118,18 @@ int amps_Init(int *argc, char **argv[])
   int length;
 #endif
 
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  /* Only the threaded engine calls MPI from several threads */
+  {
+    char *engine = getenv("AMPS_EXCHANGE");
+    int required = (engine && !strcmp(engine, "threaded")) ?
+                   MPI_THREAD_MULTIPLE : MPI_THREAD_FUNNELED;
+
+    MPI_Init_thread(argc, argv, required, &amps_thread_level);
+  }
+#else
   MPI_Init(argc, argv);
+#endif
   amps_mpi_initialized = TRUE;
 
   MPI_Comm_dup(MPI_COMM_WORLD, &amps_CommWorld);
@@ -155,6 +170,66 @@ int amps_Init(int *argc, char **argv[])
   }
 
 
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+  /* Every process must use the same exchange engine */
+  if (!amps_rank)
+  {
+    char *engine = getenv("AMPS_EXCHANGE");
+
+    if (engine == NULL || !strcmp(engine, "p2p"))
+    {
+      amps_exchange_engine = AMPS_EXCHANGE_P2P;
+    }
+    else if (!strcmp(engine, "neighbor"))
+    {
+      amps_exchange_engine = AMPS_EXCHANGE_NEIGHBOR;
+    }
+    else if (!strcmp(engine, "shared"))
+    {
+      amps_exchange_engine = AMPS_EXCHANGE_SHARED;
+    }
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+    else if (!strcmp(engine, "threaded"))
+    {
+      amps_exchange_engine = AMPS_EXCHANGE_THREADED;
+    }
+#endif
+    else
+    {
+      printf("AMPS Error: invalid AMPS_EXCHANGE <%s>, must be p2p, neighbor, shared or threaded\n",
+             engine);
+      exit(1);
+    }
+  }
+
+  MPI_Bcast(&amps_exchange_engine, 1, MPI_INT, 0, amps_CommWorld);
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  if (amps_exchange_engine == AMPS_EXCHANGE_THREADED)
+  {
+    int level;
+
+    MPI_Allreduce(&amps_thread_level, &level, 1, MPI_INT, MPI_MIN,
+                  amps_CommWorld);
+    if (level < MPI_THREAD_MULTIPLE)
+    {
+      if (!amps_rank)
+      {
+        printf("AMPS Warning: MPI does not provide MPI_THREAD_MULTIPLE, using the p2p exchange\n");
+      }
+      amps_exchange_engine = AMPS_EXCHANGE_P2P;
+    }
+  }
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+  if (amps_exchange_engine == AMPS_EXCHANGE_SHARED)
+  {
+    _amps_shared_init();
+  }
+#endif
+
 #ifdef AMPS_STDOUT_NOBUFF
   setbuf(stdout, NULL);
 #endif
@@ -268,6 +343,7 @@ int amps_EmbeddedInitComm(MPI_Comm comm)
   MPI_Comm_dup(comm, &amps_CommWorld);
   MPI_Comm_size(amps_CommWorld, &amps_size);
   MPI_Comm_rank(amps_CommWorld, &amps_rank);
+  MPI_Query_thread(&amps_thread_level);
 
   amps_clock_init();
 
@@ -62,6 +62,9 @@ amps_Package amps_NewPackage(amps_Comm     comm,
   package->src = src;
   package->recv_invoices = recv_invoices;
 
+  package->profile_site = _amps_profile_site("exchange");
+  package->profile_bytes = -1;
+
   return package;
 }
 
@@ -100,6 +103,23 @@ amps_Package amps_NewPackage(amps_Comm     comm,
   package->dest = dest;
   package->send_invoices = send_invoices;
 
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+  package->neighbor = FALSE;
+  package->neighbor_comm = MPI_COMM_NULL;
+  package->neighbor_request = MPI_REQUEST_NULL;
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+  package->shared = FALSE;
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+  package->threaded = FALSE;
+#endif
+
+  package->profile_site = _amps_profile_site("exchange");
+  package->profile_bytes = -1;
+
   return package;
 }
 
@@ -110,6 +130,28 @@ void amps_FreePackage(amps_Package package)
 
   if (package)
   {
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+    if (package->neighbor)
+    {
+      /* also marks the package as no longer committed */
+      _amps_neighbor_free(package);
+    }
+#endif
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    if (package->shared)
+    {
+      _amps_shared_free(package);
+    }
+#endif
+
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+    if (package->threaded)
+    {
+      _amps_threaded_free(package);
+    }
+#endif
+
     if (package->commited)
     {
       for (i = 0; i < package->num_recv; i++)
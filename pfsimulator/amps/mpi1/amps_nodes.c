@@ -0,0 +1,92 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#include "amps.h"
+
+#ifdef AMPS_NODE_INDICES
+
+/*===========================================================================*/
+/**
+ *
+ * \Ref{amps_NodeIndices} finds the compute node of every process of
+ * {\bf comm}.  Processes that can share memory are on the same node.
+ * Nodes are numbered from 0 in the order of their lowest rank, so rank 0
+ * is always on node 0.  {\bf node_indices} must have room for
+ * {\bf amps_Size(comm)} entries.  This is a collective operation.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * int *nodes = (int*)malloc(amps_Size(amps_CommWorld) * sizeof(int));
+ * int num_nodes;
+ *
+ * num_nodes = amps_NodeIndices(amps_CommWorld, nodes);
+ * \end{verbatim}
+ *
+ * @memo Compute node of each process
+ * @param comm communication context [IN]
+ * @param node_indices node index of each rank [OUT]
+ * @return Number of nodes
+ */
+int amps_NodeIndices(amps_Comm comm, int *node_indices)
+{
+  MPI_Comm node_comm;
+  int rank, size;
+  int leader;
+  int num_nodes;
+  int i;
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                      &node_comm);
+
+  /* A node is identified by its lowest rank */
+  MPI_Allreduce(&rank, &leader, 1, MPI_INT, MPI_MIN, node_comm);
+  MPI_Comm_free(&node_comm);
+
+  MPI_Allgather(&leader, 1, MPI_INT, node_indices, 1, MPI_INT, comm);
+
+  /* Leaders come first on their node, so they are numbered in rank order */
+  num_nodes = 0;
+  for (i = 0; i < size; i++)
+  {
+    if (node_indices[i] == i)
+    {
+      node_indices[i] = num_nodes++;
+    }
+    else
+    {
+      node_indices[i] = node_indices[node_indices[i]];
+    }
+  }
+
+  return num_nodes;
+}
+
+#endif
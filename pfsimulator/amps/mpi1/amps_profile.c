@@ -0,0 +1,267 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#include "amps.h"
+
+/*
+ * Profiling counters of this rank, one entry per site.  Sites are only
+ * added, so a site index stays valid for the whole run.
+ */
+static amps_ProfileStats *amps_profile_sites = NULL;
+static int amps_profile_num_sites = 0;
+static int amps_profile_max_sites = 0;
+
+/*
+ * Returns the index of the profiling site with the given name, adding
+ * it if this is the first use.
+ */
+int _amps_profile_site(const char *name)
+{
+  amps_ProfileStats *site;
+  int i;
+
+  for (i = 0; i < amps_profile_num_sites; i++)
+  {
+    if (strncmp(amps_profile_sites[i].name, name,
+                AMPS_PROFILE_NAME_LENGTH - 1) == 0)
+    {
+      return i;
+    }
+  }
+
+  if (amps_profile_num_sites == amps_profile_max_sites)
+  {
+    amps_profile_max_sites = amps_profile_max_sites ?
+                             2 * amps_profile_max_sites : 16;
+    amps_profile_sites = (amps_ProfileStats*)
+                         realloc(amps_profile_sites,
+                                 (size_t)amps_profile_max_sites * sizeof(amps_ProfileStats));
+  }
+
+  site = &amps_profile_sites[amps_profile_num_sites];
+  memset(site, 0, sizeof(amps_ProfileStats));
+  strncpy(site->name, name, AMPS_PROFILE_NAME_LENGTH - 1);
+  site->ranks = 1;
+
+  return amps_profile_num_sites++;
+}
+
+void _amps_profile_record(int site, double calls, double messages,
+                          double bytes, double time)
+{
+  amps_profile_sites[site].calls += calls;
+  amps_profile_sites[site].messages += messages;
+  amps_profile_sites[site].bytes += bytes;
+  amps_profile_sites[site].time += time;
+}
+
+/*
+ * Records the start of an exchange of a package.  The bytes sent are
+ * computed on the first exchange, the invoices of a package do not
+ * change size.
+ */
+void _amps_profile_exchange(amps_Package package)
+{
+  long bytes;
+  int i;
+
+  if (package->profile_bytes < 0)
+  {
+    bytes = 0;
+    for (i = 0; i < package->num_send; i++)
+    {
+      bytes += amps_sizeof_invoice(amps_CommWorld, package->send_invoices[i]);
+    }
+    package->profile_bytes = bytes;
+  }
+
+  _amps_profile_record(package->profile_site, 1, package->num_send,
+                       (double)package->profile_bytes, 0.0);
+}
+
+void _amps_profile_free(void)
+{
+  free(amps_profile_sites);
+  amps_profile_sites = NULL;
+  amps_profile_num_sites = 0;
+  amps_profile_max_sites = 0;
+}
+
+/*===========================================================================*/
+/**
+ *
+ * \Ref{amps_SetPackageName} sets the name under which the exchanges of
+ * {\bf package} are profiled.  Packages that share a name are reported
+ * together; unnamed packages are reported as "exchange".
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * package = amps_NewPackage(amps_CommWorld, ...);
+ * amps_SetPackageName(package, "vector update");
+ * \end{verbatim}
+ *
+ * @memo Name a package for profiling
+ * @param package package to name [IN/OUT]
+ * @param name profiling site name [IN]
+ */
+void amps_SetPackageName(amps_Package package, const char *name)
+{
+  package->profile_site = _amps_profile_site(name);
+}
+
+/*===========================================================================*/
+/**
+ *
+ * \Ref{amps_ProfileGather} collects the communication profile of all the
+ * nodes of {\bf comm} on rank 0.  The sites that were used are matched
+ * by name; the calls, messages, bytes and waiting time are summed over
+ * the nodes, and the minimum and maximum waiting time of a node are kept
+ * so load imbalance shows up.  On rank 0 {\bf stats} is set to an array that the caller
+ * must free with free(), on the other ranks it is set to NULL.  This is
+ * a collective operation.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * amps_ProfileStats *stats;
+ * int num_stats, i;
+ *
+ * num_stats = amps_ProfileGather(amps_CommWorld, &stats);
+ * for (i = 0; i < num_stats; i++)
+ *    printf("%s %g\n", stats[i].name, stats[i].time_max);
+ * free(stats);
+ * \end{verbatim}
+ *
+ * @memo Gather the communication profile
+ * @param comm communication context [IN]
+ * @param stats profile of the sites on rank 0 [OUT]
+ * @return Number of sites on rank 0, 0 on the other ranks
+ */
+int amps_ProfileGather(amps_Comm comm, amps_ProfileStats **stats)
+{
+  amps_ProfileStats *used;
+  amps_ProfileStats *all = NULL;
+  amps_ProfileStats *merged;
+  int *counts = NULL;
+  int *displs = NULL;
+  int rank, size;
+  int num_used, num_all, num_merged;
+  int i, j;
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  /* Only the sites used on this rank are sent */
+  used = (amps_ProfileStats*)malloc((size_t)amps_profile_num_sites * sizeof(amps_ProfileStats) + 1);
+  num_used = 0;
+  for (i = 0; i < amps_profile_num_sites; i++)
+  {
+    if (amps_profile_sites[i].calls > 0)
+    {
+      used[num_used] = amps_profile_sites[i];
+      used[num_used].time_min = used[num_used].time;
+      used[num_used].time_max = used[num_used].time;
+      num_used++;
+    }
+  }
+
+  if (rank == 0)
+  {
+    counts = (int*)malloc((size_t)size * sizeof(int));
+    displs = (int*)malloc((size_t)size * sizeof(int));
+  }
+
+  /* Sites are sent as bytes, the ranks run the same executable */
+  i = num_used * (int)sizeof(amps_ProfileStats);
+  MPI_Gather(&i, 1, MPI_INT, counts, 1, MPI_INT, 0, comm);
+
+  num_all = 0;
+  if (rank == 0)
+  {
+    for (i = 0; i < size; i++)
+    {
+      displs[i] = num_all;
+      num_all += counts[i];
+    }
+    all = (amps_ProfileStats*)malloc((size_t)num_all + 1);
+    num_all /= (int)sizeof(amps_ProfileStats);
+  }
+
+  MPI_Gatherv(used, num_used * (int)sizeof(amps_ProfileStats),
+              MPI_BYTE, all, counts, displs, MPI_BYTE, 0, comm);
+
+  free(used);
+
+  if (rank != 0)
+  {
+    *stats = NULL;
+    return 0;
+  }
+
+  free(counts);
+  free(displs);
+
+  /* Merge the sites by name, in order of first appearance */
+  merged = (amps_ProfileStats*)malloc((size_t)num_all * sizeof(amps_ProfileStats) + 1);
+  num_merged = 0;
+  for (i = 0; i < num_all; i++)
+  {
+    for (j = 0; j < num_merged; j++)
+    {
+      if (strcmp(merged[j].name, all[i].name) == 0)
+      {
+        break;
+      }
+    }
+
+    if (j == num_merged)
+    {
+      merged[num_merged++] = all[i];
+    }
+    else
+    {
+      merged[j].ranks += all[i].ranks;
+      merged[j].calls += all[i].calls;
+      merged[j].messages += all[i].messages;
+      merged[j].bytes += all[i].bytes;
+      merged[j].time += all[i].time;
+      if (all[i].time_min < merged[j].time_min)
+      {
+        merged[j].time_min = all[i].time_min;
+      }
+      if (all[i].time_max > merged[j].time_max)
+      {
+        merged[j].time_max = all[i].time_max;
+      }
+    }
+  }
+
+  free(all);
+
+  *stats = merged;
+  return num_merged;
+}
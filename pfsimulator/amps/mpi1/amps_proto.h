@@ -1,5 +1,9 @@
 /* amps_allreduce.c */
 int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+int amps_AllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation);
+int amps_AllReduceInt(amps_Comm comm, int *data, int count, MPI_Op operation);
+amps_Handle amps_IAllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation);
+void _amps_wait_allreduce(amps_Handle handle);
 
 /* amps_bcast.c */
 int amps_BCast(amps_Comm comm, int source, amps_Invoice invoice);
@@ -20,6 +24,16 @@ void _amps_wait_exchange(amps_Handle handle);
 amps_Handle amps_IExchangePackage(amps_Package package);
 void _amps_wait_exchange(amps_Handle handle);
 amps_Handle amps_IExchangePackage(amps_Package package);
+#ifdef AMPS_MPI_NEIGHBOR_EXCHANGE
+void _amps_free_neighbor_comms(void);
+void _amps_neighbor_free(amps_Package package);
+#endif
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+void _amps_shared_free(amps_Package package);
+#endif
+#ifdef AMPS_MPI_THREADED_EXCHANGE
+void _amps_threaded_free(amps_Package package);
+#endif
 
 /* amps_ffopen.c */
 amps_File amps_FFopen(amps_Comm comm, char *filename, char *type, long size);
@@ -79,10 +93,21 @@ void amps_FreePackage(amps_Package package);
 amps_Package amps_NewPackage(amps_Comm comm, int num_send, int *dest, amps_Invoice *send_invoices, int num_recv, int *src, amps_Invoice *recv_invoices);
 void amps_FreePackage(amps_Package package);
 
+/* amps_nodes.c */
+int amps_NodeIndices(amps_Comm comm, int *node_indices);
+
 /* amps_pack.c */
 int amps_create_mpi_cont_send_type(amps_Comm comm, amps_Invoice inv);
 void amps_create_mpi_type(amps_Comm comm, amps_Invoice inv);
 
+/* amps_profile.c */
+int _amps_profile_site(const char *name);
+void _amps_profile_record(int site, double calls, double messages, double bytes, double time);
+void _amps_profile_exchange(amps_Package package);
+void _amps_profile_free(void);
+void amps_SetPackageName(amps_Package package, const char *name);
+int amps_ProfileGather(amps_Comm comm, amps_ProfileStats **stats);
+
 /* amps_print.c */
 FILE* amps_SetConsole(FILE* stream);
 void amps_Printf(const char *fmt, ...);
@@ -95,6 +120,18 @@ int amps_Recv(amps_Comm comm, int source, amps_Invoice invoice);
 int amps_xsend(amps_Comm comm, int dest, amps_Invoice invoice, char *buffer);
 int amps_Send(amps_Comm comm, int dest, amps_Invoice invoice);
 
+/* amps_shared.c */
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+void _amps_shared_init(void);
+void *_amps_ctalloc_shared(size_t size);
+void _amps_tfree_shared(void *ptr);
+long _amps_shared_offset(void *ptr);
+char *_amps_shared_segment(int node_rank);
+void _amps_shared_sync(void);
+int _amps_node_rank(int rank);
+void _amps_shared_finalize(void);
+#endif
+
 /* amps_sfbcast.c */
 int amps_SFBCast(amps_Comm comm, amps_File file, amps_Invoice invoice);
 
@@ -0,0 +1,327 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#include "amps.h"
+
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+
+/*
+ * Memory shared between the processes of a node.  Every process
+ * allocates one MPI shared window segment on amps_CommNode in amps_Init
+ * and amps_CTAllocShared hands out pieces of it, so allocations are
+ * local.  The window stays in a passive target epoch for its lifetime
+ * so that MPI_Win_sync can be used to order accesses.
+ */
+static MPI_Win amps_shared_win = MPI_WIN_NULL;
+static char *amps_shared_base = NULL;
+static size_t amps_shared_size = 0;
+
+/* Pieces of the segment handed out and free, both sorted by address */
+static amps_SharedBlock *amps_shared_used = NULL;
+static amps_SharedBlock *amps_shared_free = NULL;
+
+/* Rank in amps_CommNode of each rank in amps_CommWorld */
+static int *amps_node_ranks = NULL;
+
+/*
+ * Allocates the shared segment of this process; collective over
+ * amps_CommNode.  The size in bytes is read from AMPS_SHARED_POOL_SIZE.
+ */
+void _amps_shared_init()
+{
+  MPI_Info info;
+  char *pool_size;
+
+  pool_size = getenv("AMPS_SHARED_POOL_SIZE");
+  amps_shared_size = pool_size ? (size_t)atol(pool_size) : AMPS_SHARED_POOL_SIZE;
+  amps_shared_size -= amps_shared_size % AMPS_SHARED_ALIGN;
+
+  /* Segments are not read contiguously, let MPI place them per process */
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+  MPI_Win_allocate_shared((MPI_Aint)amps_shared_size, sizeof(double), info,
+                          amps_CommNode, &amps_shared_base, &amps_shared_win);
+  MPI_Info_free(&info);
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, amps_shared_win);
+
+  if (amps_shared_size)
+  {
+    amps_shared_free = (amps_SharedBlock*)calloc(1, sizeof(amps_SharedBlock));
+    amps_shared_free->base = amps_shared_base;
+    amps_shared_free->size = amps_shared_size;
+  }
+}
+
+/*
+ * Allocates zeroed memory for amps_CTAllocShared.  When the segment is
+ * full the memory comes from calloc and is exchanged with messages.
+ */
+void *_amps_ctalloc_shared(size_t size)
+{
+  static int warned = FALSE;
+  amps_SharedBlock **prev;
+  amps_SharedBlock *block;
+  amps_SharedBlock *free_block;
+
+  if (amps_exchange_engine != AMPS_EXCHANGE_SHARED || size == 0)
+  {
+    return size ? calloc(1, size) : NULL;
+  }
+
+  /* keep pieces on separate cache lines */
+  size += (AMPS_SHARED_ALIGN - size % AMPS_SHARED_ALIGN) % AMPS_SHARED_ALIGN;
+
+  /* first fit */
+  for (prev = &amps_shared_free; *prev; prev = &(*prev)->next)
+  {
+    if ((*prev)->size >= size)
+    {
+      break;
+    }
+  }
+
+  if (*prev == NULL)
+  {
+    if (!warned)
+    {
+      printf("AMPS Warning: shared memory pool of %ld bytes is full, set AMPS_SHARED_POOL_SIZE to a larger size\n",
+             (long)amps_shared_size);
+      warned = TRUE;
+    }
+    return calloc(1, size);
+  }
+
+  free_block = *prev;
+  if (free_block->size == size)
+  {
+    *prev = free_block->next;
+    block = free_block;
+  }
+  else
+  {
+    block = (amps_SharedBlock*)malloc(sizeof(amps_SharedBlock));
+    block->base = free_block->base;
+    block->size = size;
+
+    free_block->base += size;
+    free_block->size -= size;
+  }
+
+  for (prev = &amps_shared_used; *prev; prev = &(*prev)->next)
+  {
+    if ((*prev)->base > block->base)
+    {
+      break;
+    }
+  }
+  block->next = *prev;
+  *prev = block;
+
+  memset(block->base, 0, size);
+
+  return block->base;
+}
+
+/*
+ * Frees memory for amps_TFreeShared; pointers that are not in the
+ * segment were allocated with calloc.  Free pieces are merged with their
+ * neighbors.
+ */
+void _amps_tfree_shared(void *ptr)
+{
+  amps_SharedBlock **prev;
+  amps_SharedBlock *block;
+  amps_SharedBlock *before;
+  amps_SharedBlock *next;
+
+  if (_amps_shared_offset(ptr) < 0)
+  {
+    if (ptr)
+    {
+      free(ptr);
+    }
+    return;
+  }
+
+  for (prev = &amps_shared_used; *prev; prev = &(*prev)->next)
+  {
+    if ((*prev)->base == ptr)
+    {
+      break;
+    }
+  }
+
+  if (*prev == NULL)
+  {
+    return;
+  }
+
+  block = *prev;
+  *prev = block->next;
+
+  before = NULL;
+  next = amps_shared_free;
+  while (next && next->base < block->base)
+  {
+    before = next;
+    next = next->next;
+  }
+
+  block->next = next;
+  if (before)
+  {
+    before->next = block;
+  }
+  else
+  {
+    amps_shared_free = block;
+  }
+
+  if (next && block->base + block->size == next->base)
+  {
+    block->size += next->size;
+    block->next = next->next;
+    free(next);
+  }
+
+  if (before && before->base + before->size == block->base)
+  {
+    before->size += block->size;
+    before->next = block->next;
+    free(block);
+  }
+}
+
+/*
+ * Returns the offset in bytes of ptr from the start of the shared
+ * segment of this process or -1 if it is not in the segment.
+ */
+long _amps_shared_offset(void *ptr)
+{
+  if (amps_shared_base &&
+      (char*)ptr >= amps_shared_base &&
+      (char*)ptr < amps_shared_base + amps_shared_size)
+  {
+    return (long)((char*)ptr - amps_shared_base);
+  }
+
+  return -1;
+}
+
+/*
+ * Returns the shared segment of the process with amps_CommNode rank
+ * node_rank; it may be read directly by every process on the node.
+ */
+char *_amps_shared_segment(int node_rank)
+{
+  MPI_Aint size;
+  int disp_unit;
+  char *base;
+
+  MPI_Win_shared_query(amps_shared_win, node_rank, &size, &disp_unit, &base);
+
+  return base;
+}
+
+/*
+ * Orders the accesses to the shared segments of this process before and
+ * after a notification message.
+ */
+void _amps_shared_sync()
+{
+  MPI_Win_sync(amps_shared_win);
+}
+
+/*
+ * Returns the amps_CommNode rank of the amps_CommWorld process rank or
+ * MPI_UNDEFINED if it is on another node.
+ */
+int _amps_node_rank(int rank)
+{
+  if (!amps_node_ranks)
+  {
+    MPI_Group world_group, node_group;
+    int *ranks;
+    int i;
+
+    ranks = (int*)malloc((size_t)amps_size * sizeof(int));
+    amps_node_ranks = (int*)malloc((size_t)amps_size * sizeof(int));
+    for (i = 0; i < amps_size; i++)
+    {
+      ranks[i] = i;
+    }
+
+    MPI_Comm_group(amps_CommWorld, &world_group);
+    MPI_Comm_group(amps_CommNode, &node_group);
+    MPI_Group_translate_ranks(world_group, amps_size, ranks,
+                              node_group, amps_node_ranks);
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+
+    free(ranks);
+  }
+
+  return amps_node_ranks[rank];
+}
+
+/*
+ * Frees the shared segment; called from amps_Finalize.
+ */
+void _amps_shared_finalize()
+{
+  amps_SharedBlock *block;
+
+  while (amps_shared_used)
+  {
+    block = amps_shared_used;
+    amps_shared_used = block->next;
+    free(block);
+  }
+
+  while (amps_shared_free)
+  {
+    block = amps_shared_free;
+    amps_shared_free = block->next;
+    free(block);
+  }
+
+  if (amps_shared_win != MPI_WIN_NULL)
+  {
+    MPI_Win_unlock_all(amps_shared_win);
+    MPI_Win_free(&amps_shared_win);
+  }
+
+  amps_shared_base = NULL;
+  amps_shared_size = 0;
+
+  free(amps_node_ranks);
+  amps_node_ranks = NULL;
+}
+
+#endif
@@ -1,5 +1,9 @@
 /* amps_allreduce.c */
 int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+int amps_AllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation);
+int amps_AllReduceInt(amps_Comm comm, int *data, int count, MPI_Op operation);
+amps_Handle amps_IAllReduceDouble(amps_Comm comm, double *data, int count, MPI_Op operation);
+void _amps_wait_allreduce(amps_Handle handle);
 
 /* amps_bcast.c */
 int amps_BCast(amps_Comm comm, int source, amps_Invoice invoice);
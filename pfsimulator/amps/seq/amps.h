@@ -80,6 +80,9 @@ typedef FILE *amps_File;
 #define amps_Exit(code) exit(code)
 
 #define amps_AllReduce(comm, invoice, operation)
+#define amps_AllReduceDouble(comm, data, count, operation) 0
+#define amps_AllReduceInt(comm, data, count, operation) 0
+#define amps_IAllReduceDouble(comm, data, count, operation) 0
 
 #define amps_BCast(comm, source, invoice) 0
 
@@ -442,3 +442,49 @@ int operation;
   return 0;
 }
 
+
+/*
+ * Typed reductions of contiguous values.  This layer has no cheaper
+ * path than the invoice based reduction so they are built on it; the
+ * non-blocking variant completes before returning.
+ */
+int amps_AllReduceDouble(comm, data, count, operation)
+amps_Comm comm;
+double *data;
+int count;
+int operation;
+{
+  amps_Invoice invoice;
+
+  invoice = amps_NewInvoice("%*d", count, data);
+  amps_AllReduce(comm, invoice, operation);
+  amps_FreeInvoice(invoice);
+
+  return 0;
+}
+
+int amps_AllReduceInt(comm, data, count, operation)
+amps_Comm comm;
+int *data;
+int count;
+int operation;
+{
+  amps_Invoice invoice;
+
+  invoice = amps_NewInvoice("%*i", count, data);
+  amps_AllReduce(comm, invoice, operation);
+  amps_FreeInvoice(invoice);
+
+  return 0;
+}
+
+amps_Handle amps_IAllReduceDouble(comm, data, count, operation)
+amps_Comm comm;
+double *data;
+int count;
+int operation;
+{
+  amps_AllReduceDouble(comm, data, count, operation);
+
+  return NULL;
+}
@@ -1,5 +1,8 @@
 /* amps_allreduce.c */
 int amps_AllReduce (amps_Comm comm, amps_Invoice invoice, int operation);
+int amps_AllReduceDouble (amps_Comm comm, double *data, int count, int operation);
+int amps_AllReduceInt (amps_Comm comm, int *data, int count, int operation);
+amps_Handle amps_IAllReduceDouble (amps_Comm comm, double *data, int count, int operation);
 
 /* amps_bcast.c */
 int amps_BCast (amps_Comm comm, int source, amps_Invoice invoice);
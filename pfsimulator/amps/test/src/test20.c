@@ -0,0 +1,229 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*
+ * Tests the ghost exchange of several fields in one package and reports
+ * the time per exchange.  With OpenMP the exchange is repeated for every
+ * thread count up to the maximum, which shows how the threaded engine
+ * (AMPS_EXCHANGE=threaded) scales with the number of threads.
+ */
+
+#include "amps.h"
+#include "amps_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define size 16
+#define num_fields 4
+
+#define Index(i, j, k) ((k) * (size + 2) * (size + 2) + (j) * (size + 2) + (i))
+
+static double value(int field, int i, int j, int k, int t)
+{
+  return 10000000.0 * field + 100000.0 * k + 1000.0 * j + i + t;
+}
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  amps_Package package;
+
+  amps_Clock_t start, elapsed;
+
+  int num;
+  int me;
+
+  int i, j, k, f, n;
+
+  int loop;
+  int t;
+  int threads, max_threads;
+
+  int result = 0;
+
+  double *a[num_fields];
+
+  amps_Invoice send_invoice[2];
+  amps_Invoice recv_invoice[2];
+
+  int length[2];
+  int stride[2];
+
+  int src[2];
+  int dest[2];
+  int send_plane[2];
+  int recv_plane[2];
+  int num_neighbors = 0;
+
+  if (amps_Init(&argc, &argv))
+  {
+    amps_Printf("Error amps_Init\n");
+    amps_Exit(1);
+  }
+
+  loop = atoi(argv[1]);
+
+  num = amps_Size(amps_CommWorld);
+
+  if (num < 2)
+  {
+    amps_Printf("Error: need > 1 node\n");
+    exit(1);
+  }
+
+  me = amps_Rank(amps_CommWorld);
+
+  /* planes of constant i */
+  length[0] = size + 2;
+  length[1] = size + 2;
+  stride[0] = size + 2;
+  stride[1] = size + 2;
+
+  for (f = 0; f < num_fields; f++)
+  {
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    /* lets the shared exchange engine copy the planes directly */
+    a[f] = amps_CTAllocShared(double, (size + 2) * (size + 2) * (size + 2));
+#else
+    a[f] = amps_CTAlloc(double, (size + 2) * (size + 2) * (size + 2));
+#endif
+  }
+
+  if (me > 0)
+  {
+    src[num_neighbors] = dest[num_neighbors] = me - 1;
+    send_plane[num_neighbors] = 1;
+    recv_plane[num_neighbors] = 0;
+    num_neighbors++;
+  }
+
+  if (me < num - 1)
+  {
+    src[num_neighbors] = dest[num_neighbors] = me + 1;
+    send_plane[num_neighbors] = size;
+    recv_plane[num_neighbors] = size + 1;
+    num_neighbors++;
+  }
+
+  for (n = 0; n < num_neighbors; n++)
+  {
+    send_invoice[n] = amps_NewInvoice("%&.&D(2)%&.&D(2)%&.&D(2)%&.&D(2)",
+                                      length, stride, a[0] + send_plane[n],
+                                      length, stride, a[1] + send_plane[n],
+                                      length, stride, a[2] + send_plane[n],
+                                      length, stride, a[3] + send_plane[n]);
+    recv_invoice[n] = amps_NewInvoice("%&.&D(2)%&.&D(2)%&.&D(2)%&.&D(2)",
+                                      length, stride, a[0] + recv_plane[n],
+                                      length, stride, a[1] + recv_plane[n],
+                                      length, stride, a[2] + recv_plane[n],
+                                      length, stride, a[3] + recv_plane[n]);
+  }
+
+  package = amps_NewPackage(amps_CommWorld,
+                            num_neighbors, dest, send_invoice,
+                            num_neighbors, src, recv_invoice);
+
+#ifdef _OPENMP
+  max_threads = omp_get_max_threads();
+#else
+  max_threads = 1;
+#endif
+
+  for (threads = 1; threads <= max_threads; threads++)
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+
+    amps_Sync(amps_CommWorld);
+    start = amps_Clock();
+
+    for (t = loop; t; t--)
+    {
+      for (f = 0; f < num_fields; f++)
+        for (k = 0; k <= size + 1; k++)
+          for (j = 0; j <= size + 1; j++)
+          {
+            a[f][Index(0, j, k)] = -1;
+            a[f][Index(size + 1, j, k)] = -1;
+            for (i = 1; i <= size; i++)
+              a[f][Index(i, j, k)] = value(f, i + me * size, j, k, t);
+          }
+
+      amps_Wait(amps_IExchangePackage(package));
+
+      /* the ghost planes hold the interior planes of the neighbors */
+      for (n = 0; n < num_neighbors; n++)
+      {
+        i = recv_plane[n];
+        for (f = 0; f < num_fields; f++)
+          for (k = 0; k <= size + 1; k++)
+            for (j = 0; j <= size + 1; j++)
+              if (a[f][Index(i, j, k)] != value(f, i + me * size, j, k, t))
+              {
+                result = 1;
+              }
+      }
+    }
+
+    elapsed = amps_Clock() - start;
+
+    if (!me)
+    {
+      printf("threads %d: %g seconds per exchange\n", threads,
+             (double)elapsed / AMPS_TICKS_PER_SEC / loop);
+    }
+  }
+
+  amps_FreePackage(package);
+
+  for (n = 0; n < num_neighbors; n++)
+  {
+    amps_FreeInvoice(send_invoice[n]);
+    amps_FreeInvoice(recv_invoice[n]);
+  }
+
+  for (f = 0; f < num_fields; f++)
+  {
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    amps_TFreeShared(a[f]);
+#else
+    amps_TFree(a[f]);
+#endif
+  }
+
+  amps_Finalize();
+
+  return amps_check_result(result);
+}
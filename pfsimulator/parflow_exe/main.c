@@ -392,11 +392,13 @@ int main(int argc, char *argv [])
     LogGlobals();
 
     /*-----------------------------------------------------------------------
-     * Print timing results
+     * Print timing and communication profile results
      *-----------------------------------------------------------------------*/
 
     PrintTiming();
 
+    PrintCommProfile();
+
     /*-----------------------------------------------------------------------
      * Clean up
      *-----------------------------------------------------------------------*/
@@ -192,6 +192,12 @@
 
 // Loops
 
+#if defined(ForSubgridTasks_cuda) || defined(ForSubgridTasks_kokkos) || defined(ForSubgridTasks_omp)
+  #define ForSubgridTasks CHOOSE_BACKEND(DEFER(ForSubgridTasks), ACC_ID)
+#else
+  #define ForSubgridTasks ForSubgridTasks_default
+#endif
+
 #if defined(BoxLoopI0_cuda) || defined(BoxLoopI0_kokkos) || defined(BoxLoopI0_omp)
   #define BoxLoopI0 CHOOSE_BACKEND(DEFER(BoxLoopI0), ACC_ID)
 #else
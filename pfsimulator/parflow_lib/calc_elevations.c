@@ -102,12 +102,11 @@ double         **CalcElevations(
   elevation_arrays = ctalloc(double *, SubgridArraySize(subgrids));
 
   /*
-   * SGS TODO SHOULD HAVE ASSERT MACRO
-   * This algorithm only works for one subgrid per rank due to the merge process.
-   * Unless we could guarantee subgrids are ordered on each rank.
+   * The merge process exchanges the arrays of each subgrid in order, so
+   * with several subgrids per rank the ranks of a Z column must hold
+   * matching subgrids in the same order.  Process.Topology.Subgrids
+   * splits every rank of a column the same way.
    */
-  assert(SubgridArraySize(subgrids) == 1);
-
   ForSubgridI(is, subgrids)
   {
     subgrid = SubgridArraySubgrid(subgrids, is);
@@ -155,15 +154,10 @@ double         **CalcElevations(
     });
 
     /*
-     * SGS TODO SHOULD HAVE ASSERT MACRO
-     * This algorithm only works for one subgrid per rank due to the merge process.
-     * Unless we could guarantee subgrids are ordered on each rank.
-     *
      * SGS TODO this algorithm is inefficient, currently sends all arrays from each rank in the Z
      * dimension to the bottom rank, performs a reduction and then sends up the column.
      * MPI has calls that will do this, likely more efficiently.   AMPS is a little limiting.
      */
-    assert(SubgridArraySize(subgrids) == 1);
 
     if (GlobalsR)
     {
@@ -175,12 +169,12 @@ double         **CalcElevations(
 
       amps_Invoice invoice = amps_NewInvoice("%*d", num, elevation_array);
 
-      int dstRank = pqr_to_process(GlobalsP,
-                                   GlobalsQ,
-                                   0,
-                                   GlobalsNumProcsX,
-                                   GlobalsNumProcsY,
-                                   GlobalsNumProcsZ);
+      int dstRank = pqr_to_rank(GlobalsP,
+                                GlobalsQ,
+                                0,
+                                GlobalsNumProcsX,
+                                GlobalsNumProcsY,
+                                GlobalsNumProcsZ);
 
       amps_Send(amps_CommWorld, dstRank, invoice);
 
@@ -204,12 +198,12 @@ double         **CalcElevations(
 
       for (R = 1; R < GlobalsNumProcsZ; R++)
       {
-        int dstRank = pqr_to_process(GlobalsP,
-                                     GlobalsQ,
-                                     R,
-                                     GlobalsNumProcsX,
-                                     GlobalsNumProcsY,
-                                     GlobalsNumProcsZ);
+        int dstRank = pqr_to_rank(GlobalsP,
+                                  GlobalsQ,
+                                  R,
+                                  GlobalsNumProcsX,
+                                  GlobalsNumProcsY,
+                                  GlobalsNumProcsZ);
 
         /*
          * Receive and reduce results from all processors.
@@ -249,12 +243,12 @@ double         **CalcElevations(
        */
       for (R = 1; R < GlobalsNumProcsZ; R++)
       {
-        int dstRank = pqr_to_process(GlobalsP,
-                                     GlobalsQ,
-                                     R,
-                                     GlobalsNumProcsX,
-                                     GlobalsNumProcsY,
-                                     GlobalsNumProcsZ);
+        int dstRank = pqr_to_rank(GlobalsP,
+                                  GlobalsQ,
+                                  R,
+                                  GlobalsNumProcsX,
+                                  GlobalsNumProcsY,
+                                  GlobalsNumProcsZ);
 
         amps_Invoice invoice = amps_NewInvoice("%*d", num, elevation_array);
         amps_Send(amps_CommWorld, dstRank, invoice);
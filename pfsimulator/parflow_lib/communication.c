@@ -30,6 +30,7 @@
 *****************************************************************************/
 
 #include <math.h>
+#include <string.h>
 
 #include "parflow.h"
 #include "amps.h"
@@ -140,9 +141,99 @@ int  NewCommPkgInfo(
 }
 
 
+/*
+ * Cached layouts, see FindCommPkgLayout.
+ */
+static CommPkgLayout *comm_pkg_layouts = NULL;
+
+
+/*--------------------------------------------------------------------------
+ * CommPkgEntry:
+ *   A subregion communicated with one process and the index of the
+ *   data_space subregion holding its data.
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  Subregion *comm_sr;
+  int index;
+} CommPkgEntry;
+
+static int     CompareCommPkgEntries(
+                                     const void *a,
+                                     const void *b)
+{
+  Subregion *sr_a = ((const CommPkgEntry*)a)->comm_sr;
+  Subregion *sr_b = ((const CommPkgEntry*)b)->comm_sr;
+
+  int key_a[9] = { SubregionIZ(sr_a), SubregionIY(sr_a), SubregionIX(sr_a),
+                   SubregionNZ(sr_a), SubregionNY(sr_a), SubregionNX(sr_a),
+                   SubregionSZ(sr_a), SubregionSY(sr_a), SubregionSX(sr_a) };
+  int key_b[9] = { SubregionIZ(sr_b), SubregionIY(sr_b), SubregionIX(sr_b),
+                   SubregionNZ(sr_b), SubregionNY(sr_b), SubregionNX(sr_b),
+                   SubregionSZ(sr_b), SubregionSY(sr_b), SubregionSX(sr_b) };
+  int i;
+
+  for (i = 0; i < 9; i++)
+  {
+    if (key_a[i] != key_b[i])
+    {
+      return (key_a[i] < key_b[i]) ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------
+ * GetCommPkgEntries:
+ *   Collects the subregions of `comm_region' communicated with `proc'.
+ *   Both sides of a message must agree on the order of its subregions, but
+ *   the sender lists them by its own subgrids and the receiver by its
+ *   subgrids.  The entries are therefore sorted by position; identical
+ *   subregions hold identical data, so their relative order is irrelevant.
+ *--------------------------------------------------------------------------*/
+
+static int     GetCommPkgEntries(
+                                 Region *        comm_region,
+                                 SubregionArray *data_space,
+                                 int             proc,
+                                 CommPkgEntry *  entries)
+{
+  SubregionArray  *comm_sra;
+  Subregion       *comm_sr;
+
+  int num_entries = 0;
+  int i, j;
+
+
+  ForSubregionI(i, data_space)
+  {
+    comm_sra = RegionSubregionArray(comm_region, i);
+
+    ForSubregionI(j, comm_sra)
+    {
+      comm_sr = SubregionArraySubregion(comm_sra, j);
+
+      if (SubregionProcess(comm_sr) == proc)
+      {
+        entries[num_entries].comm_sr = comm_sr;
+        entries[num_entries].index = i;
+        num_entries++;
+      }
+    }
+  }
+
+  qsort(entries, (size_t)num_entries, sizeof(CommPkgEntry),
+        CompareCommPkgEntries);
+
+  return num_entries;
+}
+
+
 /*--------------------------------------------------------------------------
  * NewCommPkg:
- *   `send_region' and `recv_region' are "regions" of `grid'.
+ *   `send_region' and `recv_region' are "regions" of `grid'.  The data for
+ *   all subregions of `data_space' is stored contiguously in `data'.
  *--------------------------------------------------------------------------*/
 
 CommPkg         *NewCommPkg(
@@ -154,14 +245,58 @@ CommPkg         *NewCommPkg(
 {
   CommPkg         *new_comm_pkg;
 
-  amps_Invoice invoice;
+  Subregion       *data_sr;
+
+  double         **data_array;
+
+  int i;
+
+
+  data_array = talloc(double *, SubregionArraySize(data_space));
+
+  ForSubregionI(i, data_space)
+  {
+    data_sr = SubregionArraySubregion(data_space, i);
+
+    data_array[i] = data + i * num_vars *
+                    SubregionNX(data_sr) * SubregionNY(data_sr) * SubregionNZ(data_sr);
+  }
+
+  new_comm_pkg = NewCommPkgMultiple(send_region, recv_region, data_space,
+                                    num_vars, data_array);
+
+  tfree(data_array);
+
+  return new_comm_pkg;
+}
+
+
+/*--------------------------------------------------------------------------
+ * NewCommPkgLayout:
+ *   Computes the processes and subregions communicated for `send_region'
+ *   and `recv_region', regions of the subregions of `data_space'.  The
+ *   layout is returned with one reference and is not cached.
+ *--------------------------------------------------------------------------*/
+
+CommPkgLayout   *NewCommPkgLayout(
+                                  Region *        send_region,
+                                  Region *        recv_region,
+                                  SubregionArray *data_space,
+                                  int             num_vars) /* number of variables in the vector */
+{
+  CommPkgLayout   *layout;
 
   SubregionArray  *comm_sra;
   Subregion       *comm_sr;
 
   Subregion       *data_sr;
 
+  CommPkgEntry    *entries;
+  int num_entries;
+
   int  *loop_array;
+  int  *entry_index;
+  int  *entry_dim;
 
   int  *send_proc_array = NULL;
   int  *recv_proc_array = NULL;
@@ -175,9 +310,8 @@ CommPkg         *NewCommPkg(
   int proc;
   int i, j, p;
 
-  int dim;
-
-  new_comm_pkg = ctalloc(CommPkg, 1);
+  layout = ctalloc(CommPkgLayout, 1);
+  layout->ref_count = 1;
 
   /*------------------------------------------------------
    * compute num send and recv subregions
@@ -200,7 +334,7 @@ CommPkg         *NewCommPkg(
   num_send_procs = 0;
   if (num_send_subregions)
   {
-    new_comm_pkg->send_ranks = send_proc_array =
+    layout->send_ranks = send_proc_array =
       talloc(int, num_send_subregions);
 
     for (i = 0; i < num_send_subregions; i++)
@@ -226,7 +360,7 @@ CommPkg         *NewCommPkg(
   num_recv_procs = 0;
   if (num_recv_subregions)
   {
-    new_comm_pkg->recv_ranks =
+    layout->recv_ranks =
       recv_proc_array = talloc(int, num_recv_subregions);
 
     for (i = 0; i < num_recv_subregions; i++)
@@ -250,51 +384,44 @@ CommPkg         *NewCommPkg(
   }
 
   /*------------------------------------------------------
-   * Set up CommPkg
+   * Set up the entries
    *------------------------------------------------------*/
 
   if (num_send_procs || num_recv_procs)
-    loop_array = (new_comm_pkg->loop_array)
+  {
+    loop_array = (layout->loop_array)
                    = talloc(int, (num_send_subregions + num_recv_subregions) * 9);
+    entry_index = (layout->entry_index)
+                    = talloc(int, num_send_subregions + num_recv_subregions);
+    entry_dim = (layout->entry_dim)
+                  = talloc(int, num_send_subregions + num_recv_subregions);
+  }
+
+  entries = talloc(CommPkgEntry, pfmax(num_send_subregions,
+                                       num_recv_subregions));
 
   /* set up send info */
   if (num_send_procs)
   {
-    new_comm_pkg->num_send_invoices = num_send_procs;
-    (new_comm_pkg->send_invoices) =
-      ctalloc(amps_Invoice, num_send_procs);
+    layout->num_send_procs = num_send_procs;
+    layout->send_num_entries = talloc(int, num_send_procs);
 
     for (p = 0; p < num_send_procs; p++)
     {
-      num_send_subregions = 0;
-      ForSubregionI(i, data_space)
+      num_entries = GetCommPkgEntries(send_region, data_space,
+                                      send_proc_array[p], entries);
+      layout->send_num_entries[p] = num_entries;
+
+      for (j = 0; j < num_entries; j++)
       {
+        i = entries[j].index;
         data_sr = SubregionArraySubregion(data_space, i);
-        comm_sra = RegionSubregionArray(send_region, i);
-
-        ForSubregionI(j, comm_sra)
-        {
-          comm_sr = SubregionArraySubregion(comm_sra, j);
-
-          if (SubregionProcess(comm_sr) == send_proc_array[p])
-          {
-            dim = NewCommPkgInfo(data_sr, comm_sr, i, num_vars,
-                                 loop_array);
-
-            invoice =
-              amps_NewInvoice("%&.&D(*)",
-                              loop_array + 1,
-                              loop_array + 5,
-                              dim,
-                              data + loop_array[0]);
-
-            amps_AppendInvoice(&(new_comm_pkg->send_invoices[p]),
-                               invoice);
-
-            num_send_subregions++;
-            loop_array += 9;
-          }
-        }
+
+        *entry_index++ = i;
+        *entry_dim++ = NewCommPkgInfo(data_sr, entries[j].comm_sr, 0,
+                                      num_vars, loop_array);
+
+        loop_array += 9;
       }
     }
   }
@@ -302,41 +429,283 @@ CommPkg         *NewCommPkg(
   /* set up recv info */
   if (num_recv_procs)
   {
-    new_comm_pkg->num_recv_invoices = num_recv_procs;
-    (new_comm_pkg->recv_invoices) =
-      ctalloc(amps_Invoice, num_recv_procs);
+    layout->num_recv_procs = num_recv_procs;
+    layout->recv_num_entries = talloc(int, num_recv_procs);
 
     for (p = 0; p < num_recv_procs; p++)
     {
-      num_recv_subregions = 0;
-      ForSubregionI(i, data_space)
+      num_entries = GetCommPkgEntries(recv_region, data_space,
+                                      recv_proc_array[p], entries);
+      layout->recv_num_entries[p] = num_entries;
+
+      for (j = 0; j < num_entries; j++)
       {
+        i = entries[j].index;
         data_sr = SubregionArraySubregion(data_space, i);
-        comm_sra = RegionSubregionArray(recv_region, i);
-
-        ForSubregionI(j, comm_sra)
-        {
-          comm_sr = SubregionArraySubregion(comm_sra, j);
-
-          if (SubregionProcess(comm_sr) == recv_proc_array[p])
-          {
-            dim = NewCommPkgInfo(data_sr, comm_sr, i, num_vars,
-                                 loop_array);
-
-            invoice =
-              amps_NewInvoice("%&.&D(*)",
-                              loop_array + 1,
-                              loop_array + 5,
-                              dim,
-                              data + loop_array[0]);
-
-            amps_AppendInvoice(&(new_comm_pkg->recv_invoices[p]),
-                               invoice);
-
-            num_recv_subregions++;
-            loop_array += 9;
-          }
-        }
+
+        *entry_index++ = i;
+        *entry_dim++ = NewCommPkgInfo(data_sr, entries[j].comm_sr, 0,
+                                      num_vars, loop_array);
+
+        loop_array += 9;
+      }
+    }
+  }
+
+  tfree(entries);
+
+  return layout;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeCommPkgLayout:
+ *   Releases a reference to `layout'; it is freed with the last one.
+ *--------------------------------------------------------------------------*/
+
+void FreeCommPkgLayout(
+                       CommPkgLayout *layout)
+{
+  CommPkgLayout **prev;
+
+  if (layout && (--layout->ref_count == 0))
+  {
+    for (prev = &comm_pkg_layouts; *prev; prev = &(*prev)->next)
+    {
+      if (*prev == layout)
+      {
+        *prev = layout->next;
+        break;
+      }
+    }
+
+    if (layout->data_space)
+    {
+      FreeSubregionArray(layout->data_space);
+    }
+    tfree(layout->key);
+
+    tfree(layout->send_ranks);
+    tfree(layout->send_num_entries);
+    tfree(layout->recv_ranks);
+    tfree(layout->recv_num_entries);
+    tfree(layout->entry_index);
+    tfree(layout->entry_dim);
+    tfree(layout->loop_array);
+
+    tfree(layout);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * SameSubregionArrays:
+ *--------------------------------------------------------------------------*/
+
+static int     SameSubregionArrays(
+                                   SubregionArray *a,
+                                   SubregionArray *b)
+{
+  Subregion *sr_a, *sr_b;
+  int i;
+
+  if (SubregionArraySize(a) != SubregionArraySize(b))
+  {
+    return FALSE;
+  }
+
+  ForSubregionI(i, a)
+  {
+    sr_a = SubregionArraySubregion(a, i);
+    sr_b = SubregionArraySubregion(b, i);
+
+    if ((SubregionIX(sr_a) != SubregionIX(sr_b)) ||
+        (SubregionIY(sr_a) != SubregionIY(sr_b)) ||
+        (SubregionIZ(sr_a) != SubregionIZ(sr_b)) ||
+        (SubregionNX(sr_a) != SubregionNX(sr_b)) ||
+        (SubregionNY(sr_a) != SubregionNY(sr_b)) ||
+        (SubregionNZ(sr_a) != SubregionNZ(sr_b)) ||
+        (SubregionSX(sr_a) != SubregionSX(sr_b)) ||
+        (SubregionSY(sr_a) != SubregionSY(sr_b)) ||
+        (SubregionSZ(sr_a) != SubregionSZ(sr_b)))
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FindCommPkgLayout:
+ *   Returns a new reference to the cached layout of `owner' and `key'
+ *   for `data_space' and `num_vars', or NULL if there is none.  The
+ *   owner is the object the regions of the layout were computed from
+ *   and the key whatever else they depend on.
+ *--------------------------------------------------------------------------*/
+
+CommPkgLayout   *FindCommPkgLayout(
+                                   const void *    owner,
+                                   const int *     key,
+                                   int             key_size,
+                                   SubregionArray *data_space,
+                                   int             num_vars)
+{
+  CommPkgLayout *layout;
+
+  for (layout = comm_pkg_layouts; layout; layout = layout->next)
+  {
+    if ((layout->owner == owner) &&
+        (layout->num_vars == num_vars) &&
+        (layout->key_size == key_size) &&
+        ((key_size == 0) ||
+         (memcmp(layout->key, key, (size_t)key_size * sizeof(int)) == 0)) &&
+        SameSubregionArrays(layout->data_space, data_space))
+    {
+      layout->ref_count++;
+      return layout;
+    }
+  }
+
+  return NULL;
+}
+
+
+/*--------------------------------------------------------------------------
+ * CacheCommPkgLayout:
+ *   Makes `layout' available to FindCommPkgLayout.  The cache does not
+ *   hold a reference; the layout leaves the cache when it is freed.
+ *--------------------------------------------------------------------------*/
+
+void CacheCommPkgLayout(
+                        CommPkgLayout * layout,
+                        const void *    owner,
+                        const int *     key,
+                        int             key_size,
+                        SubregionArray *data_space,
+                        int             num_vars)
+{
+  layout->owner = owner;
+  layout->key_size = key_size;
+  if (key_size)
+  {
+    layout->key = talloc(int, key_size);
+    memcpy(layout->key, key, (size_t)key_size * sizeof(int));
+  }
+  layout->data_space = DuplicateSubregionArray(data_space);
+  layout->num_vars = num_vars;
+
+  layout->next = comm_pkg_layouts;
+  comm_pkg_layouts = layout;
+}
+
+
+/*--------------------------------------------------------------------------
+ * ForgetCommPkgLayouts:
+ *   Removes the layouts of `owner' from the cache, e.g. when it is freed
+ *   and its address may be reused.  Packages keep their layouts.
+ *--------------------------------------------------------------------------*/
+
+void ForgetCommPkgLayouts(
+                          const void *owner)
+{
+  CommPkgLayout **prev = &comm_pkg_layouts;
+  CommPkgLayout  *layout;
+
+  while ((layout = *prev))
+  {
+    if (layout->owner == owner)
+    {
+      *prev = layout->next;
+      layout->next = NULL;
+      layout->owner = NULL;
+    }
+    else
+    {
+      prev = &layout->next;
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * NewCommPkgFromLayout:
+ *   Builds a package communicating the entries of `layout' for the data
+ *   `data_array[i]' of each subregion `i' of its data space.  The package
+ *   takes a reference to the layout.
+ *--------------------------------------------------------------------------*/
+
+CommPkg         *NewCommPkgFromLayout(
+                                      CommPkgLayout *layout,
+                                      double **      data_array)
+{
+  CommPkg         *new_comm_pkg;
+
+  amps_Invoice invoice;
+
+  int  *loop_array = layout->loop_array;
+  int  *entry_index = layout->entry_index;
+  int  *entry_dim = layout->entry_dim;
+
+  int j, p;
+
+  new_comm_pkg = ctalloc(CommPkg, 1);
+
+  new_comm_pkg->layout = layout;
+  layout->ref_count++;
+
+  new_comm_pkg->send_ranks = layout->send_ranks;
+  new_comm_pkg->recv_ranks = layout->recv_ranks;
+
+  /* set up send info */
+  if (layout->num_send_procs)
+  {
+    new_comm_pkg->num_send_invoices = layout->num_send_procs;
+    (new_comm_pkg->send_invoices) =
+      ctalloc(amps_Invoice, layout->num_send_procs);
+
+    for (p = 0; p < layout->num_send_procs; p++)
+    {
+      for (j = 0; j < layout->send_num_entries[p]; j++)
+      {
+        invoice =
+          amps_NewInvoice("%&.&D(*)",
+                          loop_array + 1,
+                          loop_array + 5,
+                          *entry_dim++,
+                          data_array[*entry_index++] + loop_array[0]);
+
+        amps_AppendInvoice(&(new_comm_pkg->send_invoices[p]),
+                           invoice);
+
+        loop_array += 9;
+      }
+    }
+  }
+
+  /* set up recv info */
+  if (layout->num_recv_procs)
+  {
+    new_comm_pkg->num_recv_invoices = layout->num_recv_procs;
+    (new_comm_pkg->recv_invoices) =
+      ctalloc(amps_Invoice, layout->num_recv_procs);
+
+    for (p = 0; p < layout->num_recv_procs; p++)
+    {
+      for (j = 0; j < layout->recv_num_entries[p]; j++)
+      {
+        invoice =
+          amps_NewInvoice("%&.&D(*)",
+                          loop_array + 1,
+                          loop_array + 5,
+                          *entry_dim++,
+                          data_array[*entry_index++] + loop_array[0]);
+
+        amps_AppendInvoice(&(new_comm_pkg->recv_invoices[p]),
+                           invoice);
+
+        loop_array += 9;
       }
     }
   }
@@ -349,12 +718,57 @@ CommPkg         *NewCommPkg(
                                           new_comm_pkg->recv_ranks,
                                           new_comm_pkg->recv_invoices);
 
+  return new_comm_pkg;
+}
 
 
+/*--------------------------------------------------------------------------
+ * NewCommPkgMultiple:
+ *   Same as NewCommPkg but the data for subregion `i' of `data_space' is
+ *   stored separately in `data_array[i]', as for vectors with several
+ *   subgrids per process.
+ *--------------------------------------------------------------------------*/
+
+CommPkg         *NewCommPkgMultiple(
+                                    Region *        send_region,
+                                    Region *        recv_region,
+                                    SubregionArray *data_space,
+                                    int             num_vars, /* number of variables in the vector */
+                                    double **       data_array)
+{
+  CommPkgLayout   *layout;
+  CommPkg         *new_comm_pkg;
+
+  layout = NewCommPkgLayout(send_region, recv_region, data_space, num_vars);
+  new_comm_pkg = NewCommPkgFromLayout(layout, data_array);
+  FreeCommPkgLayout(layout);
+
   return new_comm_pkg;
 }
 
 
+/*--------------------------------------------------------------------------
+ * SetCommPkgName:
+ *   Names the call site under which the exchanges of the package are
+ *   profiled by amps.
+ *--------------------------------------------------------------------------*/
+
+void SetCommPkgName(
+                    CommPkg *   comm_pkg,
+                    const char *name)
+{
+#ifdef AMPS_PROFILE
+  if (comm_pkg)
+  {
+    amps_SetPackageName(comm_pkg->package, name);
+  }
+#else
+  PF_UNUSED(comm_pkg);
+  PF_UNUSED(name);
+#endif
+}
+
+
 /*--------------------------------------------------------------------------
  * FreeCommPkg:
  *--------------------------------------------------------------------------*/
@@ -381,10 +795,7 @@ void FreeCommPkg(
     tfree(pkg->send_invoices);
     tfree(pkg->recv_invoices);
 
-    tfree(pkg->send_ranks);
-    tfree(pkg->recv_ranks);
-
-    tfree(pkg->loop_array);
+    FreeCommPkgLayout(pkg->layout);
 
     tfree(pkg);
   }
@@ -34,6 +34,8 @@
 #ifndef _COMMUNICATION_HEADER
 #define _COMMUNICATION_HEADER
 
+#include "region.h"
+
 /*--------------------------------------------------------------------------
  *  Update mode stuff
  *--------------------------------------------------------------------------*/
@@ -51,6 +53,45 @@
 #define VectorUpdatePGS3     8
 #define VectorUpdatePGS4     9
 
+/*--------------------------------------------------------------------------
+ * CommPkgLayout:
+ *   The processes and subregions communicated by a CommPkg, with the
+ *   data of each subregion given as an offset into the data of a
+ *   data_space subregion.  A layout does not point to any data, so it
+ *   is shared by all packages with the same regions and data space.
+ *   Layouts are reference counted and may be cached under an owner
+ *   (e.g. the ComputePkg of the regions) and a key.
+ *--------------------------------------------------------------------------*/
+
+typedef struct _CommPkgLayout {
+  int num_send_procs;
+  int           *send_ranks;
+  int           *send_num_entries;  /* subregions sent to each process */
+
+  int num_recv_procs;
+  int           *recv_ranks;
+  int           *recv_num_entries;
+
+  int           *entry_index;  /* data_space subregion of each entry */
+  int           *entry_dim;    /* dimension of each entry's invoice */
+  int           *loop_array;   /* Contains the offset, length, and
+                                * stride factors of each entry, 9 per
+                                * entry, sends first.  The invoices of
+                                * all packages using the layout point
+                                * into it. */
+
+  int ref_count;
+
+  /* Cache key, see FindCommPkgLayout */
+  const void     *owner;
+  int            *key;
+  int key_size;
+  SubregionArray *data_space;
+  int num_vars;
+
+  struct _CommPkgLayout *next;
+} CommPkgLayout;
+
 /*--------------------------------------------------------------------------
  * CommPkg:
  *   Structure containing information for communicating subregions of
@@ -68,10 +109,7 @@ typedef struct {
 
   amps_Package package;
 
-  int     *loop_array;  /* Contains the data-array index, offset, length,
-                         * and stride factors for setting up the invoices
-                         * in this package.
-                         * One array to save mallocing many small ones */
+  CommPkgLayout *layout;  /* owns the rank arrays the package uses */
 } CommPkg;
 
 /*--------------------------------------------------------------------------
@@ -65,6 +65,8 @@ ComputePkg  *NewComputePkg(
 void         FreeComputePkg(
                             ComputePkg *compute_pkg)
 {
+  ForgetCommPkgLayouts(compute_pkg);
+
   if (ComputePkgSendRegion(compute_pkg))
     FreeRegion(ComputePkgSendRegion(compute_pkg));
   if (ComputePkgRecvRegion(compute_pkg))
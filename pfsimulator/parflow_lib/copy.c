@@ -89,4 +89,6 @@ void     Copy(
       yp[i_y] = xp[i_x];
     });
   }
+
+  TouchVector(y);
 }
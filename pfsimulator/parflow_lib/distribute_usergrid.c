@@ -44,6 +44,813 @@
 
 #define pqr_to_nxyz(pqr, mxyz, lxyz)  (pqr < lxyz ? mxyz + 1 : mxyz)
 
+/*
+ * Decomposition methods; Uniform splits the bounding box evenly, the
+ * other methods balance the cell weights computed from the domain.
+ */
+#define DistributeUniform      0
+#define DistributeRectilinear  1
+#define DistributeBisection    2
+
+/*
+ * Process mappings; Lexicographic numbers the PxQxR process grid with p
+ * fastest, Node keeps the processes of a compute node together.
+ */
+#define MappingLexicographic   0
+#define MappingNode            1
+
+/*--------------------------------------------------------------------------
+ * ComputeColumnWeights:
+ *   Computes the weight of each (x,y) column and of each z layer of the
+ *   user grid.  Active cells of the domain solid count 1, inactive cells
+ *   count inactive_weight and the top active cell of each column counts
+ *   surface_weight in addition.  Each process evaluates the domain over
+ *   its subgrids of the uniform decomposition and the results are
+ *   summed over all processes.
+ *
+ *   Returns NULL if the domain geometry is not available.
+ *--------------------------------------------------------------------------*/
+
+static double  *ComputeColumnWeights(
+                                     Subgrid *     user_subgrid,
+                                     SubgridArray *all_subgrids,
+                                     double        inactive_weight,
+                                     double        surface_weight,
+                                     double *      layer_weights)
+{
+  GeomSolid     *domain_solid = NULL;
+  GrGeomSolid   *gr_domain;
+
+  GrGeomExtentArray  *extent_array;
+  SubgridArray  *subgrids;
+  Subgrid       *subgrid;
+
+  amps_Invoice invoice;
+
+  double        *column_weights;
+  double        *top;
+  char          *geom_name;
+
+  int x = SubgridIX(user_subgrid);
+  int y = SubgridIY(user_subgrid);
+  int z = SubgridIZ(user_subgrid);
+  int nx = SubgridNX(user_subgrid);
+  int ny = SubgridNY(user_subgrid);
+  int nz = SubgridNZ(user_subgrid);
+
+  int geom_index;
+  int use_clustering;
+  int is, i, j, k, ic;
+
+  geom_name = GetStringDefault("Domain.GeomName", "");
+  if (GlobalsGeomNames && GlobalsGeometries)
+  {
+    geom_index = NA_NameToIndex(GlobalsGeomNames, geom_name);
+    if (geom_index >= 0)
+    {
+      domain_solid = GlobalsGeometries[geom_index];
+    }
+  }
+
+  /* Domains defined by indicator fields have no Geom solid */
+  if (!domain_solid)
+  {
+    return NULL;
+  }
+
+  subgrids = NewSubgridArray();
+  ForSubgridI(is, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, is);
+    if (SubgridProcess(subgrid) == amps_Rank(amps_CommWorld))
+    {
+      AppendSubgrid(subgrid, subgrids);
+    }
+  }
+
+  /*
+   * Clustering computes its boxes on a grid built from the user grid,
+   * which would recurse back into this routine; the octree loops are
+   * sufficient here.
+   */
+  use_clustering = GlobalsUseClustering;
+  GlobalsUseClustering = 0;
+
+  extent_array = GrGeomCreateExtentArray(subgrids, 3, 3, 3, 3, 3, 3);
+  GrGeomSolidFromGeom(&gr_domain, domain_solid, extent_array);
+  GrGeomFreeExtentArray(extent_array);
+
+  GlobalsUseClustering = use_clustering;
+
+  column_weights = ctalloc(double, nx * ny);
+  top = talloc(double, nx * ny);
+  for (ic = 0; ic < nx * ny; ic++)
+  {
+    top[ic] = -1.0;
+  }
+
+  ForSubgridI(is, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, is);
+
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
+    int sub_nx = SubgridNX(subgrid);
+    int sub_ny = SubgridNY(subgrid);
+    int sub_nz = SubgridNZ(subgrid);
+    int r = SubgridRX(subgrid);
+
+    for (j = iy; j < iy + sub_ny; j++)
+    {
+      for (i = ix; i < ix + sub_nx; i++)
+      {
+        column_weights[(j - y) * nx + (i - x)] += inactive_weight * sub_nz;
+      }
+    }
+    for (k = iz; k < iz + sub_nz; k++)
+    {
+      layer_weights[k - z] += inactive_weight * sub_nx * sub_ny;
+    }
+
+    GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, sub_nx, sub_ny, sub_nz,
+    {
+      ic = (j - y) * nx + (i - x);
+
+      column_weights[ic] += 1.0 - inactive_weight;
+      layer_weights[k - z] += 1.0 - inactive_weight;
+
+      if (top[ic] < k)
+      {
+        top[ic] = k;
+      }
+    });
+  }
+
+  GrGeomFreeSolid(gr_domain);
+
+  /* these subgrids are owned by all_subgrids */
+  SubgridArraySize(subgrids) = 0;
+  FreeSubgridArray(subgrids);
+
+  invoice = amps_NewInvoice("%*d%*d", nx * ny, column_weights, nz, layer_weights);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+  amps_FreeInvoice(invoice);
+
+  if (surface_weight != 0.0)
+  {
+    invoice = amps_NewInvoice("%*d", nx * ny, top);
+    amps_AllReduce(amps_CommWorld, invoice, amps_Max);
+    amps_FreeInvoice(invoice);
+
+    for (ic = 0; ic < nx * ny; ic++)
+    {
+      if (top[ic] >= 0.0)
+      {
+        column_weights[ic] += surface_weight;
+        layer_weights[(int)top[ic] - z] += surface_weight;
+      }
+    }
+  }
+
+  tfree(top);
+
+  return column_weights;
+}
+
+/*--------------------------------------------------------------------------
+ * FindCut:
+ *   Returns the index in [lo, hi] at which the prefix sum of the n
+ *   weights is closest to target.
+ *--------------------------------------------------------------------------*/
+
+static int      FindCut(
+                        double *weights,
+                        int     lo,
+                        int     hi,
+                        double  target)
+{
+  double sum = 0.0;
+  int cut;
+
+  for (cut = 0; cut < lo; cut++)
+  {
+    sum += weights[cut];
+  }
+
+  while ((cut < hi) && (sum + 0.5 * weights[cut] < target))
+  {
+    sum += weights[cut];
+    cut++;
+  }
+
+  return cut;
+}
+
+/*--------------------------------------------------------------------------
+ * PartitionAxis:
+ *   Splits n weighted cells into num_parts contiguous ranges of roughly
+ *   equal weight with at least one cell each.  Range p is
+ *   [offsets[p], offsets[p+1]).
+ *--------------------------------------------------------------------------*/
+
+static void     PartitionAxis(
+                              double *weights,
+                              int     n,
+                              int     num_parts,
+                              int *   offsets)
+{
+  double total = 0.0;
+  int i, p;
+
+  for (i = 0; i < n; i++)
+  {
+    total += weights[i];
+  }
+
+  offsets[0] = 0;
+  for (p = 1; p < num_parts; p++)
+  {
+    offsets[p] = FindCut(weights, offsets[p - 1] + 1, n - (num_parts - p),
+                         total * p / num_parts);
+  }
+  offsets[num_parts] = n;
+}
+
+/*--------------------------------------------------------------------------
+ * BisectColumns:
+ *   Recursive coordinate bisection of the columns [ix, ix+nx) x
+ *   [iy, iy+ny) (relative to the user grid) over num_procs processes
+ *   numbered from first_process.  Boxes are split across their longer
+ *   side so that the column weight on each side is proportional to the
+ *   number of processes it receives.  Subgrids span the full user grid
+ *   in z.
+ *--------------------------------------------------------------------------*/
+
+static void     BisectColumns(
+                              double *      column_weights,
+                              Subgrid *     user_subgrid,
+                              int           ix,
+                              int           iy,
+                              int           nx,
+                              int           ny,
+                              int           num_procs,
+                              int           first_process,
+                              SubgridArray *all_subgrids)
+{
+  int user_nx = SubgridNX(user_subgrid);
+
+  double *weights;
+  double total;
+  int num_left, length, width, split_x;
+  int cut, lo, hi;
+  int i, j;
+
+  if (num_procs == 1)
+  {
+    AppendSubgrid(NewSubgrid(SubgridIX(user_subgrid) + ix,
+                             SubgridIY(user_subgrid) + iy,
+                             SubgridIZ(user_subgrid),
+                             nx, ny, SubgridNZ(user_subgrid),
+                             0, 0, 0,
+                             first_process),
+                  all_subgrids);
+    return;
+  }
+
+  num_left = num_procs / 2;
+
+  split_x = (nx >= ny);
+  length = split_x ? nx : ny;
+  width = split_x ? ny : nx;
+
+  weights = ctalloc(double, length);
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      weights[split_x ? i : j] += column_weights[(iy + j) * user_nx + (ix + i)];
+    }
+  }
+
+  total = 0.0;
+  for (i = 0; i < length; i++)
+  {
+    total += weights[i];
+  }
+
+  /* each side needs at least one column per process */
+  lo = (num_left + width - 1) / width;
+  hi = length - (num_procs - num_left + width - 1) / width;
+
+  cut = FindCut(weights, lo, hi, total * num_left / num_procs);
+
+  tfree(weights);
+
+  if (split_x)
+  {
+    BisectColumns(column_weights, user_subgrid, ix, iy, cut, ny,
+                  num_left, first_process, all_subgrids);
+    BisectColumns(column_weights, user_subgrid, ix + cut, iy, nx - cut, ny,
+                  num_procs - num_left, first_process + num_left, all_subgrids);
+  }
+  else
+  {
+    BisectColumns(column_weights, user_subgrid, ix, iy, nx, cut,
+                  num_left, first_process, all_subgrids);
+    BisectColumns(column_weights, user_subgrid, ix, iy + cut, nx, ny - cut,
+                  num_procs - num_left, first_process + num_left, all_subgrids);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * ComputeImbalance:
+ *   Ratio of the largest to the mean process weight of a decomposition,
+ *   with the weight of a subgrid estimated from its column weights and
+ *   the fraction of the layer weight it spans.
+ *--------------------------------------------------------------------------*/
+
+static double   ComputeImbalance(
+                                 Subgrid *     user_subgrid,
+                                 SubgridArray *all_subgrids,
+                                 double *      column_weights,
+                                 double *      layer_weights,
+                                 int           num_procs)
+{
+  int x = SubgridIX(user_subgrid);
+  int y = SubgridIY(user_subgrid);
+  int z = SubgridIZ(user_subgrid);
+  int nx = SubgridNX(user_subgrid);
+  int nz = SubgridNZ(user_subgrid);
+
+  double *process_weights = ctalloc(double, num_procs);
+  double total_layers = 0.0, layers, columns;
+  double max = 0.0, sum = 0.0;
+  int is, i, j, k;
+
+  for (k = 0; k < nz; k++)
+  {
+    total_layers += layer_weights[k];
+  }
+
+  ForSubgridI(is, all_subgrids)
+  {
+    Subgrid *subgrid = SubgridArraySubgrid(all_subgrids, is);
+
+    columns = 0.0;
+    for (j = SubgridIY(subgrid); j < SubgridIY(subgrid) + SubgridNY(subgrid); j++)
+    {
+      for (i = SubgridIX(subgrid); i < SubgridIX(subgrid) + SubgridNX(subgrid); i++)
+      {
+        columns += column_weights[(j - y) * nx + (i - x)];
+      }
+    }
+
+    layers = 0.0;
+    for (k = SubgridIZ(subgrid); k < SubgridIZ(subgrid) + SubgridNZ(subgrid); k++)
+    {
+      layers += layer_weights[k - z];
+    }
+
+    process_weights[SubgridProcess(subgrid)] +=
+      (total_layers > 0.0) ? columns * layers / total_layers : 0.0;
+  }
+
+  for (i = 0; i < num_procs; i++)
+  {
+    max = pfmax(max, process_weights[i]);
+    sum += process_weights[i];
+  }
+
+  tfree(process_weights);
+
+  return (sum > 0.0) ? max * num_procs / sum : 1.0;
+}
+
+/*--------------------------------------------------------------------------
+ * WriteProcessGrid:
+ *   Writes the decomposition as ProcessGrid keys so that it can be
+ *   reused by later runs.
+ *--------------------------------------------------------------------------*/
+
+static void     WriteProcessGrid(
+                                 SubgridArray *all_subgrids)
+{
+  char filename[2048];
+  FILE *file;
+  int is;
+
+  sprintf(filename, "%s.process_grid.tcl", GlobalsOutFileName);
+
+  if ((file = fopen(filename, "w")) == NULL)
+  {
+    amps_Printf("Error: can't open process grid file %s\n", filename);
+    return;
+  }
+
+  fprintf(file, "pfset ProcessGrid.NumSubgrids %d\n",
+          SubgridArraySize(all_subgrids));
+
+  ForSubgridI(is, all_subgrids)
+  {
+    Subgrid *subgrid = SubgridArraySubgrid(all_subgrids, is);
+
+    fprintf(file, "pfset ProcessGrid.%d.P %d\n", is, SubgridProcess(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.IX %d\n", is, SubgridIX(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.IY %d\n", is, SubgridIY(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.IZ %d\n", is, SubgridIZ(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.NX %d\n", is, SubgridNX(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.NY %d\n", is, SubgridNY(subgrid));
+    fprintf(file, "pfset ProcessGrid.%d.NZ %d\n", is, SubgridNZ(subgrid));
+  }
+
+  fclose(file);
+}
+
+/*--------------------------------------------------------------------------
+ * CopySubgridArray
+ *--------------------------------------------------------------------------*/
+
+static SubgridArray  *CopySubgridArray(
+                                       SubgridArray *subgrids)
+{
+  SubgridArray  *new_subgrids = NewSubgridArray();
+  int is;
+
+  ForSubgridI(is, subgrids)
+  {
+    AppendSubgrid(DuplicateSubgrid(SubgridArraySubgrid(subgrids, is)),
+                  new_subgrids);
+  }
+
+  return new_subgrids;
+}
+
+/*--------------------------------------------------------------------------
+ * BalanceSubgrids:
+ *   Computes a decomposition of the user grid balancing the domain cell
+ *   weights, starting from the uniform decomposition all_subgrids.
+ *   Rectilinear keeps the PxQxR layout and places the cuts along each
+ *   axis by the weights summed over the other axes.  Bisection
+ *   recursively splits the (x,y) columns.
+ *
+ *   Returns NULL if the domain geometry is not available.
+ *--------------------------------------------------------------------------*/
+
+static SubgridArray  *BalanceSubgrids(
+                                      Subgrid *     user_subgrid,
+                                      SubgridArray *all_subgrids,
+                                      int           method,
+                                      int           P,
+                                      int           Q,
+                                      int           R,
+                                      double        inactive_weight,
+                                      double        surface_weight)
+{
+  SubgridArray  *balanced_subgrids;
+
+  int x = SubgridIX(user_subgrid);
+  int y = SubgridIY(user_subgrid);
+  int z = SubgridIZ(user_subgrid);
+  int nx = SubgridNX(user_subgrid);
+  int ny = SubgridNY(user_subgrid);
+  int nz = SubgridNZ(user_subgrid);
+
+  int num_procs = P * Q * R;
+
+  double *column_weights;
+  double *layer_weights;
+  double imbalance;
+  int p, q, r, i, j;
+
+  layer_weights = ctalloc(double, nz);
+  column_weights = ComputeColumnWeights(user_subgrid, all_subgrids,
+                                        inactive_weight, surface_weight,
+                                        layer_weights);
+  if (!column_weights)
+  {
+    if (!amps_Rank(amps_CommWorld))
+    {
+      amps_Printf("Warning: domain geometry is not available for %s, "
+                  "using uniform decomposition\n", "Process.Topology.Method");
+    }
+    tfree(layer_weights);
+    return NULL;
+  }
+
+  balanced_subgrids = NewSubgridArray();
+
+  if (method == DistributeRectilinear)
+  {
+    double *weights = ctalloc(double, pfmax(nx, ny));
+    int    *ox = talloc(int, P + 1);
+    int    *oy = talloc(int, Q + 1);
+    int    *oz = talloc(int, R + 1);
+
+    for (j = 0; j < ny; j++)
+      for (i = 0; i < nx; i++)
+        weights[i] += column_weights[j * nx + i];
+    PartitionAxis(weights, nx, P, ox);
+
+    for (i = 0; i < nx; i++)
+      weights[i] = 0.0;
+    for (j = 0; j < ny; j++)
+      for (i = 0; i < nx; i++)
+        weights[j] += column_weights[j * nx + i];
+    PartitionAxis(weights, ny, Q, oy);
+
+    PartitionAxis(layer_weights, nz, R, oz);
+
+    for (p = 0; p < P; p++)
+    {
+      for (q = 0; q < Q; q++)
+      {
+        for (r = 0; r < R; r++)
+        {
+          AppendSubgrid(NewSubgrid(x + ox[p], y + oy[q], z + oz[r],
+                                   ox[p + 1] - ox[p],
+                                   oy[q + 1] - oy[q],
+                                   oz[r + 1] - oz[r],
+                                   0, 0, 0,
+                                   pqr_to_rank(p, q, r, P, Q, R)),
+                        balanced_subgrids);
+        }
+      }
+    }
+
+    tfree(weights);
+    tfree(ox);
+    tfree(oy);
+    tfree(oz);
+  }
+  else
+  {
+    BisectColumns(column_weights, user_subgrid, 0, 0, nx, ny,
+                  num_procs, 0, balanced_subgrids);
+  }
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    imbalance = ComputeImbalance(user_subgrid, all_subgrids,
+                                 column_weights, layer_weights, num_procs);
+    amps_Printf("Balanced process grid by domain cell weights, "
+                "load imbalance %g -> %g\n", imbalance,
+                ComputeImbalance(user_subgrid, balanced_subgrids,
+                                 column_weights, layer_weights, num_procs));
+  }
+
+  tfree(column_weights);
+  tfree(layer_weights);
+
+  return balanced_subgrids;
+}
+
+/*--------------------------------------------------------------------------
+ * SplitSubgrids:
+ *   Splits each process subgrid into sp x sq subgrids owned by the same
+ *   process.  Subgrids are not split in z so that the processes of a
+ *   column hold their subgrids in the same order.
+ *
+ *   Returns NULL if a subgrid is too small to be split.
+ *--------------------------------------------------------------------------*/
+
+static SubgridArray  *SplitSubgrids(
+                                    SubgridArray *all_subgrids,
+                                    int           sp,
+                                    int           sq)
+{
+  SubgridArray  *new_subgrids = NewSubgridArray();
+  Subgrid       *subgrid;
+
+  int mx, my, lx, ly;
+  int is, p, q;
+
+
+  ForSubgridI(is, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, is);
+
+    if ((SubgridNX(subgrid) < sp) || (SubgridNY(subgrid) < sq))
+    {
+      FreeSubgridArray(new_subgrids);
+      return NULL;
+    }
+
+    mx = SubgridNX(subgrid) / sp;
+    my = SubgridNY(subgrid) / sq;
+
+    lx = (SubgridNX(subgrid) % sp);
+    ly = (SubgridNY(subgrid) % sq);
+
+    for (q = 0; q < sq; q++)
+    {
+      for (p = 0; p < sp; p++)
+      {
+        AppendSubgrid(NewSubgrid(pqr_to_xyz(p, mx, lx, SubgridIX(subgrid)),
+                                 pqr_to_xyz(q, my, ly, SubgridIY(subgrid)),
+                                 SubgridIZ(subgrid),
+                                 pqr_to_nxyz(p, mx, lx),
+                                 pqr_to_nxyz(q, my, ly),
+                                 SubgridNZ(subgrid),
+                                 SubgridRX(subgrid),
+                                 SubgridRY(subgrid),
+                                 SubgridRZ(subgrid),
+                                 SubgridProcess(subgrid)),
+                      new_subgrids);
+      }
+    }
+  }
+
+  return new_subgrids;
+}
+
+#ifdef AMPS_NODE_INDICES
+
+/*--------------------------------------------------------------------------
+ * OrderColumns:
+ *   Appends the (p,q) columns of the np x nq block of the process grid
+ *   at (ip,iq) to order, halving the longer side recursively so that
+ *   consecutive columns are close together.
+ *--------------------------------------------------------------------------*/
+
+static void     OrderColumns(
+                             int  ip,
+                             int  iq,
+                             int  np,
+                             int  nq,
+                             int  P,
+                             int *order,
+                             int *num_ordered)
+{
+  if ((np * nq) == 1)
+  {
+    order[(*num_ordered)++] = iq * P + ip;
+  }
+  else if (np >= nq)
+  {
+    OrderColumns(ip, iq, np / 2, nq, P, order, num_ordered);
+    OrderColumns(ip + np / 2, iq, np - np / 2, nq, P, order, num_ordered);
+  }
+  else
+  {
+    OrderColumns(ip, iq, np, nq / 2, P, order, num_ordered);
+    OrderColumns(ip, iq + nq / 2, np, nq - nq / 2, P, order, num_ordered);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * ComputeNodeHalo:
+ *   Number of ghost cells exchanged between processes on different
+ *   nodes for the uniform PxQxR decomposition with the given mapping
+ *   (NULL for lexicographic).
+ *--------------------------------------------------------------------------*/
+
+static double   ComputeNodeHalo(
+                                int *process_map,
+                                int *node_indices,
+                                int  nx,
+                                int  ny,
+                                int  nz,
+                                int  P,
+                                int  Q,
+                                int  R)
+{
+  double halo = 0.0;
+  int p, q, r, n0;
+
+#define NodeOf(p, q, r)                                                      \
+  node_indices[process_map ?                                                 \
+               process_map[pqr_to_process(p, q, r, P, Q, R)] :               \
+               pqr_to_process(p, q, r, P, Q, R)]
+
+  for (p = 0; p < P; p++)
+  {
+    for (q = 0; q < Q; q++)
+    {
+      for (r = 0; r < R; r++)
+      {
+        n0 = NodeOf(p, q, r);
+
+        if ((p + 1 < P) && (NodeOf(p + 1, q, r) != n0))
+          halo += pqr_to_nxyz(q, ny / Q, ny % Q) * pqr_to_nxyz(r, nz / R, nz % R);
+        if ((q + 1 < Q) && (NodeOf(p, q + 1, r) != n0))
+          halo += pqr_to_nxyz(p, nx / P, nx % P) * pqr_to_nxyz(r, nz / R, nz % R);
+        if ((r + 1 < R) && (NodeOf(p, q, r + 1) != n0))
+          halo += pqr_to_nxyz(p, nx / P, nx % P) * pqr_to_nxyz(q, ny / Q, ny % Q);
+      }
+    }
+  }
+
+#undef NodeOf
+
+  return 2.0 * halo;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------
+ * NewNodeProcessMap:
+ *   Maps the PxQxR process grid to ranks so that the processes of a
+ *   compute node own a compact block of whole (p,q) columns where
+ *   possible.  Columns are taken in the order of OrderColumns and their
+ *   processes are given the ranks of the first node, then of the second
+ *   node and so on.  Halos in z, which are the largest for thin domains,
+ *   then stay within a node.
+ *
+ *   Returns NULL if all processes are on one node or the node layout is
+ *   not available.
+ *--------------------------------------------------------------------------*/
+
+static int     *NewNodeProcessMap(
+                                  int nx,
+                                  int ny,
+                                  int nz,
+                                  int P,
+                                  int Q,
+                                  int R)
+{
+  int  *process_map = NULL;
+
+#ifdef AMPS_NODE_INDICES
+  int num_procs = P * Q * R;
+
+  int  *node_indices = talloc(int, num_procs);
+  int  *node_offsets;
+  int  *node_ranks;
+  int  *columns;
+
+  int num_nodes, num_columns;
+  int i, ic, p, q, r;
+
+  num_nodes = amps_NodeIndices(amps_CommWorld, node_indices);
+
+  if (num_nodes > 1)
+  {
+    /* Ranks sorted by node, in rank order within a node */
+    node_offsets = ctalloc(int, num_nodes + 1);
+    for (i = 0; i < num_procs; i++)
+    {
+      node_offsets[node_indices[i] + 1]++;
+    }
+    for (i = 0; i < num_nodes; i++)
+    {
+      node_offsets[i + 1] += node_offsets[i];
+    }
+
+    node_ranks = talloc(int, num_procs);
+    for (i = 0; i < num_procs; i++)
+    {
+      node_ranks[node_offsets[node_indices[i]]++] = i;
+    }
+
+    columns = talloc(int, P * Q);
+    num_columns = 0;
+    OrderColumns(0, 0, P, Q, P, columns, &num_columns);
+
+    process_map = talloc(int, num_procs);
+    i = 0;
+    for (ic = 0; ic < num_columns; ic++)
+    {
+      p = columns[ic] % P;
+      q = columns[ic] / P;
+      for (r = 0; r < R; r++)
+      {
+        process_map[pqr_to_process(p, q, r, P, Q, R)] = node_ranks[i++];
+      }
+    }
+
+    if (!amps_Rank(amps_CommWorld))
+    {
+      amps_Printf("Mapped process grid to %d nodes, "
+                  "inter-node halo cells %g -> %g\n", num_nodes,
+                  ComputeNodeHalo(NULL, node_indices, nx, ny, nz, P, Q, R),
+                  ComputeNodeHalo(process_map, node_indices, nx, ny, nz, P, Q, R));
+    }
+
+    tfree(columns);
+    tfree(node_ranks);
+    tfree(node_offsets);
+  }
+
+  tfree(node_indices);
+#else
+  PF_UNUSED(nx);
+  PF_UNUSED(ny);
+  PF_UNUSED(nz);
+  PF_UNUSED(P);
+  PF_UNUSED(Q);
+  PF_UNUSED(R);
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    amps_Printf("Warning: node layout is not available for %s, "
+                "using lexicographic mapping\n", "Process.Topology.Mapping");
+  }
+#endif
+
+  return process_map;
+}
+
 /*--------------------------------------------------------------------------
  * DistributeUserGrid:
  *   We currently assume that the user's grid consists of 1 subgrid only.
@@ -52,10 +859,17 @@
 SubgridArray   *DistributeUserGrid(
                                    Grid *user_grid)
 {
+  static char first_write = 1;
+  static char first_mapping = 1;
+
   Subgrid     *user_subgrid = GridSubgrid(user_grid, 0);
 
   SubgridArray  *all_subgrids;
 
+  NameArray switch_na;
+  char      *switch_name;
+  char key[IDB_MAX_KEY_LEN];
+
   int num_procs;
 
   int x, y, z;
@@ -67,6 +881,12 @@ SubgridArray   *DistributeUserGrid(
   int mx, my, mz, m;
   int lx, ly, lz;
 
+  int method;
+  int mapping;
+  int write_process_grid;
+  int split_p, split_q;
+  double inactive_weight, surface_weight;
+
 
   nx = SubgridNX(user_subgrid);
   ny = SubgridNY(user_subgrid);
@@ -106,11 +926,25 @@ SubgridArray   *DistributeUserGrid(
 
     SubgridArray* subgrid_array = GridAllSubgrids(process_grid);
     int i;
+    int full_columns = 1;
     ForSubgridI(i, subgrid_array)
     {
       Subgrid* new_subgrid = DuplicateSubgrid(SubgridArraySubgrid(subgrid_array, i));
 
       AppendSubgrid(new_subgrid, all_subgrids);
+
+      full_columns = full_columns &&
+                     (SubgridIZ(new_subgrid) == SubgridIZ(user_subgrid)) &&
+                     (SubgridNZ(new_subgrid) == nz);
+    }
+
+    /*
+     * Process grids that are not split in z (e.g. written by the
+     * Bisection method) have every process at the bottom of its column.
+     */
+    if (full_columns)
+    {
+      GlobalsR = 0;
     }
   }
   else
@@ -119,6 +953,50 @@ SubgridArray   *DistributeUserGrid(
      * Parflow specifies process layout
      *-----------------------------------------------------------------------*/
 
+    sprintf(key, "Process.Topology.Method");
+    switch_na = NA_NewNameArray("Uniform Rectilinear Bisection");
+    switch_name = GetStringDefault(key, "Uniform");
+    method = NA_NameToIndex(switch_na, switch_name);
+    if (method < 0)
+    {
+      InputError("Error: invalid decomposition method <%s> for key <%s>\n",
+                 switch_name, key);
+    }
+    NA_FreeNameArray(switch_na);
+
+    sprintf(key, "Process.Topology.Mapping");
+    switch_na = NA_NewNameArray("Lexicographic Node");
+    switch_name = GetStringDefault(key, "Lexicographic");
+    mapping = NA_NameToIndex(switch_na, switch_name);
+    if (mapping < 0)
+    {
+      InputError("Error: invalid process mapping <%s> for key <%s>\n",
+                 switch_name, key);
+    }
+    NA_FreeNameArray(switch_na);
+
+    inactive_weight = GetDoubleDefault("Process.Topology.InactiveWeight", 0.0);
+    surface_weight = GetDoubleDefault("Process.Topology.SurfaceWeight", 0.0);
+
+    split_p = GetIntDefault("Process.Topology.Subgrids.P", 1);
+    split_q = GetIntDefault("Process.Topology.Subgrids.Q", 1);
+    if ((split_p < 1) || (split_q < 1))
+    {
+      InputError("Error: <%s> and <%s> must be at least 1\n",
+                 "Process.Topology.Subgrids.P", "Process.Topology.Subgrids.Q");
+    }
+
+    sprintf(key, "Process.Topology.WriteProcessGrid");
+    switch_na = NA_NewNameArray("False True");
+    switch_name = GetStringDefault(key, "False");
+    write_process_grid = NA_NameToIndex(switch_na, switch_name);
+    if (write_process_grid < 0)
+    {
+      InputError("Error: invalid print switch value <%s> for key <%s>\n",
+                 switch_name, key);
+    }
+    NA_FreeNameArray(switch_na);
+
     if (!P || !Q || !R)
     {
       m = (int)pow((double)((nx * ny * nz) / num_procs), (1.0 / 3.0));
@@ -154,6 +1032,28 @@ SubgridArray   *DistributeUserGrid(
     else
       return NULL;
 
+    if ((method == DistributeBisection) && (R != 1))
+    {
+      InputError("Error: decomposition method <%s> requires <%s> to be 1\n",
+                 "Bisection", "Process.Topology.R");
+    }
+
+    if ((method == DistributeBisection) && (mapping == MappingNode))
+    {
+      InputError("Error: decomposition method <%s> requires <%s> to be Lexicographic\n",
+                 "Bisection", "Process.Topology.Mapping");
+    }
+
+    /*-----------------------------------------------------------------------
+     * Map the process grid to ranks
+     *-----------------------------------------------------------------------*/
+
+    if ((mapping == MappingNode) && first_mapping)
+    {
+      GlobalsProcessMap = NewNodeProcessMap(nx, ny, nz, P, Q, R);
+    }
+    first_mapping = 0;
+
     /*-----------------------------------------------------------------------
      * Create all_subgrids
      *-----------------------------------------------------------------------*/
@@ -185,10 +1085,10 @@ SubgridArray   *DistributeUserGrid(
                                    pqr_to_nxyz(q, my, ly),
                                    pqr_to_nxyz(r, mz, lz),
                                    0, 0, 0,
-                                   pqr_to_process(p, q, r, P, Q, R)),
+                                   pqr_to_rank(p, q, r, P, Q, R)),
                         all_subgrids);
 
-          if (pqr_to_process(p, q, r, P, Q, R) == amps_Rank(amps_CommWorld))
+          if (pqr_to_rank(p, q, r, P, Q, R) == amps_Rank(amps_CommWorld))
           {
             GlobalsP = p;
             GlobalsQ = q;
@@ -197,10 +1097,75 @@ SubgridArray   *DistributeUserGrid(
         }
       }
     }
+
+    /*-----------------------------------------------------------------------
+     * Rebalance the uniform decomposition by the domain cell weights
+     *-----------------------------------------------------------------------*/
+
+    if (method != DistributeUniform)
+    {
+      /* The balanced decomposition is computed once per user grid and
+       * kept on it, since grids are created from the user grid several
+       * times per run */
+      if (!GridBalancedSubgrids(user_grid) && !GridBalanceFailed(user_grid))
+      {
+        GridBalancedSubgrids(user_grid) =
+          BalanceSubgrids(user_subgrid, all_subgrids, method, P, Q, R,
+                          inactive_weight, surface_weight);
+        GridBalanceFailed(user_grid) = (GridBalancedSubgrids(user_grid) == NULL);
+      }
+
+      if (GridBalancedSubgrids(user_grid))
+      {
+        FreeSubgridArray(all_subgrids);
+        all_subgrids = CopySubgridArray(GridBalancedSubgrids(user_grid));
+
+        if (method == DistributeBisection)
+        {
+          /* There is no PxQ process layout after bisection */
+          GlobalsP = -99999;
+          GlobalsQ = -99999;
+          GlobalsR = 0;
+        }
+      }
+    }
+
+    /*-----------------------------------------------------------------------
+     * Over-decompose each process subgrid
+     *-----------------------------------------------------------------------*/
+
+    if ((split_p * split_q) > 1)
+    {
+      SubgridArray *split_subgrids = SplitSubgrids(all_subgrids,
+                                                   split_p, split_q);
+
+      if (!split_subgrids)
+      {
+        InputError("Error: process subgrids are too small for <%s> and <%s>\n",
+                   "Process.Topology.Subgrids.P", "Process.Topology.Subgrids.Q");
+      }
+
+      FreeSubgridArray(all_subgrids);
+      all_subgrids = split_subgrids;
+    }
+
+    if (write_process_grid && first_write && !amps_Rank(amps_CommWorld))
+    {
+      WriteProcessGrid(all_subgrids);
+    }
+    first_write = 0;
   }
 
   FreeGrid(process_grid);
 
+  /*
+   * The clustered iteration boxes are computed for a single subgrid per
+   * process; fall back to the octree loops when processes own several.
+   */
+  if (all_subgrids && (MaxProcessSubgrids(all_subgrids) > 1))
+  {
+    GlobalsUseClustering = 0;
+  }
+
   return all_subgrids;
 }
-
@@ -79,6 +79,8 @@ void   NewGlobals(char *run_name)
   globals_ptr->repeat_counts = 0;
 
   globals_ptr->use_clustering = 0;
+
+  globals_ptr->process_map = NULL;
 }
 
 
@@ -88,6 +90,7 @@ void   NewGlobals(char *run_name)
 
 void  FreeGlobals()
 {
+  tfree(globals_ptr->process_map);
   tfree(globals_ptr);
 }
 
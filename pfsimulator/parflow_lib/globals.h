@@ -59,6 +59,9 @@ typedef struct _Globals {
   int q;
   int r;
 
+  /* Rank of each PxQxR process grid position, NULL if lexicographic */
+  int *process_map;
+
   /* RDF the following just doesn't seem to make sense here */
   Background     *background;
   Grid           *user_grid;         /* user specified grid */
@@ -88,6 +91,8 @@ typedef struct _Globals {
 
   int use_clustering;
 
+  long vector_epoch;          /* last modification stamp given to a Vector */
+
 #ifdef HAVE_SAMRAI
   SAMRAI::tbox::Pointer < Parflow > parflow_simulation;
 #endif
@@ -122,6 +127,8 @@ amps_ThreadLocalDcl(extern IDB *, input_database);
 #define GlobalsQ       (globals->q)
 #define GlobalsR       (globals->r)
 
+#define GlobalsProcessMap      (globals->process_map)
+
 #define GlobalsBackground      (globals->background)
 #define GlobalsUserGrid        (globals->user_grid)
 #define GlobalsMaxRefLevel     (globals->max_ref_level)
@@ -143,6 +150,14 @@ amps_ThreadLocalDcl(extern IDB *, input_database);
 
 #define GlobalsUseClustering      (globals->use_clustering)
 
+#define GlobalsVectorEpoch        (globals->vector_epoch)
+
 #define pqr_to_process(p, q, r, P, Q, R)  ((((r) * (Q)) + (q)) * (P) + (p))
 
+/* Rank of the process at (p, q, r) of the PxQxR process grid */
+#define pqr_to_rank(p, q, r, P, Q, R)                     \
+  (GlobalsProcessMap ?                                    \
+   GlobalsProcessMap[pqr_to_process(p, q, r, P, Q, R)] :  \
+   pqr_to_process(p, q, r, P, Q, R))
+
 #endif
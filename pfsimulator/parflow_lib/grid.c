@@ -105,6 +105,9 @@ Grid  *NewGrid(
 
   new_grid->compute_pkgs = NULL;
 
+  new_grid->balanced_subgrids = NULL;
+  new_grid->balance_failed = 0;
+
   return new_grid;
 }
 
@@ -118,6 +121,8 @@ void  FreeGrid(
 {
   if (grid)
   {
+    ForgetCommPkgLayouts(grid);
+
     if (grid->background)
     {
       FreeSubgrid(grid->background);
@@ -132,6 +137,9 @@ void  FreeGrid(
     if (GridComputePkgs(grid))
       FreeComputePkgs(grid);
 
+    if (GridBalancedSubgrids(grid))
+      FreeSubgridArray(GridBalancedSubgrids(grid));
+
     tfree(grid);
   }
 }
@@ -978,3 +986,40 @@ SubgridArray  *UnionSubgridArray(
   return new_sa;
 }
 
+
+/*--------------------------------------------------------------------------
+ * MaxProcessSubgrids:
+ *   Returns the largest number of subgrids owned by one process.
+ *--------------------------------------------------------------------------*/
+
+int            MaxProcessSubgrids(
+                                  SubgridArray *all_subgrids)
+{
+  int  *num_subgrids;
+  int num_procs, max_subgrids;
+  int is, p;
+
+
+  num_procs = 0;
+  ForSubgridI(is, all_subgrids)
+  {
+    num_procs = pfmax(num_procs,
+                      SubgridProcess(SubgridArraySubgrid(all_subgrids, is)) + 1);
+  }
+
+  num_subgrids = ctalloc(int, num_procs + 1);
+
+  max_subgrids = 0;
+  ForSubgridI(is, all_subgrids)
+  {
+    p = SubgridProcess(SubgridArraySubgrid(all_subgrids, is));
+    if (p >= 0)
+    {
+      max_subgrids = pfmax(max_subgrids, ++num_subgrids[p]);
+    }
+  }
+
+  tfree(num_subgrids);
+
+  return max_subgrids;
+}
@@ -75,6 +75,12 @@ typedef struct {
                                   * space of points that all subgrids
                                   * lie in.  Basically the bounding
                                   * box for the subgrids */
+
+  SubgridArray   *balanced_subgrids; /* Weight balanced decomposition of
+                                      * this user grid, computed once by
+                                      * DistributeUserGrid */
+  int balance_failed;                /* The balanced decomposition could
+                                      * not be computed */
 } Grid;
 
 
@@ -117,6 +123,9 @@ typedef struct {
 
 #define GridSize(grid)   ((grid)->size)
 
+#define GridBalancedSubgrids(grid) ((grid)->balanced_subgrids)
+#define GridBalanceFailed(grid)    ((grid)->balance_failed)
+
 #define GridComputePkgs(grid)   ((grid)->compute_pkgs)
 #define GridComputePkg(grid, i) ((grid)->compute_pkgs[(i)])
 
@@ -32,6 +32,17 @@
 /* Note we are using internal hypre methods */
 #include "_hypre_struct_mv.h"
 
+/*
+ * Versions of Hypre > 2.10.x require dimension argument for
+ * BoxCreate.  Previous versions don't require argument.
+ */
+#if PARFLOW_HYPRE_VERSION_MAJOR > 2 || \
+  (PARFLOW_HYPRE_VERSION_MAJOR >= 2 && PARFLOW_HYPRE_VERSION_MINOR >= 10)
+#define PARFLOW_HYPRE_DIM 3
+#else
+#define PARFLOW_HYPRE_DIM
+#endif
+
 #ifdef HYPRE_SEQUENTIAL
 #ifndef amps_CommWorld
 #define amps_CommWorld 0
@@ -59,6 +59,21 @@
   PF_UNUSED(nz);                                                      \
   PF_UNUSED(nzd)
 
+/**
+ * @brief Loop over the subgrids of a process, one task per subgrid
+ *
+ * Used as a replacement for ForSubgridI; the statement that follows is the
+ * loop body.  Backends may run the subgrids concurrently, so the body must
+ * declare every variable it assigns and must not reduce into variables
+ * declared outside of it.
+ *
+ * @note Multiple definitions (see backend_mapping.h).
+ *
+ * @param[in,out] i Subgrid index
+ * @param[in] subgrid_array Subgrids to loop over
+ */
+#define ForSubgridTasks_default(i, subgrid_array) ForSubgridI(i, subgrid_array)
+
 /**
  * @brief Perform a reduction over a BoxLoopI1 iteration space
  *
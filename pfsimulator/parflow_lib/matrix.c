@@ -83,42 +83,88 @@ CommPkg   *NewMatrixUpdatePkg(
                               Stencil *ghost)
 {
   CommPkg     *new_commpkg = NULL;
+  CommPkgLayout *layout;
 
   Grid* grid = MatrixGrid(matrix);
 
-  if (GridNumSubgrids(grid) > 1)
-  {
-    PARFLOW_ERROR("NewMatrixUpdatePkg can't be used with number subgrids > 1");
-  }
-  else
-  {
-    Region      *send_reg, *recv_reg;
+  Region      *send_reg, *recv_reg;
 
-    Submatrix * submatrix = MatrixSubmatrix(matrix, 0);
+  Submatrix * submatrix = MatrixSubmatrix(matrix, 0);
 
-    int ix = SubmatrixIX(submatrix);
-    int iy = SubmatrixIY(submatrix);
-    int iz = SubmatrixIZ(submatrix);
-    int sx = SubmatrixSX(submatrix);
-    int sy = SubmatrixSY(submatrix);
-    int sz = SubmatrixSZ(submatrix);
+  int i;
 
-    int n = StencilSize(MatrixStencil(matrix));
-    if (MatrixSymmetric(matrix))
-      n = (n + 1) / 2;
+  /* Empty submatrices are not projected, take the lattice from another */
+  ForSubgridI(i, GridSubgrids(grid))
+  {
+    if (SubmatrixNX(MatrixSubmatrix(matrix, i)) &&
+        SubmatrixNY(MatrixSubmatrix(matrix, i)) &&
+        SubmatrixNZ(MatrixSubmatrix(matrix, i)))
+    {
+      submatrix = MatrixSubmatrix(matrix, i);
+      break;
+    }
+  }
+
+  int ix = SubmatrixIX(submatrix);
+  int iy = SubmatrixIY(submatrix);
+  int iz = SubmatrixIZ(submatrix);
+  int sx = SubmatrixSX(submatrix);
+  int sy = SubmatrixSY(submatrix);
+  int sz = SubmatrixSZ(submatrix);
+
+  int n = StencilSize(MatrixStencil(matrix));
+  if (MatrixSymmetric(matrix))
+    n = (n + 1) / 2;
+
+  /* The layout depends on the grid, the lattice and the ghost stencil */
+  int key_size = 7 + 3 * StencilSize(ghost);
+  int *key = talloc(int, key_size);
+  int s;
+
+  key[0] = ix;
+  key[1] = iy;
+  key[2] = iz;
+  key[3] = sx;
+  key[4] = sy;
+  key[5] = sz;
+  key[6] = StencilSize(ghost);
+  for (s = 0; s < StencilSize(ghost); s++)
+  {
+    key[7 + 3 * s] = StencilShape(ghost)[s][0];
+    key[8 + 3 * s] = StencilShape(ghost)[s][1];
+    key[9 + 3 * s] = StencilShape(ghost)[s][2];
+  }
 
-    CommRegFromStencil(&send_reg, &recv_reg, MatrixGrid(matrix), ghost);
+  layout = FindCommPkgLayout(grid, key, key_size, MatrixDataSpace(matrix), n);
+  if (!layout)
+  {
+    CommRegFromStencil(&send_reg, &recv_reg, grid, ghost);
     ProjectRegion(send_reg, sx, sy, sz, ix, iy, iz);
     ProjectRegion(recv_reg, sx, sy, sz, ix, iy, iz);
 
-
-    new_commpkg = NewCommPkg(send_reg, recv_reg,
-                             MatrixDataSpace(matrix), n, SubmatrixData(submatrix));
+    layout = NewCommPkgLayout(send_reg, recv_reg, MatrixDataSpace(matrix), n);
+    CacheCommPkgLayout(layout, grid, key, key_size,
+                       MatrixDataSpace(matrix), n);
 
     FreeRegion(send_reg);
     FreeRegion(recv_reg);
   }
 
+  tfree(key);
+
+  /* Submatrices may be allocated separately */
+  double **data_array = talloc(double *, GridNumSubgrids(grid));
+
+  ForSubgridI(i, GridSubgrids(grid))
+  {
+    data_array[i] = SubmatrixData(MatrixSubmatrix(matrix, i));
+  }
+
+  new_commpkg = NewCommPkgFromLayout(layout, data_array);
+  FreeCommPkgLayout(layout);
+
+  tfree(data_array);
+
   return new_commpkg;
 }
 
@@ -281,7 +327,7 @@ Matrix          *NewMatrixType(
         {
           if (shape[n][0] == -shape[k][0] &&
               shape[n][1] == -shape[k][1] &&
-              shape[n][0] == -shape[k][0])
+              shape[n][2] == -shape[k][2])
           {
             symmetric_coeff[k] = n;
           }
@@ -608,7 +654,10 @@ Matrix          *NewMatrixType(
 #endif
     case matrix_non_samrai:
       if (ghost)
+      {
         MatrixCommPkg(new_matrix) = NewMatrixUpdatePkg(new_matrix, ghost);
+        SetCommPkgName(MatrixCommPkg(new_matrix), "MatrixUpdate");
+      }
 
       break;
     default:
@@ -150,6 +150,11 @@ typedef struct {
 #define SubmatrixElt(submatrix, s, x, y, z) \
   (SubmatrixStencilData(submatrix, s) + SubmatrixEltIndex(submatrix, x, y, z))
 
+/* Stored coefficient s of the data stencil; for symmetric matrices only
+ * the center and upper triangle coefficients are stored */
+#define SubmatrixDataStencilData(submatrix, s) \
+  (((submatrix)->data) + (s) * (SubmatrixSize(submatrix)))
+
 #define SubmatrixSize(submatrix) SubmatrixNX((submatrix)) * SubmatrixNY((submatrix)) * \
   SubmatrixNZ((submatrix))
 
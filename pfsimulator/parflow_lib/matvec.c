@@ -33,6 +33,91 @@
 
 #include "parflow.h"
 
+/*--------------------------------------------------------------------------
+ * Fused, tiled stencil application
+ *
+ * Applies every stencil coefficient to a tile of y in one pass instead of
+ * streaming y once per coefficient.  The sum for each cell is accumulated
+ * in stencil order so results match the per-coefficient loops exactly.
+ * Tiles span the full x extent and MATVEC_TILE_NY x MATVEC_TILE_NZ
+ * lines so the neighbouring x planes stay in cache across k.
+ *
+ * The accelerator backends keep the per-coefficient BoxLoops.
+ *--------------------------------------------------------------------------*/
+
+#if !defined(PARFLOW_HAVE_CUDA) && !defined(PARFLOW_HAVE_KOKKOS)
+#define MATVEC_FUSED 1
+#endif
+
+#ifdef MATVEC_FUSED
+
+#ifndef MATVEC_TILE_NY
+#define MATVEC_TILE_NY 16
+#endif
+
+#ifndef MATVEC_TILE_NZ
+#define MATVEC_TILE_NZ 8
+#endif
+
+/* Largest stencil handled by the fused kernels (27 point) */
+#define MATVEC_MAX_STENCIL_SIZE 27
+
+#ifdef PARFLOW_HAVE_OMP
+#define PRAGMA_OMP_PARALLEL_FOR_COLLAPSE2 _Pragma("omp parallel for collapse(2)")
+#else
+#define PRAGMA_OMP_PARALLEL_FOR_COLLAPSE2
+#endif
+
+/*
+ * Defines a fused kernel; num_coeffs is a compile time constant for the
+ * 7 and 19 point specializations so the stencil loop is fully unrolled.
+ */
+#define MatvecFusedKernel(name, num_coeffs)                                             \
+  static void name(int stencil_size,                                                    \
+                   double **ap, double **xp, double *yp, double alpha,                  \
+                   int nx, int ny, int nz, int sx, int sy, int sz,                      \
+                   int nx_v, int ny_v, int nx_m, int ny_m)                              \
+  {                                                                                     \
+    int jj, kk;                                                                         \
+                                                                                        \
+    PF_UNUSED(stencil_size);                                                            \
+    PRAGMA_OMP_PARALLEL_FOR_COLLAPSE2                                                   \
+    for (kk = 0; kk < nz; kk += MATVEC_TILE_NZ)                                         \
+    {                                                                                   \
+      for (jj = 0; jj < ny; jj += MATVEC_TILE_NY)                                       \
+      {                                                                                 \
+        int k_end = pfmin(kk + MATVEC_TILE_NZ, nz);                                     \
+        int j_end = pfmin(jj + MATVEC_TILE_NY, ny);                                     \
+        int i, j, k, si;                                                                \
+                                                                                        \
+        for (k = kk; k < k_end; k++)                                                    \
+        {                                                                               \
+          for (j = jj; j < j_end; j++)                                                  \
+          {                                                                             \
+            int vi = (k * sz * ny_v + j * sy) * nx_v;                                   \
+            int mi = (k * ny_m + j) * nx_m;                                             \
+                                                                                        \
+            for (i = 0; i < nx; i++, vi += sx, mi++)                                    \
+            {                                                                           \
+              double sum = yp[vi];                                                      \
+              for (si = 0; si < (num_coeffs); si++)                                     \
+              {                                                                         \
+                sum += ap[si][mi] * xp[si][vi];                                         \
+              }                                                                         \
+              yp[vi] = (alpha != 1.0) ? sum * alpha : sum;                              \
+            }                                                                           \
+          }                                                                             \
+        }                                                                               \
+      }                                                                                 \
+    }                                                                                   \
+  }
+
+MatvecFusedKernel(MatvecFused7, 7)
+MatvecFusedKernel(MatvecFused19, 19)
+MatvecFusedKernel(MatvecFusedN, stencil_size)
+
+#endif
+
 /*--------------------------------------------------------------------------
  * Matvec
  *--------------------------------------------------------------------------*/
@@ -283,6 +368,43 @@ void            Matvec(
 
         yp = SubvectorElt(y_sub, ix, iy, iz);
 
+#ifdef MATVEC_FUSED
+        if (stencil_size <= MATVEC_MAX_STENCIL_SIZE)
+        {
+          double *ap_s[MATVEC_MAX_STENCIL_SIZE];
+          double *xp_s[MATVEC_MAX_STENCIL_SIZE];
+
+          for (si = 0; si < stencil_size; si++)
+          {
+            xp_s[si] = SubvectorElt(x_sub,
+                                    (ix + s[si][0]),
+                                    (iy + s[si][1]),
+                                    (iz + s[si][2]));
+            ap_s[si] = SubmatrixElt(A_sub, si, ix, iy, iz);
+          }
+
+          switch (stencil_size)
+          {
+            case 7:
+              MatvecFused7(stencil_size, ap_s, xp_s, yp, alpha,
+                           nx, ny, nz, sx, sy, sz, nx_v, ny_v, nx_m, ny_m);
+              break;
+
+            case 19:
+              MatvecFused19(stencil_size, ap_s, xp_s, yp, alpha,
+                            nx, ny, nz, sx, sy, sz, nx_v, ny_v, nx_m, ny_m);
+              break;
+
+            default:
+              MatvecFusedN(stencil_size, ap_s, xp_s, yp, alpha,
+                           nx, ny, nz, sx, sy, sz, nx_v, ny_v, nx_m, ny_m);
+              break;
+          }
+
+          continue;
+        }
+#endif
+
         for (si = 0; si < stencil_size; si++)
         {
           xp = SubvectorElt(x_sub,
@@ -355,6 +355,56 @@ void FinalizeMetadata(PFModule* solver, const char* prefix)
   DeleteMetadata();
 }
 
+#ifdef AMPS_PROFILE
+void WriteCommProfileMetadata(const char* prefix, const amps_ProfileStats* stats, int num_stats)
+{
+  cJSON* profile = cJSON_CreateObject();
+  cJSON* sites = cJSON_CreateArray();
+  int i;
+
+  cJSON_AddNumberToObject(profile, "processes", amps_Size(amps_CommWorld));
+  cJSON_AddItemToObject(profile, "sites", sites);
+  for (i = 0; i < num_stats; ++i)
+  {
+    cJSON* site = cJSON_CreateObject();
+    cJSON* wait = cJSON_CreateObject();
+    cJSON_AddStringToObject(site, "name", stats[i].name);
+    cJSON_AddNumberToObject(site, "processes", stats[i].ranks);
+    cJSON_AddNumberToObject(site, "calls", stats[i].calls);
+    cJSON_AddNumberToObject(site, "messages", stats[i].messages);
+    cJSON_AddNumberToObject(site, "bytes", stats[i].bytes);
+    cJSON_AddNumberToObject(wait, "total", stats[i].time);
+    cJSON_AddNumberToObject(wait, "min", stats[i].time_min);
+    cJSON_AddNumberToObject(wait, "max", stats[i].time_max);
+    cJSON_AddItemToObject(site, "wait_seconds", wait);
+    cJSON_AddItemToArray(sites, site);
+  }
+
+  // Written like the metadata file, through a dummy file moved into place.
+  // The dummy file is named after the run so that runs sharing a
+  // directory do not overwrite each other.
+  char fname[2048];
+  char tmpname[2048];
+  snprintf(fname, 2047, "%s.comm_profile.json", prefix);
+  snprintf(tmpname, 2047, "%s.comm_profile.json.tmp", prefix);
+
+  char* json = cJSON_Print(profile);
+  FILE* out = fopen(tmpname, "w");
+  if (out)
+  {
+    fprintf(out, "%s", json);
+    fclose(out);
+    rename(tmpname, fname);
+  }
+  else
+  {
+    amps_Printf("Warning: could not write communication profile <%s>\n", fname);
+  }
+  free(json);
+  cJSON_Delete(profile);
+}
+#endif
+
 int MetaDataHasField(cJSON* node, const char* fieldName)
 {
   return cJSON_GetObjectItem(node, fieldName) == NULL;
@@ -50,6 +50,9 @@ void NewMetadata(PFModule* solver);
 void MetadataAddParflowDomainInfo(MetadataItem pf, PFModule* solver, Grid* localGrid);
 void UpdateMetadata(PFModule* solver, const char* prefix, int ts);
 void FinalizeMetadata(PFModule* solver, const char* prefix);
+#ifdef AMPS_PROFILE
+void WriteCommProfileMetadata(const char* prefix, const amps_ProfileStats* stats, int num_stats);
+#endif
 
 int MetaDataHasField(MetadataItem node, const char* field_name);
 
@@ -142,8 +142,11 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   PFModule    *overlandflow_module_kin = (instance_xtra->overlandflow_module_kin);
 
 
-  /* Re-use saturation vector to save memory */
-  Vector      *rel_perm = saturation;
+  /* Saturation and rel_perm values are kept in the constitutive cache
+   * for reuse by the Jacobian; re-use saturation vector for the
+   * sources to save memory */
+  ConstitutiveCache *constitutive_cache;
+  Vector      *rel_perm;
   Vector      *source = saturation;
 
   /* Overland flow variables */  //sk
@@ -223,9 +226,6 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
 
   BeginTiming(public_xtra->time_index);
 
-  /* Initialize function values to zero. */
-  PFVConstInit(0.0, fval);
-
   /* diffusive test here, this is NOT PF style and should be
    * re-done putting keys in BC Pressure Package and adding to the
    * datastructure for overlandflowBC */
@@ -234,9 +234,17 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   int overlandspinup;              //@RMM
   overlandspinup = GetIntDefault("OverlandFlowSpinUp", 0);
 
-  /* Pass pressure values to neighbors.  */
+  constitutive_cache = GetConstitutiveCache(problem_data, grid);
+  saturation = constitutive_cache->saturation;
+  rel_perm = constitutive_cache->rel_perm;
+
+  /* Pass pressure values to neighbors.  The flux sweeps below need the
+   * ghost layer; only setup that does not use the pressure is done
+   * before the exchange is finished. */
   handle = InitVectorUpdate(pressure, VectorUpdateAll);
-  FinalizeVectorUpdate(handle);
+
+  /* Initialize function values to zero. */
+  PFVConstInit(0.0, fval);
 
   KW = NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
   KE = NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
@@ -245,6 +253,11 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   qx = NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
   qy = NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
 
+  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
+                                 (problem_data, grid, gr_domain, time));
+
+  FinalizeVectorUpdate(handle);
+
   /* Calculate pressure dependent properties: density and saturation */
 
   PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density, &dtmp, &dtmp,
@@ -465,9 +478,6 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     });
   }
 
-  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
-                                 (problem_data, grid, gr_domain, time));
-
   /*
    * Temporarily insert boundary pressure values for Dirichlet
    * boundaries into cells that are in the inactive region but next
@@ -533,15 +543,14 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
         );     /* End DirichletBC */
     }          /* End ipatch loop */
   }            /* End subgrid loop */
+  TouchVector(pressure);
 
-  /* Calculate relative permeability values overwriting current
-   * phase source values */
+  /* Calculate relative permeability values */
 
   PFModuleInvokeType(PhaseRelPermInvoke, rel_perm_module,
                      (rel_perm, pressure, density, gravity, problem_data,
                       CALCFCN));
 
-
   /* Calculate contributions from second order derivatives and gravity */
   ForSubgridI(is, GridSubgrids(grid))
   {
@@ -569,6 +578,11 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     /* @RMM added to provide access to zmult */
     z_mult_sub = VectorSubvector(z_mult, is);
 
+    /* @RMM added to provide access FB values */
+    FBx_sub = VectorSubvector(FBx, is);
+    FBy_sub = VectorSubvector(FBy, is);
+    FBz_sub = VectorSubvector(FBz, is);
+
     /* RDF: assumes resolutions are the same in all 3 directions */
     r = SubgridRX(subgrid);
 
@@ -614,6 +628,11 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     /* @RMM added to provide variable dz */
     z_mult_dat = SubvectorData(z_mult_sub);
 
+    /* @RMM added to provide FB values */
+    FBx_dat = SubvectorData(FBx_sub);
+    FBy_dat = SubvectorData(FBy_sub);
+    FBz_dat = SubvectorData(FBz_sub);
+
     qx_sub = VectorSubvector(qx, is);
 
     GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
@@ -2186,6 +2205,14 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
         );
     }          /* End ipatch loop */
   }            /* End subgrid loop */
+  TouchVector(pressure);
+
+  /*
+   * The cached values are recorded for the pressure as it is left here.
+   * They were computed with the Dirichlet values inserted above, which
+   * every evaluation inserts again before using the rel perm.
+   */
+  ConstitutiveCacheSetValues(constitutive_cache, pressure, density, time);
 
   FreeBCStruct(bc_struct);
 
@@ -88,6 +88,14 @@ void FreeComputePkgs(Grid *grid);
 /* communication.c */
 int NewCommPkgInfo(Subregion *data_sr, Subregion *comm_sr, int index, int num_vars, int *loop_array);
 CommPkg *NewCommPkg(Region *send_region, Region *recv_region, SubregionArray *data_space, int num_vars, double *data);
+CommPkgLayout *NewCommPkgLayout(Region *send_region, Region *recv_region, SubregionArray *data_space, int num_vars);
+void FreeCommPkgLayout(CommPkgLayout *layout);
+CommPkgLayout *FindCommPkgLayout(const void *owner, const int *key, int key_size, SubregionArray *data_space, int num_vars);
+void CacheCommPkgLayout(CommPkgLayout *layout, const void *owner, const int *key, int key_size, SubregionArray *data_space, int num_vars);
+void ForgetCommPkgLayouts(const void *owner);
+CommPkg *NewCommPkgFromLayout(CommPkgLayout *layout, double **data_array);
+CommPkg *NewCommPkgMultiple(Region *send_region, Region *recv_region, SubregionArray *data_space, int num_vars, double **data_array);
+void SetCommPkgName(CommPkg *comm_pkg, const char *name);
 void FreeCommPkg(CommPkg *pkg);
 // SGS what's up with this?
 CommHandle *InitCommunication(CommPkg *comm_pkg);
@@ -249,6 +257,7 @@ Subgrid *ExtractSubgrid(int rx, int ry, int rz, Subgrid *subgrid);
 Subgrid *IntersectSubgrids(Subgrid *subgrid1, Subgrid *subgrid2);
 SubgridArray *SubtractSubgrids(Subgrid *subgrid1, Subgrid *subgrid2);
 SubgridArray *UnionSubgridArray(SubgridArray *subgrids);
+int MaxProcessSubgrids(SubgridArray *all_subgrids);
 
 /* hbt.c */
 HBT *HBT_new(
@@ -596,10 +605,16 @@ Problem *NewProblem(int solver);
 void FreeProblem(Problem *problem, int solver);
 ProblemData *NewProblemData(Grid *grid, Grid *grid2d);
 void FreeProblemData(ProblemData *problem_data);
+ConstitutiveCache *NewConstitutiveCache(Grid *grid);
+void FreeConstitutiveCache(ConstitutiveCache *cache);
+ConstitutiveCache *GetConstitutiveCache(ProblemData *problem_data, Grid *grid);
 
 /* problem_bc.c */
 BCStruct *NewBCStruct(SubgridArray *subgrids, GrGeomSolid *gr_domain, int num_patches, int *patch_indexes, int *bc_types, double ***values);
 void FreeBCStruct(BCStruct *bc_struct);
+BCPatchCache *NewBCPatchCache(Grid *grid, GrGeomSolid *gr_domain, int num_patches, int *patch_indexes, int *bc_types);
+void FreeBCPatchCacheValues(BCPatchCache *cache, int ipatch);
+void FreeBCPatchCache(BCPatchCache *cache);
 
 
 typedef void (*BCInternalInvoke) (Problem *problem, ProblemData *problem_data, Matrix *A, Vector *f, double time);
@@ -1049,7 +1064,7 @@ void RedBlackGSPointFreePublicXtra(void);
 int RedBlackGSPointSizeOfTempData(void);
 
 /* read_parflow_binary.c */
-void ReadPFBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid);
+int ReadPFBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid);
 void ReadPFBinary(char *filename, Vector *v);
 
 /* reg_from_stenc.c */
@@ -1211,6 +1226,7 @@ int RegisterTiming(char *name);
 void PrintTiming(void);
 void FreeTiming(void);
 #endif
+void PrintCommProfile(void);
 
 typedef void (*TotalVelocityFaceInvoke) (Vector *xvel, Vector *yvel, Vector *zvel, ProblemData *problem_data, Vector *total_mobility_x, Vector *total_mobility_y, Vector *total_mobility_z, Vector *pressure, Vector **saturations);
 typedef PFModule *(*TotalVelocityFaceInitInstanceXtraInvoke) (Problem *problem, Grid *grid, Grid *x_grid, Grid *y_grid, Grid *z_grid, double *temp_data);
@@ -1268,6 +1284,7 @@ void InitVector(Vector *v, double value);
 void InitVectorAll(Vector *v, double value);
 void InitVectorInc(Vector *v, double value, double inc);
 void InitVectorRandom(Vector *v, long seed);
+void TouchVector(Vector *vector);
 
 /* vector_utilities.c */
 void PFVLinearSum(double a, Vector *x, double b, Vector *y, Vector *z);
@@ -1404,4 +1421,7 @@ void OverlandSum(ProblemData *problem_data,
                  double       dt,
                  Vector *     overland_sum);
 
+/* water_balance.c */
+void ComputeWaterBalance(ProblemData *problem_data, Vector *pressure, Vector *saturation, Vector *evap_trans, Vector *runoff, double dt, double *balance);
+
 Grid      *ReadProcessGrid();
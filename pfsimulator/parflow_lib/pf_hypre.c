@@ -522,4 +522,183 @@ void HypreAssembleMatrixAsElements(
   HYPRE_StructMatrixAssemble(*hypre_mat);
 }
 
+void HypreAssembleMatrixAsBoxes(
+                                Matrix *     pf_Bmat,
+                                Matrix *     pf_Cmat,
+                                HYPRE_StructMatrix* hypre_mat,
+                                ProblemData *problem_data
+                                )
+{
+  Grid *mat_grid = MatrixGrid(pf_Bmat);
+  double *wp = NULL, *ep = NULL, *sop = NULL, *np = NULL;
+  double *cp_c, *wp_c = NULL, *ep_c = NULL, *sop_c = NULL, *np_c = NULL, *top_dat;
+  int sg;
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_m, ny_m, nz_m, sy_v;
+  int i, j, k, itop, k1, ktop;
+  int im, io;
+  int ilo[3];
+  int ihi[3];
+
+  int stencil;
+  int stencil_indices[5];
+  int index[3];
+
+  double coeffs[5];
+  int num_coeffs;
+
+  int stencil_size = MatrixDataStencilSize(pf_Bmat);
+  int symmetric = MatrixSymmetric(pf_Bmat);
+
+  int outside = 0;
+  int boxnum = -1;
+  int action = 0;                  // set values
+
+  hypre_Box *set_box;
+  hypre_Box *value_box;
+
+  Vector* top = ProblemDataIndexOfDomainTop(problem_data);
+
+  ForSubgridI(sg, GridSubgrids(mat_grid))
+  {
+    Subgrid* subgrid = GridSubgrid(mat_grid, sg);
+
+    Submatrix* pfB_sub = MatrixSubmatrix(pf_Bmat, sg);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_m = SubmatrixNX(pfB_sub);
+    ny_m = SubmatrixNY(pfB_sub);
+    nz_m = SubmatrixNZ(pfB_sub);
+
+    if (!(nx && ny && nz))
+      continue;
+
+    ilo[0] = SubmatrixIX(pfB_sub);
+    ilo[1] = SubmatrixIY(pfB_sub);
+    ilo[2] = SubmatrixIZ(pfB_sub);
+    ihi[0] = ilo[0] + nx_m - 1;
+    ihi[1] = ilo[1] + ny_m - 1;
+    ihi[2] = ilo[2] + nz_m - 1;
+
+    value_box = hypre_BoxCreate(PARFLOW_HYPRE_DIM);
+    hypre_BoxSetExtents(value_box, ilo, ihi);
+
+    ilo[0] = ix;
+    ilo[1] = iy;
+    ilo[2] = iz;
+    ihi[0] = ilo[0] + nx - 1;
+    ihi[1] = ilo[1] + ny - 1;
+    ihi[2] = ilo[2] + nz - 1;
+
+    set_box = hypre_BoxCreate(PARFLOW_HYPRE_DIM);
+    hypre_BoxSetExtents(set_box, ilo, ihi);
+
+    /*
+     * The Hypre stencil was built from the data stencil so stored
+     * coefficient planes map one to one onto Hypre stencil entries.
+     * Hypre wants the stencil values contiguous, PF stores each
+     * coefficient as a separate plane, so insert a plane at a time.
+     */
+    for (stencil = 0; stencil < stencil_size; ++stencil)
+    {
+      hypre_StructMatrixSetBoxValues(*hypre_mat,
+                                     set_box,
+                                     value_box,
+                                     1,
+                                     &stencil,
+                                     SubmatrixDataStencilData(pfB_sub, stencil),
+                                     action,
+                                     boxnum,
+                                     outside);
+    }
+
+    hypre_BoxDestroy(set_box);
+    hypre_BoxDestroy(value_box);
+
+    if (pf_Cmat == NULL)  /* No overland flow */
+      continue;
+
+    /*
+     * Overland flow is activated.  Replace the coefficients of the
+     * surface cells by the C matrix ones, as done element by element
+     * in HypreAssembleMatrixAsElements.
+     */
+    Submatrix* pfC_sub = MatrixSubmatrix(pf_Cmat, sg);
+    Subvector* top_sub = VectorSubvector(top, sg);
+
+    if (!symmetric)
+    {
+      wp = SubmatrixStencilData(pfB_sub, 1);
+      ep = SubmatrixStencilData(pfB_sub, 2);
+      sop = SubmatrixStencilData(pfB_sub, 3);
+      np = SubmatrixStencilData(pfB_sub, 4);
+
+      wp_c = SubmatrixStencilData(pfC_sub, 1);
+      ep_c = SubmatrixStencilData(pfC_sub, 2);
+      sop_c = SubmatrixStencilData(pfC_sub, 3);
+      np_c = SubmatrixStencilData(pfC_sub, 4);
+    }
+    cp_c = SubmatrixStencilData(pfC_sub, 0);
+    top_dat = SubvectorData(top_sub);
+
+    sy_v = SubvectorNX(top_sub);
+
+    BoxLoopI0(i, j, k, ix, iy, 0, nx, ny, 1,
+    {
+      itop = SubvectorEltIndex(top_sub, i, j, 0);
+      ktop = (int)top_dat[itop];
+
+      if (ktop >= iz && ktop < iz + nz)
+      {
+        im = SubmatrixEltIndex(pfB_sub, i, j, ktop);
+        io = SubmatrixEltIndex(pfC_sub, i, j, iz);
+
+        /* update diagonal coeff */
+        stencil_indices[0] = 0;
+        coeffs[0] = cp_c[io];               //cp[im] is zero
+        num_coeffs = 1;
+
+        if (!symmetric)
+        {
+          /* update west coeff */
+          k1 = (int)top_dat[itop - 1];
+          stencil_indices[num_coeffs] = 1;
+          coeffs[num_coeffs++] = (k1 == ktop) ? wp_c[io] : wp[im];
+          /* update east coeff */
+          k1 = (int)top_dat[itop + 1];
+          stencil_indices[num_coeffs] = 2;
+          coeffs[num_coeffs++] = (k1 == ktop) ? ep_c[io] : ep[im];
+          /* update south coeff */
+          k1 = (int)top_dat[itop - sy_v];
+          stencil_indices[num_coeffs] = 3;
+          coeffs[num_coeffs++] = (k1 == ktop) ? sop_c[io] : sop[im];
+          /* update north coeff */
+          k1 = (int)top_dat[itop + sy_v];
+          stencil_indices[num_coeffs] = 4;
+          coeffs[num_coeffs++] = (k1 == ktop) ? np_c[io] : np[im];
+        }
+
+        index[0] = i;
+        index[1] = j;
+        index[2] = ktop;
+        HYPRE_StructMatrixSetValues(*hypre_mat,
+                                    index,
+                                    num_coeffs,
+                                    stencil_indices,
+                                    coeffs);
+      }
+    });
+  }   /* End subgrid loop */
+
+  HYPRE_StructMatrixAssemble(*hypre_mat);
+}
+
 #endif // HAVE_HYPRE
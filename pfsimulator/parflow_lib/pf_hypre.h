@@ -96,6 +96,9 @@ void HypreInitialize(Matrix* pf_matrix,
  * Most of the time the block insertion will be faster since it
  * operations on blocks of indices.
  *
+ * Selected with the MatrixAssembly key of the PFMG and SMG
+ * preconditioners.
+ *
  * @param pf_Bmat The B matrix
  * @param pf_Cmat The C matrix
  * @param hyre_mat The filled in Hypre matrix
@@ -108,6 +111,28 @@ void HypreAssembleMatrixAsElements(
 				   ProblemData *problem_data
 				   );
 
+/**
+ * Assemble the Hypre matrix from B and C ParFlow matrices using box
+ * insertion.
+ *
+ * Each stored coefficient plane of B is handed to Hypre for the whole
+ * subgrid in one call, so for symmetric matrices only the center and
+ * upper triangle planes are read.  The surface cells are then patched
+ * with the C matrix coefficients one column at a time.  Produces the
+ * same Hypre matrix as HypreAssembleMatrixAsElements.
+ *
+ * @param pf_Bmat The B matrix
+ * @param pf_Cmat The C matrix
+ * @param hyre_mat The filled in Hypre matrix
+ * @param problem_data ParFlow problem data
+ */
+void HypreAssembleMatrixAsBoxes(
+				Matrix *     pf_Bmat,
+				Matrix *     pf_Cmat,
+				HYPRE_StructMatrix* hypre_mat,
+				ProblemData *problem_data
+				);
+
 #endif
 
 #endif
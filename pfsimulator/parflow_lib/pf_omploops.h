@@ -309,6 +309,32 @@ extern "C++"{
 
 #define pfmax_atomic(a,b) (a) = (a) > (b) ? (a) : (b)
 
+/**************************************************************************
+ * OpenMP Subgrid Loop Variants
+ **************************************************************************/
+
+/**
+ * @brief Loop over the subgrids of a process with one OpenMP task per subgrid
+ *
+ * With several subgrids per process one thread creates a task for each
+ * subgrid and the threads of the team execute them; BoxLoops nested in a
+ * task then run serially.  With a single subgrid the parallel region is
+ * inactive so that nested BoxLoops keep their own parallel regions.  All
+ * tasks have completed when the statement following the macro is done.
+ *
+ * The tasks have no dependencies on each other, so the body may only
+ * touch the points of its own subgrid; loops that read ghost points
+ * filled from neighbouring subgrids (stencils) must not use this macro.
+ *
+ * @param i Subgrid index, firstprivate in each task
+ * @param subgrid_array Subgrids to loop over
+ **/
+#define ForSubgridTasks_omp(i, subgrid_array)                           \
+  PRAGMA(omp parallel if (SubgridArraySize(subgrid_array) > 1))         \
+  PRAGMA(omp single)                                                    \
+  ForSubgridI(i, subgrid_array)                                         \
+  PRAGMA(omp task firstprivate(i))
+
 /**************************************************************************
  * OpenMP BoxLoop Variants
  **************************************************************************/
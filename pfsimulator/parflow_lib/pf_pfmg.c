@@ -42,6 +42,7 @@ typedef struct {
   int num_post_relax;
   int smoother;
   int raptype;
+  int assembly;
 
   int time_index_pfmg;
   int time_index_copy_hypre;
@@ -195,10 +196,20 @@ PFModule  *PFMGInitInstanceXtra(
     /* Copy the matrix entries */
     BeginTiming(public_xtra->time_index_copy_hypre);
 
-    HypreAssembleMatrixAsElements(pf_Bmat,
-				  pf_Cmat,
-				  &(instance_xtra -> hypre_mat),
-				  problem_data);
+    if (public_xtra->assembly == 0)
+    {
+      HypreAssembleMatrixAsBoxes(pf_Bmat,
+				 pf_Cmat,
+				 &(instance_xtra -> hypre_mat),
+				 problem_data);
+    }
+    else
+    {
+      HypreAssembleMatrixAsElements(pf_Bmat,
+				    pf_Cmat,
+				    &(instance_xtra -> hypre_mat),
+				    problem_data);
+    }
     
     EndTiming(public_xtra->time_index_copy_hypre);
 
@@ -283,6 +294,8 @@ PFModule  *PFMGNewPublicXtra(char *name)
   char          *raptype_name;
   NameArray raptype_switch_na;
   int raptype;
+  char          *assembly_name;
+  NameArray assembly_switch_na;
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -328,6 +341,17 @@ PFModule  *PFMGNewPublicXtra(char *name)
   }
   NA_FreeNameArray(raptype_switch_na);
 
+  assembly_switch_na = NA_NewNameArray("Boxes Elements");
+  sprintf(key, "%s.MatrixAssembly", name);
+  assembly_name = GetStringDefault(key, "Boxes");
+  public_xtra->assembly = NA_NameToIndex(assembly_switch_na, assembly_name);
+  if (public_xtra->assembly < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>.\n",
+               assembly_name, key);
+  }
+  NA_FreeNameArray(assembly_switch_na);
+
   if (raptype == 0 && smoother > 1)
   {
     InputError("Error: Galerkin RAPType is not compatible with Smoother <%s>.\n",
@@ -35,17 +35,6 @@
 #ifdef HAVE_HYPRE
 #include "hypre_dependences.h"
 
-/*
- * Versions of Hypre > 2.10.x require dimension argument for
- * BoxCreate.  Previous versions don't require argument.
- */
-#if PARFLOW_HYPRE_VERSION_MAJOR > 2 || \
-  (PARFLOW_HYPRE_VERSION_MAJOR >= 2 && PARFLOW_HYPRE_VERSION_MINOR >= 10)
-#define PARFLOW_HYPRE_DIM 3
-#else
-#define PARFLOW_HYPRE_DIM
-#endif
-
 typedef struct {
   int max_iter;
   int num_pre_relax;
@@ -40,6 +40,7 @@ typedef struct {
   int max_iter;
   int num_pre_relax;
   int num_post_relax;
+  int assembly;
 
   int time_index_smg;
   int time_index_copy_hypre;
@@ -191,10 +192,20 @@ PFModule  *SMGInitInstanceXtra(
     /* Copy the matrix entries */
     BeginTiming(public_xtra->time_index_copy_hypre);
     
-    HypreAssembleMatrixAsElements(pf_Bmat,
-				  pf_Cmat,
-				  &(instance_xtra -> hypre_mat),
-				  problem_data);
+    if (public_xtra->assembly == 0)
+    {
+      HypreAssembleMatrixAsBoxes(pf_Bmat,
+				 pf_Cmat,
+				 &(instance_xtra -> hypre_mat),
+				 problem_data);
+    }
+    else
+    {
+      HypreAssembleMatrixAsElements(pf_Bmat,
+				    pf_Cmat,
+				    &(instance_xtra -> hypre_mat),
+				    problem_data);
+    }
 
     EndTiming(public_xtra->time_index_copy_hypre);
 
@@ -267,6 +278,8 @@ PFModule  *SMGNewPublicXtra(char *name)
   PublicXtra    *public_xtra;
 
   char key[IDB_MAX_KEY_LEN];
+  char          *assembly_name;
+  NameArray assembly_switch_na;
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -279,6 +292,17 @@ PFModule  *SMGNewPublicXtra(char *name)
   sprintf(key, "%s.NumPostRelax", name);
   public_xtra->num_post_relax = GetIntDefault(key, 0);
 
+  assembly_switch_na = NA_NewNameArray("Boxes Elements");
+  sprintf(key, "%s.MatrixAssembly", name);
+  assembly_name = GetStringDefault(key, "Boxes");
+  public_xtra->assembly = NA_NameToIndex(assembly_switch_na, assembly_name);
+  if (public_xtra->assembly < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>.\n",
+               assembly_name, key);
+  }
+  NA_FreeNameArray(assembly_switch_na);
+
   public_xtra->time_index_smg = RegisterTiming("SMG");
   public_xtra->time_index_copy_hypre = RegisterTiming("HYPRE_Copies");
 
@@ -495,6 +495,76 @@ void          FreeProblemData(
     FreeVector(ProblemDataRealSpaceZ(problem_data));
     FreeVector(ProblemDataIndexOfDomainTop(problem_data));
 
+    FreeConstitutiveCache(ProblemDataConstitutiveCache(problem_data));
+
     tfree(problem_data);
   }
 }
+
+
+/*--------------------------------------------------------------------------
+ * NewConstitutiveCache
+ *--------------------------------------------------------------------------*/
+
+ConstitutiveCache  *NewConstitutiveCache(
+                                         Grid *grid)
+{
+  ConstitutiveCache  *cache;
+
+  cache = ctalloc(ConstitutiveCache, 1);
+
+  cache->grid = grid;
+
+  cache->saturation = NewVectorType(grid, 1, 1, vector_cell_centered);
+  cache->rel_perm = NewVectorType(grid, 1, 1, vector_cell_centered);
+
+  cache->density_der = NewVectorType(grid, 1, 1, vector_cell_centered);
+  cache->saturation_der = NewVectorType(grid, 1, 1, vector_cell_centered);
+  cache->rel_perm_der = NewVectorType(grid, 1, 1, vector_cell_centered);
+
+  return cache;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeConstitutiveCache
+ *--------------------------------------------------------------------------*/
+
+void                FreeConstitutiveCache(
+                                          ConstitutiveCache *cache)
+{
+  if (cache)
+  {
+    FreeVector(cache->saturation);
+    FreeVector(cache->rel_perm);
+
+    FreeVector(cache->density_der);
+    FreeVector(cache->saturation_der);
+    FreeVector(cache->rel_perm_der);
+
+    tfree(cache);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * GetConstitutiveCache
+ *   Returns the constitutive cache of problem_data, (re)allocating it
+ *   on first use or when the computational grid has changed.
+ *--------------------------------------------------------------------------*/
+
+ConstitutiveCache  *GetConstitutiveCache(
+                                         ProblemData *problem_data,
+                                         Grid *       grid)
+{
+  ConstitutiveCache  *cache = ProblemDataConstitutiveCache(problem_data);
+
+  if (cache == NULL || cache->grid != grid)
+  {
+    FreeConstitutiveCache(cache);
+    cache = NewConstitutiveCache(grid);
+    ProblemDataConstitutiveCache(problem_data) = cache;
+  }
+
+  return cache;
+}
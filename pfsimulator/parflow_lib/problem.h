@@ -113,6 +113,31 @@ typedef struct {
   PFModule  *real_space_z;
 } Problem;
 
+/*
+ * Pressure dependent properties shared between the nonlinear function
+ * and Jacobian evaluations.  Entries are keyed on the epoch of the
+ * pressure vector they were computed from, the evaluation time and
+ * the density vector used; an epoch of 0 marks an empty entry.  Code
+ * that writes to the pressure data directly must call TouchVector so
+ * that stale entries are not used.
+ */
+typedef struct {
+  Grid           *grid;
+
+  long value_epoch;
+  double value_time;
+  Vector         *value_density;
+  Vector         *saturation;
+  Vector         *rel_perm;
+
+  long derivative_epoch;
+  double derivative_time;
+  Vector         *derivative_density;
+  Vector         *density_der;
+  Vector         *saturation_der;
+  Vector         *rel_perm_der;
+} ConstitutiveCache;
+
 typedef struct {
   /* geometry information */
   int num_solids;
@@ -158,6 +183,8 @@ typedef struct {
   /* @RMM variable dz  */
   Vector *dz_mult;
   Vector *rsz;
+
+  ConstitutiveCache *constitutive_cache;
 } ProblemData;
 
 /* Values of solver argument to NewProblem function */
@@ -274,6 +301,37 @@ typedef struct {
 #define ProblemDataSSlopeY(problem_data)        ((problem_data)->y_sslope)   //RMM
 #define ProblemDataZmult(problem_data)          ((problem_data)->dz_mult)    //RMM
 #define ProblemDataRealSpaceZ(problem_data)     ((problem_data)->rsz)
+#define ProblemDataConstitutiveCache(problem_data) ((problem_data)->constitutive_cache)
+
+/*--------------------------------------------------------------------------
+ * Accessor macros: ConstitutiveCache
+ *--------------------------------------------------------------------------*/
+
+#define ConstitutiveCacheValuesValid(cache, pressure, density, time) \
+  ((cache)->value_epoch != 0 &&                                      \
+   (cache)->value_epoch == VectorEpoch(pressure) &&                  \
+   (cache)->value_time == (time) &&                                  \
+   (cache)->value_density == (density))
+
+#define ConstitutiveCacheDerivativesValid(cache, pressure, density, time) \
+  ((cache)->derivative_epoch != 0 &&                                      \
+   (cache)->derivative_epoch == VectorEpoch(pressure) &&                  \
+   (cache)->derivative_time == (time) &&                                  \
+   (cache)->derivative_density == (density))
+
+#define ConstitutiveCacheSetValues(cache, pressure, density, time) \
+  {                                                                \
+    (cache)->value_epoch = VectorEpoch(pressure);                  \
+    (cache)->value_time = (time);                                  \
+    (cache)->value_density = (density);                            \
+  }
+
+#define ConstitutiveCacheSetDerivatives(cache, pressure, density, time) \
+  {                                                                     \
+    (cache)->derivative_epoch = VectorEpoch(pressure);                  \
+    (cache)->derivative_time = (time);                                  \
+    (cache)->derivative_density = (density);                            \
+  }
 /*--------------------------------------------------------------------------
  * Misc macros
  *   RDF not quite right, maybe?
@@ -61,6 +61,7 @@ BCStruct *NewBCStruct(
   (new_bcstruct->patch_indexes) = patch_indexes;
   (new_bcstruct->bc_types) = bc_types;
   (new_bcstruct->values) = values;
+  (new_bcstruct->cache) = NULL;
 
   return new_bcstruct;
 }
@@ -76,8 +77,9 @@ void      FreeBCStruct(BCStruct *bc_struct)
   int ipatch, is;
 
 
+  /* Values attached from a BCPatchCache are owned by the cache */
   values = BCStructValues(bc_struct);
-  if (values)
+  if (values && !BCStructCache(bc_struct))
   {
     for (ipatch = 0; ipatch < BCStructNumPatches(bc_struct); ipatch++)
     {
@@ -92,3 +94,209 @@ void      FreeBCStruct(BCStruct *bc_struct)
 
   tfree(bc_struct);
 }
+
+/*--------------------------------------------------------------------------
+ * NewBCPatchCells:
+ *   Records the cells visited by the patch loop for patch ipatch on
+ *   subgrid is in structure-of-arrays form.  The ghost variant follows
+ *   ForPatchCellsPerFaceWithGhost bounds.
+ *--------------------------------------------------------------------------*/
+
+static BCPatchCells *NewBCPatchCells(
+                                     BCStruct *bc_struct,
+                                     int       ipatch,
+                                     int       is,
+                                     int       ghost)
+{
+  BCPatchCells   *cells;
+  int i, j, k, ival, num_cells;
+
+  num_cells = 0;
+  if (ghost)
+  {
+    BCStructPatchLoopOvrlndNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is,
+                                          NoLocals, DoNothing,
+                                          DoNothing, DoNothing,
+                                          DoNothing, DoNothing,
+                                          DoNothing, DoNothing,
+                                          { num_cells++; });
+  }
+  else
+  {
+    BCStructPatchLoopNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is,
+                                    NoLocals, DoNothing,
+                                    DoNothing, DoNothing,
+                                    DoNothing, DoNothing,
+                                    DoNothing, DoNothing,
+                                    { num_cells++; });
+  }
+
+  cells = ctalloc(BCPatchCells, 1);
+  BCPatchCellsNumCells(cells) = num_cells;
+  if (num_cells > 0)
+  {
+    cells->i = ctalloc(int, num_cells);
+    cells->j = ctalloc(int, num_cells);
+    cells->k = ctalloc(int, num_cells);
+    cells->fdir = ctalloc(int, num_cells);
+  }
+
+#define RecordBCPatchCell(fdir_)                  \
+  {                                               \
+    BCPatchCellsI(cells, ival) = i;               \
+    BCPatchCellsJ(cells, ival) = j;               \
+    BCPatchCellsK(cells, ival) = k;               \
+    BCPatchCellsFdir(cells, ival) = fdir_;        \
+  }
+
+  if (ghost)
+  {
+    BCStructPatchLoopOvrlndNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is,
+                                          NoLocals, DoNothing,
+                                          FACE(LeftFace, RecordBCPatchCell(LeftFace)),
+                                          FACE(RightFace, RecordBCPatchCell(RightFace)),
+                                          FACE(DownFace, RecordBCPatchCell(DownFace)),
+                                          FACE(UpFace, RecordBCPatchCell(UpFace)),
+                                          FACE(BackFace, RecordBCPatchCell(BackFace)),
+                                          FACE(FrontFace, RecordBCPatchCell(FrontFace)),
+                                          DoNothing);
+  }
+  else
+  {
+    BCStructPatchLoopNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is,
+                                    NoLocals, DoNothing,
+                                    FACE(LeftFace, RecordBCPatchCell(LeftFace)),
+                                    FACE(RightFace, RecordBCPatchCell(RightFace)),
+                                    FACE(DownFace, RecordBCPatchCell(DownFace)),
+                                    FACE(UpFace, RecordBCPatchCell(UpFace)),
+                                    FACE(BackFace, RecordBCPatchCell(BackFace)),
+                                    FACE(FrontFace, RecordBCPatchCell(FrontFace)),
+                                    DoNothing);
+  }
+
+#undef RecordBCPatchCell
+
+  return cells;
+}
+
+/*--------------------------------------------------------------------------
+ * FreeBCPatchCells
+ *--------------------------------------------------------------------------*/
+
+static void FreeBCPatchCells(BCPatchCells *cells)
+{
+  if (cells)
+  {
+    tfree(cells->i);
+    tfree(cells->j);
+    tfree(cells->k);
+    tfree(cells->fdir);
+    tfree(cells);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * NewBCPatchCache:
+ *   Builds the patch cell lists for every patch and subgrid of grid.
+ *   The values component is left empty for the owning module to fill.
+ *--------------------------------------------------------------------------*/
+
+BCPatchCache *NewBCPatchCache(
+                              Grid *        grid,
+                              GrGeomSolid * gr_domain,
+                              int           num_patches,
+                              int *         patch_indexes,
+                              int *         bc_types)
+{
+  BCPatchCache   *cache;
+  BCStruct       *bc_struct;
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  int num_subgrids = SubgridArraySize(subgrids);
+  int ipatch, is;
+
+
+  cache = ctalloc(BCPatchCache, 1);
+
+  BCPatchCacheGrid(cache) = grid;
+  BCPatchCacheGrDomain(cache) = gr_domain;
+  BCPatchCacheNumPatches(cache) = num_patches;
+  BCPatchCacheNumSubgrids(cache) = num_subgrids;
+
+  /* Uncached BCStruct used to walk the patches */
+  bc_struct = NewBCStruct(subgrids, gr_domain, num_patches,
+                          patch_indexes, bc_types, NULL);
+
+  cache->cells = ctalloc(BCPatchCells * *, num_patches);
+  cache->ghost_cells = ctalloc(BCPatchCells * *, num_patches);
+  cache->values = ctalloc(double **, num_patches);
+  cache->interval_numbers = ctalloc(int, num_patches);
+
+  for (ipatch = 0; ipatch < num_patches; ipatch++)
+  {
+    cache->cells[ipatch] = ctalloc(BCPatchCells *, num_subgrids);
+    cache->ghost_cells[ipatch] = ctalloc(BCPatchCells *, num_subgrids);
+    cache->values[ipatch] = ctalloc(double *, num_subgrids);
+    BCPatchCacheIntervalNumber(cache, ipatch) = -1;
+
+    ForSubgridI(is, subgrids)
+    {
+      BCPatchCacheCells(cache, ipatch, is) =
+        NewBCPatchCells(bc_struct, ipatch, is, FALSE);
+      BCPatchCacheGhostCells(cache, ipatch, is) =
+        NewBCPatchCells(bc_struct, ipatch, is, TRUE);
+    }
+  }
+
+  FreeBCStruct(bc_struct);
+
+  return cache;
+}
+
+/*--------------------------------------------------------------------------
+ * FreeBCPatchCacheValues:
+ *   Frees the cached values of patch ipatch and marks them invalid.
+ *--------------------------------------------------------------------------*/
+
+void FreeBCPatchCacheValues(BCPatchCache *cache, int ipatch)
+{
+  int is;
+
+
+  for (is = 0; is < BCPatchCacheNumSubgrids(cache); is++)
+  {
+    tfree(cache->values[ipatch][is]);
+    cache->values[ipatch][is] = NULL;
+  }
+  BCPatchCacheIntervalNumber(cache, ipatch) = -1;
+}
+
+/*--------------------------------------------------------------------------
+ * FreeBCPatchCache
+ *--------------------------------------------------------------------------*/
+
+void FreeBCPatchCache(BCPatchCache *cache)
+{
+  int ipatch, is;
+
+
+  if (cache)
+  {
+    for (ipatch = 0; ipatch < BCPatchCacheNumPatches(cache); ipatch++)
+    {
+      FreeBCPatchCacheValues(cache, ipatch);
+      for (is = 0; is < BCPatchCacheNumSubgrids(cache); is++)
+      {
+        FreeBCPatchCells(BCPatchCacheCells(cache, ipatch, is));
+        FreeBCPatchCells(BCPatchCacheGhostCells(cache, ipatch, is));
+      }
+      tfree(cache->cells[ipatch]);
+      tfree(cache->ghost_cells[ipatch]);
+      tfree(cache->values[ipatch]);
+    }
+    tfree(cache->cells);
+    tfree(cache->ghost_cells);
+    tfree(cache->values);
+    tfree(cache->interval_numbers);
+    tfree(cache);
+  }
+}
@@ -50,6 +50,49 @@
 #define OverlandDiffusiveBC 5
 /** @} */
 
+/*----------------------------------------------------------------
+ * BCPatchCells structure
+ *----------------------------------------------------------------*/
+
+/**
+ * @brief Precomputed cell list of one boundary patch on one subgrid
+ *
+ * Structure-of-arrays form of the cells visited by a patch loop, stored
+ * in patch loop order so that entry n corresponds to patch value ival == n.
+ */
+typedef struct {
+  int num_cells;    /**< Number of boundary cell faces on the patch */
+  int             *i;         /**< num_cells X indexes */
+  int             *j;         /**< num_cells Y indexes */
+  int             *k;         /**< num_cells Z indexes */
+  int             *fdir;      /**< num_cells face directions (LeftFace, ...) */
+} BCPatchCells;
+
+/*----------------------------------------------------------------
+ * BCPatchCache structure
+ *----------------------------------------------------------------*/
+
+/**
+ * @brief Per-grid cache of boundary patch cell lists and patch values
+ *
+ * The cell lists only depend on the grid and domain so they are built
+ * once.  The values are owned by the module filling them (e.g. BCPressure)
+ * and are only recomputed when a patch changes time cycle interval.
+ */
+typedef struct {
+  Grid            *grid;        /**< Grid the cache was built for */
+  GrGeomSolid     *gr_domain;   /**< Domain the cache was built for */
+
+  int num_patches; /**< Number of patches */
+  int num_subgrids; /**< Number of subgrids */
+
+  BCPatchCells  ***cells;       /**< num_patches x num_subgrids cell lists */
+  BCPatchCells  ***ghost_cells; /**< num_patches x num_subgrids cell lists including ghost layer */
+
+  double        ***values;           /**< num_patches x num_subgrids cached values */
+  int             *interval_numbers; /**< num_patches interval the values are valid for (-1 is invalid) */
+} BCPatchCache;
+
 /*----------------------------------------------------------------
  * BCStruct structure
  *----------------------------------------------------------------*/
@@ -64,6 +107,8 @@ typedef struct {
   int             *bc_types;       /**< num_patches BC types */
 
   double        ***values;   /**< num_patches x num_subgrids data arrays */
+
+  BCPatchCache    *cache;    /**< Optional cell list cache, not owned; values belong to the cache when set */
 } BCStruct;
 
 
@@ -87,6 +132,36 @@ typedef struct {
 #define BCStructPatchIndex(bc_struct, p)      ((bc_struct)->patch_indexes[p])
 #define BCStructBCType(bc_struct, p)          ((bc_struct)->bc_types[p])
 #define BCStructPatchValues(bc_struct, p, s)  ((bc_struct)->values[p][s])
+#define BCStructCache(bc_struct)              ((bc_struct)->cache)
+#define BCStructPatchCells(bc_struct, p, s) \
+  ((bc_struct)->cache ? (bc_struct)->cache->cells[p][s] : NULL)
+#define BCStructPatchGhostCells(bc_struct, p, s) \
+  ((bc_struct)->cache ? (bc_struct)->cache->ghost_cells[p][s] : NULL)
+/** @} */
+
+/**
+ * @name BCPatchCells Accessors
+ * @{
+ */
+#define BCPatchCellsNumCells(cells)       ((cells)->num_cells)
+#define BCPatchCellsI(cells, n)           ((cells)->i[n])
+#define BCPatchCellsJ(cells, n)           ((cells)->j[n])
+#define BCPatchCellsK(cells, n)           ((cells)->k[n])
+#define BCPatchCellsFdir(cells, n)        ((cells)->fdir[n])
+/** @} */
+
+/**
+ * @name BCPatchCache Accessors
+ * @{
+ */
+#define BCPatchCacheGrid(cache)                ((cache)->grid)
+#define BCPatchCacheGrDomain(cache)            ((cache)->gr_domain)
+#define BCPatchCacheNumPatches(cache)          ((cache)->num_patches)
+#define BCPatchCacheNumSubgrids(cache)         ((cache)->num_subgrids)
+#define BCPatchCacheCells(cache, p, s)         ((cache)->cells[p][s])
+#define BCPatchCacheGhostCells(cache, p, s)    ((cache)->ghost_cells[p][s])
+#define BCPatchCacheValues(cache)              ((cache)->values)
+#define BCPatchCacheIntervalNumber(cache, p)   ((cache)->interval_numbers[p])
 /** @} */
 
 /**
@@ -153,7 +228,7 @@ typedef struct {
  *
  * @note Do not call directly! Not intended for use code.
  */
-#define BCStructPatchLoopNoFdir(i, j, k, ival, bc_struct, ipatch, is,       \
+#define BCStructPatchLoopNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is, \
                                 locals, setup,                              \
                                 f_left, f_right,                            \
                                 f_down, f_up,                               \
@@ -186,7 +261,7 @@ typedef struct {
     });                                                                     \
   }
 
-#define BCStructPatchLoopOvrlndNoFdir(i, j, k, ival, bc_struct, ipatch, is, \
+#define BCStructPatchLoopOvrlndNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is, \
                                       locals, setup,                        \
                                       f_left, f_right,                      \
                                       f_down, f_up,                         \
@@ -219,6 +294,119 @@ typedef struct {
     });                                                                     \
   }
 
+/**
+ * @brief Iterates over a precomputed BCPatchCells list, used in ForPatchCells loops.
+ *
+ * Cells are visited in the order they were recorded so ival matches the
+ * patch value index of the uncached loop.
+ *
+ * @note Do not call directly! Not intended for use code.
+ */
+#define BCPatchCellsLoopNoFdir(i, j, k, ival, cells,                        \
+                               locals, setup,                               \
+                               f_left, f_right,                             \
+                               f_down, f_up,                                \
+                               f_back, f_front,                             \
+                               finalize)                                    \
+  {                                                                         \
+    int PV_num_cells = BCPatchCellsNumCells(cells);                         \
+    int *PV_ci = (cells)->i;                                                \
+    int *PV_cj = (cells)->j;                                                \
+    int *PV_ck = (cells)->k;                                                \
+    int *PV_cf = (cells)->fdir;                                             \
+    UNPACK(locals);                                                         \
+                                                                            \
+    for (ival = 0; ival < PV_num_cells; ival++)                             \
+    {                                                                       \
+      i = PV_ci[ival];                                                      \
+      j = PV_cj[ival];                                                      \
+      k = PV_ck[ival];                                                      \
+      setup;                                                                \
+      switch (PV_cf[ival])                                                  \
+      {                                                                     \
+        f_left;                                                             \
+        f_right;                                                            \
+        f_down;                                                             \
+        f_up;                                                               \
+        f_back;                                                             \
+        f_front;                                                            \
+      }                                                                     \
+      finalize;                                                             \
+    }                                                                       \
+  }
+
+#if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS) || defined(PARFLOW_HAVE_OMP)
+
+/* Accelerator backends parallelize the box loops directly; the cell cache is not used */
+#define BCStructPatchLoopNoFdir BCStructPatchLoopNoFdirUncached
+#define BCStructPatchLoopOvrlndNoFdir BCStructPatchLoopOvrlndNoFdirUncached
+
+#else
+
+/**
+ * @brief Patch loop dispatching to the cached cell list when the BCStruct has one.
+ *
+ * @note Do not call directly! Not intended for use code.
+ */
+#define BCStructPatchLoopNoFdir(i, j, k, ival, bc_struct, ipatch, is,       \
+                                locals, setup,                              \
+                                f_left, f_right,                            \
+                                f_down, f_up,                               \
+                                f_back, f_front,                            \
+                                finalize)                                   \
+  {                                                                         \
+    BCPatchCells *PV_cells = BCStructPatchCells(bc_struct, ipatch, is);     \
+    if (PV_cells)                                                           \
+    {                                                                       \
+      BCPatchCellsLoopNoFdir(i, j, k, ival, PV_cells,                       \
+                             locals, setup,                                 \
+                             f_left, f_right,                               \
+                             f_down, f_up,                                  \
+                             f_back, f_front,                               \
+                             finalize);                                     \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+      BCStructPatchLoopNoFdirUncached(i, j, k, ival, bc_struct, ipatch, is, \
+                                      locals, setup,                        \
+                                      f_left, f_right,                      \
+                                      f_down, f_up,                         \
+                                      f_back, f_front,                      \
+                                      finalize);                            \
+    }                                                                       \
+  }
+
+#define BCStructPatchLoopOvrlndNoFdir(i, j, k, ival, bc_struct, ipatch, is, \
+                                      locals, setup,                        \
+                                      f_left, f_right,                      \
+                                      f_down, f_up,                         \
+                                      f_back, f_front,                      \
+                                      finalize)                             \
+  {                                                                         \
+    BCPatchCells *PV_cells = BCStructPatchGhostCells(bc_struct, ipatch, is); \
+    if (PV_cells)                                                           \
+    {                                                                       \
+      BCPatchCellsLoopNoFdir(i, j, k, ival, PV_cells,                       \
+                             locals, setup,                                 \
+                             f_left, f_right,                               \
+                             f_down, f_up,                                  \
+                             f_back, f_front,                               \
+                             finalize);                                     \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+      BCStructPatchLoopOvrlndNoFdirUncached(i, j, k, ival, bc_struct,       \
+                                            ipatch, is,                     \
+                                            locals, setup,                  \
+                                            f_left, f_right,                \
+                                            f_down, f_up,                   \
+                                            f_back, f_front,                \
+                                            finalize);                      \
+    }                                                                       \
+  }
+
+#endif
+
 /*--------------------------------------------------------------------------
  * ForPatch loops and macros
  *--------------------------------------------------------------------------*/
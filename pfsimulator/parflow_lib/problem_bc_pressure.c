@@ -49,6 +49,8 @@ typedef struct {
   double     ***elevations;
   ProblemData  *problem_data;
   Grid         *grid;
+
+  BCPatchCache *bc_patch_cache;
 } InstanceXtra;
 
 /*--------------------------------------------------------------------------
@@ -92,6 +94,7 @@ BCStruct    *BCPressure(
   double      *rsz_dat;
 
   BCStruct       *bc_struct;
+  BCPatchCache   *bc_patch_cache;
   double       ***values;
 
   double         *patch_values;
@@ -121,23 +124,54 @@ BCStruct    *BCPressure(
                             BCPressureDataBCTypes(bc_pressure_data),
                             NULL);
 
+    /*---------------------------------------------------------------------
+     * Attach the patch cell cache; cell lists are only built once per grid
+     *---------------------------------------------------------------------*/
+
+    bc_patch_cache = (instance_xtra->bc_patch_cache);
+    if (bc_patch_cache
+        && ((BCPatchCacheGrid(bc_patch_cache) != grid)
+            || (BCPatchCacheGrDomain(bc_patch_cache) != gr_domain)
+            || (BCPatchCacheNumPatches(bc_patch_cache) != num_patches)))
+    {
+      FreeBCPatchCache(bc_patch_cache);
+      bc_patch_cache = NULL;
+    }
+
+    if (bc_patch_cache == NULL)
+    {
+      bc_patch_cache = NewBCPatchCache(grid, gr_domain, num_patches,
+                                       BCPressureDataPatchIndexes(bc_pressure_data),
+                                       BCPressureDataBCTypes(bc_pressure_data));
+      (instance_xtra->bc_patch_cache) = bc_patch_cache;
+    }
+
+    BCStructCache(bc_struct) = bc_patch_cache;
+
     /*---------------------------------------------------------------------
      * Set up values component of bc_struct
      *---------------------------------------------------------------------*/
 
-    values = talloc(double **, num_patches);
-    memset(values, 0, num_patches * sizeof(double **));
+    values = BCPatchCacheValues(bc_patch_cache);
     BCStructValues(bc_struct) = values;
 
     for (ipatch = 0; ipatch < num_patches; ipatch++)
     {
-      values[ipatch] = talloc(double *, SubgridArraySize(subgrids));
-      memset(values[ipatch], 0, SubgridArraySize(subgrids) * sizeof(double *));
-
       cycle_number = BCPressureDataCycleNumber(bc_pressure_data, ipatch);
       interval_number = TimeCycleDataComputeIntervalNumber(
                                                            problem, time, time_cycle_data, cycle_number);
 
+      /* Patch values only change on a time cycle transition, except
+       * for exact solutions which may depend on time directly */
+      if ((BCPatchCacheIntervalNumber(bc_patch_cache, ipatch) == interval_number)
+          && (BCPressureDataType(bc_pressure_data, ipatch) != ExactSolution))
+      {
+        continue;
+      }
+
+      FreeBCPatchCacheValues(bc_patch_cache, ipatch);
+      BCPatchCacheIntervalNumber(bc_patch_cache, ipatch) = interval_number;
+
       switch (BCPressureDataType(bc_pressure_data, ipatch))
       {
         case DirEquilRefPatch:
@@ -1217,6 +1251,7 @@ void BCPressureFreeInstanceXtra()
 
       tfree(instance_xtra->elevations);
     }
+    FreeBCPatchCache(instance_xtra->bc_patch_cache);
     PFModuleFreeInstance(instance_xtra->phase_density);
     tfree(instance_xtra);
   }
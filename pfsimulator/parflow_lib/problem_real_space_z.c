@@ -98,12 +98,12 @@ void realSpaceZ(ProblemData *problem_data, Vector *rsz)
     if (GlobalsR > 0)
     {
       amps_Invoice invoice = amps_NewInvoice("%d", &z);
-      int srcRank = pqr_to_process(GlobalsP,
-                                   GlobalsQ,
-                                   GlobalsR - 1,
-                                   GlobalsNumProcsX,
-                                   GlobalsNumProcsY,
-                                   GlobalsNumProcsZ);
+      int srcRank = pqr_to_rank(GlobalsP,
+                                GlobalsQ,
+                                GlobalsR - 1,
+                                GlobalsNumProcsX,
+                                GlobalsNumProcsY,
+                                GlobalsNumProcsZ);
 
       amps_Recv(amps_CommWorld, srcRank, invoice);
       amps_FreeInvoice(invoice);
@@ -164,12 +164,12 @@ breakout:;
     {
       amps_Invoice invoice = amps_NewInvoice("%d", &z);
 
-      int dstRank = pqr_to_process(GlobalsP,
-                                   GlobalsQ,
-                                   GlobalsR + 1,
-                                   GlobalsNumProcsX,
-                                   GlobalsNumProcsY,
-                                   GlobalsNumProcsZ);
+      int dstRank = pqr_to_rank(GlobalsP,
+                                GlobalsQ,
+                                GlobalsR + 1,
+                                GlobalsNumProcsX,
+                                GlobalsNumProcsY,
+                                GlobalsNumProcsZ);
 
       amps_Send(amps_CommWorld, dstRank, invoice);
       amps_FreeInvoice(invoice);
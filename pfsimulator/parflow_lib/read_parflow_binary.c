@@ -35,10 +35,17 @@
 #include <string.h>
 #include <math.h>
 
-void ReadPFBinary_Subvector(
-                            amps_File  file,
-                            Subvector *subvector,
-                            Subgrid *  subgrid)
+/*--------------------------------------------------------------------------
+ * ReadPFBinary_Subvector:
+ *   Reads the next subgrid record of file into subvector.  Returns 0, or
+ *   -1 if the record does not lie in subgrid, i.e. the file was
+ *   distributed for another process grid.
+ *--------------------------------------------------------------------------*/
+
+int ReadPFBinary_Subvector(
+                           amps_File  file,
+                           Subvector *subvector,
+                           Subgrid *  subgrid)
 {
   int ix, iy, iz;
   int nx, ny, nz;
@@ -51,8 +58,6 @@ void ReadPFBinary_Subvector(
   int i, j, k, ai;
   double         *data;
 
-  (void)subgrid;
-
   amps_ReadInt(file, &ix, 1);
   amps_ReadInt(file, &iy, 1);
   amps_ReadInt(file, &iz, 1);
@@ -65,6 +70,16 @@ void ReadPFBinary_Subvector(
   amps_ReadInt(file, &ry, 1);
   amps_ReadInt(file, &rz, 1);
 
+  if (nx > 0 && ny > 0 && nz > 0 &&
+      ((ix < SubgridIX(subgrid)) || (iy < SubgridIY(subgrid)) ||
+       (iz < SubgridIZ(subgrid)) ||
+       ((ix + nx) > (SubgridIX(subgrid) + SubgridNX(subgrid))) ||
+       ((iy + ny) > (SubgridIY(subgrid) + SubgridNY(subgrid))) ||
+       ((iz + nz) > (SubgridIZ(subgrid) + SubgridNZ(subgrid)))))
+  {
+    return -1;
+  }
+
   data = SubvectorElt(subvector, ix, iy, iz);
 
   ai = 0;
@@ -74,6 +89,8 @@ void ReadPFBinary_Subvector(
   {
     amps_ReadDouble(file, &data[ai], 1);
   });
+
+  return 0;
 }
 
 
@@ -134,7 +151,13 @@ void ReadPFBinary(
   {
     subgrid = SubgridArraySubgrid(subgrids, g);
     subvector = VectorSubvector(v, g);
-    ReadPFBinary_Subvector(file, subvector, subgrid);
+    if (ReadPFBinary_Subvector(file, subvector, subgrid))
+    {
+      amps_Printf("Error: %s was distributed for a different process grid;\n"
+                  "       redistribute it with pfdist and the same Process.Topology keys\n",
+                  filename);
+      exit(1);
+    }
   }
 
   amps_FFclose(file);
@@ -247,6 +247,8 @@ void  CommRegFromStencil(
   int           *proc_array = NULL;
   int num_procs;
 
+  int multiple_subgrids;
+
   int r, p, i, j, k;
 
 
@@ -256,6 +258,13 @@ void  CommRegFromStencil(
 
   neighbors = GetGridNeighbors(subgrids, GridAllSubgrids(grid), stencil);
 
+  /*
+   * When processes own several subgrids the regions are kept per pair of
+   * subgrids, since a union by process would merge data for different
+   * subgrids differently on the sending and receiving side.
+   */
+  multiple_subgrids = (MaxProcessSubgrids(GridAllSubgrids(grid)) > 1);
+
   /*------------------------------------------------------
    * Determine subgrid_region and neighbor_region
    *------------------------------------------------------*/
@@ -342,6 +351,12 @@ void  CommRegFromStencil(
       {
         sa2 = RegionSubregionArray(region0, j);
 
+        sa1 = RegionSubregionArray(region1, (r == 0) ? i : j);
+        if (multiple_subgrids)
+        {
+          sa1 = NewSubgridArray();
+        }
+
         ForSubgridI(k, sa2)
         {
           subgrid1 = SubgridArraySubgrid(sa2, k);
@@ -352,17 +367,34 @@ void  CommRegFromStencil(
             {
               case 0:
                 SubgridProcess(subgrid2) = SubgridProcess(subgrid1);
-                AppendSubgrid(subgrid2,
-                              RegionSubregionArray(region1, i));
                 break;
 
               case 1:
                 SubgridProcess(subgrid2) = SubgridProcess(subgrid0);
-                AppendSubgrid(subgrid2,
-                              RegionSubregionArray(region1, j));
                 break;
             }
+            AppendSubgrid(subgrid2, sa1);
+          }
+        }
+
+        /* union the regions of this pair of subgrids */
+        if (multiple_subgrids)
+        {
+          if (SubgridArraySize(sa1))
+          {
+            p = SubgridProcess(SubgridArraySubgrid(sa1, 0));
+
+            sa3 = UnionSubgridArray(sa1);
+            ForSubgridI(k, sa3)
+            SubgridProcess(SubgridArraySubgrid(sa3, k)) = p;
+            AppendSubgridArray(sa3,
+                               RegionSubregionArray(region1, (r == 0) ? i : j));
+
+            SubregionArraySize(sa3) = 0;
+            FreeSubgridArray(sa3);
           }
+
+          FreeSubgridArray(sa1);
         }
       }
     }
@@ -386,88 +418,91 @@ void  CommRegFromStencil(
    * Union the send_region and recv_region by process
    *------------------------------------------------------*/
 
-  proc_array = talloc(int, SubgridArraySize(neighbors));
-
-  for (r = 0; r < 2; r++)
+  if (!multiple_subgrids)
   {
-    switch (r)
-    {
-      case 0:
-        region0 = send_region;
-        break;
-
-      case 1:
-        region0 = recv_region;
-        break;
-    }
+    proc_array = talloc(int, SubgridArraySize(neighbors));
 
-    region1 = NewRegion(RegionSize(region0));
-
-    ForSubregionArrayI(i, region0)
+    for (r = 0; r < 2; r++)
     {
-      sa0 = RegionSubregionArray(region0, i);
-      sa1 = RegionSubregionArray(region1, i);
-
-      /* determine proc_array and num_procs */
-
-      num_procs = 0;
-      ForSubgridI(j, sa0)
+      switch (r)
       {
-        subgrid0 = SubgridArraySubgrid(sa0, j);
+        case 0:
+          region0 = send_region;
+          break;
 
-        for (p = 0; p < num_procs; p++)
-          if (SubgridProcess(subgrid0) == proc_array[p])
-            break;
-        if (p == num_procs)
-        {
-          proc_array[p] = SubgridProcess(subgrid0);
-          num_procs++;
-        }
+        case 1:
+          region0 = recv_region;
+          break;
       }
 
-      /* union by process */
+      region1 = NewRegion(RegionSize(region0));
 
-      for (p = 0; p < num_procs; p++)
+      ForSubregionArrayI(i, region0)
       {
-        /* put subgrids on proc_array[p] into sa2 */
+        sa0 = RegionSubregionArray(region0, i);
+        sa1 = RegionSubregionArray(region1, i);
 
-        sa2 = NewSubgridArray();
+        /* determine proc_array and num_procs */
 
+        num_procs = 0;
         ForSubgridI(j, sa0)
         {
           subgrid0 = SubgridArraySubgrid(sa0, j);
 
-          if (SubgridProcess(subgrid0) == proc_array[p])
-            AppendSubgrid(subgrid0, sa2);
+          for (p = 0; p < num_procs; p++)
+            if (SubgridProcess(subgrid0) == proc_array[p])
+              break;
+          if (p == num_procs)
+          {
+            proc_array[p] = SubgridProcess(subgrid0);
+            num_procs++;
+          }
         }
 
-        sa3 = UnionSubgridArray(sa2);
-        ForSubgridI(j, sa3)
-        SubgridProcess(SubgridArraySubgrid(sa3, j)) = proc_array[p];
-        AppendSubgridArray(sa3, sa1);
+        /* union by process */
 
-        SubregionArraySize(sa2) = 0;
-        FreeSubgridArray(sa2);
-        SubregionArraySize(sa3) = 0;
-        FreeSubgridArray(sa3);
+        for (p = 0; p < num_procs; p++)
+        {
+          /* put subgrids on proc_array[p] into sa2 */
+
+          sa2 = NewSubgridArray();
+
+          ForSubgridI(j, sa0)
+          {
+            subgrid0 = SubgridArraySubgrid(sa0, j);
+
+            if (SubgridProcess(subgrid0) == proc_array[p])
+              AppendSubgrid(subgrid0, sa2);
+          }
+
+          sa3 = UnionSubgridArray(sa2);
+          ForSubgridI(j, sa3)
+          SubgridProcess(SubgridArraySubgrid(sa3, j)) = proc_array[p];
+          AppendSubgridArray(sa3, sa1);
+
+          SubregionArraySize(sa2) = 0;
+          FreeSubgridArray(sa2);
+          SubregionArraySize(sa3) = 0;
+          FreeSubgridArray(sa3);
+        }
       }
-    }
 
-    FreeRegion(region0);
+      FreeRegion(region0);
 
-    switch (r)
-    {
-      case 0:
-        send_region = region1;
-        break;
+      switch (r)
+      {
+        case 0:
+          send_region = region1;
+          break;
 
-      case 1:
-        recv_region = region1;
-        break;
+        case 1:
+          recv_region = region1;
+          break;
+      }
     }
-  }
 
-  tfree(proc_array);
+    tfree(proc_array);
+  }
 
   /*------------------------------------------------------
    * Return
@@ -220,12 +220,13 @@ void    RichardsJacobianEval(
   Matrix      *J = (instance_xtra->J);
   Matrix      *JC = (instance_xtra->JC);
 
+  /* Pressure dependent properties, shared with NlFunctionEval */
+  ConstitutiveCache *constitutive_cache = NULL;
   Vector      *density_der = NULL;
   Vector      *saturation_der = NULL;
-
-  /* Re-use vectors to save memory */
   Vector      *rel_perm = NULL;
   Vector      *rel_perm_der = NULL;
+  int values_valid, derivatives_valid;
 
   Vector      *porosity = ProblemDataPorosity(problem_data);
   Vector      *permeability_x = ProblemDataPermeabilityX(problem_data);
@@ -336,21 +337,29 @@ void    RichardsJacobianEval(
     }
   }
 
-  /*-----------------------------------------------------------------------
-   * Allocate temp vectors
-   *-----------------------------------------------------------------------*/
-  density_der = NewVectorType(grid, 1, 1, vector_cell_centered);
-  saturation_der = NewVectorType(grid, 1, 1, vector_cell_centered);
+  /* Pass pressure values to neighbors.  The flux sweeps below need the
+   * ghost layer; only setup that does not use the pressure is done
+   * before the exchange is finished. */
+  vector_update_handle = InitVectorUpdate(pressure, VectorUpdateAll);
 
   /*-----------------------------------------------------------------------
-   * reuse the temp vectors for both saturation and rel_perm calculations.
+   * Density, saturation and rel_perm values computed by the function
+   * evaluation at this pressure, and derivatives computed by an earlier
+   * Jacobian evaluation at this pressure, are reused from the cache.
    *-----------------------------------------------------------------------*/
-  rel_perm = saturation;
-  rel_perm_der = saturation_der;
+  constitutive_cache = GetConstitutiveCache(problem_data, grid);
 
-  /* Pass pressure values to neighbors.  */
-  vector_update_handle = InitVectorUpdate(pressure, VectorUpdateAll);
-  FinalizeVectorUpdate(vector_update_handle);
+  values_valid = ConstitutiveCacheValuesValid(constitutive_cache, pressure,
+                                              density, time);
+  derivatives_valid = ConstitutiveCacheDerivativesValid(constitutive_cache,
+                                                        pressure, density,
+                                                        time);
+
+  saturation = constitutive_cache->saturation;
+  rel_perm = constitutive_cache->rel_perm;
+  density_der = constitutive_cache->density_der;
+  saturation_der = constitutive_cache->saturation_der;
+  rel_perm_der = constitutive_cache->rel_perm_der;
 
 /* Define grid for surface contribution */
   KW = NewVectorType(grid2d, 1, 1, vector_cell_centered);
@@ -380,18 +389,29 @@ void    RichardsJacobianEval(
   InitMatrix(J, 0.0);
   InitMatrix(JC, 0.0);
 
+  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
+                                 (problem_data, grid, gr_domain, time));
+
+  FinalizeVectorUpdate(vector_update_handle);
+
   /* Calculate time term contributions. */
 
-  PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density, &dtmp, &dtmp,
-                                                          CALCFCN));
-  PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density_der, &dtmp,
-                                                          &dtmp, CALCDER));
-  PFModuleInvokeType(SaturationInvoke, saturation_module, (saturation, pressure,
-                                                           density, gravity, problem_data,
-                                                           CALCFCN));
-  PFModuleInvokeType(SaturationInvoke, saturation_module, (saturation_der, pressure,
-                                                           density, gravity, problem_data,
-                                                           CALCDER));
+  if (!values_valid)
+  {
+    PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density, &dtmp, &dtmp,
+                                                            CALCFCN));
+    PFModuleInvokeType(SaturationInvoke, saturation_module, (saturation, pressure,
+                                                             density, gravity, problem_data,
+                                                             CALCFCN));
+  }
+  if (!derivatives_valid)
+  {
+    PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density_der, &dtmp,
+                                                            &dtmp, CALCDER));
+    PFModuleInvokeType(SaturationInvoke, saturation_module, (saturation_der, pressure,
+                                                             density, gravity, problem_data,
+                                                             CALCDER));
+  }
 
   ForSubgridI(is, GridSubgrids(grid))
   {
@@ -458,9 +478,6 @@ void    RichardsJacobianEval(
     });
   }    /* End subgrid loop */
 
-  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
-                                 (problem_data, grid, gr_domain, time));
-
   /* Get boundary pressure values for Dirichlet boundaries.   */
   /* These are needed for upstream weighting in mobilities - need boundary */
   /* values for rel perms and densities. */
@@ -503,16 +520,26 @@ void    RichardsJacobianEval(
         ); /* End DirichletBC Case */
     }          /* End ipatch loop */
   }            /* End subgrid loop */
+  TouchVector(pressure);
 
   /* Calculate rel_perm and rel_perm_der */
 
-  PFModuleInvokeType(PhaseRelPermInvoke, rel_perm_module,
-                     (rel_perm, pressure, density, gravity, problem_data,
-                      CALCFCN));
+  if (!values_valid)
+  {
+    PFModuleInvokeType(PhaseRelPermInvoke, rel_perm_module,
+                       (rel_perm, pressure, density, gravity, problem_data,
+                        CALCFCN));
+  }
+
+  if (!derivatives_valid)
+  {
+    PFModuleInvokeType(PhaseRelPermInvoke, rel_perm_module,
+                       (rel_perm_der, pressure, density, gravity, problem_data,
+                        CALCDER));
+  }
 
-  PFModuleInvokeType(PhaseRelPermInvoke, rel_perm_module,
-                     (rel_perm_der, pressure, density, gravity, problem_data,
-                      CALCDER));
+  ConstitutiveCacheSetValues(constitutive_cache, pressure, density, time);
+  ConstitutiveCacheSetDerivatives(constitutive_cache, pressure, density, time);
 
   /* Calculate contributions from second order derivatives and gravity */
   ForSubgridI(is, GridSubgrids(grid))
@@ -1939,8 +1966,6 @@ void    RichardsJacobianEval(
 
   FreeBCStruct(bc_struct);
 
-  FreeVector(density_der);
-  FreeVector(saturation_der);
   FreeVector(KW);
   FreeVector(KE);
   FreeVector(KN);
@@ -2175,6 +2200,7 @@ PFModule   *RichardsJacobianEvalNewPublicXtra(char *name)
   }
   NA_FreeNameArray(switch_na);
 
+
   PFModulePublicXtra(this_module) = public_xtra;
   return this_module;
 }
@@ -89,6 +89,7 @@ typedef struct {
   int print_evaptrans_sum;      /* print evaptrans_sum? */
   int print_overland_sum;       /* print overland_sum? */
   int print_overland_bc_flux;   /* print overland outflow boundary condition flux? */
+  int print_water_balance;      /* write water balance time series? */
   int write_silo_subsurf_data;  /* write permeability/porosity? */
   int write_silo_press;         /* write pressures? */
   int write_silo_velocities;    /* write velocities? */
@@ -237,6 +238,14 @@ typedef struct {
   Vector *evap_trans_sum;       /* running sum of evaporation and transpiration */
   Vector *overland_sum;
   Vector *ovrl_bc_flx;          /* vector containing outflow at the boundary */
+
+  Vector *water_balance_runoff; /* surface runoff of the last time step */
+  FILE *water_balance_file;     /* water balance time series, rank 0 only */
+  double water_balance[4];      /* terms being reduced, see ComputeWaterBalance */
+  double water_balance_time;    /* time and step of the terms being reduced */
+  int water_balance_step;
+  int water_balance_pending;    /* is a reduction of the terms in progress? */
+  amps_Handle water_balance_handle;
   Vector *dz_mult;              /* vector containing dz multplier values for all cells */
   Vector *x_velocity;           /* vector containing x-velocity face values */
   Vector *y_velocity;           /* vector containing y-velocity face values */
@@ -335,6 +344,56 @@ static const CLMForcingField clmForcingFields[] = {
 };
 int numForcingFields = sizeof(clmForcingFields) / sizeof(clmForcingFields[0]);
 
+/*--------------------------------------------------------------------------
+ * Water balance time series
+ *
+ * The terms of a time step are reduced with a non-blocking allreduce that
+ * is completed when the terms of the next step are ready, so the reduction
+ * overlaps with the solve and costs no extra synchronization.
+ *--------------------------------------------------------------------------*/
+
+static void
+FinishWaterBalance(InstanceXtra *instance_xtra)
+{
+  if (instance_xtra->water_balance_pending)
+  {
+    amps_Wait(instance_xtra->water_balance_handle);
+    instance_xtra->water_balance_pending = 0;
+
+    if (instance_xtra->water_balance_file)
+    {
+      fprintf(instance_xtra->water_balance_file, "%d,%.16e,%.16e,%.16e,%.16e,%.16e\n",
+              instance_xtra->water_balance_step,
+              instance_xtra->water_balance_time,
+              instance_xtra->water_balance[0],
+              instance_xtra->water_balance[1],
+              instance_xtra->water_balance[2],
+              instance_xtra->water_balance[3]);
+    }
+  }
+}
+
+static void
+StartWaterBalance(InstanceXtra *instance_xtra,
+                  Vector *      evap_trans,
+                  double        dt,
+                  double        t)
+{
+  FinishWaterBalance(instance_xtra);
+
+  ComputeWaterBalance(instance_xtra->problem_data,
+                      instance_xtra->pressure, instance_xtra->saturation,
+                      evap_trans, instance_xtra->water_balance_runoff,
+                      dt, instance_xtra->water_balance);
+
+  instance_xtra->water_balance_time = t;
+  instance_xtra->water_balance_step = instance_xtra->iteration_number;
+  instance_xtra->water_balance_handle =
+    amps_IAllReduceDouble(amps_CommWorld, instance_xtra->water_balance, 4,
+                          amps_Add);
+  instance_xtra->water_balance_pending = 1;
+}
+
 void
 SetupRichards(PFModule * this_module)
 {
@@ -800,6 +859,27 @@ SetupRichards(PFModule * this_module)
       NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
     InitVectorAll(instance_xtra->ovrl_bc_flx, 0.0);
 
+    if (public_xtra->print_water_balance)
+    {
+      instance_xtra->water_balance_runoff =
+        NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
+      InitVectorAll(instance_xtra->water_balance_runoff, 0.0);
+
+      if (!amps_Rank(amps_CommWorld))
+      {
+        char filename[2048];
+        sprintf(filename, "%s.water_balance.csv", GlobalsOutFileName);
+
+        if ((instance_xtra->water_balance_file = fopen(filename, "w")) == NULL)
+        {
+          InputError("Error: can't open output file %s%s\n", filename, "");
+        }
+
+        fprintf(instance_xtra->water_balance_file,
+                "Step,Time,Subsurface Storage,Surface Storage,Surface Runoff,Evaporation Transpiration\n");
+      }
+    }
+
     if (public_xtra->write_silo_overland_sum
         || public_xtra->print_overland_sum
         || public_xtra->write_silopmpio_overland_sum
@@ -1154,6 +1234,7 @@ SetupRichards(PFModule * this_module)
                        ic_phase_pressure,
                        (instance_xtra->pressure, instance_xtra->mask,
                         problem_data, problem));
+    TouchVector(instance_xtra->pressure);
 
     handle = InitVectorUpdate(instance_xtra->pressure, VectorUpdateAll);
     FinalizeVectorUpdate(handle);
@@ -1176,6 +1257,12 @@ SetupRichards(PFModule * this_module)
     handle = InitVectorUpdate(instance_xtra->pressure, VectorUpdateAll);
     FinalizeVectorUpdate(handle);
 
+    /* Initial storage, the fluxes are zero */
+    if (public_xtra->print_water_balance)
+    {
+      StartWaterBalance(instance_xtra, NULL, 0.0, t);
+    }
+
 
     /*****************************************************************/
     /*          Print out any of the requested initial data          */
@@ -2862,6 +2949,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         }
                      );
       }
+
+      TouchVector(instance_xtra->pressure);
     }
 
     /* velocity updates - not sure these are necessary jjb */
@@ -2909,6 +2998,14 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                   dt, instance_xtra->overland_sum);
     }
 
+    /***************************************************************
+     * Start the reduction of the water balance of this step
+     **************************************************************/
+    if (public_xtra->print_water_balance)
+    {
+      StartWaterBalance(instance_xtra, evap_trans, dt, t);
+    }
+
     /***************************************************************/
     /*                 Print the pressure and saturation           */
     /***************************************************************/
@@ -3898,6 +3995,16 @@ TeardownRichards(PFModule * this_module)
 
   FinalizeMetadata(this_module, GlobalsOutFileName);
 
+  FinishWaterBalance(instance_xtra);
+  if (instance_xtra->water_balance_file)
+  {
+    fclose(instance_xtra->water_balance_file);
+  }
+  if (instance_xtra->water_balance_runoff)
+  {
+    FreeVector(instance_xtra->water_balance_runoff);
+  }
+
   FreeVector(instance_xtra->saturation);
   FreeVector(instance_xtra->density);
   FreeVector(instance_xtra->old_saturation);
@@ -5238,6 +5345,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_overland_bc_flux = switch_value;
 
+  sprintf(key, "%s.PrintWaterBalance", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_water_balance = switch_value;
+
   sprintf(key, "%s.PrintWells", name);
   switch_name = GetStringDefault(key, "True");
   switch_value = NA_NameToIndex(switch_na, switch_name);
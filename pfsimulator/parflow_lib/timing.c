@@ -34,6 +34,7 @@
 #include <string.h>
 #include "parflow.h"
 #include "timing.h"
+#include "metadata.h"
 
 
 #ifdef PF_TIMING
@@ -237,3 +238,45 @@ void  FreeTiming()
 
 
 #endif
+
+
+/*--------------------------------------------------------------------------
+ * PrintCommProfile
+ *   Collects the amps communication profile of all processes and writes
+ *   it to the log and to <outfile>.comm_profile.json.  The counters are
+ *   kept whether or not timing is compiled in.
+ *--------------------------------------------------------------------------*/
+
+void  PrintCommProfile()
+{
+#ifdef AMPS_PROFILE
+  amps_ProfileStats *stats;
+  FILE *file;
+  int num_stats;
+  int i;
+
+  num_stats = amps_ProfileGather(amps_CommWorld, &stats);
+
+  IfLogging(0)
+  {
+    file = OpenLogFile("Communication");
+
+    for (i = 0; i < num_stats; i++)
+    {
+      fprintf(file, "%s:\n", stats[i].name);
+      fprintf(file, "  processes = %d\n", stats[i].ranks);
+      fprintf(file, "  calls     = %.0f\n", stats[i].calls);
+      fprintf(file, "  messages  = %.0f\n", stats[i].messages);
+      fprintf(file, "  bytes     = %.0f\n", stats[i].bytes);
+      fprintf(file, "  wait time = %f seconds (process min %f, max %f)\n",
+              stats[i].time, stats[i].time_min, stats[i].time_max);
+    }
+
+    CloseLogFile(file);
+
+    WriteCommProfileMetadata(GlobalsOutFileName, stats, num_stats);
+  }
+
+  free(stats);
+#endif
+}
@@ -49,30 +49,59 @@ static int samrai_vector_ids[5][2048];
 #include <stdlib.h>
 #include <string.h>
 
+/* Profiling names of the update modes, see communication.h */
+static const char *vector_update_names[NumUpdateModes] = {
+  "VectorUpdateAll",
+  "VectorUpdateAll2",
+  "VectorUpdateRPoint",
+  "VectorUpdateBPoint",
+  "VectorUpdateGodunov",
+  "VectorUpdateVelZ",
+  "VectorUpdatePGS1",
+  "VectorUpdatePGS2",
+  "VectorUpdatePGS3",
+  "VectorUpdatePGS4",
+};
+
 /*--------------------------------------------------------------------------
  * NewVectorCommPkg:
+ *   The layout of the package depends only on `compute_pkg' and the data
+ *   space of `vector', so it is shared by all vectors on the same grid.
  *--------------------------------------------------------------------------*/
 
 CommPkg  *NewVectorCommPkg(
                            Vector *    vector,
                            ComputePkg *compute_pkg)
 {
-  CommPkg     *new_commpkg = NULL;
-
+  CommPkg       *new_commpkg;
+  CommPkgLayout *layout;
 
   Grid *grid = VectorGrid(vector);
+  SubregionArray *data_space = VectorDataSpace(vector);
+
+  /* Subvectors may be allocated separately */
+  double **data_array = talloc(double *, GridNumSubgrids(grid));
+  int i;
 
-  if (GridNumSubgrids(grid) > 1)
+  ForSubgridI(i, GridSubgrids(grid))
   {
-    PARFLOW_ERROR("NewVectorCommPkg can't be used with number subgrids > 1");
+    data_array[i] = SubvectorData(VectorSubvector(vector, i));
   }
-  else
+
+  layout = FindCommPkgLayout(compute_pkg, NULL, 0, data_space, 1);
+  if (!layout)
   {
-    new_commpkg = NewCommPkg(ComputePkgSendRegion(compute_pkg),
-                             ComputePkgRecvRegion(compute_pkg),
-                             VectorDataSpace(vector), 1, SubvectorData(VectorSubvector(vector, 0)));
+    layout = NewCommPkgLayout(ComputePkgSendRegion(compute_pkg),
+                              ComputePkgRecvRegion(compute_pkg),
+                              data_space, 1);
+    CacheCommPkgLayout(layout, compute_pkg, NULL, 0, data_space, 1);
   }
 
+  new_commpkg = NewCommPkgFromLayout(layout, data_array);
+  FreeCommPkgLayout(layout);
+
+  tfree(data_array);
+
   return new_commpkg;
 }
 
@@ -290,6 +319,8 @@ static Vector  *NewTempVector(
   new_vector->table_index = -1;
 #endif
 
+  TouchVector(new_vector);
+
   return new_vector;
 }
 
@@ -318,7 +349,12 @@ static void     AllocateVectorData(
 
     SubvectorDataSize(subvector) = data_size;
 
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    /* Lets processes on the same node copy ghost data directly */
+    double  *data = amps_CTAllocShared(double, data_size);
+#else
     double  *data = ctalloc_amps(double, data_size);
+#endif
     VectorSubvector(vector, i)->allocated = TRUE;
 
     SubvectorData(VectorSubvector(vector, i)) = data;
@@ -328,6 +364,7 @@ static void     AllocateVectorData(
   {
     VectorCommPkg(vector, i) =
       NewVectorCommPkg(vector, GridComputePkg(grid, i));
+    SetCommPkgName(VectorCommPkg(vector, i), vector_update_names[i]);
   }
 }
 
@@ -638,7 +675,11 @@ void FreeSubvector(Subvector *subvector)
 {
   if (subvector->allocated)
   {
+#ifdef AMPS_MPI_SHARED_EXCHANGE
+    amps_TFreeShared(SubvectorData(subvector));
+#else
     tfree_amps(SubvectorData(subvector));
+#endif
   }
   tfree(subvector);
 }
@@ -770,6 +811,8 @@ void    InitVector(
       vp[iv] = value;
     });
   }
+
+  TouchVector(v);
 }
 
 /*--------------------------------------------------------------------------
@@ -817,6 +860,8 @@ void    InitVectorAll(
 #ifdef SHMEM_OBJECTS
   amps_Sync(amps_CommWorld);
 #endif
+
+  TouchVector(v);
 }
 
 
@@ -873,6 +918,8 @@ void    InitVectorInc(
       vp[iv] = value + (i + j + k) * inc;
     });
   }
+
+  TouchVector(v);
 }
 
 
@@ -931,4 +978,20 @@ void    InitVectorRandom(
 #endif
     });
   }
+
+  TouchVector(v);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TouchVector
+ *   Give the vector a new modification epoch.  Routines that write to
+ *   vector data call this so that values derived from the vector can be
+ *   recognized as stale.
+ *--------------------------------------------------------------------------*/
+
+void    TouchVector(
+                    Vector *vector)
+{
+  VectorEpoch(vector) = ++GlobalsVectorEpoch;
 }
@@ -94,6 +94,9 @@ typedef struct _Vector {
 
   enum vector_type type;
 
+  long epoch;                   /* Modification stamp; changes whenever the
+                                 * values in the vector are written */
+
 #ifdef HAVE_SAMRAI
   int samrai_id;                /* SAMRAI ID for this vector */
   // SGS FIXME This is very hacky and should be removed
@@ -149,6 +152,7 @@ typedef struct _VectorUpdateCommHandle {
 #define VectorDataSpace(vector)     ((vector)->data_space)
 #define VectorSize(vector)          ((vector)->size)
 #define VectorCommPkg(vector, mode) ((vector)->comm_pkg[mode])
+#define VectorEpoch(vector)         ((vector)->epoch)
 
 #define SizeOfVector(vector)  ((vector)->data_size)
 
@@ -86,23 +86,8 @@ void PFVLinearSum(
   int test;
 
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_y, i_z;
+  int sg;
 
   if ((b == ONE) && (z == y))      /* BLAS usage: axpy y <- ax+y */
   {
@@ -179,41 +164,43 @@ void PFVLinearSum(
    * (2) a == 0.0, b == other - user should have called N_VScale
    * (3) a,b == other, a !=b, a != -b */
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -222,6 +209,8 @@ void PFVLinearSum(
       zp[i_z] = a * xp[i_x] + b * yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(3 * VectorSize(z));
 }
 
@@ -231,45 +220,40 @@ void PFVConstInit(
                   Vector *z)
 {
   Grid       *grid = VectorGrid(z);
-  Subgrid    *subgrid;
-
-  Subvector  *z_sub;
-
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_z = 0;
 
-    i_z = 0;
     BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
     {
       zp[i_z] = c;
     });
   }
+
+  TouchVector(z);
 }
 
 void PFVProd(
@@ -279,60 +263,47 @@ void PFVProd(
              Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_y, i_z;
+  int sg;
 
   grid = VectorGrid(x);
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -341,6 +312,8 @@ void PFVProd(
       zp[i_z] = xp[i_x] * yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -351,59 +324,46 @@ void PFVDiv(
             Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_y, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -412,6 +372,8 @@ void PFVDiv(
       zp[i_z] = xp[i_x] / yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -422,20 +384,8 @@ void PFVScale(
               Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_z;
+  int sg;
 
   if (z == x)
   {       /* BLAS usage: scale x <- cx */
@@ -453,34 +403,36 @@ void PFVScale(
   }
   else
   {
-    ForSubgridI(sg, GridSubgrids(grid))
+    ForSubgridTasks(sg, GridSubgrids(grid))
     {
-      subgrid = GridSubgrid(grid, sg);
+      Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-      z_sub = VectorSubvector(z, sg);
-      x_sub = VectorSubvector(x, sg);
+      Subvector  *z_sub = VectorSubvector(z, sg);
+      Subvector  *x_sub = VectorSubvector(x, sg);
 
-      ix = SubgridIX(subgrid);
-      iy = SubgridIY(subgrid);
-      iz = SubgridIZ(subgrid);
+      int ix = SubgridIX(subgrid);
+      int iy = SubgridIY(subgrid);
+      int iz = SubgridIZ(subgrid);
 
-      nx = SubgridNX(subgrid);
-      ny = SubgridNY(subgrid);
-      nz = SubgridNZ(subgrid);
+      int nx = SubgridNX(subgrid);
+      int ny = SubgridNY(subgrid);
+      int nz = SubgridNZ(subgrid);
 
-      nx_x = SubvectorNX(x_sub);
-      ny_x = SubvectorNY(x_sub);
-      nz_x = SubvectorNZ(x_sub);
+      int nx_x = SubvectorNX(x_sub);
+      int ny_x = SubvectorNY(x_sub);
+      int nz_x = SubvectorNZ(x_sub);
 
-      nx_z = SubvectorNX(z_sub);
-      ny_z = SubvectorNY(z_sub);
-      nz_z = SubvectorNZ(z_sub);
+      int nx_z = SubvectorNX(z_sub);
+      int ny_z = SubvectorNY(z_sub);
+      int nz_z = SubvectorNZ(z_sub);
 
-      zp = SubvectorElt(z_sub, ix, iy, iz);
-      xp = SubvectorElt(x_sub, ix, iy, iz);
+      double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+      const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+      int i, j, k;
+      int i_x = 0;
+      int i_z = 0;
 
-      i_x = 0;
-      i_z = 0;
       BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
                 i_x, nx_x, ny_x, nz_x, 1, 1, 1,
                 i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -488,6 +440,8 @@ void PFVScale(
         zp[i_z] = c * xp[i_x];
       });
     }
+
+    TouchVector(z);
   }
   IncFLOPCount(VectorSize(x));
 }
@@ -498,49 +452,39 @@ void PFVAbs(
             Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_z = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -548,6 +492,8 @@ void PFVAbs(
       zp[i_z] = fabs(xp[i_x]);
     });
   }
+
+  TouchVector(z);
 }
 
 void PFVInv(
@@ -556,49 +502,39 @@ void PFVInv(
             Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
 
-  int sg, i, j, k, i_x, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_z = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -606,6 +542,8 @@ void PFVInv(
       zp[i_z] = ONE / xp[i_x];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -616,49 +554,39 @@ void PFVAddConst(
                  Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
 
-  Subvector  *x_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_z = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -666,6 +594,8 @@ void PFVAddConst(
       zp[i_z] = xp[i_x] + b;
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -691,8 +621,6 @@ double PFVDotProd(
 
   int sg, i, j, k, i_x, i_y;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -731,9 +659,7 @@ double PFVDotProd(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &sum);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
 
   IncFLOPCount(2 * VectorSize(x));
 
@@ -758,8 +684,6 @@ double PFVMaxNorm(
 
   int sg, i, j, k, i_x;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -790,9 +714,7 @@ double PFVMaxNorm(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &max_val);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Max);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &max_val, 1, amps_Max);
 
   return(max_val);
 }
@@ -819,8 +741,6 @@ double PFVWrmsNorm(
 
   int sg, i, j, k, i_x, i_w;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -860,9 +780,7 @@ double PFVWrmsNorm(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &sum);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
 
   IncFLOPCount(3 * VectorSize(x));
 
@@ -891,8 +809,6 @@ double PFVWL2Norm(
 
   int sg, i, j, k, i_x, i_w;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -932,9 +848,7 @@ double PFVWL2Norm(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &sum);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
 
   IncFLOPCount(3 * VectorSize(x));
 
@@ -959,8 +873,6 @@ double PFVL1Norm(
 
   int sg, i, j, k, i_x;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -990,9 +902,7 @@ double PFVL1Norm(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &sum);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &sum, 1, amps_Add);
 
   return(sum);
 }
@@ -1015,10 +925,6 @@ double PFVMin(
 
   int sg, i, j, k, i_x;
 
-  amps_Invoice result_invoice;
-
-  result_invoice = amps_NewInvoice("%d", &min_val);
-
   grid = VectorGrid(x);
 
   ForSubgridI(sg, GridSubgrids(grid))
@@ -1062,8 +968,7 @@ double PFVMin(
     });
   }
 
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Min);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &min_val, 1, amps_Min);
 
   return(min_val);
 }
@@ -1086,8 +991,6 @@ double PFVMax(
 
   int sg, i, j, k, i_x;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -1130,9 +1033,7 @@ double PFVMax(
     });
   }
 
-  result_invoice = amps_NewInvoice("%d", &max_val);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Max);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceDouble(amps_CommWorld, &max_val, 1, amps_Max);
 
   return(max_val);
 }
@@ -1161,8 +1062,6 @@ int PFVConstrProdPos(
 
   int sg, i, j, k, i_x, i_c;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -1204,9 +1103,7 @@ int PFVConstrProdPos(
     });
   }
 
-  result_invoice = amps_NewInvoice("%i", val);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Min);
-  amps_FreeInvoice(result_invoice);
+  amps_AllReduceInt(amps_CommWorld, val, 1, amps_Min);
 
   if (*val == 0)
   {
@@ -1227,49 +1124,39 @@ void PFVCompare(
                 Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *z_sub;
 
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    z_sub = VectorSubvector(z, sg);
-    x_sub = VectorSubvector(x, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    zp = SubvectorElt(z_sub, ix, iy, iz);
-    xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_z = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -1277,6 +1164,8 @@ void PFVCompare(
       zp[i_z] = (fabs(xp[i_x]) >= c) ? ONE : ZERO;
     });
   }
+
+  TouchVector(z);
 }
 
 
@@ -1303,8 +1192,6 @@ int PFVInvTest(
 
   int sg, i, j, k, i_x, i_z;
 
-  amps_Invoice result_invoice;
-
   ForSubgridI(sg, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, sg);
@@ -1345,9 +1232,9 @@ int PFVInvTest(
     });
   }
 
-  result_invoice = amps_NewInvoice("%i", val);
-  amps_AllReduce(amps_CommWorld, result_invoice, amps_Min);
-  amps_FreeInvoice(result_invoice);
+  TouchVector(z);
+
+  amps_AllReduceInt(amps_CommWorld, val, 1, amps_Min);
 
   if (*val == 0)
   {
@@ -1380,13 +1267,16 @@ void PFVCopy(Vector *x,
   Grid *grid = VectorGrid(x);
   int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
     Subvector  *x_sub = VectorSubvector(x, sg);
     Subvector  *y_sub = VectorSubvector(y, sg);
 
     tmemcpy(SubvectorData(y_sub), SubvectorData(x_sub), SubvectorDataSize(y_sub)*sizeof(double));
   }
+
+  /* An exact copy holds the same values as its source */
+  VectorEpoch(y) = VectorEpoch(x);
 }
 
 void PFVSum(
@@ -1396,59 +1286,46 @@ void PFVSum(
             Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
 
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1457,6 +1334,8 @@ void PFVSum(
       zp[i_z] = xp[i_x] + yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -1467,60 +1346,46 @@ void PFVDiff(
              Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1529,6 +1394,8 @@ void PFVDiff(
       zp[i_z] = xp[i_x] - yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -1538,50 +1405,39 @@ void PFVNeg(
             Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_z = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_z, nx_z, ny_z, nz_z, 1, 1, 1,
@@ -1589,6 +1445,8 @@ void PFVNeg(
       zp[i_z] = -xp[i_x];
     });
   }
+
+  TouchVector(z);
 }
 
 void PFVScaleSum(
@@ -1599,60 +1457,46 @@ void PFVScaleSum(
                  Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1661,6 +1505,8 @@ void PFVScaleSum(
       zp[i_z] = c * (xp[i_x] + yp[i_y]);
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(2 * VectorSize(x));
 }
 
@@ -1672,60 +1518,46 @@ void PFVScaleDiff(
                   Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1734,6 +1566,8 @@ void PFVScaleDiff(
       zp[i_z] = c * (xp[i_x] - yp[i_y]);
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(2 * VectorSize(x));
 }
 
@@ -1745,60 +1579,46 @@ void PFVLin1(
              Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1807,6 +1627,8 @@ void PFVLin1(
       zp[i_z] = a * (xp[i_x]) + yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(2 * VectorSize(x));
 }
 
@@ -1818,60 +1640,46 @@ void PFVLin2(
              Vector *z)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-  Subvector  *z_sub;
-
-  const double * __restrict__ xp;
-  const double * __restrict__ yp;
-  double * __restrict__ zp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-  int nx_z, ny_z, nz_z;
-
-  int sg, i, j, k, i_x, i_y, i_z;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
-    z_sub = VectorSubvector(z, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
+    Subvector  *z_sub = VectorSubvector(z, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    nx_z = SubvectorNX(z_sub);
-    ny_z = SubvectorNY(z_sub);
-    nz_z = SubvectorNZ(z_sub);
+    int nx_z = SubvectorNX(z_sub);
+    int ny_z = SubvectorNY(z_sub);
+    int nz_z = SubvectorNZ(z_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
-    zp = SubvectorElt(z_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    const double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+    double * __restrict__ zp = SubvectorElt(z_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
+    int i_z = 0;
 
-    i_x = 0;
-    i_y = 0;
-    i_z = 0;
     BoxLoopI3(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1880,6 +1688,8 @@ void PFVLin2(
       zp[i_z] = a * (xp[i_x]) - yp[i_y];
     });
   }
+
+  TouchVector(z);
   IncFLOPCount(2 * VectorSize(x));
 }
 
@@ -1890,50 +1700,39 @@ void PFVAxpy(
              Vector *y)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-  Subvector  *y_sub;
-
-  const double * __restrict__ xp;
-  double * __restrict__ yp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-  int nx_y, ny_y, nz_y;
-
-  int sg, i, j, k, i_x, i_y;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
-    y_sub = VectorSubvector(y, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
+    Subvector  *y_sub = VectorSubvector(y, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    nx_y = SubvectorNX(y_sub);
-    ny_y = SubvectorNY(y_sub);
-    nz_y = SubvectorNZ(y_sub);
+    int nx_y = SubvectorNX(y_sub);
+    int ny_y = SubvectorNY(y_sub);
+    int nz_y = SubvectorNZ(y_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
-    yp = SubvectorElt(y_sub, ix, iy, iz);
+    const double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ yp = SubvectorElt(y_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
+    int i_y = 0;
 
-    i_x = 0;
-    i_y = 0;
     BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
               i_y, nx_y, ny_y, nz_y, 1, 1, 1,
@@ -1941,6 +1740,8 @@ void PFVAxpy(
       yp[i_y] += a * (xp[i_x]);
     });
   }
+
+  TouchVector(y);
   IncFLOPCount(2 * VectorSize(x));
 }
 
@@ -1950,46 +1751,40 @@ void PFVScaleBy(
                 Vector *x)
 {
   Grid       *grid = VectorGrid(x);
-  Subgrid    *subgrid;
-
-  Subvector  *x_sub;
-
-  double * __restrict__ xp;
-
-  int ix, iy, iz;
-  int nx, ny, nz;
-  int nx_x, ny_x, nz_x;
-
-  int sg, i, j, k, i_x;
 
+  int sg;
 
-  ForSubgridI(sg, GridSubgrids(grid))
+  ForSubgridTasks(sg, GridSubgrids(grid))
   {
-    subgrid = GridSubgrid(grid, sg);
+    Subgrid    *subgrid = GridSubgrid(grid, sg);
 
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
 
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
 
-    x_sub = VectorSubvector(x, sg);
+    Subvector  *x_sub = VectorSubvector(x, sg);
 
-    nx_x = SubvectorNX(x_sub);
-    ny_x = SubvectorNY(x_sub);
-    nz_x = SubvectorNZ(x_sub);
+    int nx_x = SubvectorNX(x_sub);
+    int ny_x = SubvectorNY(x_sub);
+    int nz_x = SubvectorNZ(x_sub);
 
-    xp = SubvectorElt(x_sub, ix, iy, iz);
+    double * __restrict__ xp = SubvectorElt(x_sub, ix, iy, iz);
+
+    int i, j, k;
+    int i_x = 0;
 
-    i_x = 0;
     BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
               i_x, nx_x, ny_x, nz_x, 1, 1, 1,
     {
       xp[i_x] = xp[i_x] * a;
     });
   }
+
+  TouchVector(x);
   IncFLOPCount(VectorSize(x));
 }
 
@@ -2075,5 +1870,7 @@ void PFVLayerCopy(
       i_x += kinc;
     }
   }
+
+  TouchVector(y);
   IncFLOPCount(2 * VectorSize(x));
 }
@@ -0,0 +1,164 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#include "parflow.h"
+
+/*--------------------------------------------------------------------------
+ * ComputeWaterBalance:
+ *   Computes the contribution of this process to the water balance of a
+ *   time step of length `dt' ending with `pressure' and `saturation':
+ *
+ *     balance[0]  subsurface storage
+ *     balance[1]  surface storage (ponded water)
+ *     balance[2]  surface runoff over the step
+ *     balance[3]  evaporation and transpiration over the step
+ *
+ *   The terms are volumes and are summed over all processes by the caller.
+ *   The storage terms follow the pftools water balance commands; the
+ *   runoff uses OverlandSum and is accumulated in the 2D vector
+ *   `runoff', which is reset first.  `evap_trans' may be NULL.
+ *--------------------------------------------------------------------------*/
+
+void ComputeWaterBalance(
+                         ProblemData *problem_data,
+                         Vector *     pressure,
+                         Vector *     saturation,
+                         Vector *     evap_trans,
+                         Vector *     runoff,
+                         double       dt,
+                         double *     balance)
+{
+  GrGeomSolid *gr_domain = ProblemDataGrDomain(problem_data);
+
+  Grid        *grid = VectorGrid(pressure);
+  Subgrid     *subgrid;
+
+  Vector      *porosity = ProblemDataPorosity(problem_data);
+  Vector      *specific_storage = ProblemDataSpecificStorage(problem_data);
+  Vector      *z_mult = ProblemDataZmult(problem_data);
+  Vector      *top = ProblemDataIndexOfDomainTop(problem_data);
+
+  Subvector   *p_sub, *s_sub, *po_sub, *ss_sub, *z_sub, *et_sub;
+  Subvector   *top_sub, *r_sub;
+
+  double      *pp, *sp, *po, *ss, *zm, *et, *top_dat, *rp;
+
+  double dx, dy, dz;
+  double subsurface_storage = 0.0;
+  double surface_storage = 0.0;
+  double surface_runoff = 0.0;
+  double evaporation = 0.0;
+
+  int i, j, k, r, is;
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int ip;
+
+  InitVectorAll(runoff, 0.0);
+  OverlandSum(problem_data, pressure, dt, runoff);
+
+  ForSubgridI(is, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, is);
+
+    p_sub = VectorSubvector(pressure, is);
+    s_sub = VectorSubvector(saturation, is);
+    po_sub = VectorSubvector(porosity, is);
+    ss_sub = VectorSubvector(specific_storage, is);
+    z_sub = VectorSubvector(z_mult, is);
+    top_sub = VectorSubvector(top, is);
+    r_sub = VectorSubvector(runoff, is);
+
+    r = SubgridRX(subgrid);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    dx = SubgridDX(subgrid);
+    dy = SubgridDY(subgrid);
+    dz = SubgridDZ(subgrid);
+
+    pp = SubvectorData(p_sub);
+    sp = SubvectorData(s_sub);
+    po = SubvectorData(po_sub);
+    ss = SubvectorData(ss_sub);
+    zm = SubvectorData(z_sub);
+    top_dat = SubvectorData(top_sub);
+    rp = SubvectorData(r_sub);
+
+    GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
+    {
+      ip = SubvectorEltIndex(p_sub, i, j, k);
+
+      subsurface_storage += (sp[ip] * po[ip] + pp[ip] * sp[ip] * ss[ip])
+                            * dx * dy * dz * zm[ip];
+    });
+
+    if (evap_trans)
+    {
+      et_sub = VectorSubvector(evap_trans, is);
+      et = SubvectorData(et_sub);
+
+      GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
+      {
+        ip = SubvectorEltIndex(et_sub, i, j, k);
+
+        evaporation += et[ip] * dx * dy * dz * zm[ip] * dt;
+      });
+    }
+
+    for (j = iy; j < iy + ny; j++)
+    {
+      for (i = ix; i < ix + nx; i++)
+      {
+        /* Count each column once, on the process owning its top cell */
+        k = (int)top_dat[SubvectorEltIndex(top_sub, i, j, 0)];
+        if ((k >= iz) && (k < iz + nz))
+        {
+          ip = SubvectorEltIndex(p_sub, i, j, k);
+          if (pp[ip] > 0.0)
+          {
+            surface_storage += pp[ip] * dx * dy;
+          }
+
+          surface_runoff += rp[SubvectorEltIndex(r_sub, i, j, 0)];
+        }
+      }
+    }
+  }
+
+  balance[0] = subsurface_storage;
+  balance[1] = surface_storage;
+  balance[2] = surface_runoff;
+  balance[3] = evaporation;
+}
@@ -37,6 +37,7 @@
 *****************************************************************************/
 
 #include "databox.h"
+#include "kernels.h"
 
 /*-----------------------------------------------------------------------
  * Compute Y = alpha*X + Y
@@ -44,25 +45,7 @@
 
 void       Axpy(double alpha, Databox *X, Databox *Y)
 {
-  int nx, ny, nz;
-
-  double         *xp, *yp;
-
-  int m;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-
-  m = 0;
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    yp[m] += alpha * xp[m];
-  }
+  KernelAxpy(alpha, X, Y);
 }
 
 
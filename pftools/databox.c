@@ -199,6 +199,8 @@ void SetDataboxGrid(
 void         FreeDatabox(
                          Databox *databox)
 {
+  DataboxUnmap(databox);
+
   free(DataboxCoeffs(databox));
 
   free(databox);
@@ -90,9 +90,10 @@ typedef struct {
 
 #define DataboxLabel(databox)   ((databox)->label)
 
-#define DataboxCoeff(databox, i, j, k) \
-  (DataboxCoeffs(databox) +            \
-   (k) * DataboxNy(databox) * DataboxNx(databox) + (j) * DataboxNx(databox) + (i))
+#define DataboxCoeff(databox, i, j, k)                                \
+  (DataboxCoeffs(databox) +                                           \
+   (long)(k) * DataboxNy(databox) * DataboxNx(databox) +              \
+   (long)(j) * DataboxNx(databox) + (i))
 
 
 /* Defines how a grid definition is */
@@ -118,6 +119,11 @@ void SetDataboxGrid(Databox *databox, int nx, int ny, int nz, double x, double y
                     double dx, double dy, double dz);
 void FreeDatabox(Databox *databox);
 
+/* readdatabox.c */
+int DataboxLoad(Databox *databox, int z, int nz);
+Databox *DataboxLoadAll(Databox *databox);
+void DataboxUnmap(Databox *databox);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@
 *****************************************************************************/
 
 #include "diff.h"
+#include "kernels.h"
 
 #ifndef TRUE
 #define TRUE  1
@@ -190,25 +191,20 @@ void         MSigDiff(
                       double      absolute_zero,
                       Tcl_Obj *   result)
 {
-  double         *v1_p, *v2_p;
+  KernelDiff diff;
 
   double sig_dig_rhs;
-  double adiff, amax, sdiff;
-  double max_adiff = 0.0, max_sdiff;
+  double sdiff;
+  double max_adiff, max_sdiff;
 
-  int i, j, k;
   int mi = 0, mj = 0, mk = 0;
-  int nx, ny, nz;
+  int nx, ny;
 
   int sig_digs;
-  int m_sig_digs, m_sig_digs_everywhere;
+  int m_sig_digs_everywhere;
 
-  /*-----------------------------------------------------------------------
-   * check that dimensions are the same
-   *-----------------------------------------------------------------------*/
   nx = DataboxNx(v1);
   ny = DataboxNy(v1);
-  nz = DataboxNz(v1);
 
   /*-----------------------------------------------------------------------
    * diff the values and print the results
@@ -218,49 +214,17 @@ void         MSigDiff(
   else
     sig_dig_rhs = 0.0;
 
-  v1_p = DataboxCoeffs(v1);
-  v2_p = DataboxCoeffs(v2);
-
-  m_sig_digs_everywhere = TRUE;
-  max_sdiff = 0.0;
-  for (k = 0; k < nz; k++)
-  {
-    for (j = 0; j < ny; j++)
-    {
-      for (i = 0; i < nx; i++)
-      {
-        adiff = fabs((*v1_p) - (*v2_p));
-        amax = max(fabs(*v1_p), fabs(*v2_p));
+  KernelSigDiff(v1, v2, sig_dig_rhs, absolute_zero, &diff);
 
-        if (max_adiff < adiff)
-          max_adiff = adiff;
+  max_adiff = diff.max_adiff;
+  max_sdiff = diff.max_sdiff;
 
-        m_sig_digs = TRUE;
-        if (amax > absolute_zero)
-        {
-          sdiff = adiff / amax;
-          if (sdiff > sig_dig_rhs)
-            m_sig_digs = FALSE;
-        }
-
-        if (!m_sig_digs)
-        {
-          if (sdiff > max_sdiff)
-          {
-            max_sdiff = sdiff;
-
-            mi = i;
-            mj = j;
-            mk = k;
-          }
-
-          m_sig_digs_everywhere = FALSE;
-        }
-
-        v1_p++;
-        v2_p++;
-      }
-    }
+  m_sig_digs_everywhere = (diff.index < 0);
+  if (!m_sig_digs_everywhere)
+  {
+    mi = (int)(diff.index % nx);
+    mj = (int)((diff.index / nx) % ny);
+    mk = (int)(diff.index / ((long)nx * ny));
   }
 
   if (!m_sig_digs_everywhere)
@@ -113,9 +113,11 @@ static char *SAVESDSUSAGE = "Usage: pfsavesds dataset -filetype filename\n
 static char *BFCVELUSAGE = "Usage: pfbfcvel conductivity phead\n";
 static char *GETSUBBOXUSAGE = "Usage: pfgetsubbox dataset il jl kl iu ju ku\n";
 static char *ENLARGEBOXUSAGE = "Usage: pfenlargebox dataset new_nx new_ny new_nz\n";
-static char *LOADPFUSAGE = "Usage: pfload [-filetype] filename\n       file types: pfb pfsb sa sb rsa\n";
+static char *LOADPFUSAGE = "Usage: pfload [-lazy] [-filetype] filename\n       file types: pfb pfsb sa sb rsa\n";
 static char *RELOADUSAGE = "Usage: pfreload dataset\n";
 static char *SAVEPFUSAGE = "Usage: pfsave dataset -filetype filename\n       file types: pfb sa sb\n";
+static char *SAVEXDMFUSAGE = "Usage: pfxdmfsave dataset filename [-var name] [-flt] [-time value] [-geometry geometryfile]\n";
+static char *SAVEXDMFGEOMETRYUSAGE = "Usage: pfxdmfgeometry dataset dem filename [-tfg dzlist]\n       dzlist = {nz dz_0 dz_1 ... dz_nz-1} from the bottom up\n";
 static char *GETLISTUSAGE = "Usage: pfgetlist [dataset]\n";
 static char *GETELTUSAGE = "Usage: pfgetelt dataset i j k\n";
 static char *GETGRIDUSAGE = "Usage: pfgetgrid dataset\n";
@@ -139,6 +141,7 @@ static char *CELLMULTCONSTUSAGE = "Usage: pfcellmultconst datasetx val mask\n";
 static char *CELLDIVCONSTUSAGE = "Usage: pfcelldivconst datasetx val mask\n";
 static char *GETSTATSUSAGE = "Usage: pfstats dataset\n";
 static char *MDIFFUSAGE = "Usage: pfmdiff datasetp datasetq sig_digs [abs_zero]\n";
+static char *REDUCEPFBUSAGE = "Usage: pfreducepfb basename start stop interval operations output\n       operations = list of mean, min, max, sum and variance\n";
 static char *SAVEDIFFUSAGE = "Usage: pfsavediff datasetp datasetq sig_digs [abs_zero] -file filename\n";
 static char *DIFFELTUSAGE = "Usage: pfdiffelt datasetp datasetq i j k sig_digs [abs_zero]\n";
 static char *NEWGRIDUSAGE = "Usage: pfnewgrid {nx ny nz} {x y z} {dx dy dz} label\n       Types: int nx, ny, nz;  double x, y, z, dx, dy, dz;\n";
@@ -162,6 +165,7 @@ static char *PFUPSTREAMAREAUSAGE = "Usage: pfupstreamarea dem sx sy\n";
 static char *PFFILLFLATSUSAGE = "Usage: pffillflats dem \n";
 static char *PFPITFILLDEMUSAGE = "Usage: pfpitfilldem dem dpit maxiter\n";
 static char *PFMOVINGAVGDEMUSAGE = "Usage: pfmovingavgdem dem wsize maxiter\n";
+static char *PFPRIORITYFILLDEMUSAGE = "Usage: pfpriorityfilldem dem epsilon\n";
 static char *PFSATTRANSUSAGE = "Usage: pfsattrans nlayers mask perm\n";
 static char *PFTOPODEFTOWTUSAGE = "Usage: pftopowt deficit porosity ssat sres mask top \n";
 static char *PFTOPODEFUSAGE = "Usage: pftopodeficit profile m trans dem sx sy recharge ssat sres porosity mask\n              profile = Exponential or Linear\n";
@@ -0,0 +1,339 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Kernels
+*
+* The element-wise and reduction loops shared by the pftools arithmetic
+* and statistics commands.  The values of a Databox are contiguous so the
+* kernels work on the flat coefficient arrays.  With OpenMP the loops are
+* threaded and vectorized.  The reductions first reduce fixed size blocks
+* and then combine the blocks in order, so their results do not depend on
+* the number of threads.
+*
+*****************************************************************************/
+
+#include "kernels.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+/* Number of values reduced together; small enough to stay in cache */
+#define KERNEL_BLOCK 4096
+
+/* Boxes smaller than this are not worth starting threads for */
+#define KERNEL_MIN_PARALLEL 32768
+
+static long KernelSize(Databox *X)
+{
+  return (long)DataboxNx(X) * DataboxNy(X) * DataboxNz(X);
+}
+
+
+/*-----------------------------------------------------------------------
+ * result = X op Y in the cells where mask > 0
+ *
+ * Other cells of result are left unchanged.
+ *-----------------------------------------------------------------------*/
+
+void       KernelCellwise(int op, Databox *X, Databox *Y, Databox *mask, Databox *result)
+{
+  long m, n;
+  double         *xp, *yp;
+  double         *mask_val;
+  double         *result_val;
+
+  n = KernelSize(X);
+
+  xp = DataboxCoeffs(X);
+  yp = DataboxCoeffs(Y);
+  mask_val = DataboxCoeffs(mask);
+  result_val = DataboxCoeffs(result);
+
+  /* The selects keep the loops free of branches so they vectorize */
+  switch (op)
+  {
+    case KERNEL_CELL_SUM:
+#ifdef _OPENMP
+      #pragma omp parallel for simd if (n > KERNEL_MIN_PARALLEL)
+#endif
+      for (m = 0; m < n; m++)
+      {
+        result_val[m] = (mask_val[m] > 0) ? xp[m] + yp[m] : result_val[m];
+      }
+      break;
+
+    case KERNEL_CELL_DIFF:
+#ifdef _OPENMP
+      #pragma omp parallel for simd if (n > KERNEL_MIN_PARALLEL)
+#endif
+      for (m = 0; m < n; m++)
+      {
+        result_val[m] = (mask_val[m] > 0) ? xp[m] - yp[m] : result_val[m];
+      }
+      break;
+
+    case KERNEL_CELL_MULT:
+#ifdef _OPENMP
+      #pragma omp parallel for simd if (n > KERNEL_MIN_PARALLEL)
+#endif
+      for (m = 0; m < n; m++)
+      {
+        result_val[m] = (mask_val[m] > 0) ? xp[m] * yp[m] : result_val[m];
+      }
+      break;
+
+    case KERNEL_CELL_DIV:
+#ifdef _OPENMP
+      #pragma omp parallel for simd if (n > KERNEL_MIN_PARALLEL)
+#endif
+      for (m = 0; m < n; m++)
+      {
+        result_val[m] = (mask_val[m] > 0) ? xp[m] / yp[m] : result_val[m];
+      }
+      break;
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * Y = alpha*X + Y
+ *-----------------------------------------------------------------------*/
+
+void       KernelAxpy(double alpha, Databox *X, Databox *Y)
+{
+  long m, n;
+  double         *xp, *yp;
+
+  n = KernelSize(X);
+
+  xp = DataboxCoeffs(X);
+  yp = DataboxCoeffs(Y);
+
+#ifdef _OPENMP
+  #pragma omp parallel for simd if (n > KERNEL_MIN_PARALLEL)
+#endif
+  for (m = 0; m < n; m++)
+  {
+    yp[m] += alpha * xp[m];
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * Sum of all values of X
+ *-----------------------------------------------------------------------*/
+
+double     KernelSum(Databox *X)
+{
+  KernelStats stats;
+
+  KernelStatistics(X, &stats);
+
+  return stats.sum;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Min, max, sum, mean and variance of the values of X in one pass
+ *
+ * Each block is summed and then its squared deviations from the block
+ * mean are summed while it is still in cache.  The blocks are combined
+ * with the pairwise update of Chan, Golub and LeVeque, which is as
+ * accurate as the two pass formula.
+ *-----------------------------------------------------------------------*/
+
+void       KernelStatistics(Databox *X, KernelStats *stats)
+{
+  KernelStats *blocks;
+  double         *xp;
+  long n, num_blocks, b, count;
+
+  n = KernelSize(X);
+  xp = DataboxCoeffs(X);
+
+  stats->min = 0.0;
+  stats->max = 0.0;
+  stats->sum = 0.0;
+  stats->mean = 0.0;
+  stats->variance = 0.0;
+
+  if (n == 0)
+  {
+    return;
+  }
+
+  num_blocks = (n + KERNEL_BLOCK - 1) / KERNEL_BLOCK;
+  blocks = (KernelStats*)malloc(num_blocks * sizeof(KernelStats));
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static) if (n > KERNEL_MIN_PARALLEL)
+#endif
+  for (b = 0; b < num_blocks; b++)
+  {
+    long lo = b * KERNEL_BLOCK;
+    long hi = (lo + KERNEL_BLOCK < n) ? lo + KERNEL_BLOCK : n;
+    double min = xp[lo], max = xp[lo], sum = 0.0, m2 = 0.0, mean;
+    long m;
+
+#ifdef _OPENMP
+    #pragma omp simd reduction(+:sum) reduction(min:min) reduction(max:max)
+#endif
+    for (m = lo; m < hi; m++)
+    {
+      min = (xp[m] < min) ? xp[m] : min;
+      max = (xp[m] > max) ? xp[m] : max;
+      sum += xp[m];
+    }
+
+    mean = sum / (hi - lo);
+
+#ifdef _OPENMP
+    #pragma omp simd reduction(+:m2)
+#endif
+    for (m = lo; m < hi; m++)
+    {
+      m2 += (xp[m] - mean) * (xp[m] - mean);
+    }
+
+    blocks[b].min = min;
+    blocks[b].max = max;
+    blocks[b].sum = sum;
+    blocks[b].mean = mean;
+    blocks[b].variance = m2;
+  }
+
+  /* combine the blocks in order, variance holds the sum of squares */
+  *stats = blocks[0];
+  count = (n < KERNEL_BLOCK) ? n : KERNEL_BLOCK;
+  for (b = 1; b < num_blocks; b++)
+  {
+    long nb = (b < num_blocks - 1) ? KERNEL_BLOCK : n - b * KERNEL_BLOCK;
+    double delta = blocks[b].mean - stats->mean;
+
+    if (blocks[b].min < stats->min)
+      stats->min = blocks[b].min;
+    if (blocks[b].max > stats->max)
+      stats->max = blocks[b].max;
+
+    stats->variance += blocks[b].variance +
+                       delta * delta * ((double)count * nb / (count + nb));
+    stats->mean += delta * nb / (count + nb);
+    stats->sum += blocks[b].sum;
+    count += nb;
+  }
+
+  stats->mean = stats->sum / n;
+  stats->variance /= n;
+
+  free(blocks);
+}
+
+
+/*-----------------------------------------------------------------------
+ * Compare the significant digits of X and Y
+ *
+ * A cell fails when max(|x|, |y|) > absolute_zero and the relative
+ * difference |x - y| / max(|x|, |y|) is greater than sig_dig_rhs.  The
+ * largest absolute difference over all cells and the failing cell with the
+ * largest relative difference are returned.
+ *-----------------------------------------------------------------------*/
+
+void       KernelSigDiff(Databox *X, Databox *Y, double sig_dig_rhs, double absolute_zero, KernelDiff *diff)
+{
+  KernelDiff *blocks;
+  double         *xp, *yp;
+  long n, num_blocks, b;
+
+  n = KernelSize(X);
+  xp = DataboxCoeffs(X);
+  yp = DataboxCoeffs(Y);
+
+  diff->max_adiff = 0.0;
+  diff->max_sdiff = 0.0;
+  diff->index = -1;
+
+  if (n == 0)
+  {
+    return;
+  }
+
+  num_blocks = (n + KERNEL_BLOCK - 1) / KERNEL_BLOCK;
+  blocks = (KernelDiff*)malloc(num_blocks * sizeof(KernelDiff));
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static) if (n > KERNEL_MIN_PARALLEL)
+#endif
+  for (b = 0; b < num_blocks; b++)
+  {
+    long lo = b * KERNEL_BLOCK;
+    long hi = (lo + KERNEL_BLOCK < n) ? lo + KERNEL_BLOCK : n;
+    double max_adiff = 0.0, max_sdiff = 0.0;
+    long index = -1;
+    long m;
+
+    for (m = lo; m < hi; m++)
+    {
+      double adiff = fabs(xp[m] - yp[m]);
+      double amax = (fabs(xp[m]) > fabs(yp[m])) ? fabs(xp[m]) : fabs(yp[m]);
+
+      if (adiff > max_adiff)
+        max_adiff = adiff;
+
+      if (amax > absolute_zero)
+      {
+        double sdiff = adiff / amax;
+        if (sdiff > sig_dig_rhs && sdiff > max_sdiff)
+        {
+          max_sdiff = sdiff;
+          index = m;
+        }
+      }
+    }
+
+    blocks[b].max_adiff = max_adiff;
+    blocks[b].max_sdiff = max_sdiff;
+    blocks[b].index = index;
+  }
+
+  /* combine in order so ties go to the first cell */
+  for (b = 0; b < num_blocks; b++)
+  {
+    if (blocks[b].max_adiff > diff->max_adiff)
+      diff->max_adiff = blocks[b].max_adiff;
+
+    if (blocks[b].index >= 0 &&
+        (diff->index < 0 || blocks[b].max_sdiff > diff->max_sdiff))
+    {
+      diff->max_sdiff = blocks[b].max_sdiff;
+      diff->index = blocks[b].index;
+    }
+  }
+
+  free(blocks);
+}
@@ -0,0 +1,87 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Header file for `kernels.c'
+*
+* Element-wise and reduction kernels over the values of Databoxes.
+*
+*****************************************************************************/
+
+#ifndef KERNELS_HEADER
+#define KERNELS_HEADER
+
+#include "databox.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------
+ * Cell-wise operations
+ *-----------------------------------------------------------------------*/
+
+#define KERNEL_CELL_SUM   0
+#define KERNEL_CELL_DIFF  1
+#define KERNEL_CELL_MULT  2
+#define KERNEL_CELL_DIV   3
+
+/*-----------------------------------------------------------------------
+ * Results of the reductions
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  double min;
+  double max;
+  double sum;
+  double mean;
+  double variance;       /* population variance */
+} KernelStats;
+
+typedef struct {
+  double max_adiff;      /* largest absolute difference over all cells */
+  double max_sdiff;      /* largest relative difference above the bound */
+  long index;            /* first cell with max_sdiff, -1 if none */
+} KernelDiff;
+
+/*-----------------------------------------------------------------------
+ * function prototypes
+ *-----------------------------------------------------------------------*/
+
+/* kernels.c */
+void KernelCellwise(int op, Databox *X, Databox *Y, Databox *mask, Databox *result);
+void KernelAxpy(double alpha, Databox *X, Databox *Y);
+double KernelSum(Databox *X);
+void KernelStatistics(Databox *X, KernelStats *stats);
+void KernelSigDiff(Databox *X, Databox *Y, double sig_dig_rhs, double absolute_zero, KernelDiff *diff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
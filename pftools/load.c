@@ -34,6 +34,7 @@
 
 #include "pfload_file.h"
 #include "load.h"
+#include "readdatabox.h"
 #include "tools_io.h"
 
 
@@ -53,8 +54,9 @@ void           LoadParflowB(
 
   Subgrid  *subgrid;
 
-  int process, num_procs;
+  int process, num_procs, num_subgrids;
   int p;
+  int header = 1;
 
   double   *ptr;
 
@@ -90,6 +92,7 @@ void           LoadParflowB(
       num_procs = process;
   }
   num_procs++;
+  num_subgrids = SubgridArraySize(all_subgrids);
 
   /*--------------------------------------------------------------------
    * Load the data
@@ -136,8 +139,8 @@ void           LoadParflowB(
         }
 #endif
 
-        /* if (process == 0), write header info */
-        if (!process)
+        /* write header info before the first subgrid of process 0 */
+        if (!process && header)
         {
           tools_WriteDouble(file, &BackgroundX(background), 1);
           tools_WriteDouble(file, &BackgroundY(background), 1);
@@ -151,9 +154,10 @@ void           LoadParflowB(
           tools_WriteDouble(file, &BackgroundDY(background), 1);
           tools_WriteDouble(file, &BackgroundDZ(background), 1);
 
-          tools_WriteInt(file, &num_procs, 1);
+          tools_WriteInt(file, &num_subgrids, 1);
 
           file_pos += 6 * tools_SizeofDouble + 4 * tools_SizeofInt;
+          header = 0;
         }
 
         ix = SubgridIX(subgrid);
@@ -186,11 +190,14 @@ void           LoadParflowB(
 
 #ifdef AMPS_SPLIT_FILE
         fclose(file);
-#else
-        fprintf(dist_file, "%ld\n", file_pos);
 #endif
       }
     }
+
+#ifndef AMPS_SPLIT_FILE
+    /* each process reads its subgrids from one offset */
+    fprintf(dist_file, "%ld\n", file_pos);
+#endif
   }
 
 #ifndef AMPS_SPLIT_FILE
@@ -198,3 +205,328 @@ void           LoadParflowB(
   fclose(dist_file);
 #endif
 }
+
+
+#ifndef AMPS_SPLIT_FILE
+
+/* Upper bound on the values of an output subgrid copied at once, unless
+ * one xy plane of the subgrid is larger */
+#define DIST_PIECE_VALUES (1 << 20)
+
+typedef struct {
+  Subgrid  *subgrid;
+  long offset;               /* file offset of the first value */
+} DistSubgrid;
+
+/*-----------------------------------------------------------------------
+ * Copy planes z to z+nz-1 of the output subgrid from the input file
+ *
+ * buffer holds the planes, in file byte order, after the call; cells
+ * not covered by an input subgrid are 0.
+ *-----------------------------------------------------------------------*/
+
+static int    DistCopyPlanes(
+                             FILE *      in_file,
+                             PFBSubgrid *in_subgrids,
+                             int         num_in_subgrids,
+                             Subgrid *   subgrid,
+                             int         z,
+                             int         nz,
+                             char *      buffer,
+                             char *      rows)
+{
+  int ix = SubgridIX(subgrid);
+  int iy = SubgridIY(subgrid);
+  int iz = SubgridIZ(subgrid) + z;
+  int nx = SubgridNX(subgrid);
+  int ny = SubgridNY(subgrid);
+
+  int s, k, j, jj, num_rows;
+
+  memset(buffer, 0, (size_t)nx * ny * nz * 8);
+
+  for (s = 0; s < num_in_subgrids; s++)
+  {
+    PFBSubgrid *in = &in_subgrids[s];
+
+    /* intersection of the input subgrid with the planes */
+    int x0 = (ix > in->x) ? ix : in->x;
+    int y0 = (iy > in->y) ? iy : in->y;
+    int z0 = (iz > in->z) ? iz : in->z;
+    int x1 = (ix + nx < in->x + in->nx) ? ix + nx : in->x + in->nx;
+    int y1 = (iy + ny < in->y + in->ny) ? iy + ny : in->y + in->ny;
+    int z1 = (iz + nz < in->z + in->nz) ? iz + nz : in->z + in->nz;
+
+    if (x0 >= x1 || y0 >= y1 || z0 >= z1)
+      continue;
+
+    for (k = z0; k < z1; k++)
+    {
+      for (j = y0; j < y1; j += num_rows)
+      {
+        char *dest = buffer +
+                     ((((long)(k - iz) * ny + (j - iy)) * nx) + (x0 - ix)) * 8;
+        long src = in->offset +
+                   ((((long)(k - in->z) * in->ny + (j - in->y)) * in->nx) + (x0 - in->x)) * 8;
+
+        if (x1 - x0 == in->nx)
+        {
+          /* whole input rows are contiguous, read as many as fit */
+          num_rows = DIST_PIECE_VALUES / in->nx;
+          if (num_rows < 1)
+            num_rows = 1;
+          if (num_rows > y1 - j)
+            num_rows = y1 - j;
+
+          if (fseek(in_file, src, SEEK_SET) ||
+              fread(rows, 8, (size_t)num_rows * in->nx, in_file) != (size_t)num_rows * in->nx)
+            return 0;
+
+          for (jj = 0; jj < num_rows; jj++)
+          {
+            memcpy(dest + (long)jj * nx * 8, rows + (long)jj * in->nx * 8,
+                   (size_t)in->nx * 8);
+          }
+        }
+        else
+        {
+          num_rows = 1;
+
+          if (fseek(in_file, src, SEEK_SET) ||
+              fread(dest, 8, x1 - x0, in_file) != (size_t)(x1 - x0))
+            return 0;
+        }
+      }
+    }
+  }
+
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * DistParflowB:
+ *
+ * Distributes the `parflow' binary file in_name over all_subgrids and
+ * writes it to out_name and out_name.dist, giving the same files as
+ * reading in_name and calling LoadParflowB.  The values are copied
+ * between the files a few planes of an output subgrid at a time, so
+ * memory use does not depend on the size of the domain.  With OpenMP the
+ * output subgrids are copied in parallel.
+ *
+ * Returns 0 on success and -1 if a file could not be read or written.
+ *-----------------------------------------------------------------------*/
+
+int           DistParflowB(
+                           char *        in_name,
+                           char *        out_name,
+                           SubgridArray *all_subgrids,
+                           Background *  background)
+{
+  char dist_name[MAXPATHLEN];
+  FILE        *file;
+  FILE        *dist_file;
+
+  PFBSubgrid  *in_subgrids;
+  DistSubgrid *out_subgrids;
+  Subgrid     *subgrid;
+
+  double coords[6];
+  int sizes[4];
+  int NX, NY, NZ;
+
+  int process, num_procs, num_subgrids;
+  int num_out, max_values;
+  int p, s_i;
+  int failed = 0;
+
+  long file_pos = 0;
+
+  if (!ReadParflowBLayout(in_name, coords, sizes, &in_subgrids))
+    return -1;
+
+  NX = sizes[0];
+  NY = sizes[1];
+  NZ = sizes[2];
+
+  /*--------------------------------------------------------------------
+   * Order the subgrids by process as LoadParflowB writes them
+   *--------------------------------------------------------------------*/
+
+  num_procs = -1;
+  ForSubgridI(s_i, all_subgrids)
+  {
+    process = SubgridProcess(SubgridArraySubgrid(all_subgrids, s_i));
+
+    if (process > num_procs)
+      num_procs = process;
+  }
+  num_procs++;
+  num_subgrids = SubgridArraySize(all_subgrids);
+
+  out_subgrids = (DistSubgrid*)malloc((SubgridArraySize(all_subgrids) + 1) * sizeof(DistSubgrid));
+
+  strcpy(dist_name, out_name);
+  strcat(dist_name, ".dist");
+
+  if ((file = fopen(out_name, "wb")) == NULL)
+  {
+    free(in_subgrids);
+    free(out_subgrids);
+    return -1;
+  }
+
+  if ((dist_file = fopen(dist_name, "wb")) == NULL)
+  {
+    fclose(file);
+    free(in_subgrids);
+    free(out_subgrids);
+    return -1;
+  }
+
+  fprintf(dist_file, "0\n");
+
+  num_out = 0;
+  max_values = 0;
+  for (p = 0; p < num_procs; p++)
+  {
+    ForSubgridI(s_i, all_subgrids)
+    {
+      subgrid = SubgridArraySubgrid(all_subgrids, s_i);
+
+      if (SubgridProcess(subgrid) == p)
+      {
+        long plane = (long)SubgridNX(subgrid) * SubgridNY(subgrid);
+        long values = plane * SubgridNZ(subgrid);
+
+        /* if (process == 0), write header info */
+        if (!p && !num_out)
+        {
+          tools_WriteDouble(file, &BackgroundX(background), 1);
+          tools_WriteDouble(file, &BackgroundY(background), 1);
+          tools_WriteDouble(file, &BackgroundZ(background), 1);
+
+          tools_WriteInt(file, &NX, 1);
+          tools_WriteInt(file, &NY, 1);
+          tools_WriteInt(file, &NZ, 1);
+
+          tools_WriteDouble(file, &BackgroundDX(background), 1);
+          tools_WriteDouble(file, &BackgroundDY(background), 1);
+          tools_WriteDouble(file, &BackgroundDZ(background), 1);
+
+          tools_WriteInt(file, &num_subgrids, 1);
+
+          file_pos += 6 * tools_SizeofDouble + 4 * tools_SizeofInt;
+        }
+
+        tools_WriteInt(file, &SubgridIX(subgrid), 1);
+        tools_WriteInt(file, &SubgridIY(subgrid), 1);
+        tools_WriteInt(file, &SubgridIZ(subgrid), 1);
+
+        tools_WriteInt(file, &SubgridNX(subgrid), 1);
+        tools_WriteInt(file, &SubgridNY(subgrid), 1);
+        tools_WriteInt(file, &SubgridNZ(subgrid), 1);
+
+        tools_WriteInt(file, &SubgridRX(subgrid), 1);
+        tools_WriteInt(file, &SubgridRY(subgrid), 1);
+        tools_WriteInt(file, &SubgridRZ(subgrid), 1);
+
+        file_pos += 9 * tools_SizeofInt;
+
+        out_subgrids[num_out].subgrid = subgrid;
+        out_subgrids[num_out].offset = file_pos;
+        num_out++;
+
+        if (plane > 0)
+        {
+          long piece = (plane < DIST_PIECE_VALUES) ?
+                       (DIST_PIECE_VALUES / plane) * plane : plane;
+          if (piece > values)
+            piece = values;
+          if (piece > max_values)
+            max_values = (int)piece;
+        }
+
+        /* leave room for the values, they are written below */
+        file_pos += values * tools_SizeofDouble;
+        fseek(file, file_pos, SEEK_SET);
+      }
+    }
+
+    /* each process reads its subgrids from one offset */
+    fprintf(dist_file, "%ld\n", file_pos);
+  }
+
+  if (ferror(file))
+    failed = 1;
+  if (fclose(file))
+    failed = 1;
+  if (fclose(dist_file))
+    failed = 1;
+
+  /*--------------------------------------------------------------------
+   * Copy the values of each output subgrid
+   *--------------------------------------------------------------------*/
+
+  if (!failed && max_values > 0)
+  {
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      FILE *in_file = fopen(in_name, "rb");
+      FILE *out_file = fopen(out_name, "r+b");
+      char *buffer = (char*)malloc((size_t)max_values * 8);
+      char *rows = (char*)malloc(((size_t)DIST_PIECE_VALUES + NX) * 8);
+      int ok = (in_file != NULL) && (out_file != NULL);
+      int o;
+
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic)
+#endif
+      for (o = 0; o < num_out; o++)
+      {
+        Subgrid *sg = out_subgrids[o].subgrid;
+        long plane = (long)SubgridNX(sg) * SubgridNY(sg);
+        int step, z;
+
+        if (!ok || plane == 0)
+          continue;
+
+        step = (plane < DIST_PIECE_VALUES) ? (int)(DIST_PIECE_VALUES / plane) : 1;
+
+        for (z = 0; z < SubgridNZ(sg) && ok; z += step)
+        {
+          int nz = (z + step < SubgridNZ(sg)) ? step : SubgridNZ(sg) - z;
+
+          ok = DistCopyPlanes(in_file, in_subgrids, sizes[3], sg, z, nz, buffer, rows) &&
+               fseek(out_file, out_subgrids[o].offset + z * plane * 8, SEEK_SET) == 0 &&
+               fwrite(buffer, 8, (size_t)plane * nz, out_file) == (size_t)plane * nz;
+        }
+      }
+
+      if (in_file)
+        fclose(in_file);
+      if (out_file && fclose(out_file))
+        ok = 0;
+
+      if (!ok)
+      {
+#ifdef _OPENMP
+        #pragma omp atomic write
+#endif
+        failed = 1;
+      }
+
+      free(buffer);
+      free(rows);
+    }
+  }
+
+  free(in_subgrids);
+  free(out_subgrids);
+
+  return failed ? -1 : 0;
+}
+
+#endif
@@ -38,6 +38,7 @@ extern "C" {
 
 /* load.c */
 void LoadParflowB(char *filename, SubgridArray *all_subgrids, Background *background, Databox *databox);
+int DistParflowB(char *in_name, char *out_name, SubgridArray *all_subgrids, Background *background);
 
 #ifdef __cplusplus
 }
@@ -76,6 +76,8 @@ namespace eval Parflow {
     namespace export pfdist
     namespace export pfsave
     namespace export pfvtksave
+    namespace export pfxdmfsave
+    namespace export pfxdmfgeometry
     namespace export pfpatchysolid
     namespace export pfsolidfmtconvert
     namespace export pfgetelt
@@ -100,6 +102,7 @@ namespace eval Parflow {
     namespace export pfcellmultconst
     namespace export pfcelldivconst
     namespace export pfgetstats
+    namespace export pfreducepfb
     namespace export pfmdiff
     namespace export pfdiffelt
     namespace export pfsavediff
@@ -128,6 +131,7 @@ namespace eval Parflow {
     namespace export pffillflats
     namespace export pfpitfilldem
     namespace export pfmovingavgdem
+    namespace export pfpriorityfilldem
     namespace export pftopodeficit
     namespace export pfsattrans
     namespace export pfeffectiverecharge
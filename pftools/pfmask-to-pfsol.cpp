@@ -31,8 +31,11 @@
 
 #include "tclap/CmdLine.h"
 
+#include <array>
 #include <vector>
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -137,9 +140,9 @@ void writePFSOL(string filename, vector<Simplify::Vertex>* vertices, vector<Simp
   pfsolFile.precision(dbl::max_digits10);
 
   // Version
-  pfsolFile << "1" << std::endl;
+  pfsolFile << "1" << '\n';
 
-  pfsolFile << vertices -> size() << std::endl;
+  pfsolFile << vertices -> size() << '\n';
 
   for (auto it = vertices->begin(); it != vertices->end(); ++it)
   {
@@ -147,49 +150,51 @@ void writePFSOL(string filename, vector<Simplify::Vertex>* vertices, vector<Simp
     double y = (*it).p.y;
     double z = (*it).p.z;
 
-    pfsolFile << x << " " << y << " " << z << std::endl;
+    pfsolFile << x << " " << y << " " << z << '\n';
   }
 
   // Number of solids
-  pfsolFile << "1" << std::endl;
+  pfsolFile << "1" << '\n';
 
-  pfsolFile << triangles -> size() << std::endl;
+  pfsolFile << triangles -> size() << '\n';
 
   for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
   {
-    pfsolFile << (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << std::endl;
+    pfsolFile << (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << '\n';
   }
 
   // Number of patches
-  
-  // This looping is not very efficient but would require some extra data structures to eliminate.
-  pfsolFile << g_patchLabels.size() << std::endl;
+
+  // Collect the triangles of each patch in a single pass
+  std::map<int, std::vector<int> > patchTriangles;
   for(auto patch : g_patchLabels)
   {
-    int numTriangles = 0;
-    for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+    patchTriangles[patch];
+  }
+
+  int index = 0;
+  for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+  {
+    auto patch = patchTriangles.find((*it).patch);
+    if (patch != patchTriangles.end())
     {
-      if((*it).patch == patch)
-      {
-	numTriangles++;
-      }
+      patch -> second.push_back(index);
     }
-    
-    pfsolFile << numTriangles << std::endl;
 
-    std::cout << "Number of triangles in patch " << patch << " = " << numTriangles << std::endl;
+    ++index;
+  }
+
+  pfsolFile << g_patchLabels.size() << '\n';
+  for(auto patch : patchTriangles)
+  {
+    pfsolFile << patch.second.size() << '\n';
 
-    int index = 0;
-    for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
-    {
-      if((*it).patch == patch)
-      {
-	pfsolFile << index << std::endl;
-      }
+    std::cout << "Number of triangles in patch " << patch.first << " = " << patch.second.size() << std::endl;
 
-      ++index;
+    for(auto triangle : patch.second)
+    {
+      pfsolFile << triangle << '\n';
     }
-    
   }
 
   pfsolFile.close();
@@ -201,12 +206,12 @@ void writeVTK(string filename, vector<Simplify::Vertex>* vertices, vector<Simpli
 
   vtkFile.precision(dbl::max_digits10);
 
-  vtkFile << "# vtk DataFile Version 2.0" << std::endl;
-  vtkFile << filename << std::endl;
-  vtkFile << "ASCII" << std::endl;
+  vtkFile << "# vtk DataFile Version 2.0" << '\n';
+  vtkFile << filename << '\n';
+  vtkFile << "ASCII" << '\n';
 
-  vtkFile << "DATASET POLYDATA" << std::endl;
-  vtkFile << "POINTS " << vertices -> size() << " float" << std::endl;
+  vtkFile << "DATASET POLYDATA" << '\n';
+  vtkFile << "POINTS " << vertices -> size() << " float" << '\n';
 
   for (auto it = vertices->begin(); it != vertices->end(); ++it)
   {
@@ -214,27 +219,361 @@ void writeVTK(string filename, vector<Simplify::Vertex>* vertices, vector<Simpli
     double y = (*it).p.y;
     double z = (*it).p.z;
 
-    vtkFile << x << " " << y << " " << z << std::endl;
+    vtkFile << x << " " << y << " " << z << '\n';
   }
 
-  vtkFile << "POLYGONS " << triangles -> size() << " " << (3+1) * triangles -> size() << std::endl;
+  vtkFile << "POLYGONS " << triangles -> size() << " " << (3+1) * triangles -> size() << '\n';
   for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
   {
-    vtkFile << "3 " <<   (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << std::endl;
+    vtkFile << "3 " <<   (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << '\n';
   }
 
   // Write out patch labeling
-  vtkFile << "CELL_DATA " << triangles -> size() << std::endl;
-  vtkFile << "SCALARS patch_index int 1" << std::endl;
-  vtkFile << "LOOKUP_TABLE default" << std::endl;
+  vtkFile << "CELL_DATA " << triangles -> size() << '\n';
+  vtkFile << "SCALARS patch_index int 1" << '\n';
+  vtkFile << "LOOKUP_TABLE default" << '\n';
   for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
   {
-    vtkFile << (*it).patch << std::endl;
+    vtkFile << (*it).patch << '\n';
   }
 
   vtkFile.close();
 }
 
+/*
+ * Rows of the top and bottom faces are merged in independent bands of
+ * this many rows, so the result does not depend on the number of threads.
+ */
+#define MERGE_BAND_ROWS 64
+
+/*
+ * A rectangle of coplanar cell faces with the same patch label on one
+ * side of the domain.  Corners are given as vertex (i,j) indices; for the
+ * left/right faces i0 == i1 and for the front/back faces j0 == j1.
+ */
+struct MergedFace
+{
+  int patch;
+  int i0, j0;
+  int i1, j1;
+};
+
+/*
+ * Merge the top or bottom faces of the cells in rows [jlo,jhi) into
+ * rectangles.  A cell has a face if it is inside the domain (inside is
+ * nonzero) and faces are merged if their labels are equal.
+ */
+void mergeHorizontalFaces(int nx, int ny, int jlo, int jhi,
+			  const vector<int>& inside, const vector<int>& labels,
+			  vector<MergedFace>& faces)
+{
+  vector<char> done(nx * (jhi - jlo), 0);
+
+  for(int j = jlo; j < jhi; ++j)
+  {
+    for(int i = 0; i < nx; ++i)
+    {
+      if (!inside[ triangleIndex(i,j,0) ] || done[ (j - jlo) * nx + i ])
+      {
+	continue;
+      }
+
+      int label = labels[ triangleIndex(i,j,0) ];
+
+      // Grow along i, then along j while the whole run matches
+      int iend = i + 1;
+      while (iend < nx && inside[ triangleIndex(iend,j,0) ] && !done[ (j - jlo) * nx + iend ]
+	     && labels[ triangleIndex(iend,j,0) ] == label)
+      {
+	++iend;
+      }
+
+      int jend = j + 1;
+      while (jend < jhi)
+      {
+	int ii = i;
+	while (ii < iend && inside[ triangleIndex(ii,jend,0) ] && !done[ (jend - jlo) * nx + ii ]
+	       && labels[ triangleIndex(ii,jend,0) ] == label)
+	{
+	  ++ii;
+	}
+
+	if (ii < iend)
+	{
+	  break;
+	}
+	++jend;
+      }
+
+      for(int jj = j; jj < jend; ++jj)
+      {
+	for(int ii = i; ii < iend; ++ii)
+	{
+	  done[ (jj - jlo) * nx + ii ] = 1;
+	}
+      }
+
+      faces.push_back({label, i, j, iend, jend});
+    }
+  }
+}
+
+/*
+ * Build the boundary surface of the domain directly from merged faces.
+ *
+ * Instead of two triangles for every exposed cell face, coplanar faces
+ * with the same patch label are merged into rectangles (two triangles
+ * each): top and bottom faces into maximal rectangles within bands of
+ * rows, side faces into runs along the boundary.  The work for each side
+ * and band is independent and is done in parallel.  The triangles are
+ * returned grouped by patch.
+ *
+ * Where a corner of one rectangle lies on an edge of another the edge is
+ * split at that corner and the rectangle is triangulated as a fan around
+ * its center, so neighboring triangles always share whole edges.
+ */
+void buildMergedSurface(int nx, int ny, double sx, double sy, double sz,
+			double dx, double dy, double dz,
+			vector< vector<int> >& indicators,
+			vector<Simplify::Vertex>* vertices,
+			vector<Simplify::Triangle>* triangles)
+{
+  const vector<int>& inside = indicators[TOP];
+
+  int numBands = (ny + MERGE_BAND_ROWS - 1) / MERGE_BAND_ROWS;
+
+  // One task per band of top faces, per band of bottom faces and per
+  // column (left/right) or row (front/back) of side faces
+  int numTasks = 2 * numBands + 2 * nx + 2 * ny;
+  vector< vector<MergedFace> > taskFaces(numTasks);
+  vector<int> taskDirection(numTasks);
+
+#pragma omp parallel for schedule(dynamic)
+  for(int task = 0; task < numTasks; ++task)
+  {
+    vector<MergedFace>& faces = taskFaces[task];
+
+    if (task < 2 * numBands)
+    {
+      int direction = (task < numBands) ? TOP : BOTTOM;
+      int band = task % numBands;
+      int jhi = std::min(ny, (band + 1) * MERGE_BAND_ROWS);
+
+      taskDirection[task] = direction;
+      mergeHorizontalFaces(nx, ny, band * MERGE_BAND_ROWS, jhi, inside, indicators[direction], faces);
+    }
+    else if (task < 2 * numBands + 2 * nx)
+    {
+      // Left or right faces of column i are runs along j
+      int direction = (task < 2 * numBands + nx) ? LEFT : RIGHT;
+      int i = (task - 2 * numBands) % nx;
+      int neighbor = (direction == LEFT) ? i - 1 : i + 1;
+
+      taskDirection[task] = direction;
+      for(int j = 0; j < ny; ++j)
+      {
+	if (!inside[ triangleIndex(i,j,0) ]
+	    || (neighbor >= 0 && neighbor < nx && inside[ triangleIndex(neighbor,j,0) ]))
+	{
+	  continue;
+	}
+
+	int label = indicators[direction][ triangleIndex(i,j,0) ];
+	int x = (direction == LEFT) ? i : i + 1;
+
+	if (!faces.empty() && faces.back().j1 == j && faces.back().patch == label)
+	{
+	  faces.back().j1 = j + 1;
+	}
+	else
+	{
+	  faces.push_back({label, x, j, x, j + 1});
+	}
+      }
+    }
+    else
+    {
+      // Front or back faces of row j are runs along i
+      int direction = (task < 2 * numBands + 2 * nx + ny) ? FRONT : BACK;
+      int j = (task - 2 * numBands - 2 * nx) % ny;
+      int neighbor = (direction == FRONT) ? j - 1 : j + 1;
+
+      taskDirection[task] = direction;
+      for(int i = 0; i < nx; ++i)
+      {
+	if (!inside[ triangleIndex(i,j,0) ]
+	    || (neighbor >= 0 && neighbor < ny && inside[ triangleIndex(i,neighbor,0) ]))
+	{
+	  continue;
+	}
+
+	int label = indicators[direction][ triangleIndex(i,j,0) ];
+	int y = (direction == FRONT) ? j : j + 1;
+
+	if (!faces.empty() && faces.back().i1 == i && faces.back().patch == label)
+	{
+	  faces.back().i1 = i + 1;
+	}
+	else
+	{
+	  faces.push_back({label, i, y, i + 1, y});
+	}
+      }
+    }
+  }
+
+  // Order the faces by patch, keeping the task order within a patch
+  std::map<int, vector< std::pair<int, MergedFace> > > patchFaces;
+  for(int task = 0; task < numTasks; ++task)
+  {
+    for(auto face : taskFaces[task])
+    {
+      g_patchLabels.insert(face.patch);
+      patchFaces[face.patch].push_back(std::make_pair(taskDirection[task], face));
+    }
+  }
+
+  // Corners of a face in the order that gives outward normals, the same
+  // orientation as the per cell triangles
+  auto faceCorners = [](int direction, const MergedFace& f)
+		     {
+		       std::array< std::array<int, 3>, 4> c;
+		       switch (direction)
+		       {
+			 case TOP:
+			   c[0] = {f.i0,f.j0,1}; c[1] = {f.i1,f.j0,1}; c[2] = {f.i1,f.j1,1}; c[3] = {f.i0,f.j1,1};
+			   break;
+			 case BOTTOM:
+			   c[0] = {f.i0,f.j0,0}; c[1] = {f.i0,f.j1,0}; c[2] = {f.i1,f.j1,0}; c[3] = {f.i1,f.j0,0};
+			   break;
+			 case LEFT:
+			   c[0] = {f.i0,f.j0,0}; c[1] = {f.i0,f.j0,1}; c[2] = {f.i0,f.j1,1}; c[3] = {f.i0,f.j1,0};
+			   break;
+			 case RIGHT:
+			   c[0] = {f.i0,f.j0,0}; c[1] = {f.i0,f.j1,0}; c[2] = {f.i0,f.j1,1}; c[3] = {f.i0,f.j0,1};
+			   break;
+			 case FRONT:
+			   c[0] = {f.i0,f.j0,0}; c[1] = {f.i1,f.j0,0}; c[2] = {f.i1,f.j0,1}; c[3] = {f.i0,f.j0,1};
+			   break;
+			 default:
+			   c[0] = {f.i0,f.j0,0}; c[1] = {f.i0,f.j0,1}; c[2] = {f.i1,f.j0,1}; c[3] = {f.i1,f.j0,0};
+			   break;
+		       }
+		       return c;
+		     };
+
+  auto cornerIndex = [&](const std::array<int, 3>& c)
+		     {
+		       return ((long)(nx + 1) * (ny + 1) * c[2]) + ((long)c[1] * (nx + 1)) + c[0];
+		     };
+
+  // Mark the corners of all faces.  A corner of one face that lies on an
+  // edge of another is a T-junction; that face is split there so the
+  // triangles of neighboring faces share their edges.
+  vector<char> isCorner((long)(nx + 1) * (ny + 1) * 2, 0);
+  for(const auto& patch : patchFaces)
+  {
+    for(const auto& directionFace : patch.second)
+    {
+      for(const auto& c : faceCorners(directionFace.first, directionFace.second))
+      {
+	isCorner[ cornerIndex(c) ] = 1;
+      }
+    }
+  }
+
+  // Number the vertices in the order they are first used
+  std::unordered_map<long, int> vertexNumber;
+  auto vertex = [&](const std::array<int, 3>& c)
+		{
+		  long index = cornerIndex(c);
+		  auto it = vertexNumber.find(index);
+		  if (it != vertexNumber.end())
+		  {
+		    return it -> second;
+		  }
+
+		  Simplify::Vertex v;
+		  v.p.x = sx + c[0] * dx;
+		  v.p.y = sy + c[1] * dy;
+		  v.p.z = sz + c[2] * dz;
+		  v.used = true;
+		  v.new_index = vertices -> size();
+		  vertices -> push_back(v);
+		  vertexNumber[index] = v.new_index;
+		  return v.new_index;
+		};
+
+  auto addTriangle = [&](int patch, int v0, int v1, int v2)
+		     {
+		       Simplify::Triangle triangle;
+		       triangle.patch = patch;
+		       triangle.deleted = 0;
+		       triangle.v[0] = v0;
+		       triangle.v[1] = v1;
+		       triangle.v[2] = v2;
+		       triangles -> push_back(triangle);
+		     };
+
+  for(const auto& patch : patchFaces)
+  {
+    for(const auto& directionFace : patch.second)
+    {
+      std::array< std::array<int, 3>, 4> c = faceCorners(directionFace.first, directionFace.second);
+      int p = directionFace.second.patch;
+
+      // Walk the edges of the face and collect the corners on them
+      vector< std::array<int, 3> > polygon;
+      for(int n = 0; n < 4; ++n)
+      {
+	std::array<int, 3> point = c[n];
+	const std::array<int, 3>& next = c[(n + 1) % 4];
+	int axis = (point[0] != next[0]) ? 0 : ((point[1] != next[1]) ? 1 : 2);
+	int step = (next[axis] > point[axis]) ? 1 : -1;
+
+	polygon.push_back(point);
+	for(point[axis] += step; point[axis] != next[axis]; point[axis] += step)
+	{
+	  if (isCorner[ cornerIndex(point) ])
+	  {
+	    polygon.push_back(point);
+	  }
+	}
+      }
+
+      // Vertices are numbered in corner order, not in argument evaluation order
+      vector<int> v(polygon.size());
+      for(size_t n = 0; n < polygon.size(); ++n)
+      {
+	v[n] = vertex(polygon[n]);
+      }
+
+      if (polygon.size() == 4)
+      {
+	addTriangle(p, v[0], v[1], v[2]);
+	addTriangle(p, v[0], v[2], v[3]);
+      }
+      else
+      {
+	// Fan around a new vertex at the center of the face, which
+	// avoids degenerate triangles along the split edges
+	Simplify::Vertex center;
+	center.p.x = sx + 0.5 * (c[0][0] + c[2][0]) * dx;
+	center.p.y = sy + 0.5 * (c[0][1] + c[2][1]) * dy;
+	center.p.z = sz + 0.5 * (c[0][2] + c[2][2]) * dz;
+	center.used = true;
+	center.new_index = vertices -> size();
+	vertices -> push_back(center);
+
+	for(size_t n = 0; n < polygon.size(); ++n)
+	{
+	  addTriangle(p, v[n], v[(n + 1) % polygon.size()], center.new_index);
+	}
+      }
+    }
+  }
+}
+
 Databox         *ReadASCMask(
                              char * file_name,
                              double default_value)
@@ -334,6 +673,8 @@ int main(int argc, char **argv)
   int bottom;
   int side;
   float zTop,zBot;
+  bool mergeFaces;
+  bool simplify;
 
   try {  
 
@@ -361,6 +702,12 @@ int main(int argc, char **argv)
     TCLAP::ValueArg<float> zBotArg("","z-bottom","Set bottom of domain",false,NAN,"float");
     cmd.add( zBotArg );
 
+    TCLAP::SwitchArg mergeFacesArg("","merge-faces","Merge coplanar faces with the same patch label", false);
+    cmd.add( mergeFacesArg );
+
+    TCLAP::SwitchArg simplifyArg("","simplify","Simplify the merged surface (always done without --merge-faces)", false);
+    cmd.add( simplifyArg );
+
     TCLAP::ValueArg<string>* maskFilenamesArgs[g_maskNames.size()];
 
     int index = 0;
@@ -396,6 +743,8 @@ int main(int argc, char **argv)
     side = sideArg.getValue();;
     zTop = zTopArg.getValue();;
     zBot = zBotArg.getValue();;
+    mergeFaces = mergeFacesArg.getValue();
+    simplify = simplifyArg.getValue();
 
   }
   catch (TCLAP::ArgException &e)  // catch any exceptions
@@ -502,6 +851,26 @@ int main(int argc, char **argv)
 
   cout << endl;
 
+  if (mergeFaces)
+  {
+    vector<Simplify::Vertex> vertices;
+    vector<Simplify::Triangle> triangles;
+
+    buildMergedSurface(nx, ny, sx, sy, sz, dx, dy, dz, indicators, &vertices, &triangles);
+
+    Simplify::swap(vertices, triangles);
+
+    if (simplify)
+    {
+      Simplify::simplify_mesh_lossless();
+    }
+
+    writeVTK(vtkOutFilename, &Simplify::vertices, &Simplify::triangles);
+    writePFSOL(pfsolOutFilename, &Simplify::vertices, &Simplify::triangles);
+
+    return 0;
+  }
+
   vector<Simplify::Vertex>* vertices = new vector<Simplify::Vertex>((nx+1)*(ny+1)*(nz+1));
 
   vector<Simplify::Triangle>* triangles = new vector<Simplify::Triangle>();
@@ -190,6 +190,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfgetstats", (Tcl_CmdProc*)GetStatsCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfreducepfb", (Tcl_CmdProc*)ReducePFBCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfmdiff", (Tcl_CmdProc*)MDiffCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfdiffelt", (Tcl_CmdProc*)DiffEltCommand,
@@ -242,6 +244,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfmovingavgdem", (Tcl_CmdProc*)MovingAvgCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfpriorityfilldem", (Tcl_CmdProc*)PriorityFillCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsattrans", (Tcl_CmdProc*)SatTransmissivityCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pftopoindex", (Tcl_CmdProc*)TopoIndexCommand,
@@ -274,6 +278,10 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfvtksave", (Tcl_CmdProc*)SavePFVTKCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfxdmfsave", (Tcl_CmdProc*)SaveXDMFCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfxdmfgeometry", (Tcl_CmdProc*)SaveXDMFGeometryCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfpatchysolid", (Tcl_CmdProc*)MakePatchySolidCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsolidfmtconvert", (Tcl_CmdProc*)pfsolFmtConvert,
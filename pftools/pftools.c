@@ -73,6 +73,7 @@
 #include "water_table.h"
 #include "water_balance.h"
 #include "toposlopes.h"
+#include "reduce.h"
 
 #include "region.h"
 #include "grid.h"
@@ -131,7 +132,9 @@ int            PFDistCommand(
   Grid          *user_grid;
   SubgridArray  *all_subgrids;
 
+#ifdef AMPS_SPLIT_FILE
   Databox *inbox;
+#endif
 
   char command[1024];
 
@@ -196,35 +199,132 @@ int            PFDistCommand(
     background = ReadBackground(interp);
     user_grid = ReadUserGrid(interp);
 
-    int nz_in;
-    Subgrid     *user_subgrid = GridSubgrid(user_grid, 0);
-    if (nz_manual != 0)
-    {
-      nz_in = SubgridNZ(user_subgrid); // Save the correct nz
-      SubgridNZ(user_subgrid) = nz_manual; // Set the manual nz
-    }
     /*--------------------------------------------------------------------
-     * Get inbox from input_filename
+     * A process grid written by the simulator (WriteProcessGrid) is used
+     * as is; otherwise only the uniform lexicographic layout is known.
      *--------------------------------------------------------------------*/
+    if ((all_subgrids = ReadProcessGrid(interp)) != NULL)
+    {
+      if (nz_manual != 0)
+      {
+        int i;
 
-    inbox = Read(ParflowB, filename);
+        ForSubgridI(i, all_subgrids)
+        {
+          SubgridIZ(SubgridArraySubgrid(all_subgrids, i)) = 0;
+          SubgridNZ(SubgridArraySubgrid(all_subgrids, i)) = nz_manual;
+        }
+      }
+    }
+    else
+    {
+      char *method = GetString(interp, "Process.Topology.Method");
+      char *mapping = GetString(interp, "Process.Topology.Mapping");
+      int unsupported = (method && strcmp(method, "Uniform")) ||
+                        (mapping && strcmp(mapping, "Lexicographic"));
+
+      free(method);
+      free(mapping);
+
+      if (unsupported)
+      {
+        printf("Error: pfdist only computes the Uniform, Lexicographic process topology\n");
+        printf("       run with Process.Topology.WriteProcessGrid and source the\n");
+        printf("       written process_grid.tcl before calling pfdist\n");
+
+        FreeBackground(background);
+        FreeGrid(user_grid);
+        return TCL_ERROR;
+      }
+
+      int nz_in;
+      Subgrid     *user_subgrid = GridSubgrid(user_grid, 0);
+      if (nz_manual != 0)
+      {
+        nz_in = SubgridNZ(user_subgrid); // Save the correct nz
+        SubgridNZ(user_subgrid) = nz_manual; // Set the manual nz
+      }
+      /*------------------------------------------------------------------
+       * Load the data
+       *------------------------------------------------------------------*/
+
+      all_subgrids = DistributeUserGrid(user_grid, num_procs,
+                                        num_procs_x, num_procs_y, num_procs_z);
+      if (nz_manual != 0)
+      {
+        SubgridNZ(user_subgrid) = nz_in;  // Restore the correct nz
+      }
+      if (!all_subgrids)
+      {
+        printf("Incorrect process allocation input\n");
+        exit(1);
+      }
+
+      /*------------------------------------------------------------------
+       * Split each process block the way the simulator does for
+       * Process.Topology.Subgrids.P/Q
+       *------------------------------------------------------------------*/
+      int split_p = GetIntDefault(interp, "Process.Topology.Subgrids.P", 1);
+      int split_q = GetIntDefault(interp, "Process.Topology.Subgrids.Q", 1);
+
+      if (split_p * split_q > 1)
+      {
+        SubgridArray *split_subgrids = SplitUserGrid(all_subgrids,
+                                                     split_p, split_q);
+        FreeSubgridArray(all_subgrids);
+
+        if (!split_subgrids)
+        {
+          printf("Error: Process.Topology.Subgrids.P/Q exceed the process block size\n");
+
+          FreeBackground(background);
+          FreeGrid(user_grid);
+          return TCL_ERROR;
+        }
+        all_subgrids = split_subgrids;
+      }
+    }
 
+#ifndef AMPS_SPLIT_FILE
     /*--------------------------------------------------------------------
-     * Load the data
+     * Copy the file to its distributed form subgrid by subgrid; the
+     * original is kept as filename.bak until the copy is complete.
      *--------------------------------------------------------------------*/
 
-    all_subgrids = DistributeUserGrid(user_grid, num_procs,
-                                      num_procs_x, num_procs_y, num_procs_z);
-    if (nz_manual != 0)
+    sprintf(command, "%s.bak", filename);
+
+    int failed = rename(filename, command);
+
+    if (!failed && DistParflowB(command, filename, all_subgrids, background))
     {
-      SubgridNZ(user_subgrid) = nz_in;  // Restore the correct nz
+      char dist_name[1024];
+
+      /* drop the partial copy before the original is restored */
+      sprintf(dist_name, "%s.dist", filename);
+      remove(dist_name);
+
+      rename(command, filename);
+      failed = 1;
     }
-    if (!all_subgrids)
+
+    if (failed)
     {
-      printf("Incorrect process allocation input\n");
-      exit(1);
+      FreeBackground(background);
+      FreeGrid(user_grid);
+      FreeSubgridArray(all_subgrids);
+
+      ReadWriteError(interp);
+      return TCL_ERROR;
     }
 
+    remove(command);
+#else
+    /*--------------------------------------------------------------------
+     * Get inbox from input_filename
+     *--------------------------------------------------------------------*/
+
+    inbox = Read(ParflowB, filename);
+
 #ifdef _WIN32
     sprintf(command, "move %s %s.bak", filename, filename);
     system(command);
@@ -243,11 +343,12 @@ int            PFDistCommand(
     unlink(command);
 #endif
 
+    FreeDatabox(inbox);
+#endif
 
     FreeBackground(background);
     FreeGrid(user_grid);
     FreeSubgridArray(all_subgrids);
-    FreeDatabox(inbox);
 
     return TCL_OK;
   }
@@ -1099,8 +1200,18 @@ int            LoadPFCommand(
   char newhashkey[MAX_KEY_SIZE];
 
   double default_value = 0.0;
+  int lazy = 0;
 
 
+  /* -lazy decodes the z layers of a pfb file when they are first used */
+
+  if (argc > 1 && strcmp(argv[1], "-lazy") == 0)
+  {
+    lazy = 1;
+    argc--;
+    argv++;
+  }
+
   /* Check and see if there is at least one argument following  */
   /* the command.                                               */
 
@@ -1170,7 +1281,7 @@ int            LoadPFCommand(
   }
 
   if (strcmp(filetype, "pfb") == 0)
-    databox = ReadParflowB(filename, default_value);
+    databox = MapParflowB(filename, default_value, lazy);
   else if (strcmp(filetype, "pfsb") == 0)
     databox = ReadParflowSB(filename, default_value);
   else if (strcmp(filetype, "sa") == 0)
@@ -1436,6 +1547,79 @@ int               SavePFCommand(
   return TCL_OK;
 }
 
+/*-----------------------------------------------------------------------
+ * Compute the points of a terrain following grid for the cells of
+ * databox.  The top of the grid follows the top layer of dem, which is
+ * interpolated to the cell corners, and layer k of points lies
+ * c_dz[k] - zoffset below it.  Returns nzp * (nx+1) * (ny+1) points as
+ * x, y, z triples with x varying fastest.
+ *-----------------------------------------------------------------------*/
+
+static double *ComputeTFGPoints(
+                                Databox *databox,
+                                Databox *dem,
+                                int      nzp,
+                                double * c_dz,
+                                double   zoffset)
+{
+  int nx = DataboxNx(databox);
+  int ny = DataboxNy(databox);
+  int nz2 = DataboxNz(dem);
+  int nxp = nx + 1;
+  int nyp = ny + 1;
+
+  double x = DataboxX(databox);
+  double y = DataboxY(databox);
+  double dx = DataboxDx(databox);
+  double dy = DataboxDy(databox);
+
+  double *Xp = (double*)malloc(sizeof(double) * nxp * nyp * nzp * 3);
+  double elev;
+  int i, j, k;
+  int imn, jmn, imx, jmx;
+  long n = 0;
+
+  for (k = 0; k < nzp; ++k)
+  {
+    for (j = 0; j < nyp; ++j)
+    {
+      for (i = 0; i < nxp; ++i)
+      {
+        Xp[n] = x + i * dx;
+        Xp[n + 1] = y + j * dy;
+
+        /*  Simple interpolation */
+        imn = -1;
+        jmn = -1;
+        imx = 0;
+        jmx = 0;
+        if (i == 0)
+        {
+          imn = 0;
+        }
+        if (i >= nx)
+        {
+          imx = -1;
+        }
+        if (j == 0)
+        {
+          jmn = 0;
+        }
+        if (j >= ny)
+        {
+          jmx = -1;
+        }
+        elev = (*DataboxCoeff(dem, i + imn, j + jmn, nz2 - 1) + *DataboxCoeff(dem, i + imx, j + jmn, nz2 - 1) +
+                *DataboxCoeff(dem, i + imn, j + jmx, nz2 - 1) + *DataboxCoeff(dem, i + imx, j + jmx, nz2 - 1)) / 4.0;
+        Xp[n + 2] = elev - zoffset + c_dz[k];
+        n = n + 3;
+      }
+    }
+  }
+
+  return Xp;
+}
+
 /*-----------------------------------------------------------------------
  * routine for `pfvtksave' command
  * Description: The first argument to this command is the hashkey of the
@@ -1456,7 +1640,7 @@ int SavePFVTKCommand(
 
   char          *filename;
   char          *varname;
-  int i, j, k;
+  int i;
   int flt = 0;
   char          *dzlist_in;
   char*         Endp1=0;
@@ -1655,7 +1839,6 @@ int SavePFVTKCommand(
     int nz = DataboxNz(databox);
     int nx2 = DataboxNx(databox2);        // DEM
     int ny2 = DataboxNy(databox2);
-    int nz2 = DataboxNz(databox2);
 
     if ((nx != nx2) || (ny != ny2))
     {
@@ -1663,98 +1846,23 @@ int SavePFVTKCommand(
       return TCL_ERROR;
     }
 
-    double x = DataboxX(databox);
-    double y = DataboxY(databox);
-
-    double dx = DataboxDx(databox);
-    double dy = DataboxDy(databox);
     double dz = DataboxDz(databox);
 
-    int nxp = nx + 1;
-    int nyp = ny + 1;
     int nzp = nz + 1;
-    int nxyzp = nxp * nyp * nzp;
-    int n = 0;
 
     double *Xp;
 
-    double elev = 0;
     double zoffset = nz * dz;
 
-    /* CLM mode uses 1-layer, adjust accordingly */
-    int nzl = 0;
-
-    int imn, jmn, imx, jmx;
-
     if ((strcmp(argv[2], "-clmvtk") == 0))
     {
-      nzp = 2;
-      nzl = 0;
-      zoffset = dz;
-      Xp = (double*)malloc(sizeof(double) * (nxp * nyp * 2) * 3);
-      // Block for CLM case
-      for (k = nzl; k < nzp; ++k)
-      {
-        for (j = 0; j < nyp; ++j)
-        {
-          for (i = 0; i < nxp; ++i)
-          {
-            Xp[n] = x + i * dx;
-            Xp[n + 1] = y + j * dy;
-            //
-            if (1 == 0)
-            {
-              /* Simple method, use cell elevation, duplicate edge point */
-              imn = 0;
-              jmn = 0;
-              if (i >= nx)
-              {
-                imn = -1;
-              }
-              if (j >= ny)
-              {
-                jmn = -1;
-              }
-              elev = *DataboxCoeff(databox2, i + imn, j + jmn, nz2 - 1);
-              Xp[n + 2] = elev - zoffset + dz * (double)k;
-            }
-            else
-            {
-              /*  Simple interpolation */
-              imn = -1;
-              jmn = -1;
-              imx = 0;
-              jmx = 0;
-              if (i == 0)
-              {
-                imn = 0;
-              }
-              if (i >= nx)
-              {
-                imx = -1;
-              }
-              if (j == 0)
-              {
-                jmn = 0;
-              }
-              if (j >= ny)
-              {
-                jmx = -1;
-              }
-              elev = (*DataboxCoeff(databox2, i + imn, j + jmn, nz2 - 1) + *DataboxCoeff(databox2, i + imx, j + jmn, nz2 - 1) +
-                      *DataboxCoeff(databox2, i + imn, j + jmx, nz2 - 1) + *DataboxCoeff(databox2, i + imx, j + jmx, nz2 - 1)) / 4.0;
-              Xp[n + 2] = elev - zoffset + dz * (double)k;
-            }
-            n = n + 3;
-          }
-        }
-      }
-      // End block for CLM case
+      /* CLM mode uses 1-layer, adjust accordingly */
+      double c_dz[2] = { 0.0, dz };
+
+      Xp = ComputeTFGPoints(databox, databox2, 2, c_dz, dz);
     }
     else
     {
-      Xp = (double*)malloc(sizeof(double) * nxyzp * 3);
-
       if ((strcmp(dzlist_in, "-999999") != 0) && (dz_els != (nzp - 1)))
       {
         printf("ERROR: Num els of Var_dz list not equal to nz!  \n");
@@ -1787,67 +1895,7 @@ int SavePFVTKCommand(
         }
       }
 
-      /* compute point locations */
-      for (k = nzl; k < nzp; ++k)
-      {
-        for (j = 0; j < nyp; ++j)
-        {
-          for (i = 0; i < nxp; ++i)
-          {
-            Xp[n] = x + i * dx;
-            Xp[n + 1] = y + j * dy;
-            //
-            if (1 == 0)
-            {
-              /* Simple method, use cell elevation, duplicate edge point */
-              imn = 0;
-              jmn = 0;
-              if (i >= nx)
-              {
-                imn = -1;
-              }
-              if (j >= ny)
-              {
-                jmn = -1;
-              }
-              elev = *DataboxCoeff(databox2, i + imn, j + jmn, nz2 - 1);
-              //                        Xp[n+2] = elev - zoffset + dz*(double)k;  // NBE commented
-              Xp[n + 2] = elev - zoffset + c_dz[k];
-            }
-            else
-            {
-              /*  Simple interpolation */
-              imn = -1;
-              jmn = -1;
-              imx = 0;
-              jmx = 0;
-              if (i == 0)
-              {
-                imn = 0;
-              }
-              if (i >= nx)
-              {
-                imx = -1;
-              }
-              if (j == 0)
-              {
-                jmn = 0;
-              }
-              if (j >= ny)
-              {
-                jmx = -1;
-              }
-              elev = (*DataboxCoeff(databox2, i + imn, j + jmn, nz2 - 1) + *DataboxCoeff(databox2, i + imx, j + jmn, nz2 - 1) +
-                      *DataboxCoeff(databox2, i + imn, j + jmx, nz2 - 1) + *DataboxCoeff(databox2, i + imx, j + jmx, nz2 - 1)) / 4.0;
-              //                        Xp[n+2] = elev - zoffset + dz*(double)k; // NBE commented
-              Xp[n + 2] = elev - zoffset + c_dz[k];
-            }
-            n = n + 3;
-          }
-        }
-      }
-
-      // End of normal block
+      Xp = ComputeTFGPoints(databox, databox2, nzp, c_dz, zoffset);
     }
 
     /* Make sure the file could be opened, then write to it */
@@ -1859,18 +1907,19 @@ int SavePFVTKCommand(
     if ((strcmp(argv[2], "-vtk") == 0))
     {
       PrintTFG_VTK(fp, databox, Xp, varname, flt);
-      return TCL_OK;
     }
     else if ((strcmp(argv[2], "-clmvtk") == 0))
     {
       PrintTFG_CLMVTK(fp, databox, Xp, varname, flt);
-      return TCL_OK;
     }
     else
     {
       printf("ERROR: Invalid filetype \n");
+      free(Xp);
+      fclose(fp);
       return TCL_ERROR;
     }
+    free(Xp);
     fclose(fp);
     return TCL_OK;
   }   // END OF ARGC LOGICAL
@@ -1886,6 +1935,301 @@ int SavePFVTKCommand(
 // END of PFVsave
 /* -------------------------------------------------------------------------------------- */
 
+/*-----------------------------------------------------------------------
+ * routine for `pfxdmfsave' command
+ * Description: The first argument to this command is the hashkey of the
+ *              dataset to be saved, the second is the name of the XDMF
+ *              file.  The values are written as raw binary to a file of
+ *              the same name with the extension .bin.  The remaining
+ *              arguments are optional and can be in any order.
+ * Cmd. syntax: pfxdmfsave dataset filename [-var name -flt -time value -geometry geometryfile]
+ *-----------------------------------------------------------------------*/
+
+int SaveXDMFCommand(
+                    ClientData  clientData,
+                    Tcl_Interp *interp,
+                    int         argc,
+                    char *      argv[])
+{
+  Data          *data = (Data*)clientData;
+
+  char          *hashkey;
+  char          *filename;
+  char          *datafile;
+  char          *varname = "variable";
+  char          *geometry = NULL;
+  char          *time = NULL;
+  char          *path, *slash, *ext;
+  int flt = 0;
+  int i, failed;
+  double value;
+
+  FILE          *fp;
+
+  Tcl_HashEntry *entryPtr;
+  Databox       *databox;
+
+  if (argc < 3)
+  {
+    WrongNumArgsError(interp, SAVEXDMFUSAGE);
+    return TCL_ERROR;
+  }
+
+  hashkey = argv[1];
+  filename = argv[2];
+
+  /* Scan through the argument list and match options */
+  for (i = 3; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-flt") == 0)
+    {
+      flt = 1;
+    }
+    else if ((strcmp(argv[i], "-var") == 0) && (i + 1 < argc))
+    {
+      varname = argv[++i];
+    }
+    else if ((strcmp(argv[i], "-time") == 0) && (i + 1 < argc))
+    {
+      if (Tcl_GetDouble(interp, argv[i + 1], &value) == TCL_ERROR)
+      {
+        NotADoubleError(interp, i + 1, SAVEXDMFUSAGE);
+        return TCL_ERROR;
+      }
+      time = argv[++i];
+    }
+    else if ((strcmp(argv[i], "-geometry") == 0) && (i + 1 < argc))
+    {
+      geometry = argv[++i];
+    }
+    else
+    {
+      InvalidOptionError(interp, i, SAVEXDMFUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if ((databox = DataMember(data, hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, hashkey);
+    return TCL_ERROR;
+  }
+
+  /* The .bin file is next to the XDMF file, which refers to it by its
+   * name alone; an .xmf extension is replaced */
+  datafile = (char*)malloc(strlen(filename) + 5);
+  strcpy(datafile, filename);
+  ext = strrchr(datafile, '.');
+  if (ext && (strcmp(ext, ".xmf") == 0))
+  {
+    *ext = '\0';
+  }
+  strcat(datafile, ".bin");
+
+  slash = strrchr(filename, '/');
+
+  /* Like the data, the geometry is found relative to the XDMF file.  Make
+   * sure it exists and has a point for every corner of the cells. */
+  if (geometry)
+  {
+    long size = -1;
+
+    path = (char*)malloc(strlen(filename) + strlen(geometry) + 1);
+    if (slash && (geometry[0] != '/'))
+    {
+      strncpy(path, filename, slash - filename + 1);
+      strcpy(path + (slash - filename + 1), geometry);
+    }
+    else
+    {
+      strcpy(path, geometry);
+    }
+
+    if ((fp = fopen(path, "rb")) != NULL)
+    {
+      fseek(fp, 0, SEEK_END);
+      size = ftell(fp);
+      fclose(fp);
+    }
+
+    if (size != (long)(DataboxNx(databox) + 1) * (DataboxNy(databox) + 1) * (DataboxNz(databox) + 1) * 3 * sizeof(double))
+    {
+      Tcl_AppendResult(interp, "\nError: Geometry file ", path,
+                       " is missing or does not match the dataset\n", SAVEXDMFUSAGE, (char*)NULL);
+      free(path);
+      free(datafile);
+      return TCL_ERROR;
+    }
+
+    free(path);
+  }
+
+  if ((fp = fopen(datafile, "wb")) == NULL)
+  {
+    free(datafile);
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  PrintRaw(fp, databox, flt);
+  failed = ferror(fp);
+  failed |= fclose(fp);
+
+  if (!failed && ((fp = fopen(filename, "w")) != NULL))
+  {
+    slash = strrchr(datafile, '/');
+    PrintXDMF(fp, databox, varname, slash ? slash + 1 : datafile, geometry, time, flt);
+    failed = ferror(fp);
+    failed |= fclose(fp);
+  }
+  else
+  {
+    failed = 1;
+  }
+
+  free(datafile);
+
+  if (failed)
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
+/*-----------------------------------------------------------------------
+ * routine for `pfxdmfgeometry' command
+ * Description: Writes the points of the terrain following grid of a
+ *              dataset, shifted to the top layer of a DEM as in
+ *              pfvtksave, as raw native doubles for pfxdmfsave -geometry.
+ *              The grid is written once and shared by a whole series.
+ *              -tfg gives the layer thicknesses from the bottom up
+ *              instead of the dz of the dataset.
+ * Cmd. syntax: pfxdmfgeometry dataset dem filename [-tfg dzlist]
+ *-----------------------------------------------------------------------*/
+
+int SaveXDMFGeometryCommand(
+                            ClientData  clientData,
+                            Tcl_Interp *interp,
+                            int         argc,
+                            char *      argv[])
+{
+  Data          *data = (Data*)clientData;
+
+  char          *hashkey, *demhash;
+  char          *filename;
+  char         **dzlist = NULL;
+  int num_dz = 0;
+  int nz, k, dz_els, failed;
+  double zoffset;
+  double        *c_dz;
+  double        *Xp;
+
+  FILE          *fp;
+
+  Tcl_HashEntry *entryPtr;
+  Databox       *databox, *dem;
+
+  if ((argc != 4) && (argc != 6))
+  {
+    WrongNumArgsError(interp, SAVEXDMFGEOMETRYUSAGE);
+    return TCL_ERROR;
+  }
+
+  hashkey = argv[1];
+  demhash = argv[2];
+  filename = argv[3];
+
+  if ((databox = DataMember(data, hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, hashkey);
+    return TCL_ERROR;
+  }
+
+  if ((dem = DataMember(data, demhash, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, demhash);
+    return TCL_ERROR;
+  }
+
+  if ((DataboxNx(databox) != DataboxNx(dem)) || (DataboxNy(databox) != DataboxNy(dem)))
+  {
+    DimensionError(interp);
+    return TCL_ERROR;
+  }
+
+  nz = DataboxNz(databox);
+
+  if (argc == 6)
+  {
+    if (strcmp(argv[4], "-tfg") != 0)
+    {
+      InvalidOptionError(interp, 4, SAVEXDMFGEOMETRYUSAGE);
+      return TCL_ERROR;
+    }
+
+    if (Tcl_SplitList(interp, argv[5], &num_dz, (const char ***)&dzlist) == TCL_ERROR)
+    {
+      return TCL_ERROR;
+    }
+
+    if ((num_dz != nz + 1) || (Tcl_GetInt(interp, dzlist[0], &dz_els) == TCL_ERROR) || (dz_els != nz))
+    {
+      Tcl_Free((char*)dzlist);
+      Tcl_ResetResult(interp);
+      InvalidArgError(interp, 5, SAVEXDMFGEOMETRYUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  /* Bottom of each layer of points, measured from the bottom of the grid */
+  c_dz = (double*)malloc(sizeof(double) * (nz + 1));
+  c_dz[0] = 0.0;
+  for (k = 1; k <= nz; ++k)
+  {
+    double dz = DataboxDz(databox);
+
+    if (dzlist && (Tcl_GetDouble(interp, dzlist[k], &dz) == TCL_ERROR))
+    {
+      Tcl_Free((char*)dzlist);
+      free(c_dz);
+      NotADoubleError(interp, 5, SAVEXDMFGEOMETRYUSAGE);
+      return TCL_ERROR;
+    }
+    c_dz[k] = c_dz[k - 1] + dz;
+  }
+  zoffset = dzlist ? c_dz[nz] : nz * DataboxDz(databox);
+
+  if (dzlist)
+  {
+    Tcl_Free((char*)dzlist);
+  }
+
+  Xp = ComputeTFGPoints(databox, dem, nz + 1, c_dz, zoffset);
+  free(c_dz);
+
+  if ((fp = fopen(filename, "wb")) == NULL)
+  {
+    free(Xp);
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  fwrite(Xp, sizeof(double), (size_t)(DataboxNx(databox) + 1) * (DataboxNy(databox) + 1) * (nz + 1) * 3, fp);
+  failed = ferror(fp);
+  failed |= fclose(fp);
+  free(Xp);
+
+  if (failed)
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
 /*-----------------------------------------------------------------------
  * routine for `pfpatchysolid' command
  *-----------------------------------------------------------------------*/
@@ -2463,7 +2807,7 @@ int               GetEltCommand(
 
   /* Make sure the data set name(hashkey) exists */
 
-  if ((databox = DataMember(data, hashkey, entryPtr)) == NULL)
+  if ((databox = DataMemberLazy(data, hashkey, entryPtr)) == NULL)
   {
     SetNonExistantError(interp, argv[1]);
     return TCL_ERROR;
@@ -2497,6 +2841,12 @@ int               GetEltCommand(
     return TCL_ERROR;
   }
 
+  if (DataboxLoad(databox, k, 1))
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
   result = Tcl_NewDoubleObj(*DataboxCoeff(databox, i, j, k));
   Tcl_SetObjResult(interp, result);
 
@@ -2536,7 +2886,7 @@ int               GetGridCommand(
 
   /* Make sure that the dat set given exists */
 
-  if ((databox = DataMember(data, argv[1], entryPtr)) == NULL)
+  if ((databox = DataMemberLazy(data, argv[1], entryPtr)) == NULL)
   {
     SetNonExistantError(interp, argv[1]);
     return TCL_ERROR;
@@ -4488,6 +4838,129 @@ int               GetStatsCommand(
 
 
 
+/*-----------------------------------------------------------------------
+ * routine for `pfreducepfb' command
+ * Description: The files basename.start.pfb, basename.(start+interval).pfb,
+ *              ... up to basename.stop.pfb (step numbers printed as %05d,
+ *              as ParFlow writes them) are reduced cell by cell without
+ *              being loaded.  For each operation in the operations list
+ *              (mean, min, max, sum or variance) the file
+ *              output.operation.pfb is written.  A list of the files
+ *              written is returned.
+ *
+ * Cmd. Syntax: pfreducepfb basename start stop interval operations output
+ *-----------------------------------------------------------------------*/
+
+int               ReducePFBCommand(
+                                   ClientData  clientData,
+                                   Tcl_Interp *interp,
+                                   int         argc,
+                                   char *      argv[])
+{
+  int start, stop, interval;
+  int operations, operation;
+  int num_names, n, op;
+  char         **names;
+  char          *output;
+  char          *file_name;
+
+  /* Six arguments must be given */
+
+  if (argc != 7)
+  {
+    WrongNumArgsError(interp, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_GetInt(interp, argv[2], &start) == TCL_ERROR)
+  {
+    NotAnIntError(interp, 2, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_GetInt(interp, argv[3], &stop) == TCL_ERROR)
+  {
+    NotAnIntError(interp, 3, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_GetInt(interp, argv[4], &interval) == TCL_ERROR)
+  {
+    NotAnIntError(interp, 4, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (interval <= 0)
+  {
+    NumberNotPositiveError(interp, 4);
+    return TCL_ERROR;
+  }
+
+  if (stop < start)
+  {
+    InvalidArgError(interp, 3, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  /* The operations are a list of names */
+
+  if (Tcl_SplitList(interp, argv[5], &num_names, (const char ***)&names) == TCL_ERROR)
+  {
+    return TCL_ERROR;
+  }
+
+  operations = 0;
+  for (n = 0; n < num_names; n++)
+  {
+    operation = 0;
+    for (op = 0; op < REDUCE_NUM_OPERATIONS; op++)
+    {
+      if (strcmp(names[n], ReduceOperationName(1 << op)) == 0)
+      {
+        operation = 1 << op;
+      }
+    }
+
+    if (!operation)
+    {
+      Tcl_Free((char*)names);
+      InvalidArgError(interp, 5, REDUCEPFBUSAGE);
+      return TCL_ERROR;
+    }
+
+    operations |= operation;
+  }
+  Tcl_Free((char*)names);
+
+  if (!operations)
+  {
+    InvalidArgError(interp, 5, REDUCEPFBUSAGE);
+    return TCL_ERROR;
+  }
+
+  output = argv[6];
+
+  if (ReducePFBSeries(argv[1], start, stop, interval, operations, output) < 0)
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  file_name = (char*)malloc(strlen(output) + 32);
+  for (op = 0; op < REDUCE_NUM_OPERATIONS; op++)
+  {
+    if (operations & (1 << op))
+    {
+      sprintf(file_name, "%s.%s.pfb", output, ReduceOperationName(1 << op));
+      Tcl_AppendElement(interp, file_name);
+    }
+  }
+  free(file_name);
+
+  return TCL_OK;
+}
+
+
 /*-----------------------------------------------------------------------
  * routine for `pfmdiff' command
  * Description: Two data set hash keys are given as the first two arguments.
@@ -4938,7 +5411,7 @@ int               DeleteCommand(
 
   /* Make sure the data set exists */
 
-  if ((databox = DataMember(data, argv[1], entryPtr)) == NULL)
+  if ((databox = DataMemberLazy(data, argv[1], entryPtr)) == NULL)
   {
     SetNonExistantError(interp, argv[1]);
     return TCL_ERROR;
@@ -4985,7 +5458,7 @@ int            ComputeTopCommand(
 
   mask_hashkey = argv[1];
 
-  if ((mask = DataMember(data, mask_hashkey, entryPtr)) == NULL)
+  if ((mask = DataMemberLazy(data, mask_hashkey, entryPtr)) == NULL)
   {
     SetNonExistantError(interp, mask_hashkey);
     return TCL_ERROR;
@@ -5006,6 +5479,13 @@ int            ComputeTopCommand(
     /* create the new databox structure for top */
     if ((top = NewDatabox(nx, ny, 1, x, y, z, dx, dy, dz)))
     {
+      if (ComputeTop(mask, top))
+      {
+        FreeDatabox(top);
+        ReadWriteError(interp);
+        return TCL_ERROR;
+      }
+
       /* Make sure the data set pointer was added to */
       /* the hash table successfully.                */
 
@@ -5015,8 +5495,6 @@ int            ComputeTopCommand(
       {
         Tcl_AppendElement(interp, newhashkey);
       }
-
-      ComputeTop(mask, top);
     }
     else
     {
@@ -5146,7 +5624,7 @@ int            ExtractTopCommand(
     return TCL_ERROR;
   }
 
-  if ((databox = DataMember(data, data_hashkey, entryPtr)) == NULL)
+  if ((databox = DataMemberLazy(data, data_hashkey, entryPtr)) == NULL)
   {
     SetNonExistantError(interp, data_hashkey);
     return TCL_ERROR;
@@ -5167,17 +5645,22 @@ int            ExtractTopCommand(
     /* create the new databox structure for top */
     if ((top_values = NewDatabox(nx, ny, 1, x, y, z, dx, dy, dz)))
     {
+      if (ExtractTop(top, databox, top_values))
+      {
+        FreeDatabox(top_values);
+        ReadWriteError(interp);
+        return TCL_ERROR;
+      }
+
       /* Make sure the data set pointer was added to */
       /* the hash table successfully.                */
 
       if (!AddData(data, top_values, filename, newhashkey))
-        FreeDatabox(top);
+        FreeDatabox(top_values);
       else
       {
         Tcl_AppendElement(interp, newhashkey);
       }
-
-      ExtractTop(top, databox, top_values);
     }
     else
     {
@@ -5396,57 +5879,12 @@ int BuildDomainCommand(
 
   Tcl_DStringInit(&result);
 
-  subgrid_array = NewSubgridArray();
-
   /*--------------------------------------------------------------------
    * Get the processor topology from the database
    *--------------------------------------------------------------------*/
-  int s_i;
-  int size = GetInt(interp, "ProcessGrid.NumSubgrids");
-
-  for (s_i = 0; s_i < size; s_i++)
+  if ((subgrid_array = ReadProcessGrid(interp)) == NULL)
   {
-    char key[1024];
-    int p;
-
-    int ix;
-    int iy;
-    int iz;
-
-    int nx;
-    int ny;
-    int nz;
-
-    int rx = 0;
-    int ry = 0;
-    int rz = 0;
-
-    sprintf(key, "ProcessGrid.%d.P", s_i);
-    p = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.IX", s_i);
-    ix = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.IY", s_i);
-    iy = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.IZ", s_i);
-    iz = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.NX", s_i);
-    nx = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.NY", s_i);
-    ny = GetInt(interp, key);
-
-    sprintf(key, "ProcessGrid.%d.NZ", s_i);
-    nz = GetInt(interp, key);
-
-    AppendSubgrid(NewSubgrid(ix, iy, iz,
-                             nx, ny, nz,
-                             rx, ry, rz,
-                             p),
-                  &subgrid_array);
+    subgrid_array = NewSubgridArray();
   }
 
   char newhashkey[32];
@@ -6186,11 +6624,9 @@ int            SlopeYUpwindCommand(
  * Description: Compute upstream contributing area for each point [i,j]
  *              based on neighboring slopes (sx and sy).
  *
- * Notes:       loops of over all [i,j]
- *              at each [i,j], loops over neighbors to find parent(s)
- *              adds parent area to area[i,j]
- *              recursively loops over each parent's neighbors, calculates
- *                area over ALL upstream cells until reaches a divide
+ * Notes:       counts ALL upstream cells of [i,j] up to the divide;
+ *                cells draining into two neighbors split their area
+ *                (see ComputeUpstreamArea)
  *              returns values as NUMBER OF CELLS (not actual area)
  *                to calculate areas, simply multiply area*dx*dy
  *
@@ -6610,6 +7046,104 @@ int            MovingAvgCommand(
 }
 
 
+/*-----------------------------------------------------------------------
+ * routine for `pfpriorityfilldem' command
+ * Description: One pass priority-flood fill of all depressions in DEM.
+ *
+ * Notes:       Assumes that user specifies epsilon in same units as DEM;
+ *              cells on the edge or next to nodata cells are outlets
+ *
+ * Cmd. syntax: pfpriorityfilldem dem epsilon
+ *-----------------------------------------------------------------------*/
+int            PriorityFillCommand(
+                                   ClientData  clientData,
+                                   Tcl_Interp *interp,
+                                   int         argc,
+                                   char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;    // Points to new hash table entry
+  Data          *data = (Data*)clientData;
+
+  // Inputs
+  Databox       *dem;
+  char          *dem_hashkey;
+  double epsilon;
+
+  // Output
+  Databox       *newdem;
+  char          *filename = "Priority-Filled DEM";
+  char newdem_hashkey[MAX_KEY_SIZE];
+
+  // Local
+  int nraised;
+  int nx, ny, nz;
+  double x, y, z;
+  double dx, dy, dz;
+
+  /* Check if two arguments following command  */
+  if (argc != 3)
+  {
+    WrongNumArgsError(interp, PFPRIORITYFILLDEMUSAGE);
+    return TCL_ERROR;
+  }
+
+  dem_hashkey = argv[1];
+  if (Tcl_GetDouble(interp, argv[2], &epsilon) == TCL_ERROR)
+  {
+    NotADoubleError(interp, 2, PFPRIORITYFILLDEMUSAGE);
+    return TCL_ERROR;
+  }
+
+  if ((dem = DataMember(data, dem_hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, dem_hashkey);
+    return TCL_ERROR;
+  }
+
+  {
+    nx = DataboxNx(dem);
+    ny = DataboxNy(dem);
+    nz = 1;
+
+    x = DataboxX(dem);
+    y = DataboxY(dem);
+    z = DataboxZ(dem);
+
+    dx = DataboxDx(dem);
+    dy = DataboxDy(dem);
+    dz = DataboxDz(dem);
+
+    /* create the new databox structure for filled dem  */
+    if ((newdem = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)))
+    {
+      /* Make sure the data set pointer was added to */
+      /* the hash table successfully.                */
+      if (!AddData(data, newdem, filename, newdem_hashkey))
+        FreeDatabox(newdem);
+      else
+      {
+        Tcl_AppendElement(interp, newdem_hashkey);
+      }
+
+      nraised = ComputePriorityFill(dem, epsilon, newdem);
+
+      // Print summary...
+      printf("*******************************************************\n");
+      printf("SUMMARY: pfpriorityfilldem  \n");
+      printf("*******************************************************\n");
+      printf("RAISED CELLS: \t\t %d \n", nraised);
+      printf("   \n");
+    }
+    else
+    {
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
+  }
+  return TCL_OK;
+}
+
+
 /*-----------------------------------------------------------------------
  * routine for `pfslopexD4' command
  * Description: Compute D4 slope x at all [i,j].
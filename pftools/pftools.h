@@ -80,10 +80,15 @@ typedef struct {
 #define DataGridType(data)  ((data)->grid_type)
 #define DataTotalMem(data)  ((data)->total_members)
 #define DataNum(data)       ((data)->num)
-#define DataMember(data, hashkey, entryPtr)                           \
+/* Databoxes loaded with pfload are decoded on first use; DataMember
+ * returns a fully decoded databox, DataMemberLazy leaves it to the caller
+ * to DataboxLoad the z layers it reads. */
+#define DataMemberLazy(data, hashkey, entryPtr)                       \
   (((entryPtr = Tcl_FindHashEntry(&DataMembers(data), hashkey)) != 0) \
    ? (Databox*)Tcl_GetHashValue(entryPtr)                             \
    : (Databox*)NULL)
+#define DataMember(data, hashkey, entryPtr) \
+  DataboxLoadAll(DataMemberLazy(data, hashkey, entryPtr))
 #define FreeData(data) (free((Data*)data))
 
 
@@ -133,6 +138,7 @@ int CellDiffConstCommand(ClientData clientData, Tcl_Interp *interp, int argc, ch
 int CellMultConstCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int CellDivConstCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int GetStatsCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int ReducePFBCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int MDiffCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SaveDiffCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int DiffEltCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
@@ -152,6 +158,8 @@ int SurfaceRunoffCommand(ClientData clientData, Tcl_Interp *interp, int argc, ch
 int WaterTableDepthCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 
 int SavePFVTKCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int SaveXDMFCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int SaveXDMFGeometryCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int MakePatchySolidCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int pfsolFmtConvert (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 
@@ -175,6 +183,7 @@ int UpstreamAreaCommand(ClientData clientData, Tcl_Interp *interp, int argc, cha
 int FillFlatsCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int PitFillCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int MovingAvgCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int PriorityFillCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SegmentD8Command(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int ChildD8Command(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int FlintsLawCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
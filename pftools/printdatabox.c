@@ -1099,3 +1099,104 @@ void            PrintTFG_CLMVTK(
     }
   }
 }
+
+/*-----------------------------------------------------------------------
+ * print the coefficients of a Databox as raw binary in the native byte
+ * order, as double or float (see PrintXDMF)
+ *-----------------------------------------------------------------------*/
+
+void            PrintRaw(
+                         FILE *   fp,
+                         Databox *v,
+                         int      flt)
+{
+  long n = (long)DataboxNx(v) * DataboxNy(v) * DataboxNz(v);
+
+  if (flt == 1)
+  {
+    /* Convert a block at a time instead of copying the whole box */
+    float DTf[4096];
+    double *DTd = DataboxCoeffs(v);
+    long i, j, m;
+
+    for (i = 0; i < n; i += m)
+    {
+      m = (n - i < 4096) ? n - i : 4096;
+      for (j = 0; j < m; ++j)
+      {
+        DTf[j] = (float)DTd[i + j];
+      }
+      fwrite(DTf, sizeof(float), m, fp);
+    }
+  }
+  else
+  {
+    fwrite(DataboxCoeffs(v), sizeof(double), n, fp);
+  }
+}
+
+/*-----------------------------------------------------------------------
+ * print an XDMF description of a Databox whose values were written to
+ * datafile by PrintRaw.  The grid is uniform unless geometry names a raw
+ * file of (nx+1)*(ny+1)*(nz+1) native double x, y, z triples, which is
+ * how a terrain following grid is shared by every step of a series.
+ * time is the value of the step or NULL.
+ *-----------------------------------------------------------------------*/
+
+void            PrintXDMF(
+                          FILE *   fp,
+                          Databox *v,
+                          char *   varname,
+                          char *   datafile,
+                          char *   geometry,
+                          char *   time,
+                          int      flt)
+{
+  int NX = DataboxNx(v);
+  int NY = DataboxNy(v);
+  int NZ = DataboxNz(v);
+
+  int one = 1;
+  char *endian = (*(char*)&one) ? "Little" : "Big";
+
+  fprintf(fp, "<?xml version=\"1.0\" ?>\n");
+  fprintf(fp, "<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd\" []>\n");
+  fprintf(fp, "<Xdmf Version=\"2.0\">\n");
+  fprintf(fp, "  <Domain>\n");
+  fprintf(fp, "    <Grid Name=\"%s\" GridType=\"Uniform\">\n", varname);
+
+  if (time)
+  {
+    fprintf(fp, "      <Time Value=\"%s\"/>\n", time);
+  }
+
+  /* XDMF dimensions are listed slowest varying first */
+  if (geometry)
+  {
+    fprintf(fp, "      <Topology TopologyType=\"3DSMesh\" Dimensions=\"%i %i %i\"/>\n",
+            NZ + 1, NY + 1, NX + 1);
+    fprintf(fp, "      <Geometry GeometryType=\"XYZ\">\n");
+    fprintf(fp, "        <DataItem Dimensions=\"%ld 3\" NumberType=\"Float\" Precision=\"8\" Format=\"Binary\" Endian=\"%s\">%s</DataItem>\n",
+            (long)(NX + 1) * (NY + 1) * (NZ + 1), endian, geometry);
+    fprintf(fp, "      </Geometry>\n");
+  }
+  else
+  {
+    fprintf(fp, "      <Topology TopologyType=\"3DCoRectMesh\" Dimensions=\"%i %i %i\"/>\n",
+            NZ + 1, NY + 1, NX + 1);
+    fprintf(fp, "      <Geometry GeometryType=\"ORIGIN_DXDYDZ\">\n");
+    fprintf(fp, "        <DataItem Dimensions=\"3\" NumberType=\"Float\" Precision=\"8\" Format=\"XML\">%.17g %.17g %.17g</DataItem>\n",
+            DataboxZ(v), DataboxY(v), DataboxX(v));
+    fprintf(fp, "        <DataItem Dimensions=\"3\" NumberType=\"Float\" Precision=\"8\" Format=\"XML\">%.17g %.17g %.17g</DataItem>\n",
+            DataboxDz(v), DataboxDy(v), DataboxDx(v));
+    fprintf(fp, "      </Geometry>\n");
+  }
+
+  fprintf(fp, "      <Attribute Name=\"%s\" AttributeType=\"Scalar\" Center=\"Cell\">\n", varname);
+  fprintf(fp, "        <DataItem Dimensions=\"%i %i %i\" NumberType=\"Float\" Precision=\"%i\" Format=\"Binary\" Endian=\"%s\">%s</DataItem>\n",
+          NZ, NY, NX, (flt == 1) ? 4 : 8, endian, datafile);
+  fprintf(fp, "      </Attribute>\n");
+  fprintf(fp, "    </Grid>\n");
+  fprintf(fp, "  </Domain>\n");
+  fprintf(fp, "</Xdmf>\n");
+}
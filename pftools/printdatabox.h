@@ -70,6 +70,8 @@ void PrintAVSField(FILE *fp, Databox *v);
 int  PrintSDS(char *filename, int type, Databox *v);
 void PrintVizamrai(FILE *fp, Databox *v);
 void PrintSilo(char * filename, Databox *v);
+void PrintRaw(FILE *fp, Databox *v, int flt);
+void PrintXDMF(FILE *fp, Databox *v, char *varname, char *datafile, char *geometry, char *time, int flt);
 
 #ifdef __cplusplus
 }
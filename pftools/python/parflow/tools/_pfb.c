@@ -0,0 +1,657 @@
+/*
+ * Native reader for ParFlow binary (pfb) files
+ *
+ * The values of a pfb file, or of a box of it given by start and count,
+ * are decoded directly into a preallocated, C contiguous float64 buffer
+ * (usually a numpy array) given by the caller.  Like ReadPFBinary in the
+ * simulator, each subgrid is placed at the (ix, iy, iz) of its own
+ * header, so files written with any process topology are read; only the
+ * rows of the subgrids inside the box are read.  The subgrids of a file, or the files of a sequence,
+ * are decoded in parallel with OpenMP when the module is built with it,
+ * and the GIL is released while reading.
+ *
+ * Only the Python C API and the buffer protocol are used, so numpy is not
+ * needed to build the module.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PFB_HEADER_SIZE 64
+#define PFB_SUBGRID_HEADER_SIZE 36
+
+typedef struct {
+  double x, y, z;
+  int nx, ny, nz;
+  double dx, dy, dz;
+  int num_subgrids;
+} PFBHeader;
+
+typedef struct {
+  int ix, iy, iz;
+  int nx, ny, nz;
+  long long offset;    /* of the values, after the subgrid header */
+} PFBSubgrid;
+
+/* the part of the grid that is read */
+typedef struct {
+  int ix, iy, iz;
+  int nx, ny, nz;
+} PFBBox;
+
+static int is_little_endian(void)
+{
+  uint16_t one = 1;
+
+  return *(unsigned char*)&one;
+}
+
+static int32_t read_int(const unsigned char *buf)
+{
+  return (int32_t)(((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+                   ((uint32_t)buf[2] << 8) | (uint32_t)buf[3]);
+}
+
+static double read_double(const unsigned char *buf)
+{
+  uint64_t bits = 0;
+  double value;
+  int i;
+
+  for (i = 0; i < 8; i++)
+  {
+    bits = (bits << 8) | buf[i];
+  }
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static int seek(FILE *fp, long long offset)
+{
+#if defined(_WIN32)
+  return _fseeki64(fp, offset, SEEK_SET);
+#else
+  return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+static int parse_header(FILE *fp, PFBHeader *header)
+{
+  unsigned char buf[PFB_HEADER_SIZE];
+
+  if (fread(buf, 1, PFB_HEADER_SIZE, fp) != PFB_HEADER_SIZE)
+  {
+    return -1;
+  }
+
+  header->x = read_double(buf);
+  header->y = read_double(buf + 8);
+  header->z = read_double(buf + 16);
+  header->nx = read_int(buf + 24);
+  header->ny = read_int(buf + 28);
+  header->nz = read_int(buf + 32);
+  header->dx = read_double(buf + 36);
+  header->dy = read_double(buf + 44);
+  header->dz = read_double(buf + 52);
+  header->num_subgrids = read_int(buf + 60);
+
+  if (header->nx <= 0 || header->ny <= 0 || header->nz <= 0 || header->num_subgrids <= 0)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * Walk the subgrid headers of the file, which follow each other with the
+ * values of one subgrid in between.  Returns a malloc'ed array of the
+ * subgrids, or NULL if the file is truncated or a subgrid lies outside
+ * of the grid.
+ */
+static PFBSubgrid *parse_subgrids(FILE *fp, const PFBHeader *header)
+{
+  PFBSubgrid *subgrids = (PFBSubgrid*)malloc(sizeof(PFBSubgrid) * header->num_subgrids);
+  unsigned char buf[PFB_SUBGRID_HEADER_SIZE];
+  long long offset = PFB_HEADER_SIZE;
+  int s;
+
+  if (subgrids == NULL)
+  {
+    return NULL;
+  }
+
+  for (s = 0; s < header->num_subgrids; s++)
+  {
+    PFBSubgrid *sg = &subgrids[s];
+
+    if (seek(fp, offset) || fread(buf, 1, PFB_SUBGRID_HEADER_SIZE, fp) != PFB_SUBGRID_HEADER_SIZE)
+    {
+      free(subgrids);
+      return NULL;
+    }
+
+    sg->ix = read_int(buf);
+    sg->iy = read_int(buf + 4);
+    sg->iz = read_int(buf + 8);
+    sg->nx = read_int(buf + 12);
+    sg->ny = read_int(buf + 16);
+    sg->nz = read_int(buf + 20);
+    sg->offset = offset + PFB_SUBGRID_HEADER_SIZE;
+
+    if (sg->ix < 0 || sg->iy < 0 || sg->iz < 0 ||
+        sg->nx < 0 || sg->ny < 0 || sg->nz < 0 ||
+        sg->ix + sg->nx > header->nx || sg->iy + sg->ny > header->ny ||
+        sg->iz + sg->nz > header->nz)
+    {
+      free(subgrids);
+      return NULL;
+    }
+
+    offset = sg->offset + 8LL * sg->nx * sg->ny * sg->nz;
+  }
+
+  return subgrids;
+}
+
+static int int_max(int a, int b)
+{
+  return a > b ? a : b;
+}
+
+static int int_min(int a, int b)
+{
+  return a < b ? a : b;
+}
+
+/*
+ * Read the values of one subgrid that lie in box and store them in out,
+ * which has the shape (box nz, ny, nx) if z_first, else (nx, ny, nz).
+ * fp is only used by the calling thread.
+ */
+static int decode_subgrid(FILE *fp, const PFBSubgrid *sg, const PFBBox *box,
+                          double *out, int z_first)
+{
+  int x0 = int_max(sg->ix, box->ix), x1 = int_min(sg->ix + sg->nx, box->ix + box->nx);
+  int y0 = int_max(sg->iy, box->iy), y1 = int_min(sg->iy + sg->ny, box->iy + box->ny);
+  int z0 = int_max(sg->iz, box->iz), z1 = int_min(sg->iz + sg->nz, box->iz + box->nz);
+  long long row = x1 - x0;
+  long long NX = box->nx, NY = box->ny, NZ = box->nz;
+  long long offset, pos = -1;
+  unsigned char *buf;
+  int swap = is_little_endian();
+  int i, j, k;
+
+  if (x0 >= x1 || y0 >= y1 || z0 >= z1)
+  {
+    return 0;
+  }
+
+  buf = (unsigned char*)malloc(8 * row);
+  if (buf == NULL)
+  {
+    return -1;
+  }
+
+  /* Values are stored a row of x at a time, big endian; seek only when
+   * the rows read are not contiguous in the file */
+  for (k = z0; k < z1; k++)
+  {
+    for (j = y0; j < y1; j++)
+    {
+      offset = sg->offset +
+               8 * (((long long)(k - sg->iz) * sg->ny + j - sg->iy) * sg->nx + x0 - sg->ix);
+
+      if ((offset != pos && seek(fp, offset)) || fread(buf, 8, row, fp) != (size_t)row)
+      {
+        free(buf);
+        return -1;
+      }
+      pos = offset + 8 * row;
+
+      if (swap)
+      {
+        for (i = 0; i < row; i++)
+        {
+          unsigned char *b = buf + 8 * i, t;
+          t = b[0]; b[0] = b[7]; b[7] = t;
+          t = b[1]; b[1] = b[6]; b[6] = t;
+          t = b[2]; b[2] = b[5]; b[5] = t;
+          t = b[3]; b[3] = b[4]; b[4] = t;
+        }
+      }
+
+      if (z_first)
+      {
+        memcpy(out + ((k - box->iz) * NY + j - box->iy) * NX + x0 - box->ix, buf, 8 * row);
+      }
+      else
+      {
+        double *dst = out + ((x0 - box->ix) * NY + j - box->iy) * NZ + k - box->iz;
+        for (i = 0; i < row; i++)
+        {
+          memcpy(dst + i * NY * NZ, buf + 8 * i, 8);
+        }
+      }
+    }
+  }
+
+  free(buf);
+  return 0;
+}
+
+/*
+ * Read the values of the file at path that lie in box into out.  The
+ * subgrids are decoded by num_threads threads.  Returns 0, -1 if the file
+ * cannot be read or -2 if its grid is not expected.
+ */
+static int read_file(const char *path, const PFBHeader *expected, const PFBBox *box,
+                     double *out, int z_first, int num_threads)
+{
+  PFBHeader header;
+  PFBSubgrid *subgrids;
+  FILE *fp;
+  int s, failed = 0;
+
+  if ((fp = fopen(path, "rb")) == NULL)
+  {
+    return -1;
+  }
+
+  if (parse_header(fp, &header) || (subgrids = parse_subgrids(fp, &header)) == NULL)
+  {
+    fclose(fp);
+    return -1;
+  }
+
+  if (header.nx != expected->nx || header.ny != expected->ny || header.nz != expected->nz)
+  {
+    free(subgrids);
+    fclose(fp);
+    return -2;
+  }
+
+  if (num_threads > 1 && header.num_subgrids > 1)
+  {
+    fclose(fp);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads) reduction(|:failed)
+#endif
+    {
+      FILE *tfp = fopen(path, "rb");
+
+      failed |= (tfp == NULL);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (s = 0; s < header.num_subgrids; s++)
+      {
+        if (tfp)
+        {
+          failed |= decode_subgrid(tfp, &subgrids[s], box, out, z_first) != 0;
+        }
+      }
+
+      if (tfp)
+      {
+        fclose(tfp);
+      }
+    }
+  }
+  else
+  {
+    for (s = 0; s < header.num_subgrids && !failed; s++)
+    {
+      failed = decode_subgrid(fp, &subgrids[s], box, out, z_first) != 0;
+    }
+    fclose(fp);
+  }
+
+  free(subgrids);
+  return failed ? -1 : 0;
+}
+
+static int get_output_buffer(PyObject *array, Py_buffer *view, Py_ssize_t count)
+{
+  if (PyObject_GetBuffer(array, view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE | PyBUF_FORMAT) < 0)
+  {
+    return -1;
+  }
+
+  if (view->itemsize != 8 || view->format == NULL || strcmp(view->format, "d") != 0)
+  {
+    PyErr_SetString(PyExc_TypeError, "out must be a float64 array");
+    PyBuffer_Release(view);
+    return -1;
+  }
+
+  if (view->len != count * 8)
+  {
+    PyErr_SetString(PyExc_ValueError, "out does not have the size of the values read");
+    PyBuffer_Release(view);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* the number of threads to use, 0 asks for the OpenMP default */
+static int thread_count(int num_threads)
+{
+#ifdef _OPENMP
+  return num_threads > 0 ? num_threads : omp_get_max_threads();
+#else
+  (void)num_threads;
+  return 1;
+#endif
+}
+
+/*
+ * Set box from the start and count given for x, y and z; a negative
+ * count reads to the end of the grid.  Raises ValueError and returns -1
+ * if the box does not lie in the grid.
+ */
+static int make_box(const PFBHeader *header, const int *start, const int *count, PFBBox *box)
+{
+  const int n[3] = { header->nx, header->ny, header->nz };
+  int b[6];
+  int d;
+
+  for (d = 0; d < 3; d++)
+  {
+    b[d] = start[d];
+    b[d + 3] = count[d] < 0 ? n[d] - start[d] : count[d];
+
+    if (b[d] < 0 || b[d + 3] < 0 || b[d] + b[d + 3] > n[d])
+    {
+      PyErr_SetString(PyExc_ValueError, "start and count do not lie in the pfb grid");
+      return -1;
+    }
+  }
+
+  box->ix = b[0]; box->iy = b[1]; box->iz = b[2];
+  box->nx = b[3]; box->ny = b[4]; box->nz = b[5];
+  return 0;
+}
+
+static int read_expected_header(const char *path, PFBHeader *header)
+{
+  FILE *fp = fopen(path, "rb");
+  int status;
+
+  if (fp == NULL)
+  {
+    return -1;
+  }
+  status = parse_header(fp, header);
+  fclose(fp);
+  return status;
+}
+
+PyDoc_STRVAR(read_header_doc,
+             "read_header(file)\n\n"
+             "Return the header of a pfb file as a dictionary with the keys\n"
+             "x, y, z, nx, ny, nz, dx, dy, dz and n_subgrids.");
+
+static PyObject *pfb_read_header(PyObject *self, PyObject *args)
+{
+  PyObject *path_obj;
+  PFBHeader header;
+  int status;
+
+  (void)self;
+
+  if (!PyArg_ParseTuple(args, "O&", PyUnicode_FSConverter, &path_obj))
+  {
+    return NULL;
+  }
+
+  status = read_expected_header(PyBytes_AS_STRING(path_obj), &header);
+  if (status)
+  {
+    PyErr_Format(PyExc_OSError, "Cannot read pfb header from %s", PyBytes_AS_STRING(path_obj));
+    Py_DECREF(path_obj);
+    return NULL;
+  }
+  Py_DECREF(path_obj);
+
+  return Py_BuildValue("{s:d,s:d,s:d,s:i,s:i,s:i,s:d,s:d,s:d,s:i}",
+                       "x", header.x, "y", header.y, "z", header.z,
+                       "nx", header.nx, "ny", header.ny, "nz", header.nz,
+                       "dx", header.dx, "dy", header.dy, "dz", header.dz,
+                       "n_subgrids", header.num_subgrids);
+}
+
+PyDoc_STRVAR(read_pfb_doc,
+             "read_pfb(file, out, z_first=True, num_threads=0, start=(0, 0, 0),\n"
+             "         count=(-1, -1, -1))\n\n"
+             "Read the values of a pfb file in the box of count (x, y, z) values\n"
+             "from index start into out, a C contiguous float64 array of shape\n"
+             "(nz, ny, nx) of the box if z_first, else (nx, ny, nz).  A negative\n"
+             "count reads to the end of the grid.  The subgrids are decoded in\n"
+             "parallel by num_threads threads (0 uses the OpenMP default).");
+
+static PyObject *pfb_read_pfb(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static char *kwlist[] = { "file", "out", "z_first", "num_threads", "start", "count", NULL };
+  PyObject *path_obj, *array;
+  Py_buffer view;
+  PFBHeader header;
+  PFBBox box;
+  int start[3] = { 0, 0, 0 }, count[3] = { -1, -1, -1 };
+  int z_first = 1, num_threads = 0;
+  int status;
+
+  (void)self;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O|pi(iii)(iii)", kwlist,
+                                   PyUnicode_FSConverter, &path_obj, &array,
+                                   &z_first, &num_threads,
+                                   &start[0], &start[1], &start[2],
+                                   &count[0], &count[1], &count[2]))
+  {
+    return NULL;
+  }
+
+  if (read_expected_header(PyBytes_AS_STRING(path_obj), &header))
+  {
+    PyErr_Format(PyExc_OSError, "Cannot read pfb header from %s", PyBytes_AS_STRING(path_obj));
+    Py_DECREF(path_obj);
+    return NULL;
+  }
+
+  if (make_box(&header, start, count, &box) < 0 ||
+      get_output_buffer(array, &view, (Py_ssize_t)box.nx * box.ny * box.nz) < 0)
+  {
+    Py_DECREF(path_obj);
+    return NULL;
+  }
+
+  num_threads = thread_count(num_threads);
+
+  Py_BEGIN_ALLOW_THREADS
+  status = read_file(PyBytes_AS_STRING(path_obj), &header, &box, (double*)view.buf,
+                     z_first, num_threads);
+  Py_END_ALLOW_THREADS
+
+  PyBuffer_Release(&view);
+
+  if (status)
+  {
+    PyErr_Format(PyExc_OSError, "Cannot read pfb file %s", PyBytes_AS_STRING(path_obj));
+    Py_DECREF(path_obj);
+    return NULL;
+  }
+
+  Py_DECREF(path_obj);
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(read_pfb_sequence_doc,
+             "read_pfb_sequence(files, out, z_first=True, num_threads=0,\n"
+             "                  start=(0, 0, 0), count=(-1, -1, -1))\n\n"
+             "Read the same box of a sequence of pfb files with the same grid\n"
+             "into out, a C contiguous float64 array of shape (len(files), nz,\n"
+             "ny, nx) of the box if z_first, else (len(files), nx, ny, nz).  The\n"
+             "box is given as in read_pfb.  The files are read in parallel by\n"
+             "num_threads threads (0 uses the OpenMP default).");
+
+static PyObject *pfb_read_pfb_sequence(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static char *kwlist[] = { "files", "out", "z_first", "num_threads", "start", "count", NULL };
+  PyObject *files, *seq, *array;
+  Py_buffer view;
+  PFBHeader header;
+  PFBBox box;
+  int start[3] = { 0, 0, 0 }, count[3] = { -1, -1, -1 };
+  PyObject **paths;
+  Py_ssize_t num_files, f;
+  long long size;
+  int z_first = 1, num_threads = 0;
+  int failed = 0;
+
+  (void)self;
+  memset(&header, 0, sizeof(header));
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|pi(iii)(iii)", kwlist,
+                                   &files, &array, &z_first, &num_threads,
+                                   &start[0], &start[1], &start[2],
+                                   &count[0], &count[1], &count[2]))
+  {
+    return NULL;
+  }
+
+  if ((seq = PySequence_Fast(files, "files must be a sequence")) == NULL)
+  {
+    return NULL;
+  }
+
+  num_files = PySequence_Fast_GET_SIZE(seq);
+  if (num_files == 0)
+  {
+    Py_DECREF(seq);
+    Py_RETURN_NONE;
+  }
+
+  paths = (PyObject**)PyMem_Calloc(num_files, sizeof(PyObject*));
+  if (paths == NULL)
+  {
+    Py_DECREF(seq);
+    return PyErr_NoMemory();
+  }
+
+  for (f = 0; f < num_files; f++)
+  {
+    if (!PyUnicode_FSConverter(PySequence_Fast_GET_ITEM(seq, f), &paths[f]))
+    {
+      failed = 1;
+      break;
+    }
+  }
+  Py_DECREF(seq);
+
+  if (!failed && read_expected_header(PyBytes_AS_STRING(paths[0]), &header))
+  {
+    PyErr_Format(PyExc_OSError, "Cannot read pfb header from %s", PyBytes_AS_STRING(paths[0]));
+    failed = 1;
+  }
+
+  if (!failed && make_box(&header, start, count, &box) < 0)
+  {
+    failed = 1;
+  }
+
+  size = (long long)box.nx * box.ny * box.nz;
+
+  if (!failed && get_output_buffer(array, &view, (Py_ssize_t)(size * num_files)) < 0)
+  {
+    failed = 1;
+  }
+
+  if (!failed)
+  {
+    int *status = (int*)calloc(num_files, sizeof(int));
+
+    num_threads = thread_count(num_threads);
+
+    Py_BEGIN_ALLOW_THREADS
+
+    /* One file per thread; the subgrids of a file are read in order */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+#endif
+    for (f = 0; f < num_files; f++)
+    {
+      status[f] = read_file(PyBytes_AS_STRING(paths[f]), &header, &box,
+                            (double*)view.buf + f * size, z_first, 1);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    for (f = 0; f < num_files; f++)
+    {
+      if (status[f] == -2)
+      {
+        PyErr_Format(PyExc_ValueError, "Grid of %s differs from %s",
+                     PyBytes_AS_STRING(paths[f]), PyBytes_AS_STRING(paths[0]));
+        failed = 1;
+        break;
+      }
+      else if (status[f])
+      {
+        PyErr_Format(PyExc_OSError, "Cannot read pfb file %s", PyBytes_AS_STRING(paths[f]));
+        failed = 1;
+        break;
+      }
+    }
+    free(status);
+  }
+
+  for (f = 0; f < num_files; f++)
+  {
+    Py_XDECREF(paths[f]);
+  }
+  PyMem_Free(paths);
+
+  if (failed)
+  {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef pfb_methods[] = {
+  { "read_header", (PyCFunction)pfb_read_header, METH_VARARGS, read_header_doc },
+  { "read_pfb", (PyCFunction)(void (*)(void))pfb_read_pfb, METH_VARARGS | METH_KEYWORDS, read_pfb_doc },
+  { "read_pfb_sequence", (PyCFunction)(void (*)(void))pfb_read_pfb_sequence, METH_VARARGS | METH_KEYWORDS,
+    read_pfb_sequence_doc },
+  { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef pfb_module = {
+  PyModuleDef_HEAD_INIT,
+  "_pfb",
+  "Native reader for ParFlow binary files",
+  -1,
+  pfb_methods,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+PyMODINIT_FUNC PyInit__pfb(void)
+{
+  return PyModule_Create(&pfb_module);
+}
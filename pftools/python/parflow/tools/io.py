@@ -49,12 +49,35 @@ from .hydrology import (
 from .fs import get_absolute_path
 from .helper import sort_dict, get_or_create_dict
 
+try:
+    from . import _pfb
+except ImportError:
+    # The native reader is optional, fall back to reading in Python
+    _pfb = None
+
 try:
     from yaml import CDumper as YAMLDumper
 except ImportError:
     from yaml import Dumper as YAMLDumper
 
 
+def _keys_to_subarray(keys: dict, header: dict, z_key: str='z'):
+    """
+    Convert a set of keys for indexing subarrays (see ``read_pfb``) to the
+    start index and the number of values along x, y and z.
+    """
+    start_x = keys['x']['start'] or 0
+    start_y = keys['y']['start'] or 0
+    start_z = keys[z_key]['start'] or 0
+    stop_x = keys['x']['stop'] or header['nx']
+    stop_y = keys['y']['stop'] or header['ny']
+    stop_z = keys[z_key]['stop'] or header['nz']
+    nx = int(np.max([stop_x - start_x, 1]))
+    ny = int(np.max([stop_y - start_y, 1]))
+    nz = int(np.max([stop_z - start_z, 1]))
+    return (int(start_x), int(start_y), int(start_z)), (nx, ny, nz)
+
+
 def read_pfb(file: str, keys: dict=None, mode: str='full', z_first: bool=True):
     """
     Read a single pfb file, and return the data therein
@@ -77,20 +100,19 @@ def read_pfb(file: str, keys: dict=None, mode: str='full', z_first: bool=True):
     :return:
         An nd array containing the data from the pfb file.
     """
+    if _pfb and keys:
+        # Read only the requested subarray with the native reader
+        start, count = _keys_to_subarray(keys, _pfb.read_header(file))
+        data = np.empty(count[::-1] if z_first else count, dtype=np.float64)
+        _pfb.read_pfb(file, data, z_first, start=start, count=count)
+        return data
+
     with ParflowBinaryReader(file) as pfb:
         if not keys:
             data = pfb.read_all_subgrids(mode=mode, z_first=z_first)
         else:
-            base_header = pfb.header
-            start_x = keys['x']['start'] or 0
-            start_y = keys['y']['start'] or 0
-            start_z = keys['z']['start'] or 0
-            stop_x = keys['x']['stop'] or base_header['nx']
-            stop_y = keys['y']['stop'] or base_header['ny']
-            stop_z = keys['z']['stop'] or base_header['nz']
-            nx = np.max([stop_x - start_x, 1])
-            ny = np.max([stop_y - start_y, 1])
-            nz = np.max([stop_z - start_z, 1])
+            (start_x, start_y, start_z), (nx, ny, nz) = \
+                _keys_to_subarray(keys, pfb.header)
             data = pfb.read_subarray(
                         start_x, start_y, start_z, nx, ny, nz, z_first=z_first)
     return data
@@ -245,6 +267,9 @@ def read_pfb_sequence(
     approach is faster than looping over the ``read_pfb`` function
     because it caches the subgrid information from the first
     pfb file and then uses that to initialize all other readers.
+    When the native ``_pfb`` extension is built the files, or the
+    subarrays given by keys, are decoded concurrently by the extension
+    instead.
 
     :param file_seq:
         An iterable sequence of file names to be read.
@@ -270,6 +295,27 @@ def read_pfb_sequence(
     """
     # Filter out unique files only
     file_seq = sorted(list(set(file_seq)))
+    if _pfb:
+        # Decode every file at once, in parallel, with the native reader
+        base_header = _pfb.read_header(file_seq[0])
+        if not keys:
+            start = (0, 0, 0)
+            count = (base_header['nx'], base_header['ny'], base_header['nz'])
+        else:
+            start, count = _keys_to_subarray(keys, base_header, z_is)
+        if z_first:
+            seq_size = (len(file_seq), *count[::-1])
+        else:
+            seq_size = (len(file_seq), *count)
+        pfb_seq = np.empty(seq_size, dtype=np.float64)
+        _pfb.read_pfb_sequence(file_seq, pfb_seq, z_first, start=start, count=count)
+        if z_is == 'time':
+            if z_first:
+                pfb_seq = np.concatenate(pfb_seq, axis=0)
+            else:
+                pfb_seq = np.concatenate(pfb_seq, axis=-1)
+        return pfb_seq
+
     with ParflowBinaryReader(file_seq[0]) as pfb_init:
         base_header = pfb_init.header
         base_sg_offsets = pfb_init.subgrid_offsets
@@ -281,15 +327,8 @@ def read_pfb_sequence(
     if not keys:
         nx, ny, nz = base_header['nx'], base_header['ny'], base_header['nz']
     else:
-        start_x = keys['x']['start'] or 0
-        start_y = keys['y']['start'] or 0
-        start_z = keys[z_is]['start'] or 0
-        stop_x = keys['x']['stop'] or base_header['nx']
-        stop_y = keys['y']['stop'] or base_header['ny']
-        stop_z = keys[z_is]['stop'] or base_header['nz']
-        nx = np.max([stop_x - start_x, 1])
-        ny = np.max([stop_y - start_y, 1])
-        nz = np.max([stop_z - start_z, 1])
+        (start_x, start_y, start_z), (nx, ny, nz) = \
+            _keys_to_subarray(keys, base_header, z_is)
 
     if z_first:
         seq_size = (len(file_seq), nz, ny, nx)
@@ -719,8 +758,11 @@ class ParflowBinaryReader:
                 full_shape = tuple(self.header[dim] for dim in ['nz', 'ny', 'nx'])
             else:
                 full_shape = tuple(self.header[dim] for dim in ['nx', 'ny', 'nz'])
-            chunks = self.chunks['x'], self.chunks['y'], self.chunks['z']
             all_data = np.empty(full_shape, dtype=np.float64)
+            if _pfb:
+                # The native reader places each subgrid from its own header
+                _pfb.read_pfb(self.filename, all_data, z_first)
+                return all_data
             for i in range(self.header['n_subgrids']):
                 nx, ny, nz = self.subgrid_shapes[i]
                 ix, iy, iz = self.subgrid_start_indices[i]
@@ -459,16 +459,8 @@ def _getitem_no_state(file_or_seq, key, dims, mode, z_first=True, z_is='z'):
         else:
             d = ['x', 'y', 'z']
 
-        with ParflowBinaryReader(file_or_seq) as pfd:
-            sub = pfd.read_subarray(
-                start_x=accessor['x']['start'],
-                start_y=accessor['y']['start'],
-                start_z=accessor['z']['start'],
-                nx=accessor['x']['stop'],
-                ny=accessor['y']['stop'],
-                nz=accessor['z']['stop'],
-                z_first=z_first
-            )
+        # Read only the requested subarray
+        sub = read_pfb(file_or_seq, keys=accessor, z_first=z_first)
         sub = sub[accessor[d[0]]['indices'],
                   accessor[d[1]]['indices'],
                   accessor[d[2]]['indices']].squeeze()
@@ -15,6 +15,7 @@ rootdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "../.."))
 sys.path.append(rootdir)
 from parflow.tools.pf_backend import ParflowBackendEntrypoint
 from parflow import ParflowBinaryReader, read_pfb_sequence, read_pfb, write_pfb
+from parflow.tools import io as pfio
 from pfb_summary import PFBSummary
 
 EXAMPLE_PFB_FILE_PATH_0 = f"{rootdir}/tools/tests/data/forsyth5.out.press.00000.pfb"
@@ -150,5 +151,82 @@ class TestPFXArray(unittest.TestCase):
                 number_of_subgrids = int(header.get('n_subgrids', 0))
                 self.assertEqual(1, number_of_subgrids)
 
+    @unittest.skipIf(pfio._pfb is None, 'native PFB reader not built')
+    def test_native_reader(self):
+        """Compare the native reader against reading the subgrids in Python."""
+        da = np.random.random((3, 7, 9))
+        with tempfile.TemporaryDirectory() as TEMP_DIRECTORY:
+            file_seq = []
+            for i in range(3):
+                file_name = f'{TEMP_DIRECTORY}/native.{i:05d}.pfb'
+                write_pfb(file_name, da + i, p=2, q=3, r=2, dist=False)
+                file_seq.append(file_name)
+
+            for z_first in [True, False]:
+                native = read_pfb_sequence(file_seq, z_first=z_first)
+                native_file = read_pfb(file_seq[0], z_first=z_first)
+                native_pfb = pfio._pfb
+                try:
+                    pfio._pfb = None
+                    python = read_pfb_sequence(file_seq, z_first=z_first)
+                    python_file = read_pfb(file_seq[0], z_first=z_first)
+                finally:
+                    pfio._pfb = native_pfb
+                np.testing.assert_array_equal(native, python)
+                np.testing.assert_array_equal(native_file, python_file)
+            np.testing.assert_array_equal(native[1].T, da + 1)
+
+            # Files on a different grid can not share the output array
+            file_name = f'{TEMP_DIRECTORY}/native.other.pfb'
+            write_pfb(file_name, da[:, :, 1:], p=1, q=1, r=1)
+            with self.assertRaises(ValueError):
+                read_pfb_sequence(file_seq + [file_name])
+
+    @unittest.skipIf(pfio._pfb is None, 'native PFB reader not built')
+    def test_native_subarray(self):
+        """Compare subarrays read by the native reader against Python."""
+        da = np.random.random((5, 8, 9))
+        with tempfile.TemporaryDirectory() as TEMP_DIRECTORY:
+            file_seq = []
+            for i in range(2):
+                file_name = f'{TEMP_DIRECTORY}/subarray.{i:05d}.pfb'
+                write_pfb(file_name, da + i, p=2, q=3, r=1, dist=False)
+                file_seq.append(file_name)
+
+            # Subarrays that cross subgrid boundaries and single indices
+            selections = [
+                dict(x=slice(2, 7), y=slice(1, 6), z=slice(1, 4)),
+                dict(x=4, z=slice(0, 2)),
+                dict(y=slice(3, 8)),
+            ]
+            for selection in selections:
+                native_pfb = pfio._pfb
+                try:
+                    ds = xr.open_dataset(file_seq[0], name='da', engine='parflow')
+                    native = ds['da'].isel(**selection).values
+                    pfio._pfb = None
+                    ds = xr.open_dataset(file_seq[0], name='da', engine='parflow')
+                    python = ds['da'].isel(**selection).values
+                finally:
+                    pfio._pfb = native_pfb
+                index = tuple(selection.get(d, slice(None)) for d in ['z', 'y', 'x'])
+                np.testing.assert_array_equal(native, da[index])
+                np.testing.assert_array_equal(python, da[index])
+
+            keys = {'x': {'start': 3, 'stop': 8},
+                    'y': {'start': 2, 'stop': 4},
+                    'z': {'start': 1, 'stop': None}}
+            for z_first in [True, False]:
+                native = read_pfb_sequence(file_seq, keys=keys, z_first=z_first)
+                native_pfb = pfio._pfb
+                try:
+                    pfio._pfb = None
+                    python = read_pfb_sequence(file_seq, keys=keys, z_first=z_first)
+                finally:
+                    pfio._pfb = native_pfb
+                np.testing.assert_array_equal(native, python)
+            np.testing.assert_array_equal(native[1].T, da[1:, 2:4, 3:8] + 1)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -1,5 +1,21 @@
+import sys
 from pathlib import Path
-from setuptools import find_packages, setup
+from setuptools import Extension, find_packages, setup
+
+# The native PFB reader is optional, parflow.tools.io falls back to
+# reading in Python when it cannot be built
+if sys.platform in ('win32', 'darwin'):
+    OPENMP_FLAGS = []
+else:
+    OPENMP_FLAGS = ['-fopenmp']
+
+PFB_EXTENSION = Extension(
+    'parflow.tools._pfb',
+    sources=['parflow/tools/_pfb.c'],
+    extra_compile_args=OPENMP_FLAGS,
+    extra_link_args=OPENMP_FLAGS,
+    optional=True,
+)
 
 # reading the README file
 HERE = Path(__file__).parent
@@ -21,6 +37,7 @@ setup(
     ],
     keywords=['ParFlow', 'groundwater model', 'surface water model'],
     packages=find_packages(),
+    ext_modules=[PFB_EXTENSION],
     install_requires=[
         'pyyaml>=5.4',
     ],
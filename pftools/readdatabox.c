@@ -51,6 +51,11 @@
 #include <ctype.h>
 #include <unistd.h>
 
+#ifdef PARFLOW_HAVE_PREAD
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
 #define round(x) ((x) >= 0 ? (double)((x) + 0.5) : (double)((x) - 0.5))
 
 /*-----------------------------------------------------------------------
@@ -398,6 +403,492 @@ Databox         *ReadParflowB(
 }
 
 
+#ifdef PARFLOW_HAVE_PREAD
+
+/*-----------------------------------------------------------------------
+ * Databoxes created by MapParflowB keep the position of every subgrid of
+ * the file in this list until all of their z layers are decoded.  The
+ * size and modification time of the file are kept to detect a file that
+ * changed after it was indexed.
+ *-----------------------------------------------------------------------*/
+
+typedef struct databox_map {
+  Databox            *databox;
+
+  char               *file_name;
+  off_t file_size;
+  time_t file_mtime;
+
+  int num_subgrids;
+  int                *subgrids;    /* x, y, z, nx, ny, nz of each subgrid */
+  off_t              *offsets;     /* file offset of each subgrid's values */
+
+  char               *loaded;      /* set for decoded z layers */
+  int num_loaded;
+  double default_value;
+
+  struct databox_map *next;
+} DataboxMap;
+
+static DataboxMap *databox_maps = NULL;
+
+static DataboxMap *FindDataboxMap(
+                                  Databox *databox)
+{
+  DataboxMap *map;
+
+  for (map = databox_maps; map != NULL; map = map->next)
+  {
+    if (map->databox == databox)
+    {
+      return map;
+    }
+  }
+
+  return NULL;
+}
+
+/* read size bytes at offset, returns 0 if the file is too short */
+static int MapRead(
+                   int    fd,
+                   char * buffer,
+                   size_t size,
+                   off_t  offset)
+{
+  ssize_t count;
+
+  while (size > 0)
+  {
+    if ((count = pread(fd, buffer, size, offset)) <= 0)
+      return 0;
+
+    buffer += count;
+    size -= (size_t)count;
+    offset += count;
+  }
+
+  return 1;
+}
+
+/* copy big endian values read from the file */
+static void MapCopy(
+                    void * dest,
+                    char * src,
+                    size_t size,
+                    size_t num)
+{
+#ifdef CASC_HAVE_BIGENDIAN
+  memcpy(dest, src, size * num);
+#else
+  char *out = (char*)dest;
+  size_t n, b;
+
+  for (n = 0; n < num; n++)
+  {
+    for (b = 0; b < size; b++)
+    {
+      out[b] = src[size - 1 - b];
+    }
+    out += size;
+    src += size;
+  }
+#endif
+}
+
+static void FreeMap(
+                    DataboxMap *map)
+{
+  DataboxMap **ptr;
+
+  for (ptr = &databox_maps; *ptr != NULL; ptr = &(*ptr)->next)
+  {
+    if (*ptr == map)
+    {
+      *ptr = map->next;
+      break;
+    }
+  }
+
+  free(map->file_name);
+  free(map->subgrids);
+  free(map->offsets);
+  free(map->loaded);
+  free(map);
+}
+
+#endif
+
+/*-----------------------------------------------------------------------
+ * read the layout of a binary `parflow' file
+ *
+ * Reads the header into coords (X Y Z DX DY DZ) and sizes (NX NY NZ
+ * num_subgrids) without reading any values.  If subgrids is not NULL an
+ * array with the header and value offset of every subgrid is allocated
+ * and returned in it.  Returns 0 if the file can not be read or the
+ * subgrids do not fit the grid.
+ *-----------------------------------------------------------------------*/
+
+int              ReadParflowBLayout(
+                                    char *       file_name,
+                                    double *     coords,
+                                    int *        sizes,
+                                    PFBSubgrid **subgrids)
+{
+  FILE       *fp;
+  PFBSubgrid *sg;
+  int header[9];
+  int n, ok;
+
+  if ((fp = fopen(file_name, "rb")) == NULL)
+    return 0;
+
+  tools_ReadDouble(fp, &coords[0], 3);
+  tools_ReadInt(fp, &sizes[0], 3);
+  tools_ReadDouble(fp, &coords[3], 3);
+  tools_ReadInt(fp, &sizes[3], 1);
+
+  ok = !feof(fp) && !ferror(fp) &&
+       sizes[0] >= 0 && sizes[1] >= 0 && sizes[2] >= 0 && sizes[3] >= 0;
+
+  if (ok && subgrids)
+  {
+    *subgrids = (PFBSubgrid*)malloc((sizes[3] + 1) * sizeof(PFBSubgrid));
+
+    for (n = 0; ok && n < sizes[3]; n++)
+    {
+      sg = &(*subgrids)[n];
+
+      tools_ReadInt(fp, header, 9);
+
+      sg->x = header[0]; sg->y = header[1]; sg->z = header[2];
+      sg->nx = header[3]; sg->ny = header[4]; sg->nz = header[5];
+      sg->rx = header[6]; sg->ry = header[7]; sg->rz = header[8];
+      sg->offset = ftell(fp);
+
+      ok = !feof(fp) && !ferror(fp) &&
+           sg->x >= 0 && sg->y >= 0 && sg->z >= 0 &&
+           sg->nx >= 0 && sg->ny >= 0 && sg->nz >= 0 &&
+           sg->x + sg->nx <= sizes[0] && sg->y + sg->ny <= sizes[1] &&
+           sg->z + sg->nz <= sizes[2] &&
+           fseek(fp, (long)sg->nx * sg->ny * sg->nz * 8, SEEK_CUR) == 0;
+    }
+
+    if (!ok)
+    {
+      free(*subgrids);
+      *subgrids = NULL;
+    }
+  }
+
+  fclose(fp);
+  return ok;
+}
+
+
+/*-----------------------------------------------------------------------
+ * map a binary `parflow' file
+ *
+ * Like ReadParflowB but only the subgrid headers are read here; the
+ * values of a z layer are read from the file and decoded the first time
+ * the layer is requested with DataboxLoad.  Unless lazy is set every
+ * layer is decoded before returning.
+ *
+ * A lazily loaded databox reads the file again when its layers are
+ * decoded, so the file must not change until then; DataboxLoad fails if
+ * its size or modification time differ from when it was indexed.
+ *-----------------------------------------------------------------------*/
+
+Databox         *MapParflowB(
+                             char * file_name,
+                             double default_value,
+                             int    lazy)
+{
+#ifdef PARFLOW_HAVE_PREAD
+  Databox         *v;
+  DataboxMap      *map;
+
+  struct stat st;
+  int fd;
+
+  double X, Y, Z;
+  int NX, NY, NZ;
+  double DX, DY, DZ;
+
+  char header[64];
+  off_t pos, size;
+  int    *sg;
+  int nsg;
+
+  if ((fd = open(file_name, O_RDONLY)) < 0)
+    return NULL;
+
+  if (fstat(fd, &st) || !MapRead(fd, header, 64, 0))
+  {
+    close(fd);
+    return NULL;
+  }
+
+  map = (DataboxMap*)calloc(1, sizeof(DataboxMap));
+  map->file_size = st.st_size;
+  map->file_mtime = st.st_mtime;
+
+  /* read in header info */
+  MapCopy(&X, header, 8, 1);
+  MapCopy(&Y, header + 8, 8, 1);
+  MapCopy(&Z, header + 16, 8, 1);
+
+  MapCopy(&NX, header + 24, 4, 1);
+  MapCopy(&NY, header + 28, 4, 1);
+  MapCopy(&NZ, header + 32, 4, 1);
+
+  MapCopy(&DX, header + 36, 8, 1);
+  MapCopy(&DY, header + 44, 8, 1);
+  MapCopy(&DZ, header + 52, 8, 1);
+
+  MapCopy(&map->num_subgrids, header + 60, 4, 1);
+
+  if (NX < 0 || NY < 0 || NZ < 0 || map->num_subgrids < 0)
+  {
+    close(fd);
+    free(map);
+    return NULL;
+  }
+
+  /* find the values of each subgrid */
+  map->subgrids = (int*)malloc((size_t)(map->num_subgrids + 1) * 6 * sizeof(int));
+  map->offsets = (off_t*)malloc((size_t)(map->num_subgrids + 1) * sizeof(off_t));
+
+  pos = 64;
+  for (nsg = 0; nsg < map->num_subgrids; nsg++)
+  {
+    sg = &map->subgrids[6 * nsg];
+
+    if (!MapRead(fd, header, 36, pos))
+      break;
+
+    MapCopy(sg, header, 4, 6);
+    pos += 36;
+
+    if (sg[0] < 0 || sg[1] < 0 || sg[2] < 0 || sg[3] < 0 || sg[4] < 0 || sg[5] < 0 ||
+        sg[0] + sg[3] > NX || sg[1] + sg[4] > NY || sg[2] + sg[5] > NZ)
+      break;
+
+    size = (off_t)sg[3] * sg[4] * sg[5] * 8;
+    if (pos + size > map->file_size)
+      break;
+
+    map->offsets[nsg] = pos;
+    pos += size;
+  }
+
+  close(fd);
+
+  if (nsg < map->num_subgrids)
+  {
+    FreeMap(map);
+    return NULL;
+  }
+
+  /* create the new databox structure, layers are filled when decoded */
+  if ((v = (Databox*)calloc(1, sizeof(Databox))) == NULL ||
+      (DataboxCoeffs(v) = (double*)calloc((size_t)NX * (size_t)NY * (size_t)NZ + 1,
+                                          sizeof(double))) == NULL)
+  {
+    free(v);
+    FreeMap(map);
+    return NULL;
+  }
+
+  SetDataboxGrid(v, NX, NY, NZ, X, Y, Z, DX, DY, DZ);
+
+  map->databox = v;
+  map->file_name = strdup(file_name);
+  map->loaded = (char*)calloc((size_t)NZ + 1, sizeof(char));
+  map->default_value = default_value;
+
+  map->next = databox_maps;
+  databox_maps = map;
+
+  if (NZ == 0)
+  {
+    FreeMap(map);
+  }
+  else if (!lazy && DataboxLoad(v, 0, NZ))
+  {
+    FreeDatabox(v);
+    return NULL;
+  }
+
+  return v;
+#else
+  (void)lazy;
+  return ReadParflowB(file_name, default_value);
+#endif
+}
+
+
+/*-----------------------------------------------------------------------
+ * decode z layers z to z+nz-1 of a databox created by MapParflowB
+ *
+ * Does nothing for other databoxes or layers that are already decoded.
+ * Once every layer is decoded the index is released and the databox is
+ * an ordinary one.  Returns 0 on success and -1 if the file can not be
+ * read or changed since it was indexed.
+ *-----------------------------------------------------------------------*/
+
+int             DataboxLoad(
+                            Databox *databox,
+                            int      z,
+                            int      nz)
+{
+#ifdef PARFLOW_HAVE_PREAD
+  DataboxMap      *map;
+  struct stat st;
+  int fd;
+  int    *sg;
+  char   *buffer = NULL;
+  size_t n, num, plane, max_plane = 0;
+  int nsg, j, k;
+  int failed = 0;
+
+  if ((map = FindDataboxMap(databox)) == NULL)
+    return 0;
+
+  if (z < 0)
+  {
+    nz += z;
+    z = 0;
+  }
+  if (z + nz > DataboxNz(databox))
+  {
+    nz = DataboxNz(databox) - z;
+  }
+
+  for (k = z; k < z + nz && map->loaded[k]; k++)
+  {
+    ;
+  }
+  if (k == z + nz)
+    return 0;
+
+  if ((fd = open(map->file_name, O_RDONLY)) < 0 || fstat(fd, &st) ||
+      st.st_size != map->file_size || st.st_mtime != map->file_mtime)
+  {
+    printf("Error: <%s> changed since it was loaded\n", map->file_name);
+    if (fd >= 0)
+      close(fd);
+    return -1;
+  }
+
+  for (nsg = 0; nsg < map->num_subgrids; nsg++)
+  {
+    sg = &map->subgrids[6 * nsg];
+    plane = (size_t)sg[3] * sg[4] * 8;
+    if (plane > max_plane)
+      max_plane = plane;
+  }
+  buffer = (char*)malloc(max_plane + 1);
+
+  for (k = z; k < z + nz && !failed; k++)
+  {
+    if (map->loaded[k])
+      continue;
+
+    num = (size_t)DataboxNx(databox) * DataboxNy(databox);
+    for (n = 0; n < num; n++)
+    {
+      DataboxCoeff(databox, 0, 0, k)[n] = map->default_value;
+    }
+
+    /* read the slab of each subgrid in this layer */
+    for (nsg = 0; nsg < map->num_subgrids && !failed; nsg++)
+    {
+      sg = &map->subgrids[6 * nsg];
+      if (k < sg[2] || k >= sg[2] + sg[5])
+        continue;
+
+      plane = (size_t)sg[3] * sg[4] * 8;
+      if (!MapRead(fd, buffer, plane, map->offsets[nsg] + (off_t)(k - sg[2]) * plane))
+      {
+        failed = 1;
+        break;
+      }
+
+      for (j = 0; j < sg[4]; j++)
+      {
+        MapCopy(DataboxCoeff(databox, sg[0], sg[1] + j, k),
+                buffer + (size_t)j * sg[3] * 8, 8, (size_t)sg[3]);
+      }
+    }
+
+    if (!failed)
+    {
+      map->loaded[k] = 1;
+      map->num_loaded++;
+    }
+  }
+
+  free(buffer);
+  close(fd);
+
+  if (failed)
+    return -1;
+
+  if (map->num_loaded == DataboxNz(databox))
+  {
+    FreeMap(map);
+  }
+#else
+  (void)databox;
+  (void)z;
+  (void)nz;
+#endif
+
+  return 0;
+}
+
+
+/*-----------------------------------------------------------------------
+ * decode all z layers of a databox created by MapParflowB
+ *
+ * Returns the databox, or NULL if its layers can not be read.  Pointers
+ * that are not mapped databoxes (e.g. other data sets in the pftools hash
+ * table) are returned unchanged.
+ *-----------------------------------------------------------------------*/
+
+Databox         *DataboxLoadAll(
+                                Databox *databox)
+{
+#ifdef PARFLOW_HAVE_PREAD
+  if (databox_maps != NULL && FindDataboxMap(databox) != NULL &&
+      DataboxLoad(databox, 0, DataboxNz(databox)))
+  {
+    return NULL;
+  }
+#endif
+
+  return databox;
+}
+
+
+/*-----------------------------------------------------------------------
+ * release the index of a databox that is being freed
+ *-----------------------------------------------------------------------*/
+
+void            DataboxUnmap(
+                             Databox *databox)
+{
+#ifdef PARFLOW_HAVE_PREAD
+  DataboxMap      *map;
+
+  if (databox_maps != NULL && (map = FindDataboxMap(databox)) != NULL)
+  {
+    FreeMap(map);
+  }
+#endif
+}
+
+
 /*-----------------------------------------------------------------------
  * read a scattered binary `parflow' file
  *-----------------------------------------------------------------------*/
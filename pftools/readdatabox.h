@@ -59,12 +59,25 @@ extern "C" {
 #define NULL ((void*)0)
 #endif
 
+/*-----------------------------------------------------------------------
+ * Position of a subgrid in a `parflow' binary file
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  int x, y, z;
+  int nx, ny, nz;
+  int rx, ry, rz;
+  long offset;              /* file offset of the first value */
+} PFBSubgrid;
+
 /*-----------------------------------------------------------------------
  * function prototypes
  *-----------------------------------------------------------------------*/
 
 /* readdatabox.c */
+int ReadParflowBLayout(char *file_name, double *coords, int *sizes, PFBSubgrid **subgrids);
 Databox *ReadParflowB(char *file_name, double default_value);
+Databox *MapParflowB(char *file_name, double default_value, int lazy);
 Databox *ReadParflowSB(char *file_name, double default_value);
 Databox *ReadSimpleA(char *file_name, double default_value);
 Databox *ReadRealSA(char *file_name, double default_value);
@@ -0,0 +1,485 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Reduce a time series of PFB files
+*
+* Combines the files basename.%05d.pfb of a run cell by cell into mean,
+* min, max, sum and variance fields without loading whole files.  The
+* domain is cut into pieces of the subgrids in the files; each piece is
+* read from every file of the series, reduced and written to the outputs
+* before the next one is started, so the memory used is a few pieces per
+* thread.  With OpenMP the pieces are reduced in parallel; each thread
+* keeps one handle open on every file of the series and on every output.
+*
+*****************************************************************************/
+
+#include "reduce.h"
+#include "readdatabox.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Upper bound on the values in a piece, unless one xy plane is larger */
+#define REDUCE_PIECE_VALUES (1 << 20)
+
+/* Size of the header and of a subgrid header in a PFB file */
+#define REDUCE_HEADER_SIZE  64
+#define REDUCE_SUBGRID_SIZE 36
+
+typedef struct {
+  int subgrid;
+  int z;                    /* first z plane of the subgrid in the piece */
+  int nz;
+} ReducePiece;
+
+static char *reduce_names[REDUCE_NUM_OPERATIONS] =
+{ "mean", "min", "max", "sum", "variance" };
+
+
+/*-----------------------------------------------------------------------
+ * Name of a single REDUCE_ operation, NULL if it is not one
+ *-----------------------------------------------------------------------*/
+
+char       *ReduceOperationName(int operation)
+{
+  int n;
+
+  for (n = 0; n < REDUCE_NUM_OPERATIONS; n++)
+  {
+    if (operation == (1 << n))
+    {
+      return reduce_names[n];
+    }
+  }
+
+  return NULL;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Big endian conversion of arrays of values
+ *-----------------------------------------------------------------------*/
+
+static void ReduceSwap(void *data, int size, long num)
+{
+#ifndef CASC_HAVE_BIGENDIAN
+  char *p = (char*)data;
+  char tmp;
+  long n;
+  int b;
+
+  for (n = 0; n < num; n++, p += size)
+  {
+    for (b = 0; b < size / 2; b++)
+    {
+      tmp = p[b];
+      p[b] = p[size - 1 - b];
+      p[size - 1 - b] = tmp;
+    }
+  }
+#endif
+}
+
+static int ReduceRead(FILE *fp, void *data, int size, long num)
+{
+  if (fread(data, size, num, fp) != (size_t)num)
+    return 0;
+
+  ReduceSwap(data, size, num);
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Check that a file of the series has the grid and the subgrid layout
+ * of the first file
+ *-----------------------------------------------------------------------*/
+
+static int ReduceLayoutMatches(
+                               char *      file_name,
+                               double *    coords,
+                               int *       sizes,
+                               PFBSubgrid *subgrids)
+{
+  PFBSubgrid *file_subgrids = NULL;
+  double file_coords[6];
+  int file_sizes[4];
+  int ok, n, s;
+
+  ok = ReadParflowBLayout(file_name, file_coords, file_sizes, &file_subgrids);
+
+  /* the origin and the spacing must match as well as the sizes */
+  for (n = 0; n < 6 && ok; n++)
+  {
+    ok = (file_coords[n] == coords[n]);
+  }
+
+  for (n = 0; n < 4 && ok; n++)
+  {
+    ok = (file_sizes[n] == sizes[n]);
+  }
+
+  for (s = 0; s < sizes[3] && ok; s++)
+  {
+    PFBSubgrid *sg = &subgrids[s];
+    PFBSubgrid *file_sg = &file_subgrids[s];
+
+    ok = file_sg->x == sg->x && file_sg->y == sg->y && file_sg->z == sg->z &&
+         file_sg->nx == sg->nx && file_sg->ny == sg->ny && file_sg->nz == sg->nz &&
+         file_sg->offset == sg->offset;
+  }
+
+  free(file_subgrids);
+  return ok;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Read the values of a piece from one file of the series
+ *-----------------------------------------------------------------------*/
+
+static int ReadPFBPiece(
+                        FILE *       fp,
+                        PFBSubgrid * sg,
+                        ReducePiece *piece,
+                        double *     values)
+{
+  return fseek(fp, sg->offset + (long)piece->z * sg->nx * sg->ny * 8, SEEK_SET) == 0 &&
+         ReduceRead(fp, values, 8, (long)sg->nx * sg->ny * piece->nz);
+}
+
+
+/*-----------------------------------------------------------------------
+ * Reduce the files basename.start.pfb, basename.(start+interval).pfb, ...
+ * up to stop and write output.<operation>.pfb for each of the given
+ * operations.  The outputs have the subgrids of the first file.  The
+ * variance is the population variance over the series.
+ *
+ * Returns the number of files reduced, or -1 if a file could not be read
+ * or does not match the first one, or an output could not be written.
+ *-----------------------------------------------------------------------*/
+
+int         ReducePFBSeries(
+                            char *basename,
+                            int   start,
+                            int   stop,
+                            int   interval,
+                            int   operations,
+                            char *output)
+{
+  PFBSubgrid *subgrids;
+  ReducePiece   *pieces;
+  char         **files;
+  char          *outputs[REDUCE_NUM_OPERATIONS];
+
+  double coords[6];
+  int sizes[4];
+  int num_files, num_pieces, max_piece;
+  int failed = 0;
+  int n, op, s, z;
+
+  if (interval <= 0 || stop < start)
+    return -1;
+
+  /*-----------------------------------------------------------------------
+   * Check the series against the first file
+   *-----------------------------------------------------------------------*/
+
+  num_files = (stop - start) / interval + 1;
+  files = (char**)malloc(num_files * sizeof(char*));
+  for (n = 0; n < num_files; n++)
+  {
+    files[n] = (char*)malloc(strlen(basename) + 32);
+    sprintf(files[n], "%s.%05d.pfb", basename, start + n * interval);
+  }
+
+  subgrids = NULL;
+  failed = !ReadParflowBLayout(files[0], coords, sizes, &subgrids);
+
+  for (n = 1; n < num_files && !failed; n++)
+  {
+    failed = !ReduceLayoutMatches(files[n], coords, sizes, subgrids);
+  }
+
+  /*-----------------------------------------------------------------------
+   * Cut the subgrids into pieces of whole xy planes
+   *-----------------------------------------------------------------------*/
+
+  num_pieces = 0;
+  max_piece = 0;
+  pieces = NULL;
+  if (!failed)
+  {
+    int num_alloc = 0;
+
+    for (s = 0; s < sizes[3]; s++)
+    {
+      long plane = (long)subgrids[s].nx * subgrids[s].ny;
+      int step = (plane > 0 && plane < REDUCE_PIECE_VALUES) ?
+                 (int)(REDUCE_PIECE_VALUES / plane) : 1;
+
+      if (plane == 0)
+        continue;
+
+      for (z = 0; z < subgrids[s].nz; z += step)
+      {
+        if (num_pieces == num_alloc)
+        {
+          num_alloc = 2 * num_alloc + 16;
+          pieces = (ReducePiece*)realloc(pieces, num_alloc * sizeof(ReducePiece));
+        }
+
+        pieces[num_pieces].subgrid = s;
+        pieces[num_pieces].z = z;
+        pieces[num_pieces].nz = (z + step < subgrids[s].nz) ? step : subgrids[s].nz - z;
+
+        if (plane * pieces[num_pieces].nz > max_piece)
+          max_piece = (int)(plane * pieces[num_pieces].nz);
+
+        num_pieces++;
+      }
+    }
+  }
+
+  /*-----------------------------------------------------------------------
+   * Write the headers of the outputs; the values are filled in by piece
+   *-----------------------------------------------------------------------*/
+
+  for (op = 0; op < REDUCE_NUM_OPERATIONS; op++)
+  {
+    FILE *fp;
+    double header_doubles[3];
+    int header_ints[9];
+
+    outputs[op] = NULL;
+    if (failed || !(operations & (1 << op)))
+      continue;
+
+    outputs[op] = (char*)malloc(strlen(output) + 32);
+    sprintf(outputs[op], "%s.%s.pfb", output, reduce_names[op]);
+
+    if ((fp = fopen(outputs[op], "wb")) == NULL)
+    {
+      failed = 1;
+      continue;
+    }
+
+    memcpy(header_doubles, coords, 3 * sizeof(double));
+    ReduceSwap(header_doubles, 8, 3);
+    fwrite(header_doubles, 8, 3, fp);
+    memcpy(header_ints, sizes, 3 * sizeof(int));
+    ReduceSwap(header_ints, 4, 3);
+    fwrite(header_ints, 4, 3, fp);
+    memcpy(header_doubles, coords + 3, 3 * sizeof(double));
+    ReduceSwap(header_doubles, 8, 3);
+    fwrite(header_doubles, 8, 3, fp);
+    header_ints[0] = sizes[3];
+    ReduceSwap(header_ints, 4, 1);
+    fwrite(header_ints, 4, 1, fp);
+
+    for (s = 0; s < sizes[3]; s++)
+    {
+      PFBSubgrid *sg = &subgrids[s];
+
+      header_ints[0] = sg->x; header_ints[1] = sg->y; header_ints[2] = sg->z;
+      header_ints[3] = sg->nx; header_ints[4] = sg->ny; header_ints[5] = sg->nz;
+      header_ints[6] = sg->rx; header_ints[7] = sg->ry; header_ints[8] = sg->rz;
+      ReduceSwap(header_ints, 4, 9);
+
+      fseek(fp, sg->offset - REDUCE_SUBGRID_SIZE, SEEK_SET);
+      fwrite(header_ints, 4, 9, fp);
+    }
+
+    if (ferror(fp))
+      failed = 1;
+    fclose(fp);
+  }
+
+  /*-----------------------------------------------------------------------
+   * Reduce the pieces
+   *-----------------------------------------------------------------------*/
+
+  if (!failed && num_pieces > 0)
+  {
+#ifdef _OPENMP
+    #pragma omp parallel private(n, op)
+#endif
+    {
+      double *values = (double*)malloc(max_piece * sizeof(double));
+      double *mean = (double*)malloc(max_piece * sizeof(double));
+      double *m2 = (double*)malloc(max_piece * sizeof(double));
+      double *min = (double*)malloc(max_piece * sizeof(double));
+      double *max = (double*)malloc(max_piece * sizeof(double));
+      double *sum = (double*)malloc(max_piece * sizeof(double));
+      FILE  **in = (FILE**)calloc(num_files, sizeof(FILE*));
+      FILE   *out[REDUCE_NUM_OPERATIONS] = { NULL };
+      int ok = 1;
+      int p;
+
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic)
+#endif
+      for (p = 0; p < num_pieces; p++)
+      {
+        ReducePiece   *piece = &pieces[p];
+        PFBSubgrid *sg = &subgrids[piece->subgrid];
+        int size = sg->nx * sg->ny * piece->nz;
+        int m;
+
+        if (!ok)
+          continue;
+
+        for (n = 0; n < num_files && ok; n++)
+        {
+          if (!in[n])
+            in[n] = fopen(files[n], "rb");
+
+          ok = in[n] && ReadPFBPiece(in[n], sg, piece, values);
+          if (!ok)
+            break;
+
+          if (n == 0)
+          {
+            for (m = 0; m < size; m++)
+            {
+              mean[m] = values[m];
+              m2[m] = 0.0;
+              min[m] = values[m];
+              max[m] = values[m];
+              sum[m] = values[m];
+            }
+          }
+          else
+          {
+            /* running mean and sum of squared deviations (Welford) */
+            double count = n + 1;
+
+            for (m = 0; m < size; m++)
+            {
+              double delta = values[m] - mean[m];
+              mean[m] += delta / count;
+              m2[m] += delta * (values[m] - mean[m]);
+              min[m] = (values[m] < min[m]) ? values[m] : min[m];
+              max[m] = (values[m] > max[m]) ? values[m] : max[m];
+              sum[m] += values[m];
+            }
+          }
+        }
+
+        for (op = 0; op < REDUCE_NUM_OPERATIONS && ok; op++)
+        {
+          double *result;
+
+          if (!outputs[op])
+            continue;
+
+          switch (1 << op)
+          {
+            case REDUCE_MEAN:
+              result = mean;
+              break;
+
+            case REDUCE_MIN:
+              result = min;
+              break;
+
+            case REDUCE_MAX:
+              result = max;
+              break;
+
+            case REDUCE_SUM:
+              result = sum;
+              break;
+
+            default:
+              for (m = 0; m < size; m++)
+              {
+                values[m] = m2[m] / num_files;
+              }
+              result = values;
+              break;
+          }
+
+          ReduceSwap(result, 8, size);
+
+          if (!out[op])
+            out[op] = fopen(outputs[op], "r+b");
+
+          ok = out[op] &&
+               fseek(out[op], sg->offset + (long)piece->z * sg->nx * sg->ny * 8, SEEK_SET) == 0 &&
+               fwrite(result, 8, size, out[op]) == (size_t)size;
+        }
+      }
+
+      for (n = 0; n < num_files; n++)
+      {
+        if (in[n])
+          fclose(in[n]);
+      }
+
+      for (op = 0; op < REDUCE_NUM_OPERATIONS; op++)
+      {
+        if (out[op])
+          ok = (fclose(out[op]) == 0) && ok;
+      }
+
+      if (!ok)
+      {
+#ifdef _OPENMP
+        #pragma omp atomic write
+#endif
+        failed = 1;
+      }
+
+      free(values);
+      free(mean);
+      free(m2);
+      free(min);
+      free(max);
+      free(sum);
+      free(in);
+    }
+  }
+
+  for (op = 0; op < REDUCE_NUM_OPERATIONS; op++)
+  {
+    free(outputs[op]);
+  }
+
+  for (n = 0; n < num_files; n++)
+  {
+    free(files[n]);
+  }
+  free(files);
+  free(subgrids);
+  free(pieces);
+
+  return failed ? -1 : num_files;
+}
@@ -0,0 +1,63 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#ifndef REDUCE_HEADER
+#define REDUCE_HEADER
+
+#include "parflow_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------
+ * Reductions over a series of files; combined as bit flags
+ *-----------------------------------------------------------------------*/
+
+#define REDUCE_MEAN      1
+#define REDUCE_MIN       2
+#define REDUCE_MAX       4
+#define REDUCE_SUM       8
+#define REDUCE_VARIANCE 16
+
+#define REDUCE_NUM_OPERATIONS 5
+
+/*-----------------------------------------------------------------------
+ * function prototypes
+ *-----------------------------------------------------------------------*/
+
+/* reduce.c */
+char *ReduceOperationName(int operation);
+int ReducePFBSeries(char *basename, int start, int stop, int interval,
+                    int operations, char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,6 +37,7 @@
 *****************************************************************************/
 
 #include "stats.h"
+#include "kernels.h"
 
 /*-----------------------------------------------------------------------
  * Print various statistics
@@ -51,73 +52,14 @@ void        Stats(
                   double * variance,
                   double * stdev)
 {
-  double  *dp;
+  KernelStats stats;
 
-  double dtmp;
+  KernelStatistics(databox, &stats);
 
-  int i, j, k;
-  int nx, ny, nz, n;
-
-
-  nx = DataboxNx(databox);
-  ny = DataboxNy(databox);
-  nz = DataboxNz(databox);
-  n = nx * ny * nz;
-
-  /*---------------------------------------------------
-   * Compute min, max, mean
-   *---------------------------------------------------*/
-
-  dp = DataboxCoeffs(databox);
-
-  *min = *dp;
-  *max = *dp;
-  *mean = 0.0;
-  *sum = 0.0;
-
-  for (k = 0; k < nz; k++)
-  {
-    for (j = 0; j < ny; j++)
-    {
-      for (i = 0; i < nx; i++)
-      {
-        if (*dp < *min)
-          *min = *dp;
-
-        if (*dp > *max)
-          *max = *dp;
-
-        *sum += *dp;
-
-        dp++;
-      }
-    }
-  }
-
-  *mean = *sum / n;
-
-  /*---------------------------------------------------
-   * Compute variance, standard deviation
-   *---------------------------------------------------*/
-
-  dp = DataboxCoeffs(databox);
-
-  *variance = 0.0;
-
-  for (k = 0; k < nz; k++)
-  {
-    for (j = 0; j < ny; j++)
-    {
-      for (i = 0; i < nx; i++)
-      {
-        dtmp = (*dp - *mean);
-        *variance += dtmp * dtmp;
-
-        dp++;
-      }
-    }
-  }
-
-  *variance /= n;
+  *min = stats.min;
+  *max = stats.max;
+  *mean = stats.mean;
+  *sum = stats.sum;
+  *variance = stats.variance;
   *stdev = sqrt(*variance);
 }
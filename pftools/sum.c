@@ -27,6 +27,7 @@
  **********************************************************************EHEADER*/
 
 #include "databox.h"
+#include "kernels.h"
 
 
 /*****************************************************************************
@@ -41,24 +42,7 @@
 
 void       Sum(Databox *X, double *sum)
 {
-  int nx, ny, nz;
-  double         *xp;
-  int m;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-
-  m = 0;
-
-  *sum = 0;
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    *sum += xp[m];
-  }
+  *sum = KernelSum(X);
 }
 
 
@@ -67,27 +51,7 @@ void       Sum(Databox *X, double *sum)
  *-----------------------------------------------------------------------*/
 void       CellSum(Databox *X, Databox *Y, Databox *mask, Databox *sum)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *sum_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  sum_val = DataboxCoeffs(sum);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      sum_val[m] = xp[m] + yp[m];
-    }
-  }
+  KernelCellwise(KERNEL_CELL_SUM, X, Y, mask, sum);
 }
 
 
@@ -96,27 +60,7 @@ void       CellSum(Databox *X, Databox *Y, Databox *mask, Databox *sum)
  *-----------------------------------------------------------------------*/
 void       CellDiff(Databox *X, Databox *Y, Databox *mask, Databox *diff)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *diff_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  diff_val = DataboxCoeffs(diff);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      diff_val[m] = xp[m] - yp[m];
-    }
-  }
+  KernelCellwise(KERNEL_CELL_DIFF, X, Y, mask, diff);
 }
 
 
@@ -125,27 +69,7 @@ void       CellDiff(Databox *X, Databox *Y, Databox *mask, Databox *diff)
  *-----------------------------------------------------------------------*/
 void       CellMult(Databox *X, Databox *Y, Databox *mask, Databox *mult)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *mult_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  mult_val = DataboxCoeffs(mult);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      mult_val[m] = xp[m] * yp[m];
-    }
-  }
+  KernelCellwise(KERNEL_CELL_MULT, X, Y, mask, mult);
 }
 
 
@@ -154,27 +78,7 @@ void       CellMult(Databox *X, Databox *Y, Databox *mask, Databox *mult)
  *-----------------------------------------------------------------------*/
 void       CellDiv(Databox *X, Databox *Y, Databox *mask, Databox *div)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *div_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  div_val = DataboxCoeffs(div);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      div_val[m] = xp[m] / yp[m];
-    }
-  }
+  KernelCellwise(KERNEL_CELL_DIV, X, Y, mask, div);
 }
 
 
@@ -28,6 +28,7 @@
 #include "top.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 
@@ -39,14 +40,16 @@
  * non-zero entry is the top.
  *
  * Returns a top Databox with (z) indices of the top surface for each
- * i,j location.
+ * i,j location.  Returns -1 if the layers of a lazily loaded mask can
+ * not be read, 0 otherwise.
  *
  *-----------------------------------------------------------------------*/
 
-void ComputeTop(Databox *mask, Databox  *top)
+int ComputeTop(Databox *mask, Databox  *top)
 {
   int i, j, k;
   int nx, ny, nz;
+  long remaining;
 
   nx = DataboxNx(mask);
   ny = DataboxNy(mask);
@@ -56,24 +59,35 @@ void ComputeTop(Databox *mask, Databox  *top)
   {
     for (i = 0; i < nx; i++)
     {
-      for (k = nz - 1; k >= 0; --k)
+      *(DataboxCoeff(top, i, j, 0)) = -1;
+    }
+  }
+
+  /* Sweep down one layer at a time so a lazily loaded mask only decodes
+   * the layers down to the deepest top. */
+  remaining = (long)nx * ny;
+  for (k = nz - 1; k >= 0 && remaining > 0; --k)
+  {
+    if (DataboxLoad(mask, k, 1))
+    {
+      return -1;
+    }
+
+    for (j = 0; j < ny; j++)
+    {
+      for (i = 0; i < nx; i++)
       {
-        if (*(DataboxCoeff(mask, i, j, k)) > 0.0)
+        if (*(DataboxCoeff(top, i, j, 0)) < 0 &&
+            *(DataboxCoeff(mask, i, j, k)) > 0.0)
         {
-          break;
+          *(DataboxCoeff(top, i, j, 0)) = k;
+          remaining--;
         }
       }
-
-      if (k >= 0)
-      {
-        *(DataboxCoeff(top, i, j, 0)) = k;
-      }
-      else
-      {
-        *(DataboxCoeff(top, i, j, 0)) = -1;
-      }
     }
   }
+
+  return 0;
 }
 
 void ComputeBottom(Databox *mask, Databox  *bottom)
@@ -117,18 +131,41 @@ void ComputeBottom(Databox *mask, Databox  *bottom)
  * z indices that define the top of the domain).
  *
  * Returns a Databox with top values extracted for each i,j location.
+ * Returns -1 if the layers of a lazily loaded dataset can not be read,
+ * 0 otherwise.
  *
  *-----------------------------------------------------------------------*/
 
-void ExtractTop(Databox *top, Databox  *data, Databox *top_values_of_data)
+int ExtractTop(Databox *top, Databox  *data, Databox *top_values_of_data)
 {
   int i, j;
   int nx, ny, nz;
+  char *layers;
 
   nx = DataboxNx(data);
   ny = DataboxNy(data);
   nz = DataboxNz(data);
 
+  /* Only the layers holding a top need to be loaded */
+  layers = (char*)calloc(nz + 1, sizeof(char));
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      int k = *(DataboxCoeff(top, i, j, 0));
+      if (k >= 0 && k < nz && !layers[k])
+      {
+        layers[k] = 1;
+        if (DataboxLoad(data, k, 1))
+        {
+          free(layers);
+          return -1;
+        }
+      }
+    }
+  }
+  free(layers);
+
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
@@ -149,4 +186,6 @@ void ExtractTop(Databox *top, Databox  *data, Databox *top_values_of_data)
       }
     }
   }
+
+  return 0;
 }
@@ -38,9 +38,9 @@ extern "C" {
  * function prototypes
  *-----------------------------------------------------------------------*/
 
-void ComputeTop(Databox *mask, Databox  *top);
+int ComputeTop(Databox *mask, Databox  *top);
 void ComputeBottom(Databox *mask, Databox  *bottom);
-void ExtractTop(Databox *v1, Databox *v2, Databox *v3);
+int ExtractTop(Databox *v1, Databox *v2, Databox *v3);
 
 #ifdef __cplusplus
 }
@@ -27,6 +27,7 @@
  **********************************************************************EHEADER*/
 #include "toposlopes.h"
 #include <math.h>
+#include <stdlib.h>
 
 
 /*-----------------------------------------------------------------------
@@ -1499,11 +1500,178 @@ void ComputeParentMap(int      i,
 }
 
 
+/*-----------------------------------------------------------------------
+ * UpstreamReceivers:
+ *
+ * Finds the cells that [i,j] drains into, the neighbors [i,j] is a parent
+ * of (see ComputeTestParent).  A cell with nonzero slopes in both x and y
+ * drains into two cells.  Returns the number of receivers; their indices
+ * (j*nx+i) are stored in receivers.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int UpstreamReceivers(
+                             int      i,
+                             int      j,
+                             Databox *dem,
+                             Databox *sx,
+                             Databox *sy,
+                             int *    receivers)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int ii, jj;
+  int n, num = 0;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return 0;
+  }
+
+  for (n = 0; n < 2; n++)
+  {
+    ii = i;
+    jj = j;
+
+    if (n == 0)
+    {
+      if (*DataboxCoeff(sx, i, j, 0) < 0.)
+      {
+        ii = i + 1;
+      }
+      else if (*DataboxCoeff(sx, i, j, 0) > 0.)
+      {
+        ii = i - 1;
+      }
+    }
+    else
+    {
+      if (*DataboxCoeff(sy, i, j, 0) < 0.)
+      {
+        jj = j + 1;
+      }
+      else if (*DataboxCoeff(sy, i, j, 0) > 0.)
+      {
+        jj = j - 1;
+      }
+    }
+
+    if ((ii != i || jj != j) && ii >= 0 && jj >= 0 && ii < nx && jj < ny &&
+        *DataboxCoeff(dem, ii, jj, 0) != -9999.0)
+    {
+      receivers[num++] = jj * nx + ii;
+    }
+  }
+
+  return num;
+}
+
+
+/*-----------------------------------------------------------------------
+ * UpstreamParents:
+ *
+ * Finds the parents of cell [i,j], the neighbors that drain into it.
+ * Returns the number of parents; their indices (j*nx+i) are stored in
+ * parents.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int UpstreamParents(
+                           int      i,
+                           int      j,
+                           Databox *dem,
+                           Databox *sx,
+                           Databox *sy,
+                           int *    parents)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int num = 0;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return 0;
+  }
+
+  if (i > 0 && *DataboxCoeff(dem, i - 1, j, 0) != -9999.0 &&
+      *DataboxCoeff(sx, i - 1, j, 0) < 0.)
+  {
+    parents[num++] = j * nx + i - 1;
+  }
+  if (i < nx - 1 && *DataboxCoeff(dem, i + 1, j, 0) != -9999.0 &&
+      *DataboxCoeff(sx, i + 1, j, 0) > 0.)
+  {
+    parents[num++] = j * nx + i + 1;
+  }
+  if (j > 0 && *DataboxCoeff(dem, i, j - 1, 0) != -9999.0 &&
+      *DataboxCoeff(sy, i, j - 1, 0) < 0.)
+  {
+    parents[num++] = (j - 1) * nx + i;
+  }
+  if (j < ny - 1 && *DataboxCoeff(dem, i, j + 1, 0) != -9999.0 &&
+      *DataboxCoeff(sy, i, j + 1, 0) > 0.)
+  {
+    parents[num++] = (j + 1) * nx + i;
+  }
+
+  return num;
+}
+
+
+/*-----------------------------------------------------------------------
+ * UpstreamWeight:
+ *
+ * Fraction of the flow of parent p that goes to its receiver c.  A cell
+ * with nonzero slopes in both x and y splits its flow between its two
+ * receivers in proportion to the face fluxes |sx|*dy and |sy|*dx.
+ *
+ *-----------------------------------------------------------------------*/
+
+static double UpstreamWeight(
+                             int      p,
+                             int      c,
+                             Databox *sx,
+                             Databox *sy)
+{
+  int nx = DataboxNx(sx);
+  double dx = DataboxDx(sx);
+  double dy = DataboxDy(sx);
+  double fx, fy;
+
+  // no spacing (e.g. simple ASCII input), weight by the slopes alone
+  if (dx <= 0.0 || dy <= 0.0)
+  {
+    dx = 1.0;
+    dy = 1.0;
+  }
+
+  fx = fabs(*DataboxCoeff(sx, p % nx, p / nx, 0)) * dy;
+  fy = fabs(*DataboxCoeff(sy, p % nx, p / nx, 0)) * dx;
+
+  if (fx == 0.0 || fy == 0.0)
+  {
+    return 1.0;
+  }
+
+  return (p / nx == c / nx) ? fx / (fx + fy) : fy / (fx + fy);
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeUpstreamArea:
  *
- * Computes upstream area for all cells by looping over grid and calling
- * ComputeUpstreamAreaIJ for each cell.
+ * Computes upstream area for all cells, the number of cells that drain
+ * into [i,j] (directly or through other cells) plus [i,j] itself.  A cell
+ * that drains into two neighbors splits its area between them (see
+ * UpstreamWeight), so the area leaving the domain adds up to the number
+ * of active cells.
+ *
+ * The cells are visited in upstream to downstream order (Kahn's algorithm
+ * on the parent counts), one front of cells whose parents are all done at
+ * a time; the cells of a front are independent.  Cells on a slope cycle
+ * are never ready; when no cell is ready the cycle above the first
+ * remaining cell is broken at one of its cells, which only gets the area
+ * of its finished parents.
  *
  * Area returned as NUMBER OF CELLS
  * To get actual area, multiply area_ij*dx*dy
@@ -1515,58 +1683,149 @@ void ComputeUpstreamArea(
                          Databox *sy,
                          Databox *area)
 {
-  int i, j;
-  int ii, jj;
-  int nx, ny, nz;
-  double x, y, z;
-  double dx, dy, dz;
-  Databox        *parentmap;
-
-  // create new databox for parentmap
-  nx = DataboxNx(sx);
-  ny = DataboxNy(sx);
-  nz = DataboxNz(sx);
-  x = DataboxX(sx);
-  y = DataboxY(sx);
-  z = DataboxZ(sx);
-  dx = DataboxDx(sx);
-  dy = DataboxDy(sx);
-  dz = DataboxDz(sx);
-  parentmap = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
+  int nx = DataboxNx(sx);
+  long num_cells = (long)nx * DataboxNy(sx);
+  int neighbors[4];
+  int num_neighbors;
+  int *front;
+  int *next;
+  int *walk = NULL;
+  unsigned char *pending;
+  unsigned char *done;
+  long num_front, num_next;
+  long first = 0;
+  long f, n;
+  int c, m, search = 0;
+
+  front = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+  next = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+  pending = (unsigned char*)malloc((size_t)(num_cells + 1));
+  done = (unsigned char*)malloc((size_t)(num_cells + 1));
+
+  // count the parents of each cell, start from cells without parents
+  num_front = 0;
+  for (n = 0; n < num_cells; n++)
+  {
+    pending[n] = 0;
+    done[n] = 1;
+    if (*DataboxCoeff(dem, n % nx, n / nx, 0) != -9999.0)
+    {
+      pending[n] = (unsigned char)UpstreamParents(n % nx, n / nx, dem, sx, sy,
+                                                  neighbors);
+      done[n] = 0;
+      if (pending[n] == 0)
+      {
+        front[num_front++] = n;
+      }
+    }
+    *DataboxCoeff(area, n % nx, n / nx, 0) = 0.0;
+  }
 
-  // loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  for (;;)
   {
-    for (i = 0; i < nx; i++)
+    if (num_front == 0)
     {
-      // zero out parentmap
-      for (jj = 0; jj < ny; jj++)
+      // the remaining cells are on or below a slope cycle
+      while (first < num_cells && done[first])
       {
-        for (ii = 0; ii < nx; ii++)
+        first++;
+      }
+      if (first == num_cells)
+      {
+        break;
+      }
+
+      // follow unfinished parents upstream until a cell repeats
+      if (walk == NULL)
+      {
+        walk = (int*)calloc((size_t)(num_cells + 1), sizeof(int));
+      }
+      search++;
+      c = first;
+      while (walk[c] != search)
+      {
+        walk[c] = search;
+        num_neighbors = UpstreamParents(c % nx, c / nx, dem, sx, sy, neighbors);
+        for (m = 0; done[neighbors[m]]; m++)
         {
-          *DataboxCoeff(parentmap, ii, jj, 0) = 0.0;
+          ;
         }
+        c = neighbors[m];
       }
+      front[num_front++] = c;
+    }
 
-      // generate parent map for [i,j]
-      // (skip nodata cells...if not nodata, recursive loop)
-      if (*DataboxCoeff(dem, i, j, 0) != -9999.0)
+    // areas of the front, its parents are done
+#ifdef _OPENMP
+    #pragma omp parallel for private(c, m, num_neighbors, neighbors) schedule(static)
+#endif
+    for (f = 0; f < num_front; f++)
+    {
+      double sum = 1.0;
+
+      c = front[f];
+      num_neighbors = UpstreamParents(c % nx, c / nx, dem, sx, sy, neighbors);
+      for (m = 0; m < num_neighbors; m++)
       {
-        ComputeParentMap(i, j, dem, sx, sy, parentmap);
+        if (done[neighbors[m]])
+        {
+          sum += UpstreamWeight(neighbors[m], c, sx, sy) *
+                 *DataboxCoeff(area, neighbors[m] % nx, neighbors[m] / nx, 0);
+        }
       }
+      *DataboxCoeff(area, c % nx, c / nx, 0) = sum;
+      done[c] = 1;
+    }
 
-      // calculate area as sum over parentmap
-      for (jj = 0; jj < ny; jj++)
+    // receivers whose parents are now all done form the next front
+    num_next = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for private(c, m, num_neighbors, neighbors) schedule(static)
+#endif
+    for (f = 0; f < num_front; f++)
+    {
+      c = front[f];
+      num_neighbors = UpstreamReceivers(c % nx, c / nx, dem, sx, sy, neighbors);
+      for (m = 0; m < num_neighbors; m++)
       {
-        for (ii = 0; ii < nx; ii++)
+        unsigned char left;
+        long slot;
+
+        if (done[neighbors[m]])
+        {
+          continue;
+        }
+
+#ifdef _OPENMP
+        #pragma omp atomic capture
+#endif
+        left = --pending[neighbors[m]];
+
+        if (left == 0)
         {
-          *DataboxCoeff(area, i, j, 0) = *DataboxCoeff(area, i, j, 0) + *DataboxCoeff(parentmap, ii, jj, 0);
+#ifdef _OPENMP
+          #pragma omp atomic capture
+#endif
+          slot = num_next++;
+
+          next[slot] = neighbors[m];
         }
       }
-    }   // end loop over i
-  }  // end loop over j
+    }
 
-  FreeDatabox(parentmap);
+    {
+      int *swap = front;
+      front = next;
+      next = swap;
+    }
+    num_front = num_next;
+  }
+
+  free(front);
+  free(next);
+  free(pending);
+  free(done);
+  free(walk);
 }
 
 
@@ -1968,6 +2227,190 @@ int ComputePitFill(
 }
 
 
+/*-----------------------------------------------------------------------
+ * PriorityFloodPush, PriorityFloodPop:
+ *
+ * Binary min-heap of cells ordered by elevation.  Cells with equal
+ * elevations are popped in the order they were pushed so the result does
+ * not depend on the heap layout.
+ *
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  double z;
+  long order;
+  int index;
+} PriorityFloodCell;
+
+static int PriorityFloodLess(
+                             PriorityFloodCell *a,
+                             PriorityFloodCell *b)
+{
+  return (a->z < b->z) || ((a->z == b->z) && (a->order < b->order));
+}
+
+static void PriorityFloodPush(
+                              PriorityFloodCell *heap,
+                              long *             size,
+                              PriorityFloodCell  cell)
+{
+  long n = (*size)++;
+  long parent;
+
+  while (n > 0)
+  {
+    parent = (n - 1) / 2;
+    if (!PriorityFloodLess(&cell, &heap[parent]))
+    {
+      break;
+    }
+    heap[n] = heap[parent];
+    n = parent;
+  }
+  heap[n] = cell;
+}
+
+static PriorityFloodCell PriorityFloodPop(
+                                          PriorityFloodCell *heap,
+                                          long *             size)
+{
+  PriorityFloodCell top = heap[0];
+  PriorityFloodCell last = heap[--(*size)];
+  long n = 0;
+  long child;
+
+  while ((child = 2 * n + 1) < *size)
+  {
+    if ((child + 1 < *size) && PriorityFloodLess(&heap[child + 1], &heap[child]))
+    {
+      child++;
+    }
+    if (!PriorityFloodLess(&heap[child], &last))
+    {
+      break;
+    }
+    heap[n] = heap[child];
+    n = child;
+  }
+  heap[n] = last;
+
+  return top;
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputePriorityFill:
+ *
+ * Fills all depressions in the DEM in a single pass with the priority-flood
+ * algorithm (Barnes et al., 2014).  Cells on the domain edge or next to a
+ * nodata cell (dem=-9999.0) are outlets and keep their elevations.  Starting
+ * from the outlets, cells are visited from the lowest up; each unvisited
+ * neighbor (4-point) of the current cell is raised to at least the current
+ * elevation plus epsilon, so every cell keeps a downhill path to an outlet.
+ *
+ * With epsilon > 0 no filled cell is a sink in the sense of ComputePitFill;
+ * with epsilon = 0 depressions are filled flat.
+ *
+ * Inputs is the DEM to be processed and epsilon.
+ * Outputs is the filled DEM (newdem) and the number of raised cells.
+ *
+ *-----------------------------------------------------------------------*/
+int ComputePriorityFill(
+                        Databox *dem,
+                        double   epsilon,
+                        Databox *newdem)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  long num_cells = (long)nx * ny;
+  PriorityFloodCell *heap;
+  PriorityFloodCell cell, next;
+  unsigned char *visited;
+  long size = 0;
+  long order = 0;
+  long n;
+  int i, j, ii, jj, m;
+  int outlet;
+  int nraised = 0;
+
+  heap = (PriorityFloodCell*)malloc((size_t)(num_cells + 1) * sizeof(PriorityFloodCell));
+  visited = (unsigned char*)calloc((size_t)(num_cells + 1), 1);
+
+  // start from the outlets
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      *DataboxCoeff(newdem, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
+
+      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+      {
+        visited[j * nx + i] = 1;
+        continue;
+      }
+
+      outlet = (i == 0) || (j == 0) || (i == nx - 1) || (j == ny - 1);
+      outlet = outlet ||
+               (*DataboxCoeff(dem, i - 1, j, 0) == -9999.0) ||
+               (*DataboxCoeff(dem, i + 1, j, 0) == -9999.0) ||
+               (*DataboxCoeff(dem, i, j - 1, 0) == -9999.0) ||
+               (*DataboxCoeff(dem, i, j + 1, 0) == -9999.0);
+
+      if (outlet)
+      {
+        visited[j * nx + i] = 1;
+        cell.z = *DataboxCoeff(dem, i, j, 0);
+        cell.order = order++;
+        cell.index = j * nx + i;
+        PriorityFloodPush(heap, &size, cell);
+      }
+    }
+  }
+
+  // flood inwards from the lowest cell reached so far
+  while (size > 0)
+  {
+    cell = PriorityFloodPop(heap, &size);
+    i = cell.index % nx;
+    j = cell.index / nx;
+
+    for (m = 0; m < 4; m++)
+    {
+      ii = i + ((m == 0) ? -1 : (m == 1) ? 1 : 0);
+      jj = j + ((m == 2) ? -1 : (m == 3) ? 1 : 0);
+
+      if (ii < 0 || jj < 0 || ii > nx - 1 || jj > ny - 1)
+      {
+        continue;
+      }
+
+      n = (long)jj * nx + ii;
+      if (visited[n])
+      {
+        continue;
+      }
+      visited[n] = 1;
+
+      next.z = *DataboxCoeff(newdem, ii, jj, 0);
+      if (next.z < cell.z + epsilon)
+      {
+        next.z = cell.z + epsilon;
+        *DataboxCoeff(newdem, ii, jj, 0) = next.z;
+        nraised++;
+      }
+      next.order = order++;
+      next.index = (int)n;
+      PriorityFloodPush(heap, &size, next);
+    }
+  }
+
+  free(heap);
+  free(visited);
+
+  return nraised;
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeMovingAvg:
  *
@@ -2964,6 +3407,82 @@ void ComputeHydroStatFromWT(
 } // END ComputeHydroStatInitFromWT
 
 
+/*-----------------------------------------------------------------------
+ * D8Lowest:
+ *
+ * Finds the lowest on-grid cell of the 3x3 neighborhood of [i,j] (the first
+ * in row order if several are equally low).  [i,j] itself is included only
+ * if self is nonzero.  The elevation and indices are returned in zmin, imin
+ * and jmin; imin and jmin are -9999 if there is no such cell.
+ *
+ * Returns the number of nodata cells in the neighborhood.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int D8Lowest(
+                    Databox *dem,
+                    int      i,
+                    int      j,
+                    int      self,
+                    double * zmin,
+                    int *    imin,
+                    int *    jmin)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int ii, jj;
+  int nodata = 0;
+  double z;
+
+  *imin = -9999;
+  *jmin = -9999;
+  *zmin = 100000000000.0;
+  for (jj = j - 1; jj <= j + 1; jj++)
+  {
+    for (ii = i - 1; ii <= i + 1; ii++)
+    {
+      // skip off-grid cells (and self if requested)
+      if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1) ||
+          (!self && (ii == i) && (jj == j)))
+      {
+        continue;
+      }
+
+      z = *DataboxCoeff(dem, ii, jj, 0);
+      if (z == -9999.0)
+      {
+        nodata++;
+      }
+      if (z < *zmin)
+      {
+        *zmin = z;
+        *imin = ii;
+        *jmin = jj;
+      }
+    }
+  }
+
+  return nodata;
+}
+
+
+/*-----------------------------------------------------------------------
+ * D8Nodata:
+ *
+ * Returns 1 if [i,j] is on the grid and a nodata cell, 0 otherwise.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int D8Nodata(
+                    Databox *dem,
+                    int      i,
+                    int      j)
+{
+  return (i >= 0) && (j >= 0) && (i < DataboxNx(dem)) && (j < DataboxNy(dem)) &&
+         (*DataboxCoeff(dem, i, j, 0) == -9999.0);
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeSlopeD8:
  *
@@ -2978,7 +3497,7 @@ void ComputeSlopeD8(
                     Databox *dem,
                     Databox *slope)
 {
-  int i, j, ii, jj;
+  int i, j;
   int imin, jmin;
   int nx, ny;
   int nodata;
@@ -2999,6 +3518,10 @@ void ComputeSlopeD8(
   s3 = 0.;
 
   // Loop over all [i,j]
+  // (rows are independent)
+#ifdef _OPENMP
+  #pragma omp parallel for private(i, imin, jmin, zmin, nodata, s1, s2, s3)
+#endif
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
@@ -3011,41 +3534,10 @@ void ComputeSlopeD8(
 
       else
       {
-        // Loop over neighbors (adjacent and diagonal)
-        // ** Find elevation and indices of lowest neighbor
+        // Find elevation and indices of lowest neighbor (adjacent and diagonal)
+        // and count nodata neighbors
         // ** Exclude off-grid cells
-        imin = -9999;
-        jmin = -9999;
-        zmin = 100000000.0;
-        nodata = 0;
-        for (jj = j - 1; jj <= j + 1; jj++)
-        {
-          for (ii = i - 1; ii <= i + 1; ii++)
-          {
-            // skip if off grid
-            if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-            {
-              ;
-            }
-
-            // find lowest neighbor
-            else
-            {
-              // count number of nodata neighbors
-              if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
-              {
-                nodata = nodata + 1;
-              }
-              // set zmin, imin, jmin if lower than previous zmin
-              if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
-              {
-                zmin = *DataboxCoeff(dem, ii, jj, 0);
-                imin = ii;
-                jmin = jj;
-              }
-            }       // end find lowest neighbor
-          }      // end loop over ii
-        }     // end loop over jj
+        nodata = D8Lowest(dem, i, j, 1, &zmin, &imin, &jmin);
 
         // Calculate slope towards lowest neighbor
 
@@ -3169,18 +3661,18 @@ void ComputeSlopeD8(
           s2 = -9999.0;
           s3 = -9999.0;
           // if adjacent left/right is nodata, compute slope over dy
-          if ((*DataboxCoeff(dem, i - 1, j, 0) == -9999.0) || (*DataboxCoeff(dem, i + 1, j, 0) == -9999.0))
+          if (D8Nodata(dem, i - 1, j) || D8Nodata(dem, i + 1, j))
           {
             s1 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dx;
           }
-          if ((*DataboxCoeff(dem, i, j - 1, 0) == -9999.0) || (*DataboxCoeff(dem, i, j + 1, 0) == -9999.0))
+          if (D8Nodata(dem, i, j - 1) || D8Nodata(dem, i, j + 1))
           {
             s2 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dy;
           }
-          if ((*DataboxCoeff(dem, i - 1, j - 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i - 1, j + 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i + 1, j - 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i + 1, j + 1, 0) == -9999.0))
+          if (D8Nodata(dem, i - 1, j - 1) ||
+              D8Nodata(dem, i - 1, j + 1) ||
+              D8Nodata(dem, i + 1, j - 1) ||
+              D8Nodata(dem, i + 1, j + 1))
           {
             s3 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dxy;
           }
@@ -3212,7 +3704,7 @@ void ComputeSegmentD8(
                       Databox *dem,
                       Databox *ds)
 {
-  int i, j, ii, jj;
+  int i, j;
   int imin, jmin;
   int nx, ny;
   int nodata;
@@ -3234,6 +3726,10 @@ void ComputeSegmentD8(
   smax = 0.;
 
   // Loop over all [i,j]
+  // (rows are independent)
+#ifdef _OPENMP
+  #pragma omp parallel for private(i, imin, jmin, zmin, nodata, s1, s2, s3, smax)
+#endif
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
@@ -3246,41 +3742,10 @@ void ComputeSegmentD8(
 
       else
       {
-        // Loop over neighbors (adjacent and diagonal)
-        // ** Find elevation and indices of lowest neighbor
-        // ** Exclude self and off-grid cells
-        imin = -9999;
-        jmin = -9999;
-        zmin = 100000000000.0;
-        nodata = 0;
-        for (jj = j - 1; jj <= j + 1; jj++)
-        {
-          for (ii = i - 1; ii <= i + 1; ii++)
-          {
-            // skip if off grid
-            if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-            {
-              ;
-            }
-
-            // find lowest neighbor
-            else
-            {
-              // count number of nodata neighbors
-              if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
-              {
-                nodata = nodata + 1;
-              }
-              // set zmin, imin, jmin if lower than previous zmin
-              if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
-              {
-                zmin = *DataboxCoeff(dem, ii, jj, 0);
-                imin = ii;
-                jmin = jj;
-              }
-            }       // end find lowest neighbor
-          }
-        }
+        // Find elevation and indices of lowest neighbor (adjacent and diagonal)
+        // and count nodata neighbors
+        // ** Exclude off-grid cells
+        nodata = D8Lowest(dem, i, j, 1, &zmin, &imin, &jmin);
 
         // Calculate slope towards lowest neighbor
 
@@ -3401,23 +3866,23 @@ void ComputeSegmentD8(
           s2 = -9999.0;
           s3 = -9999.0;
           // if adjacent left/right is nodata, compute slope over dy
-          if ((*DataboxCoeff(dem, i - 1, j, 0) == -9999.0) || (*DataboxCoeff(dem, i + 1, j, 0) == -9999.0))
+          if (D8Nodata(dem, i - 1, j) || D8Nodata(dem, i + 1, j))
           {
             s1 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dx;
           }
-          if ((*DataboxCoeff(dem, i, j - 1, 0) == -9999.0) || (*DataboxCoeff(dem, i, j + 1, 0) == -9999.0))
+          if (D8Nodata(dem, i, j - 1) || D8Nodata(dem, i, j + 1))
           {
             s2 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dy;
           }
-          if ((*DataboxCoeff(dem, i - 1, j - 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i - 1, j + 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i + 1, j - 1, 0) == -9999.0) ||
-              (*DataboxCoeff(dem, i + 1, j + 1, 0) == -9999.0))
+          if (D8Nodata(dem, i - 1, j - 1) ||
+              D8Nodata(dem, i - 1, j + 1) ||
+              D8Nodata(dem, i + 1, j - 1) ||
+              D8Nodata(dem, i + 1, j + 1))
           {
             s3 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dxy;
           }
 
-          smax = fmax(s1, fmax(s1, s3));
+          smax = fmax(s1, fmax(s2, s3));
           if (smax == s1)
           {
             *DataboxCoeff(ds, i, j, 0) = dx;
@@ -3451,7 +3916,7 @@ void ComputeChildD8(
                     Databox *dem,
                     Databox *child)
 {
-  int i, j, ii, jj;
+  int i, j;
   int imin, jmin;
   int nx, ny;
   double zmin;
@@ -3460,6 +3925,10 @@ void ComputeChildD8(
   ny = DataboxNy(dem);
 
   // Loop over all [i,j]
+  // (rows are independent)
+#ifdef _OPENMP
+  #pragma omp parallel for private(i, imin, jmin, zmin)
+#endif
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
@@ -3475,34 +3944,10 @@ void ComputeChildD8(
       // This is because nodata cells are assumed to be ocean, and neighboring
       // cells are assumed to drain to the ocean. Ignoring nodata cells is
       // OK here, though, because we only use the D8 child elevations to determine
-      // local minima from which to start our Flint's Law recursion...
-      // Parent-child relationships are computed by ComputeTestParentD8...
+      // local minima from which to start our Flint's Law sweep...
+      // Parent-child relationships are computed by D8Receiver...
 
-      imin = -9999;
-      jmin = -9999;
-      zmin = 100000000000.0;
-      for (jj = j - 1; jj <= j + 1; jj++)
-      {
-        for (ii = i - 1; ii <= i + 1; ii++)
-        {
-          // skip if off grid
-          if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-          {
-            ;
-          }
-
-          // find lowest neighbor
-          else
-          {
-            if ((*DataboxCoeff(dem, ii, jj, 0) < zmin))
-            {
-              zmin = *DataboxCoeff(dem, ii, jj, 0);
-              imin = ii;
-              jmin = jj;
-            }
-          }
-        }
-      }
+      D8Lowest(dem, i, j, 1, &zmin, &imin, &jmin);
 
       // Determine elevation lowest neighbor -- lowest neighbor is D8 child!!
       // ** If cell is a local minimum (edge or otherwise), set value to -9999.0 (local min)
@@ -3635,10 +4080,321 @@ int ComputeTestParentD8(
 
 
 /*-----------------------------------------------------------------------
- * ComputeFlintsLawRec:
+ * D8Receiver:
+ *
+ * Returns the index (j*nx+i) of the D8 child of [i,j], the lowest of its
+ * neighbors, if that neighbor has data and is lower than [i,j]; [i,j] is
+ * then the D8 parent of the child in the sense of ComputeTestParentD8.
+ * Returns -1 for nodata cells, local minima and cells that drain to nodata.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int D8Receiver(
+                      Databox *dem,
+                      int      i,
+                      int      j)
+{
+  int imin, jmin;
+  double zmin;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return -1;
+  }
+
+  D8Lowest(dem, i, j, 0, &zmin, &imin, &jmin);
+  if ((imin < 0) || (zmin == -9999.0) || !(zmin < *DataboxCoeff(dem, i, j, 0)))
+  {
+    return -1;
+  }
+
+  return jmin * DataboxNx(dem) + imin;
+}
+
+
+/*-----------------------------------------------------------------------
+ * D8Graph:
+ *
+ * Explicit D8 donor graph of a DEM.  Every cell drains into at most one
+ * receiver (see D8Receiver), which is strictly lower, so the graph is a
+ * forest with one tree per cell that has data but no receiver.  The cells
+ * of each tree are stored together in order, root first and each receiver
+ * before its donors, so a tree can be swept upstream without recursion and
+ * separate trees can be swept in parallel.
+ *
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  int num_trees;
+  int *receiver;    /* receiver of each cell, -1 if none */
+  int *tree_start;  /* tree t is order[tree_start[t]] ... order[tree_start[t+1]-1] */
+  int *order;
+} D8Graph;
+
+static D8Graph *NewD8Graph(
+                           Databox *dem)
+{
+  D8Graph *graph;
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  long num_cells = (long)nx * ny;
+  int *donor_start;
+  int *donors;
+  long n, head, tail;
+  int i, j, m, r;
+
+  graph = (D8Graph*)malloc(sizeof(D8Graph));
+  graph->receiver = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+  graph->tree_start = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+  graph->order = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+  donor_start = (int*)calloc((size_t)(num_cells + 1), sizeof(int));
+  donors = (int*)malloc((size_t)(num_cells + 1) * sizeof(int));
+
+  // receivers only depend on the neighborhood of each cell
+#ifdef _OPENMP
+  #pragma omp parallel for private(i)
+#endif
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      graph->receiver[(long)j * nx + i] = D8Receiver(dem, i, j);
+    }
+  }
+
+  // donor lists of all cells, in cell order
+  for (n = 0; n < num_cells; n++)
+  {
+    if (graph->receiver[n] >= 0)
+    {
+      donor_start[graph->receiver[n] + 1]++;
+    }
+  }
+  for (n = 0; n < num_cells; n++)
+  {
+    donor_start[n + 1] += donor_start[n];
+  }
+  for (n = 0; n < num_cells; n++)
+  {
+    r = graph->receiver[n];
+    if (r >= 0)
+    {
+      donors[donor_start[r]++] = n;
+    }
+  }
+  for (n = num_cells; n > 0; n--)
+  {
+    donor_start[n] = donor_start[n - 1];
+  }
+  donor_start[0] = 0;
+
+  // walk each tree breadth first from its root
+  graph->num_trees = 0;
+  tail = 0;
+  for (n = 0; n < num_cells; n++)
+  {
+    if ((graph->receiver[n] < 0) && (DataboxCoeffs(dem)[n] != -9999.0))
+    {
+      graph->tree_start[graph->num_trees++] = tail;
+      graph->order[tail++] = n;
+      for (head = tail - 1; head < tail; head++)
+      {
+        r = graph->order[head];
+        for (m = donor_start[r]; m < donor_start[r + 1]; m++)
+        {
+          graph->order[tail++] = donors[m];
+        }
+      }
+    }
+  }
+  graph->tree_start[graph->num_trees] = tail;
+
+  free(donor_start);
+  free(donors);
+
+  return graph;
+}
+
+static void FreeD8Graph(
+                        D8Graph *graph)
+{
+  free(graph->receiver);
+  free(graph->tree_start);
+  free(graph->order);
+  free(graph);
+}
+
+
+/*-----------------------------------------------------------------------
+ * D8FlintsLawSweep:
  *
- * Recursively computes Flint's law up a given drainage network
+ * Computes Flint's law elevations (see ComputeFlintsLaw) up the D8 graph of
+ * dem.  Trees are started at cells marked as local minima in child, which
+ * are set to their DEM elevation; cells of other trees keep their value in
+ * demflint, and nodata cells are set to -9999.0.  This gives the same result
+ * as calling ComputeFlintsLawRec for each local minimum.
  *
+ *-----------------------------------------------------------------------*/
+
+static void D8FlintsLawSweep(
+                             D8Graph *graph,
+                             Databox *dem,
+                             Databox *demflint,
+                             Databox *child,
+                             Databox *area,
+                             Databox *ds,
+                             double   c,
+                             double   p)
+{
+  double *z = DataboxCoeffs(dem);
+  double *zflint = DataboxCoeffs(demflint);
+  double *a = DataboxCoeffs(area);
+  double *s = DataboxCoeffs(ds);
+  long num_cells = (long)DataboxNx(dem) * DataboxNy(dem);
+  long n;
+  int t, m;
+
+#ifdef _OPENMP
+  #pragma omp parallel for private(n)
+#endif
+  for (n = 0; n < num_cells; n++)
+  {
+    if (z[n] == -9999.0)
+    {
+      zflint[n] = -9999.0;
+    }
+  }
+
+  // trees are independent, but of very different size
+#ifdef _OPENMP
+  #pragma omp parallel for private(m, n) schedule(dynamic, 16)
+#endif
+  for (t = 0; t < graph->num_trees; t++)
+  {
+    n = graph->order[graph->tree_start[t]];
+    if (DataboxCoeffs(child)[n] != -9999.0)
+    {
+      continue;
+    }
+
+    zflint[n] = z[n];
+    for (m = graph->tree_start[t] + 1; m < graph->tree_start[t + 1]; m++)
+    {
+      n = graph->order[m];
+      zflint[n] = zflint[graph->receiver[n]] + c * pow(a[n], p) * s[n];
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * D8LMCoeff:
+ *
+ * Computes Flint's law elevations for [c,p] and the Levenberg-Marquardt
+ * fitting matrix alpha and vector beta (see ComputeLMCoeff) using the D8
+ * graph of dem.  Returns chisq.
+ *
+ * Sums are formed per row and the rows are added in order, so the result
+ * does not depend on the number of threads.
+ *
+ *-----------------------------------------------------------------------*/
+
+static double D8LMCoeff(
+                        D8Graph *graph,
+                        Databox *demflint,
+                        Databox *dem,
+                        Databox *area,
+                        Databox *child,
+                        Databox *ds,
+                        double   c,
+                        double   p,
+                        double   alpha[][2],
+                        double   beta[])
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  long num_cells = (long)nx * ny;
+  double *sums;
+  double chisq;
+  double apow, df, dfdc, dfdp;
+  long n;
+  int i, j;
+
+  // reset demflint to -1111.0 and compute function values for [c,p]
+#ifdef _OPENMP
+  #pragma omp parallel for private(n)
+#endif
+  for (n = 0; n < num_cells; n++)
+  {
+    DataboxCoeffs(demflint)[n] = -1111.0;
+  }
+  D8FlintsLawSweep(graph, dem, demflint, child, area, ds, c, p);
+
+  // per row sums of chisq, alpha[0][0], alpha[0][1], alpha[1][1], beta[0], beta[1]
+  sums = (double*)calloc((size_t)ny * 6, sizeof(double));
+
+#ifdef _OPENMP
+  #pragma omp parallel for private(i, apow, df, dfdc, dfdp)
+#endif
+  for (j = 0; j < ny; j++)
+  {
+    double *row = sums + (long)j * 6;
+
+    for (i = 0; i < nx; i++)
+    {
+      // skip nodata cells and local minima
+      // (don't fit to cells w/o downstream slopes)
+      if ((*DataboxCoeff(dem, i, j, 0) == -9999.0) ||
+          (*DataboxCoeff(child, i, j, 0) == -9999.0))
+      {
+        continue;
+      }
+
+      // residual and derivatives wrt. c, p at [i,j]
+      apow = pow(*DataboxCoeff(area, i, j, 0), p);
+      dfdc = apow * (*DataboxCoeff(ds, i, j, 0));
+      dfdp = c * apow * log(*DataboxCoeff(area, i, j, 0)) * (*DataboxCoeff(ds, i, j, 0));
+      df = *DataboxCoeff(dem, i, j, 0) - *DataboxCoeff(demflint, i, j, 0);
+
+      // NOTE: we assume all local variances are unity, so chisq reduces to the sum of squared residuals
+      row[0] += df * df;
+      row[1] += dfdc * dfdc;
+      row[2] += dfdc * dfdp;
+      row[3] += dfdp * dfdp;
+      row[4] += df * dfdc;
+      row[5] += df * dfdp;
+    }
+  }
+
+  chisq = 0.0;
+  alpha[0][0] = 0.0;
+  alpha[0][1] = 0.0;
+  alpha[1][1] = 0.0;
+  beta[0] = 0.0;
+  beta[1] = 0.0;
+  for (j = 0; j < ny; j++)
+  {
+    chisq += sums[(long)j * 6];
+    alpha[0][0] += sums[(long)j * 6 + 1];
+    alpha[0][1] += sums[(long)j * 6 + 2];
+    alpha[1][1] += sums[(long)j * 6 + 3];
+    beta[0] += sums[(long)j * 6 + 4];
+    beta[1] += sums[(long)j * 6 + 5];
+  }
+  alpha[1][0] = alpha[0][1];
+
+  free(sums);
+  return chisq;
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputeFlintsLawRec:
+ *
+ * Computes Flint's law up the drainage network above [i,j], starting from
+ * the value of demflint at [i,j].  Only cells set to -1111.0 in demflint
+ * are computed.  The network is walked with an explicit stack, not by
+ * recursion, so its size is not limited by the call stack.
  *
  *---------------------------------------------------------------------*/
 void ComputeFlintsLawRec(
@@ -3654,70 +4410,62 @@ void ComputeFlintsLawRec(
 {
   int ii, jj;
   int nx, ny;
-  int test = -999;
+  int *stack;
+  long top, n;
 
   nx = DataboxNx(demflint);
   ny = DataboxNy(demflint);
 
+  // if i or j is off grid --> skip
+  if ((i < 0) || (i >= nx) || (j < 0) || (j >= ny))
+  {
+    return;
+  }
+
   // if [i,j] is nodata cell --> skip
   if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
   {
     *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-    test = 0;
+    return;
   }
 
-  // if i or j is off grid --> skip
-  else if ((i < 0) || (i >= nx) || (j < 0) || (j >= ny))
-  {
-    test = 0;
-  }
+  // every cell is pushed at most once
+  stack = (int*)malloc((size_t)((long)nx * ny + 1) * sizeof(int));
+  top = 0;
+  stack[top++] = j * nx + i;
 
-  // else --> loop over neighbors of [i,j]
-  else
+  while (top > 0)
   {
+    n = stack[--top];
+    i = n % nx;
+    j = n / nx;
+
+    // loop over neighbors of [i,j]...
+    // if [ii,jj] is a D8 parent of [i,j]
+    // ...and Flint's Law DEM not already computed for [ii,jj]
+    // ...then compute DEM and move upstream
     for (jj = j - 1; jj <= j + 1; jj++)
     {
       for (ii = i - 1; ii <= i + 1; ii++)
       {
-        // skip nodata neighbors...
-        if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
-        {
-          test = 0;
-        }
-
-        // skip off-grid neighbors...
-        else if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-        {
-          test = 0;
-        }
-
-        // skip self...
-        else if ((ii == i) && (jj == j))
-        {
-          test = 0;
-        }
-
-        // if on grid, not nodata, and not self, test if [ii,jj] is D8 parent of [i,j]
-        else
+        if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1) ||
+            ((ii == i) && (jj == j)))
         {
-          test = ComputeTestParentD8(i, j, ii, jj, dem);
+          continue;
         }
 
-        // if [ii,jj] is a parent
-        // ...and Flint's Law DEM not already computed for [ii,jj] -- i.e., demflint(ii,jj)==-1111. (avoid infinite loop)
-        // ...then compute DEM and move upstream (RECURSIVE!)
-        if ((test == 1) && (*DataboxCoeff(demflint, ii, jj, 0) == -1111.0))
+        if ((D8Receiver(dem, ii, jj) == n) &&
+            (*DataboxCoeff(demflint, ii, jj, 0) == -1111.0))
         {
-          // compute DEM...
           *DataboxCoeff(demflint, ii, jj, 0) = *DataboxCoeff(demflint, i, j, 0) +
                                                c * pow(*DataboxCoeff(area, ii, jj, 0), p) * *DataboxCoeff(ds, ii, jj, 0);
-
-          // recursive loop...
-          ComputeFlintsLawRec(ii, jj, dem, demflint, child, area, ds, c, p);
-        }     // end recursive if statement
+          stack[top++] = jj * nx + ii;
+        }
       }    // end loop over ii
     }   // end loop over jj
-  }  // end if re: off grid
+  }
+
+  free(stack);
 }
 
 
@@ -3739,11 +4487,10 @@ void ComputeFlintsLawRec(
  * For cells without D8 child (local minima or drains off grid),
  * value is set to value of original DEM.
  *
- * NOTE: This routine loops over all cells to find local minima, then
- *       recursively loops upstream from child to parent, calculating
- *       each successive parent's elevation based on the child elevation
- *       and Flint's law. Every drainage path therefore satisfies Flint's
- *       law perfectly.
+ * NOTE: This routine builds the D8 donor graph, then sweeps each drainage
+ *       tree upstream from its local minimum, calculating each successive
+ *       parent's elevation based on the child elevation and Flint's law.
+ *       Every drainage path therefore satisfies Flint's law perfectly.
  *
  *-----------------------------------------------------------------------*/
 void ComputeFlintsLaw(
@@ -3762,6 +4509,7 @@ void ComputeFlintsLaw(
   Databox        *area;
   Databox        *ds;
   Databox        *child;
+  D8Graph        *graph;
 
   nx = DataboxNx(dem);
   ny = DataboxNy(dem);
@@ -3790,11 +4538,12 @@ void ComputeFlintsLaw(
     }
   }
 
-  // compute segment lengths and child elevations for D8 grid
+  // compute segment lengths, child elevations and donor graph for D8 grid
   ds = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
   child = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
   ComputeSegmentD8(dem, ds);
   ComputeChildD8(dem, child);
+  graph = NewD8Graph(dem);
 
   // initialize all cells of computed DEM to -1111.0
   for (j = 0; j < ny; j++)
@@ -3806,34 +4555,12 @@ void ComputeFlintsLaw(
   }
 
   // compute elevations using Flint's law
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, c, p);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  // -- nodata cells (assumed to be ocean/estuary cells) are set to -9999.0
+  // -- local minima (no child) are set to the original DEM value
+  // -- parent elevations are computed upstream from there
+  D8FlintsLawSweep(graph, dem, demflint, child, area, ds, c, p);
 
+  FreeD8Graph(graph);
   FreeDatabox(sx);
   FreeDatabox(sy);
   FreeDatabox(area);
@@ -3890,6 +4617,7 @@ void ComputeFlintsLawFit(
   Databox        *area;
   Databox        *ds;
   Databox        *child;
+  D8Graph        *graph;
 
   // get grid info
   nx = DataboxNx(dem);
@@ -3926,6 +4654,7 @@ void ComputeFlintsLawFit(
   child = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
   ComputeSegmentD8(dem, ds);
   ComputeChildD8(dem, child);
+  graph = NewD8Graph(dem);
 
   // INITIALIZE L-M VARS
   const int ma = 2;
@@ -3966,7 +4695,7 @@ void ComputeFlintsLawFit(
   }
 
   // calculate chisq at initial parameter values
-  chisq = ComputeLMCoeff(demflint, dem, area, child, ds, c0, p0, alpha, beta, chisq);
+  chisq = D8LMCoeff(graph, demflint, dem, area, child, ds, c0, p0, alpha, beta);
   ochisq = chisq;
 
   // L-M ITERATION
@@ -4002,17 +4731,8 @@ void ComputeFlintsLawFit(
     ctry = c + da[0];
     ptry = p + da[1];
 
-    // reset all cells of computed DEM (demflint) to -1111.0
-    for (j = 0; j < ny; j++)
-    {
-      for (i = 0; i < nx; i++)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -1111.0;
-      }
-    }
-
-    // Call ComputeLMCoeff
-    chisq = ComputeLMCoeff(demflint, dem, area, child, ds, ctry, ptry, covar, da, chisq);
+    // compute chisq, fitting matrix (and demflint) for trial parameters
+    chisq = D8LMCoeff(graph, demflint, dem, area, child, ds, ctry, ptry, covar, da);
 
     // compute convergence criteria
     dchisq = 100.0 * fabs(chisq - ochisq) / (ochisq);
@@ -4057,34 +4777,8 @@ void ComputeFlintsLawFit(
       *DataboxCoeff(demflint, i, j, 0) = -1111.0;
     }
   }
-  // -- then call recursive loop
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, ctry, ptry);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  // -- then sweep upstream from the local minima
+  D8FlintsLawSweep(graph, dem, demflint, child, area, ds, ctry, ptry);
 
   printf("-------------------------------------------------------------\n");
   printf("Flints Law Fit: \n");
@@ -4092,6 +4786,7 @@ void ComputeFlintsLawFit(
   printf("[c0, p0] = [%f, %f] \n", c0, p0);
   printf("[ c,  p] = [%f, %f] \n", ctry, ptry);
 
+  FreeD8Graph(graph);
   FreeDatabox(sx);
   FreeDatabox(sy);
   FreeDatabox(area);
@@ -4114,42 +4809,21 @@ void ComputeFlintLM(
 {
   int i, j;
   int nx, ny;
+  D8Graph *graph;
 
   nx = DataboxNx(dem);
   ny = DataboxNy(dem);
 
   // Calculate Flints Law DEM using current parameter estimates
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      //    (THI IS THE SAME AS IN ComputeFlintsLaw)
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      //    (THIS IS THE SAME AS IN ComputeFlintsLaw)
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, c, p);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  // (THIS IS THE SAME AS IN ComputeFlintsLaw)
+  graph = NewD8Graph(dem);
+  D8FlintsLawSweep(graph, dem, demflint, child, area, ds, c, p);
+  FreeD8Graph(graph);
 
   // Loop again to calculate derivatives
+#ifdef _OPENMP
+  #pragma omp parallel for private(i)
+#endif
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
@@ -4158,7 +4832,7 @@ void ComputeFlintLM(
       if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
       {
         *DataboxCoeff(dzdc, i, j, 0) = 0.0;
-        *DataboxCoeff(dzdc, i, j, 0) = 0.0;
+        *DataboxCoeff(dzdp, i, j, 0) = 0.0;
       }
 
       // else, compute derivative WRT c, p
@@ -4186,97 +4860,14 @@ double ComputeLMCoeff(
                       double   beta[], // working space     -- [2] array
                       double   chisq) // chisq value
 {
-  int i, j;
-  int ma = 2;
-  int nx, ny, nz;
-  double x, y, z;
-  double dx, dy, dz;
-  double df;
-  Databox *dfdc;
-  Databox *dfdp;
-
-  // get grid info
-  nx = DataboxNx(dem);
-  ny = DataboxNy(dem);
-  nz = DataboxNz(dem);
-  x = DataboxX(dem);
-  y = DataboxY(dem);
-  z = DataboxZ(dem);
-  dx = DataboxDx(dem);
-  dy = DataboxDy(dem);
-  dz = DataboxDz(dem);
-
-  // initialize derivatives
-  dfdc = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
-  dfdp = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
-
-  // set alpha and beta values to zero
-  for (i = 0; i < ma; i++)
-  {
-    beta[i] = 0.0;
-    for (j = 0; j < ma; j++)
-    {
-      alpha[i][j] = 0.0;
-    }
-  }
-
-  // resetting demflint to -1111.0
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      *DataboxCoeff(demflint, i, j, 0) = -1111.0;
-    }
-  }
-
-  // calculate function values and derivatives at all [i,j] for current parameter values [c,p]
-  ComputeFlintLM(dem, demflint, area, child, ds, c, p, dfdc, dfdp);
-
-  // loop to calculate chisq, alpha, beta
-  chisq = 0.0;
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // skip nodata cells
-      // (don't fit to nodata cells -- ignored by all calculations)
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        ;
-      }
-
-      // skip local minima
-      // (don't fit to cells w/o downstream slopes)
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        ;
-      }
+  D8Graph *graph;
 
-      // compute coefficients based on all other cells
-      else
-      {
-        // calculate residual at [i,j]
-        df = *DataboxCoeff(dem, i, j, 0) - *DataboxCoeff(demflint, i, j, 0);
-
-        // add to chisq sum...
-        // NOTE: we assume all local variances are unity, so chisq reduces to the sum of squared residuals
-        chisq = chisq + (df * df);
-
-        // add to alphas
-        alpha[0][0] = alpha[0][0] + (*DataboxCoeff(dfdc, i, j, 0)) * (*DataboxCoeff(dfdc, i, j, 0));
-        alpha[0][1] = alpha[0][1] + (*DataboxCoeff(dfdc, i, j, 0)) * (*DataboxCoeff(dfdp, i, j, 0));
-        alpha[1][0] = alpha[1][0] + (*DataboxCoeff(dfdp, i, j, 0)) * (*DataboxCoeff(dfdc, i, j, 0));
-        alpha[1][1] = alpha[1][1] + (*DataboxCoeff(dfdp, i, j, 0)) * (*DataboxCoeff(dfdp, i, j, 0));
-
-        // add to betas
-        beta[0] = beta[0] + (df) * (*DataboxCoeff(dfdc, i, j, 0));
-        beta[1] = beta[1] + (df) * (*DataboxCoeff(dfdp, i, j, 0));
-      }    // end if child
-    }   // end loop over i
-  }  // end loop over j
+  // calculate function values at all [i,j] for current parameter values [c,p],
+  // then chisq, alpha, beta from the residuals and derivatives
+  graph = NewD8Graph(dem);
+  chisq = D8LMCoeff(graph, demflint, dem, area, child, ds, c, p, alpha, beta);
+  FreeD8Graph(graph);
 
-  FreeDatabox(dfdc);
-  FreeDatabox(dfdp);
   return chisq;
 }
 
@@ -4441,6 +5032,7 @@ void ComputeFlintsLawByBasin(
   Databox        *parentmap;
   Databox        *basin_in;
   Databox        *basin_out;
+  D8Graph        *graph;
 
   // get grid info
   nx = DataboxNx(dem);
@@ -4509,7 +5101,7 @@ void ComputeFlintsLawByBasin(
         ComputeParentMap(i_grid, j_grid, dem, sx, sy, parentmap);
         for (j = 0; j < ny; j++)
         {
-          for (i = 0; j < nx; j++)
+          for (i = 0; i < nx; i++)
           {
             *DataboxCoeff(basin_out, i, j, 0) = -1111.0;
 
@@ -4651,34 +5243,10 @@ void ComputeFlintsLawByBasin(
           }
         }
 
-        // -- then call recursive loop
-        for (j = 0; j < ny; j++)
-        {
-          for (i = 0; i < nx; i++)
-          {
-            // If original DEM elevation is -9999.0
-            // -- nodata cell (assumed to be ocean/estuary cell)
-            // -- set demflint to -9999.0
-            // -- continue loop
-            if (*DataboxCoeff(basin_in, i, j, 0) == -9999.0)
-            {
-              *DataboxCoeff(basin_out, i, j, 0) = -9999.0;
-            }
-
-            // If child elevation is set to -9999.0...
-            // -- cell is a local minimum (no child)
-            // -- set demflint elevation to original DEM value
-            // -- then loop upstream (recursively) to calculate parent elevations
-            else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-            {
-              // set value at [i,j]
-              *DataboxCoeff(basin_out, i, j, 0) = *DataboxCoeff(basin_in, i, j, 0);
-
-              // call recursive function
-              ComputeFlintsLawRec(i, j, basin_in, basin_out, child, area, ds, ctry, ptry);
-            }
-          }      // end loop over i
-        }     // end loop over j
+        // -- then sweep upstream from the local minima
+        graph = NewD8Graph(basin_in);
+        D8FlintsLawSweep(graph, basin_in, basin_out, child, area, ds, ctry, ptry);
+        FreeD8Graph(graph);
 
         // copy fitted values from basin_out to demflint
         for (j = 0; j < ny; j++)
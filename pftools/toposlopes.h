@@ -83,6 +83,11 @@ int ComputeMovingAvg(
                      Databox *dem,
                      double   wsize);
 
+int ComputePriorityFill(
+                        Databox *dem,
+                        double   epsilon,
+                        Databox *newdem);
+
 void ComputeSlopeXD4(
                      Databox *dem,
                      Databox *sx);
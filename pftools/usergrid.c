@@ -269,3 +269,113 @@ SubgridArray   *DistributeUserGrid(
   return all_subgrids;
 }
 
+
+
+/*--------------------------------------------------------------------------
+ * SplitUserGrid:
+ *   Splits each process subgrid into sp x sq subgrids owned by the same
+ *   process, as the Process.Topology.Subgrids keys do in ParFlow.
+ *   Returns NULL if a subgrid is too small to be split.
+ *--------------------------------------------------------------------------*/
+
+SubgridArray   *SplitUserGrid(
+                              SubgridArray *all_subgrids,
+                              int           sp,
+                              int           sq)
+{
+  SubgridArray  *new_subgrids;
+  Subgrid       *subgrid;
+
+  int mx, my, lx, ly;
+  int s_i, p, q;
+
+
+  new_subgrids = NewSubgridArray();
+
+  ForSubgridI(s_i, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, s_i);
+
+    if ((SubgridNX(subgrid) < sp) || (SubgridNY(subgrid) < sq))
+    {
+      FreeSubgridArray(new_subgrids);
+      return NULL;
+    }
+
+    mx = SubgridNX(subgrid) / sp;
+    my = SubgridNY(subgrid) / sq;
+
+    lx = (SubgridNX(subgrid) % sp);
+    ly = (SubgridNY(subgrid) % sq);
+
+    for (q = 0; q < sq; q++)
+      for (p = 0; p < sp; p++)
+      {
+        AppendSubgrid(NewSubgrid(pqr_to_xyz(p, mx, lx, SubgridIX(subgrid)),
+                                 pqr_to_xyz(q, my, ly, SubgridIY(subgrid)),
+                                 SubgridIZ(subgrid),
+                                 pqr_to_nxyz(p, mx, lx),
+                                 pqr_to_nxyz(q, my, ly),
+                                 SubgridNZ(subgrid),
+                                 SubgridRX(subgrid),
+                                 SubgridRY(subgrid),
+                                 SubgridRZ(subgrid),
+                                 SubgridProcess(subgrid)),
+                      &new_subgrids);
+      }
+  }
+
+  return new_subgrids;
+}
+
+
+/*--------------------------------------------------------------------------
+ * ReadProcessGrid:
+ *   Builds the subgrid array given by the ProcessGrid keys, e.g. as
+ *   written by Process.Topology.WriteProcessGrid.  Returns NULL if
+ *   ProcessGrid.NumSubgrids is not set.
+ *--------------------------------------------------------------------------*/
+
+SubgridArray   *ReadProcessGrid(Tcl_Interp *interp)
+{
+  SubgridArray  *all_subgrids;
+
+  char key[1024];
+
+  int num_subgrids;
+  int s_i, p;
+  int ix, iy, iz;
+  int nx, ny, nz;
+
+
+  num_subgrids = GetIntDefault(interp, "ProcessGrid.NumSubgrids", -1);
+  if (num_subgrids < 0)
+    return NULL;
+
+  all_subgrids = NewSubgridArray();
+
+  for (s_i = 0; s_i < num_subgrids; s_i++)
+  {
+    sprintf(key, "ProcessGrid.%d.P", s_i);
+    p = GetInt(interp, key);
+
+    sprintf(key, "ProcessGrid.%d.IX", s_i);
+    ix = GetInt(interp, key);
+    sprintf(key, "ProcessGrid.%d.IY", s_i);
+    iy = GetInt(interp, key);
+    sprintf(key, "ProcessGrid.%d.IZ", s_i);
+    iz = GetInt(interp, key);
+
+    sprintf(key, "ProcessGrid.%d.NX", s_i);
+    nx = GetInt(interp, key);
+    sprintf(key, "ProcessGrid.%d.NY", s_i);
+    ny = GetInt(interp, key);
+    sprintf(key, "ProcessGrid.%d.NZ", s_i);
+    nz = GetInt(interp, key);
+
+    AppendSubgrid(NewSubgrid(ix, iy, iz, nx, ny, nz, 0, 0, 0, p),
+                  &all_subgrids);
+  }
+
+  return all_subgrids;
+}
@@ -67,6 +67,8 @@ Grid *ReadUserGrid(Tcl_Interp *interp);
 void FreeUserGrid(Grid *user_grid);
 SubgridArray *DistributeUserGrid(Grid *user_grid, int num_procs, int P, int Q, int R);
 SubgridArray *CopyGrid(SubgridArray *all_subgrids);
+SubgridArray *SplitUserGrid(SubgridArray *all_subgrids, int sp, int sq);
+SubgridArray *ReadProcessGrid(Tcl_Interp *interp);
 
 #ifdef __cplusplus
 }
@@ -361,4 +361,71 @@ pfvtksave $Perm -vtk "CLM.out.Perm.00005.vtk" -var "Perm" -flt -dem $DEMdat -tfg
 pfvtksave $CLMdat -clmvtk "CLM.out.CLM.00005.vtk" -flt 
 pfvtksave $CLMdat -clmvtk "CLM.out.CLM.00005.vtk" -flt -dem $DEMdat
 
-pfvtksave $DEMdat -vtk "CLM.out.Elev.00000.vtk" -flt -var "Elevation" -dem $DEMdat
\ No newline at end of file
+pfvtksave $DEMdat -vtk "CLM.out.Elev.00000.vtk" -flt -var "Elevation" -dem $DEMdat
+
+pfxdmfgeometry $Pdat $DEMdat "CLM.out.grid.bin" -tfg $dzlist
+pfxdmfsave $Pdat "CLM.out.Press.00005.xmf" -var "Press" -time 5 -geometry "CLM.out.grid.bin"
+pfxdmfsave $Pdat "CLM.out.Press.00005f.xmf" -var "Press" -flt
+
+#
+# Tests of the XDMF output; test/tcl/pfxdmf.tcl compares the files of a
+# small grid with the regression output
+#
+set passed 1
+
+set grid [pfgetgrid $Pdat]
+set nx [lindex [lindex $grid 0] 0]
+set ny [lindex [lindex $grid 0] 1]
+set nz [lindex [lindex $grid 0] 2]
+
+proc readBytes {filename} {
+    set file [open $filename r]
+    fconfigure $file -translation binary
+    set bytes [read $file]
+    close $file
+    return $bytes
+}
+
+if {[file size CLM.out.grid.bin] != [expr ($nx + 1) * ($ny + 1) * ($nz + 1) * 3 * 8]} {
+    puts "FAILED : CLM.out.grid.bin has the wrong size"
+    set passed 0
+}
+
+foreach {file format size} {CLM.out.Press.00005.bin d 8 CLM.out.Press.00005f.bin f 4} {
+    if {[file size $file] != [expr $nx * $ny * $nz * $size]} {
+	puts "FAILED : $file has the wrong size"
+	set passed 0
+	continue
+    }
+
+    binary scan [readBytes $file] $format* values
+    set n 0
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		set value [pfgetelt $Pdat $i $j $k]
+		if {abs([lindex $values $n] - $value) > 1e-6 * (abs($value) + 1.0)} {
+		    puts "FAILED : $file differs from the dataset at ($i, $j, $k)"
+		    set passed 0
+		}
+		incr n
+	    }
+	}
+    }
+}
+
+foreach {file refs} {CLM.out.Press.00005.xmf {CLM.out.Press.00005.bin CLM.out.grid.bin} CLM.out.Press.00005f.xmf CLM.out.Press.00005f.bin} {
+    set xmf [readBytes $file]
+    foreach ref "$refs \"$nz $ny $nx\"" {
+	if {[string first $ref $xmf] < 0} {
+	    puts "FAILED : $file does not refer to $ref"
+	    set passed 0
+	}
+    }
+}
+
+if $passed {
+    puts "clm_vtk : PASSED"
+} {
+    puts "clm_vtk : FAILED"
+}
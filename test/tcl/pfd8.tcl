@@ -0,0 +1,104 @@
+#
+# Test the D8 commands pfslopeD8, pfsegmentD8, pfchildD8, pfflintslaw
+# and pfflintslawfit on a small DEM against reference outputs.
+#
+# The DEM drains to a strip of nodata cells (ocean) on the south edge and
+# has an isolated nodata cell inside.  It has a flat pit of two cells, a
+# local minimum on the south edge next to a neighbor of the same
+# elevation, a local minimum in the north east corner and a cell with
+# three lowest neighbors of the same elevation.  dx and dy differ so the
+# adjacent and diagonal directions give different slopes and segments.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set name "pfd8"
+
+# rows from south (j = 0) to north
+set rows {
+    {20 19 19 16 12 -9999 -9999 -9999}
+    {22 21 19 17 15 10 8 6}
+    {24 22 21 20 18 16 15 14}
+    {26 20 23 -9999 21 20 19 18}
+    {28 20 22 24 25 24 23 22}
+    {30 29 28 28 27 26 26 21}
+}
+
+set nx 8
+set ny 6
+
+set file [open $name.out.dem.sa w]
+puts $file "$nx $ny 1"
+foreach row $rows {
+    foreach z $row {
+	puts $file $z
+    }
+}
+close $file
+
+set dem [pfload -sa $name.out.dem.sa]
+pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {10.0 5.0 1.0} $dem
+
+set slope [pfslopeD8 $dem]
+set segment [pfsegmentD8 $dem]
+set child [pfchildD8 $dem]
+set flint [pfflintslaw $dem 2.0 -0.3]
+set fit [pfflintslawfit $dem 1.0 -0.5 200]
+
+pfsave $slope -pfb $name.out.slope.pfb
+pfsave $segment -pfb $name.out.segment.pfb
+pfsave $child -pfb $name.out.child.pfb
+pfsave $flint -pfb $name.out.flintslaw.pfb
+pfsave $fit -pfb $name.out.flintslawfit.pfb
+
+#
+# Tests
+#
+source pftest.tcl
+set passed 1
+
+foreach output {slope segment child flintslaw flintslawfit} {
+    if ![pftestFile $name.out.$output.pfb "Max difference in $output" $sig_digits] {
+	set passed 0
+    }
+}
+
+# nodata cells stay nodata
+foreach cell {{5 0} {6 0} {7 0} {3 3}} {
+    foreach dataset [list $slope $segment $flint $fit] {
+	if {[pfgetelt $dataset [lindex $cell 0] [lindex $cell 1] 0] != -9999.0} {
+	    puts "FAILED : nodata cell $cell has a value"
+	    set passed 0
+	}
+    }
+}
+
+# the cells of the flat pit are local minima
+foreach cell {{1 3} {1 4}} {
+    set i [lindex $cell 0]
+    set j [lindex $cell 1]
+    if {[pfgetelt $slope $i $j 0] != 0.0 || [pfgetelt $child $i $j 0] != -9999.0 ||
+	[pfgetelt $flint $i $j 0] != [pfgetelt $dem $i $j 0]} {
+	puts "FAILED : pit cell $cell is not a local minimum"
+	set passed 0
+    }
+}
+
+# of three lowest neighbors of the same elevation the first in scan
+# order, the adjacent cell to the south, is the child
+if {[pfgetelt $child 1 1 0] != 19.0 || [pfgetelt $segment 1 1 0] != 5.0 ||
+    [pfgetelt $slope 1 1 0] != 0.4} {
+    puts "FAILED : cell (1, 1) does not drain to the first of its tied neighbors"
+    set passed 0
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
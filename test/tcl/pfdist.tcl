@@ -0,0 +1,124 @@
+#
+# Test that pfdist, which copies the file subgrid by subgrid, writes the
+# same files as loading the whole file and distributing it with
+# pfdistondomain.
+#
+# The input file is first distributed over a 2 x 1 x 1 topology, so its
+# subgrids do not line up with the 3 x 2 x 1 topology it is then
+# distributed to.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset FileVersion 4
+
+set name "pfdist"
+
+pfset ComputationalGrid.Lower.X  0.0
+pfset ComputationalGrid.Lower.Y  0.0
+pfset ComputationalGrid.Lower.Z  0.0
+
+pfset ComputationalGrid.DX       1.0
+pfset ComputationalGrid.DY       1.0
+pfset ComputationalGrid.DZ       1.0
+
+pfset ComputationalGrid.NX       7
+pfset ComputationalGrid.NY       5
+pfset ComputationalGrid.NZ       4
+
+set file [open $name.out.data.sa w]
+puts $file "7 5 4"
+for {set k 0} {$k < 4} {incr k} {
+    for {set j 0} {$j < 5} {incr j} {
+	for {set i 0} {$i < 7} {incr i} {
+	    puts $file [expr $i + 10 * $j + 100 * $k + 0.5]
+	}
+    }
+}
+close $file
+
+set data [pfload -sa $name.out.data.sa]
+pfsave $data -pfb $name.out.data.pfb
+
+pfset Process.Topology.P 2
+pfset Process.Topology.Q 1
+pfset Process.Topology.R 1
+
+pfdist $name.out.data.pfb
+
+file copy -force $name.out.data.pfb $name.out.streamed.pfb
+file copy -force $name.out.data.pfb $name.out.loaded.pfb
+
+pfset Process.Topology.P 3
+pfset Process.Topology.Q 2
+pfset Process.Topology.R 1
+
+pfdist $name.out.streamed.pfb
+
+# every cell is active, so the domain is the uniform 3 x 2 x 1 layout
+set top [pfcomputetop $data]
+set bottom [pfcomputebottom $data]
+set domain [pfcomputedomain $top $bottom]
+
+pfdistondomain $name.out.loaded.pfb $domain
+
+proc ReadBytes {filename} {
+    set file [open $filename rb]
+    set bytes [read $file]
+    close $file
+    return $bytes
+}
+
+#
+# Tests
+#
+set passed 1
+
+foreach suffix {pfb pfb.dist} {
+    if {[ReadBytes $name.out.streamed.$suffix] != [ReadBytes $name.out.loaded.$suffix]} {
+	puts "FAILED : pfdist and pfdistondomain wrote different $suffix files"
+	set passed 0
+    }
+}
+
+set streamed [pfload $name.out.streamed.pfb]
+for {set k 0} {$k < 4} {incr k} {
+    for {set j 0} {$j < 5} {incr j} {
+	for {set i 0} {$i < 7} {incr i} {
+	    if {[pfgetelt $streamed $i $j $k] != [pfgetelt $data $i $j $k]} {
+		puts "FAILED : value ($i, $j, $k) of the distributed file differs"
+		set passed 0
+	    }
+	}
+    }
+}
+
+# a failed pfdist restores the file and leaves no partial .dist behind
+pfsave $data -pfb $name.out.truncated.pfb
+set file [open $name.out.truncated.pfb r+]
+chan truncate $file 200
+close $file
+
+if {![catch {pfdist $name.out.truncated.pfb}]} {
+    puts "FAILED : pfdist distributed a truncated file"
+    set passed 0
+}
+if {[file size $name.out.truncated.pfb] != 200} {
+    puts "FAILED : pfdist did not restore the truncated file"
+    set passed 0
+}
+if {[file exists $name.out.truncated.pfb.dist]} {
+    puts "FAILED : pfdist left a partial .dist file behind"
+    set passed 0
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -0,0 +1,97 @@
+#
+# Test pfload of a ParFlow binary file that changes after it is loaded.
+#
+# A dataset loaded without -lazy does not depend on the file.  A dataset
+# loaded with -lazy reads its layers from the file on first use, so once
+# the file is truncated the layers read before still hold the saved
+# values and the others give an error.  Loading the truncated file must
+# fail.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set name "pfload"
+
+set file [open $name.out.data.sa w]
+puts $file "4 3 5"
+for {set k 0} {$k < 5} {incr k} {
+    for {set j 0} {$j < 3} {incr j} {
+	for {set i 0} {$i < 4} {incr i} {
+	    puts $file [expr $i + 10 * $j + 100 * $k + 0.5]
+	}
+    }
+}
+close $file
+
+set data [pfload -sa $name.out.data.sa]
+pfsave $data -pfb $name.out.data.pfb
+pfsave $data -pfb $name.out.touched.pfb
+
+set eager [pfload $name.out.data.pfb]
+set lazy [pfload -lazy $name.out.data.pfb]
+set touched [pfload -lazy $name.out.touched.pfb]
+
+# read one layer of the lazy dataset before the file changes
+pfgetelt $lazy 0 0 2
+
+# a file rewritten with the same size is noticed from its time
+file mtime $name.out.touched.pfb [expr [file mtime $name.out.touched.pfb] - 10]
+
+#
+# Tests
+#
+set passed 1
+
+if {![catch {pfgetelt $touched 0 0 0}]} {
+    puts "FAILED : pfgetelt read a layer of a file that changed"
+    set passed 0
+}
+
+set file [open $name.out.data.pfb r+]
+chan truncate $file 100
+close $file
+
+for {set k 0} {$k < 5} {incr k} {
+    for {set j 0} {$j < 3} {incr j} {
+	for {set i 0} {$i < 4} {incr i} {
+	    if {[pfgetelt $eager $i $j $k] != [pfgetelt $data $i $j $k]} {
+		puts "FAILED : value ($i, $j, $k) changed after the file was truncated"
+		set passed 0
+	    }
+	}
+    }
+}
+
+for {set j 0} {$j < 3} {incr j} {
+    for {set i 0} {$i < 4} {incr i} {
+	if {[pfgetelt $lazy $i $j 2] != [pfgetelt $data $i $j 2]} {
+	    puts "FAILED : lazy value ($i, $j, 2) changed after the file was truncated"
+	    set passed 0
+	}
+    }
+}
+
+foreach k {0 1 3 4} {
+    if {![catch {pfgetelt $lazy 0 0 $k}]} {
+	puts "FAILED : pfgetelt read layer $k of a truncated file"
+	set passed 0
+    }
+}
+
+foreach option {"" -lazy} {
+    if {![catch {eval pfload $option $name.out.data.pfb}]} {
+	puts "FAILED : pfload $option loaded a truncated file"
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -0,0 +1,109 @@
+#
+# Test of pfpriorityfilldem on a small DEM with a pit inside a flat ring
+# of cells that drains through a single outlet on the edge.
+#
+# With epsilon 0 only the pit is raised, to the level of the flat ring.
+# With epsilon 0.01 the cells are raised in steps of epsilon away from
+# the outlet so that every cell drains.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set name "pfpriorityfilldem"
+
+set elevations {
+    9 9 9 9 9
+    9 6 6 6 9
+    5 6 2 6 9
+    9 6 6 6 9
+    9 9 9 9 9
+}
+
+set file [open $name.out.dem.sa w]
+puts $file "5 5 1"
+foreach z $elevations {
+    puts $file $z
+}
+close $file
+
+set dem [pfload -sa $name.out.dem.sa]
+pfsetgrid {5 5 1} {0.0 0.0 0.0} {1.0 1.0 1.0} $dem
+
+#
+# Tests
+#
+proc checkFill {dem filled expected nraised} {
+    set passed 1
+    set n 0
+    set raised 0
+
+    for {set j 0} {$j < 5} {incr j} {
+	for {set i 0} {$i < 5} {incr i} {
+	    set z [pfgetelt $filled $i $j 0]
+	    if {abs($z - [lindex $expected $n]) > 1e-9} {
+		puts "FAILED : cell ($i, $j) filled to $z, expected [lindex $expected $n]"
+		set passed 0
+	    }
+	    if {$z != [pfgetelt $dem $i $j 0]} {
+		incr raised
+	    }
+	    incr n
+	}
+    }
+
+    if {$raised != $nraised} {
+	puts "FAILED : $raised cells raised, expected $nraised"
+	set passed 0
+    }
+
+    return $passed
+}
+
+set passed 1
+
+set filled [pfpriorityfilldem $dem 0.0]
+if ![checkFill $dem $filled {
+    9 9 9 9 9
+    9 6 6 6 9
+    5 6 6 6 9
+    9 6 6 6 9
+    9 9 9 9 9
+} 1] {
+    set passed 0
+}
+
+set filled [pfpriorityfilldem $dem 0.01]
+if ![checkFill $dem $filled {
+    9 9    9    9    9
+    9 6.01 6.02 6.03 9
+    5 6    6.01 6.02 9
+    9 6.01 6.02 6.03 9
+    9 9    9    9    9
+} 8] {
+    set passed 0
+}
+
+# with epsilon > 0 every inner cell has a lower neighbor
+for {set j 1} {$j < 4} {incr j} {
+    for {set i 1} {$i < 4} {incr i} {
+	set z [pfgetelt $filled $i $j 0]
+	if {([pfgetelt $filled [expr $i - 1] $j 0] >= $z) &&
+	    ([pfgetelt $filled [expr $i + 1] $j 0] >= $z) &&
+	    ([pfgetelt $filled $i [expr $j - 1] 0] >= $z) &&
+	    ([pfgetelt $filled $i [expr $j + 1] 0] >= $z)} {
+	    puts "FAILED : cell ($i, $j) is a sink after filling"
+	    set passed 0
+	}
+    }
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -0,0 +1,159 @@
+#
+# Test pfreducepfb against the same reductions computed from the loaded
+# files with the cellwise arithmetic commands.
+#
+# The series is distributed over a 2 x 2 x 1 topology so the files have
+# several subgrids.  A file with a different origin or spacing in the
+# series must be rejected.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset FileVersion 4
+
+set name "pfreducepfb"
+
+set nx 7
+set ny 5
+set nz 4
+
+pfset ComputationalGrid.Lower.X  0.0
+pfset ComputationalGrid.Lower.Y  0.0
+pfset ComputationalGrid.Lower.Z  0.0
+
+pfset ComputationalGrid.DX       1.0
+pfset ComputationalGrid.DY       1.0
+pfset ComputationalGrid.DZ       1.0
+
+pfset ComputationalGrid.NX       $nx
+pfset ComputationalGrid.NY       $ny
+pfset ComputationalGrid.NZ       $nz
+
+pfset Process.Topology.P 2
+pfset Process.Topology.Q 2
+pfset Process.Topology.R 1
+
+proc WriteStep {filename nx ny nz step} {
+    set file [open $filename w]
+    puts $file "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $file [expr sin($i + 2 * $j + 3 * $k + 0.7 * $step) * ($step + 1)]
+	    }
+	}
+    }
+    close $file
+}
+
+# steps 0 to 6; the reduced series is 1, 3, 5
+for {set step 0} {$step <= 6} {incr step} {
+    set file [format "%s.out.series.%05d" $name $step]
+    WriteStep $file.sa $nx $ny $nz $step
+    set step_data [pfload -sa $file.sa]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {1.0 1.0 1.0} $step_data
+    pfsave $step_data -pfb $file.pfb
+    pfdist $file.pfb
+    pfdelete $step_data
+}
+
+set outputs [pfreducepfb $name.out.series 1 5 2 {mean min max sum variance} $name.out.reduced]
+
+#
+# The same reductions from the loaded files
+#
+set file [open $name.out.mask.sa w]
+puts $file "$nx $ny $nz"
+for {set n 0} {$n < $nx * $ny * $nz} {incr n} {
+    puts $file 1.0
+}
+close $file
+set mask [pfload -sa $name.out.mask.sa]
+
+set steps {1 3 5}
+foreach step $steps {
+    set data($step) [pfload [format "%s.out.series.%05d.pfb" $name $step]]
+}
+
+set sum [pfcellmultconst $data(1) 0.0 $mask]
+set squares [pfcellmultconst $data(1) 0.0 $mask]
+foreach step $steps {
+    set sum [pfcellsum $sum $data($step) $mask]
+    set squares [pfcellsum $squares [pfcellmult $data($step) $data($step) $mask] $mask]
+}
+set mean [pfcelldivconst $sum 3.0 $mask]
+set variance [pfcelldiff [pfcelldivconst $squares 3.0 $mask] [pfcellmult $mean $mean $mask] $mask]
+
+#
+# Tests
+#
+set passed 1
+
+set expected_outputs {}
+foreach operation {mean min max sum variance} {
+    lappend expected_outputs $name.out.reduced.$operation.pfb
+    set reduced($operation) [pfload $name.out.reduced.$operation.pfb]
+}
+if {$outputs != $expected_outputs} {
+    puts "FAILED : pfreducepfb returned <$outputs>"
+    set passed 0
+}
+
+for {set k 0} {$k < $nz} {incr k} {
+    for {set j 0} {$j < $ny} {incr j} {
+	for {set i 0} {$i < $nx} {incr i} {
+	    set values {}
+	    foreach step $steps {
+		lappend values [pfgetelt $data($step) $i $j $k]
+	    }
+	    set values [lsort -real $values]
+
+	    set expected(min) [lindex $values 0]
+	    set expected(max) [lindex $values end]
+	    set expected(mean) [pfgetelt $mean $i $j $k]
+	    set expected(sum) [pfgetelt $sum $i $j $k]
+	    set expected(variance) [pfgetelt $variance $i $j $k]
+
+	    foreach operation {mean min max sum variance} {
+		set value [pfgetelt $reduced($operation) $i $j $k]
+		if {abs($value - $expected($operation)) > 1e-10} {
+		    puts "FAILED : $operation ($i, $j, $k) is $value, expected $expected($operation)"
+		    set passed 0
+		}
+	    }
+	}
+    }
+}
+
+# a file of the series on a different grid is rejected; pfdist writes
+# the origin and spacing of the ComputationalGrid keys
+set file [format "%s.out.series.%05d" $name 3]
+foreach {key value} {Lower.X 1.0 DY 2.0} {
+    pfset ComputationalGrid.$key $value
+    pfdist $file.pfb
+
+    if {![catch {pfreducepfb $name.out.series 1 5 2 {mean} $name.out.moved}]} {
+	puts "FAILED : pfreducepfb reduced a file with a different ComputationalGrid.$key"
+	set passed 0
+    }
+
+    pfset ComputationalGrid.Lower.X 0.0
+    pfset ComputationalGrid.DY 1.0
+}
+
+# a missing file of the series is an error
+if {![catch {pfreducepfb $name.out.series 0 8 2 {mean} $name.out.missing}]} {
+    puts "FAILED : pfreducepfb reduced a series with a missing file"
+    set passed 0
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -0,0 +1,103 @@
+#
+# Test pfupstreamarea on tilted planes.
+#
+# With slopes in both x and y every cell splits its area between the
+# cell below it in x and the cell below it in y, in proportion to the
+# face fluxes |sx|*dy and |sy|*dx; the area leaving the domain adds up
+# to the number of cells.  With a slope in x only every cell drains its
+# row.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set name "pfupstreamarea"
+
+set nx 30
+set ny 20
+
+proc WritePlane {filename nx ny value} {
+    set file [open $filename w]
+    puts $file "$nx $ny 1"
+    for {set j 0} {$j < $ny} {incr j} {
+	for {set i 0} {$i < $nx} {incr i} {
+	    puts $file $value
+	}
+    }
+    close $file
+}
+
+WritePlane $name.out.dem.sa $nx $ny 100.0
+WritePlane $name.out.sx.sa $nx $ny 0.01
+WritePlane $name.out.sy.sa $nx $ny 0.03
+WritePlane $name.out.zero.sa $nx $ny 0.0
+
+set dem [pfload -sa $name.out.dem.sa]
+set sx [pfload -sa $name.out.sx.sa]
+set sy [pfload -sa $name.out.sy.sa]
+set zero [pfload -sa $name.out.zero.sa]
+
+foreach dataset [list $dem $sx $sy $zero] {
+    pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {2.0 1.0 1.0} $dataset
+}
+
+# positive slopes drain towards i - 1 and j - 1
+set area [pfupstreamarea $dem $sx $sy]
+set row [pfupstreamarea $dem $sx $zero]
+
+#
+# Tests
+#
+set passed 1
+
+# the fraction of each cell's area going to the x and y receivers,
+# |sx|*dy and |sy|*dx with dx = 2 and dy = 1
+set wx [expr 0.01 / (0.01 + 0.03 * 2.0)]
+set wy [expr 0.03 * 2.0 / (0.01 + 0.03 * 2.0)]
+
+set outflow 0.0
+for {set j [expr $ny - 1]} {$j >= 0} {incr j -1} {
+    for {set i [expr $nx - 1]} {$i >= 0} {incr i -1} {
+	set expected 1.0
+	if {$i < $nx - 1} {
+	    set expected [expr $expected + $wx * $reference([expr $i + 1],$j)]
+	}
+	if {$j < $ny - 1} {
+	    set expected [expr $expected + $wy * $reference($i,[expr $j + 1])]
+	}
+	set reference($i,$j) $expected
+
+	set value [pfgetelt $area $i $j 0]
+	if {abs($value - $expected) > 1e-10 * $expected} {
+	    puts "FAILED : area ($i, $j) is $value, expected $expected"
+	    set passed 0
+	}
+
+	if {$i == 0} {
+	    set outflow [expr $outflow + $wx * $value]
+	}
+	if {$j == 0} {
+	    set outflow [expr $outflow + $wy * $value]
+	}
+
+	if {[pfgetelt $row $i $j 0] != $nx - $i} {
+	    puts "FAILED : row area ($i, $j) is [pfgetelt $row $i $j 0], expected [expr $nx - $i]"
+	    set passed 0
+	}
+    }
+}
+
+if {abs($outflow - $nx * $ny) > 1e-8} {
+    puts "FAILED : area leaving the domain is $outflow, expected [expr $nx * $ny]"
+    set passed 0
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -0,0 +1,92 @@
+#
+# Test of pfxdmfgeometry and pfxdmfsave on a small terrain following grid.
+#
+# The raw data and geometry files and the XDMF descriptions are compared
+# byte for byte with the files in correct_output.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set name "pfxdmf"
+
+#-----------------------------------------------------------------------------
+# A 4x3x2 dataset with distinct values and a sloping DEM
+#-----------------------------------------------------------------------------
+
+set file [open $name.out.data.sa w]
+puts $file "4 3 2"
+for {set k 0} {$k < 2} {incr k} {
+    for {set j 0} {$j < 3} {incr j} {
+	for {set i 0} {$i < 4} {incr i} {
+	    puts $file [expr $i + 10 * $j + 100 * $k + 0.25]
+	}
+    }
+}
+close $file
+
+set file [open $name.out.dem.sa w]
+puts $file "4 3 1"
+for {set j 0} {$j < 3} {incr j} {
+    for {set i 0} {$i < 4} {incr i} {
+	puts $file [expr 5.0 + 0.5 * $i - 0.25 * $j]
+    }
+}
+close $file
+
+set data [pfload -sa $name.out.data.sa]
+pfsetgrid {4 3 2} {0.0 0.0 0.0} {10.0 20.0 1.0} $data
+
+set dem [pfload -sa $name.out.dem.sa]
+pfsetgrid {4 3 1} {0.0 0.0 0.0} {10.0 20.0 1.0} $dem
+
+#-----------------------------------------------------------------------------
+# Write the grid once and two steps that refer to it, and a uniform grid
+# step in float
+#-----------------------------------------------------------------------------
+
+pfxdmfgeometry $data $dem $name.out.grid.bin -tfg "2 1.5 0.5"
+pfxdmfsave $data $name.out.press.00005.xmf -var "Press" -time 5 -geometry $name.out.grid.bin
+pfxdmfsave $data $name.out.pressf.xmf -var "Press" -flt
+
+#
+# Tests
+#
+proc readBytes {filename} {
+    set file [open $filename r]
+    fconfigure $file -translation binary
+    set bytes [read $file]
+    close $file
+    return $bytes
+}
+
+set passed 1
+
+foreach {file size} [list grid.bin [expr 5 * 4 * 3 * 3 * 8] \
+			  press.00005.bin [expr 4 * 3 * 2 * 8] \
+			  press.00005.xmf 0 \
+			  pressf.bin [expr 4 * 3 * 2 * 4] \
+			  pressf.xmf 0] {
+    set output [readBytes $name.out.$file]
+
+    if {![file exists ../correct_output/$name.out.$file]} {
+	puts "FAILED : regression check output file <../correct_output/$name.out.$file> does not exist"
+	set passed 0
+    } elseif {$size && ([string length $output] != $size)} {
+	puts "FAILED : $name.out.$file has [string length $output] bytes, expected $size"
+	set passed 0
+    } elseif {![string equal $output [readBytes ../correct_output/$name.out.$file]]} {
+	puts "FAILED : $name.out.$file differs from the regression output"
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "$name : PASSED"
+} {
+    puts "$name : FAILED"
+}
@@ -302,6 +302,9 @@ pfset Solver.WriteSiloPressure True
 pfset Solver.WriteSiloSaturation True
 pfset Solver.WriteSiloConcentration True
 
+pfset Solver.PrintSpecificStorage True
+pfset Solver.PrintWaterBalance True
+
 #-----------------------------------------------------------------------------
 # Run and Unload the ParFlow output files
 #-----------------------------------------------------------------------------
@@ -333,6 +336,34 @@ foreach i "00000 00001 00002" {
 }
 }
 
+#
+# The water balance computed during the run must match pftools
+#
+set mask             [pfload $runname.out.mask.pfb]
+set top              [pfcomputetop $mask]
+set porosity         [pfload $runname.out.porosity.pfb]
+set specific_storage [pfload $runname.out.specific_storage.pfb]
+
+set file [open $runname.out.water_balance.csv r]
+gets $file header
+while {[gets $file line] >= 0} {
+    set fields [split $line ","]
+    set i [format "%05d" [lindex $fields 0]]
+
+    set pressure   [pfload $runname.out.press.$i.pfb]
+    set saturation [pfload $runname.out.satur.$i.pfb]
+
+    set subsurface_storage [pfsum [pfsubsurfacestorage $mask $porosity $pressure $saturation $specific_storage]]
+    if ![pftestIsEqual $subsurface_storage [lindex $fields 2] "Subsurface storage for timestep $i"] {
+	set passed 0
+    }
+
+    set surface_storage [pfsum [pfsurfacestorage $top $pressure]]
+    if ![pftestIsEqual $surface_storage [lindex $fields 3] "Surface storage for timestep $i"] {
+	set passed 0
+    }
+}
+close $file
 
 if $passed {
     puts "$runname : PASSED"